@@ -0,0 +1,88 @@
+/**
+ * allocation_counter.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Replaces global 'operator new' to count heap allocations. Include it
+ * into exactly one translation unit of a benchmark.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+
+namespace xw::bench
+{
+
+inline std::atomic<size_t> allocations_count = 0;
+
+// Runs 'func' 'iterations' times and prints average count
+// of heap allocations made by a single iteration.
+template <typename FuncT>
+inline double count_allocations(const std::string& name, size_t iterations, FuncT func)
+{
+	// Lazy initialization is not counted.
+	func();
+
+	auto start = allocations_count.load();
+	for (size_t i = 0; i < iterations; i++)
+	{
+		func();
+	}
+
+	auto allocations_per_op = (double)(allocations_count.load() - start) / (double)iterations;
+	std::printf("%-56s %10zu iterations %12.1f allocs/op\n", name.c_str(), iterations, allocations_per_op);
+	return allocations_per_op;
+}
+
+}
+
+void* operator new(size_t size)
+{
+	xw::bench::allocations_count.fetch_add(1, std::memory_order_relaxed);
+	if (auto* pointer = std::malloc(size ? size : 1))
+	{
+		return pointer;
+	}
+
+	throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	xw::bench::allocations_count.fetch_add(1, std::memory_order_relaxed);
+	auto align = std::max((size_t)alignment, sizeof(void*));
+	if (auto* pointer = std::aligned_alloc(align, (size + align - 1) / align * align))
+	{
+		return pointer;
+	}
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept
+{
+	std::free(pointer);
+}
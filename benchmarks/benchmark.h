@@ -0,0 +1,53 @@
+/**
+ * benchmark.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Minimal timing helpers shared by benchmarks.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+
+namespace xw::bench
+{
+
+// Prevents the compiler from optimizing away the computed value.
+template <typename T>
+inline void do_not_optimize(const T& value)
+{
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Runs 'func' 'iterations' times and prints average time
+// of a single iteration in nanoseconds.
+template <typename FuncT>
+inline double run(const std::string& name, size_t iterations, FuncT func)
+{
+	// Warm up caches and lazy initialization.
+	for (size_t i = 0; i < iterations / 10 + 1; i++)
+	{
+		func();
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < iterations; i++)
+	{
+		func();
+	}
+
+	auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+	auto ns_per_op = elapsed.count() / (double)iterations;
+	std::printf(
+		"%-56s %10zu iterations %12.1f ns/op %14.0f ops/s\n",
+		name.c_str(), iterations, ns_per_op, 1e9 / ns_per_op
+	);
+	return ns_per_op;
+}
+
+}
@@ -0,0 +1,215 @@
+/**
+ * controllers/bench_async_controllers.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Compares throughput of a controller which waits 1 ms for an upstream
+ * service when it blocks one of 16 worker threads and when it is a
+ * coroutine which is suspended on a single event loop.
+ */
+
+// C++ libraries.
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Base libraries.
+#include <xalwart.base/logger.h>
+
+// Framework libraries.
+#include "../benchmark.h"
+#include "../../src/controllers/controller.h"
+#include "../../src/controllers/async_controller.h"
+#include "../../src/utility/event_loop.h"
+
+using namespace xw;
+
+
+static const auto UPSTREAM_LATENCY = std::chrono::milliseconds(1);
+static const size_t WORKERS_COUNT = 16;
+static const size_t REQUESTS_COUNT = 2048;
+
+// Resumes coroutines on their loops when the latency passes, the same
+// way as a driver of an upstream service does when the reply arrives.
+class Upstream final
+{
+public:
+	Upstream() : _thread([this]() { this->_run(); })
+	{
+	}
+
+	~Upstream()
+	{
+		{
+			std::lock_guard lock(this->_mutex);
+			this->_stopped = true;
+		}
+
+		this->_condition.notify_one();
+		this->_thread.join();
+	}
+
+	auto call(util::EventLoop& loop)
+	{
+		struct Awaiter
+		{
+			Upstream* upstream;
+			util::EventLoop* loop;
+
+			bool await_ready() const noexcept
+			{
+				return false;
+			}
+
+			void await_suspend(std::coroutine_handle<> handle) const
+			{
+				{
+					std::lock_guard lock(this->upstream->_mutex);
+					this->upstream->_calls.push({std::chrono::steady_clock::now() + UPSTREAM_LATENCY, this->loop, handle});
+				}
+
+				this->upstream->_condition.notify_one();
+			}
+
+			void await_resume() const noexcept
+			{
+			}
+		};
+
+		return Awaiter{this, &loop};
+	}
+
+private:
+	struct Call
+	{
+		std::chrono::steady_clock::time_point deadline;
+		util::EventLoop* loop;
+		std::coroutine_handle<> handle;
+
+		bool operator> (const Call& other) const
+		{
+			return this->deadline > other.deadline;
+		}
+	};
+
+	std::mutex _mutex;
+	std::condition_variable _condition;
+	std::priority_queue<Call, std::vector<Call>, std::greater<>> _calls;
+	bool _stopped = false;
+	std::thread _thread;
+
+	void _run()
+	{
+		std::unique_lock lock(this->_mutex);
+		while (!this->_stopped)
+		{
+			if (this->_calls.empty())
+			{
+				this->_condition.wait(lock);
+			}
+			else if (auto deadline = this->_calls.top().deadline; deadline > std::chrono::steady_clock::now())
+			{
+				this->_condition.wait_until(lock, deadline);
+			}
+			else
+			{
+				auto call = this->_calls.top();
+				this->_calls.pop();
+				call.loop->schedule(call.handle);
+			}
+		}
+	}
+};
+
+static Upstream upstream;
+
+class BlockingController : public ctrl::Controller<>
+{
+public:
+	explicit BlockingController(const ILogger* logger) : ctrl::Controller<>({"get"}, logger)
+	{
+	}
+
+	std::unique_ptr<http::IResponse> get(http::IRequest* request) const override
+	{
+		std::this_thread::sleep_for(UPSTREAM_LATENCY);
+		return std::make_unique<http::Response>(200, "<p>Hello, World</p>");
+	}
+};
+
+class SuspendingController : public ctrl::AsyncController<>
+{
+public:
+	explicit SuspendingController(const ILogger* logger) : ctrl::AsyncController<>({"get"}, logger)
+	{
+	}
+
+	Result get(http::IRequest* request) const override
+	{
+		co_await upstream.call(util::EventLoop::current());
+		co_return std::make_unique<http::Response>(200, "<p>Hello, World</p>");
+	}
+};
+
+static util::Task<size_t> process_all(http::IRequest* request, const ILogger* logger)
+{
+	std::vector<util::Task<std::unique_ptr<http::IResponse>>> tasks;
+	tasks.reserve(REQUESTS_COUNT);
+	for (size_t i = 0; i < REQUESTS_COUNT; i++)
+	{
+		tasks.push_back(ctrl::_dispatch_async(std::make_unique<SuspendingController>(logger), request, std::tuple<>()));
+		tasks.back().start();
+	}
+
+	size_t processed = 0;
+	for (auto& task : tasks)
+	{
+		processed += (co_await task)->get_status() == 200;
+	}
+
+	co_return processed;
+}
+
+int main()
+{
+	auto logger_config = log::Config();
+	logger_config.disable_all_levels();
+	log::Logger logger(logger_config);
+
+	net::RequestContext context;
+	context.method = "GET";
+	context.path = "/hello/";
+	context.headers = {{"Host", "127.0.0.1"}};
+	http::Request request(context, 99999, 99, 9999, 99, 9999, {});
+
+	auto ns_per_op = bench::run("blocking controller, 16 workers", 4, [&]() {
+		std::atomic<size_t> next = 0;
+		std::vector<std::thread> workers;
+		for (size_t i = 0; i < WORKERS_COUNT; i++)
+		{
+			workers.emplace_back([&]() {
+				while (next++ < REQUESTS_COUNT)
+				{
+					bench::do_not_optimize(BlockingController(&logger).dispatch(&request));
+				}
+			});
+		}
+
+		for (auto& worker : workers)
+		{
+			worker.join();
+		}
+	});
+	std::printf("%56s %.0f requests/s\n", "", REQUESTS_COUNT / ns_per_op * 1e9);
+
+	ns_per_op = bench::run("asynchronous controller, 1 event loop", 4, [&]() {
+		bench::do_not_optimize(util::EventLoop::current().run_until_complete(process_all(&request, &logger)));
+	});
+	std::printf("%56s %.0f requests/s\n", "", REQUESTS_COUNT / ns_per_op * 1e9);
+
+	return 0;
+}
@@ -0,0 +1,100 @@
+/**
+ * http/bench_file_response.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Sends 1 KB, 1 MB and 1 GB files to a pipe using copying 'get_chunk()'
+ * and memory-mapped 'get_chunk_view()' and reports throughput and peak
+ * resident set size. The pipe is drained by a separate thread, so the
+ * kernel copies the data just like it does for a socket.
+ */
+
+// C++ libraries.
+#include <filesystem>
+#include <thread>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+// Framework libraries.
+#include "../benchmark.h"
+#include "../../src/http/response.h"
+
+using namespace xw;
+
+
+static long max_rss_kb()
+{
+	struct rusage usage{};
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+static std::string make_file(size_t size)
+{
+	auto file_path = std::filesystem::temp_directory_path() / ("xw_bench_" + std::to_string(size) + ".bin");
+	std::string block(64 * 1024, 'x');
+	auto fd = ::open(file_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	for (size_t written = 0; written < size; written += block.size())
+	{
+		auto count = std::min(block.size(), size - written);
+		if (::write(fd, block.data(), count) != (ssize_t)count)
+		{
+			break;
+		}
+	}
+
+	::close(fd);
+	return file_path.string();
+}
+
+int main()
+{
+	int pipe_fds[2];
+	if (::pipe(pipe_fds) != 0)
+	{
+		return 1;
+	}
+
+	auto sink = pipe_fds[1];
+	std::thread drain([source = pipe_fds[0]]() {
+		std::string buffer(1024 * 1024, '\0');
+		while (::read(source, buffer.data(), buffer.size()) > 0)
+		{
+		}
+
+		::close(source);
+	});
+	for (size_t size : {1024ul, 1024ul * 1024, 1024ul * 1024 * 1024})
+	{
+		auto file_path = make_file(size);
+		size_t iterations = std::max<size_t>(3, (1024ul * 1024 * 1024) / size / 8);
+		auto suffix = " (" + std::to_string(size / 1024) + " KB)";
+
+		auto ns_per_op = bench::run("get_chunk" + suffix, iterations, [&]() {
+			http::FileResponse response(file_path);
+			std::string chunk;
+			while (!(chunk = response.get_chunk()).empty())
+			{
+				bench::do_not_optimize(::write(sink, chunk.data(), chunk.size()));
+			}
+		});
+		std::printf("%56s %.1f MB/s, max RSS %ld KB\n", "", size / ns_per_op * 1e9 / 1e6, max_rss_kb());
+
+		ns_per_op = bench::run("get_chunk_view" + suffix, iterations, [&]() {
+			http::FileResponse response(file_path);
+			std::string_view chunk;
+			while (!(chunk = response.get_chunk_view()).empty())
+			{
+				bench::do_not_optimize(::write(sink, chunk.data(), chunk.size()));
+			}
+		});
+		std::printf("%56s %.1f MB/s, max RSS %ld KB\n", "", size / ns_per_op * 1e9 / 1e6, max_rss_kb());
+
+		std::filesystem::remove(file_path);
+	}
+
+	::close(sink);
+	drain.join();
+	return 0;
+}
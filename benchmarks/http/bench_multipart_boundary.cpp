@@ -0,0 +1,101 @@
+/**
+ * http/bench_multipart_boundary.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Scans 1 GB of synthetic multipart bodies for the boundary in windows
+ * of the size of the buffered reader, the same way as 'PartReader' does.
+ * Bodies are random binary data, text with CRLF line endings and text
+ * which contains many lines starting with "--".
+ */
+
+// C++ libraries.
+#include <cstring>
+#include <random>
+#include <string>
+#include <string_view>
+
+// Framework libraries.
+#include "../benchmark.h"
+#include "../../src/http/mime/multipart/part_reader.h"
+
+using namespace xw;
+
+
+static const std::string BOUNDARY = "----WebKitFormBoundary7MA4YWxkTrZu0gW";
+static const size_t BODY_SIZE = 64 * 1024 * 1024;
+static const size_t WINDOW_SIZE = 64 * 1024;
+
+static std::string make_binary_body()
+{
+	std::mt19937_64 random(42);
+	std::string result(BODY_SIZE, '\0');
+	for (size_t i = 0; i + 8 <= result.size(); i += 8)
+	{
+		auto value = random();
+		std::memcpy(result.data() + i, &value, 8);
+	}
+
+	return result;
+}
+
+static std::string make_text_body(std::string_view line)
+{
+	std::string result;
+	result.reserve(BODY_SIZE + line.size());
+	while (result.size() < BODY_SIZE)
+	{
+		result.append(line);
+	}
+
+	result.resize(BODY_SIZE);
+	return result;
+}
+
+// Returns the size of the body before the boundary.
+static size_t scan_body(std::string_view body, const http::mime::multipart::BoundaryMatcher& matcher)
+{
+	auto dash_boundary = std::string_view(matcher.boundary()).substr(2);
+	size_t position = 0;
+	while (position < body.size())
+	{
+		auto window = body.substr(position, WINDOW_SIZE);
+		auto [n, ok] = http::mime::multipart::_scan_until_boundary(
+			window, dash_boundary, matcher, (ssize_t)position
+		);
+		position += n;
+		if (!ok || n == 0)
+		{
+			break;
+		}
+	}
+
+	return position;
+}
+
+int main()
+{
+	http::mime::multipart::BoundaryMatcher matcher("\r\n--" + BOUNDARY);
+	auto closing = "\r\n--" + BOUNDARY + "--\r\n";
+	const std::pair<std::string, std::string> BODIES[] = {
+		{"binary", make_binary_body() + closing},
+		{"text with CRLF", make_text_body("Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do.\r\n") + closing},
+		{"text with dashes", make_text_body("\r\n--\r\n----WebKit\r\n--------WebKitFormBoundary7MA4YWxk\r\n-") + closing}
+	};
+
+	// Each iteration scans 64 MB, so each body is scanned 16 times.
+	for (const auto& [name, body] : BODIES)
+	{
+		auto ns_per_op = bench::run("scan_until_boundary: " + name, 16, [&]() {
+			bench::do_not_optimize(scan_body(body, matcher));
+		});
+		std::printf("%56s %.1f MB/s\n", "", BODY_SIZE / ns_per_op * 1e9 / 1e6);
+
+		ns_per_op = bench::run("string_view::find (reference): " + name, 16, [&]() {
+			bench::do_not_optimize(std::string_view(body).find(matcher.boundary()));
+		});
+		std::printf("%56s %.1f MB/s\n", "", BODY_SIZE / ns_per_op * 1e9 / 1e6);
+	}
+
+	return 0;
+}
@@ -0,0 +1,115 @@
+/**
+ * http/bench_request_allocations.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Reports heap allocations and time per request for hello-world and
+ * JSON responses, and for a response which reads a cookie, when the
+ * request is allocated on the heap and when it is allocated from the
+ * per-request arena which the server passes to 'conf::Application'.
+ * 'RequestView' refers to headers of the server instead of copying them.
+ */
+
+// C++ libraries.
+#include <map>
+#include <memory_resource>
+
+// Framework libraries.
+#include "../allocation_counter.h"
+#include "../benchmark.h"
+#include "../../src/http/request.h"
+#include "../../src/http/response.h"
+#include "../../src/utility/arena.h"
+
+using namespace xw;
+
+
+static std::unique_ptr<http::IResponse> hello_world(http::IRequest*)
+{
+	return std::make_unique<http::Response>(200, "Hello, World!", "text/plain");
+}
+
+static std::unique_ptr<http::IResponse> json(http::IRequest* request)
+{
+	return std::make_unique<http::JsonResponse>(nlohmann::json{
+		{"message", "Hello, World!"},
+		{"path", request->url().path},
+		{"page", request->url().query().get("page")}
+	});
+}
+
+// The jar of cookies is allocated from the resource of the request.
+static std::unique_ptr<http::IResponse> session(http::IRequest* request)
+{
+	auto session_id = request->cookie_jar().get("sessionid");
+	return std::make_unique<http::Response>(200, std::string(session_id.value_or("")), "text/plain");
+}
+
+template <typename HandlerT>
+static size_t handle_on_heap(
+	const net::RequestContext& context, const std::map<std::string, std::string>& environment, HandlerT handler
+)
+{
+	auto request = std::make_shared<http::Request>(context, 99999, 99, 9999, 99, 9999, environment);
+	auto response = handler(request.get());
+	return response->serialize_slices().size();
+}
+
+template <typename RequestT, typename HandlerT>
+static size_t handle_in_arena(
+	const net::RequestContext& context, const std::map<std::string, std::string>& environment,
+	util::Arena& arena, HandlerT handler
+)
+{
+	util::ArenaResetGuard reset_guard(arena);
+	auto request = std::allocate_shared<RequestT>(
+		std::pmr::polymorphic_allocator<RequestT>(arena.resource()),
+		context, 99999, 99, 9999, 99, 9999, environment, arena.resource()
+	);
+	auto response = handler(request.get());
+	return response->serialize_slices().size();
+}
+
+int main()
+{
+	net::RequestContext context;
+	context.method = "GET";
+	context.path = "/products/";
+	context.query = "page=2&sort=price";
+	context.headers = {
+		{"Host", "127.0.0.1"},
+		{"Accept", "text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8"},
+		{"Accept-Encoding", "gzip, deflate, br"},
+		{"Cookie", "sessionid=0123456789abcdef; csrftoken=fedcba9876543210"},
+		{"User-Agent", "Mozilla/5.0 (X11; Linux x86_64) Gecko/20100101 Firefox/89.0"}
+	};
+	std::map<std::string, std::string> environment = {{"REMOTE_ADDR", "127.0.0.1"}};
+	util::Arena arena;
+
+	const size_t iterations = 200000;
+	for (const auto& [name, handler] : std::map<std::string, decltype(&hello_world)>{
+		{"hello-world", hello_world}, {"json", json}, {"session", session}
+	})
+	{
+		bench::count_allocations(name + ": request on heap", iterations, [&]() {
+			bench::do_not_optimize(handle_on_heap(context, environment, handler));
+		});
+		bench::count_allocations(name + ": request in arena", iterations, [&]() {
+			bench::do_not_optimize(handle_in_arena<http::Request>(context, environment, arena, handler));
+		});
+		bench::count_allocations(name + ": request view in arena", iterations, [&]() {
+			bench::do_not_optimize(handle_in_arena<http::RequestView>(context, environment, arena, handler));
+		});
+		bench::run(name + ": request on heap", iterations, [&]() {
+			bench::do_not_optimize(handle_on_heap(context, environment, handler));
+		});
+		bench::run(name + ": request in arena", iterations, [&]() {
+			bench::do_not_optimize(handle_in_arena<http::Request>(context, environment, arena, handler));
+		});
+		bench::run(name + ": request view in arena", iterations, [&]() {
+			bench::do_not_optimize(handle_in_arena<http::RequestView>(context, environment, arena, handler));
+		});
+	}
+
+	return 0;
+}
@@ -0,0 +1,192 @@
+/**
+ * http/bench_transfer_decoders.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Decodes 100 MB of "base64" and "quoted-printable" part bodies with
+ * 'Base64Reader' and 'QuotePrintableReader' reading blocks of the size
+ * of the buffered reader. Naive decoders which handle one character at
+ * a time are measured on the same data for reference.
+ */
+
+// C++ libraries.
+#include <cstring>
+#include <random>
+#include <string>
+#include <string_view>
+
+// Framework libraries.
+#include "../benchmark.h"
+#include "../../src/http/mime/multipart/base64_reader.h"
+#include "../../src/http/mime/multipart/quote_printable_reader.h"
+
+using namespace xw;
+
+
+static const size_t DATA_SIZE = 100 * 1024 * 1024;
+static const size_t WINDOW_SIZE = 64 * 1024;
+static const std::string BASE64_ALPHABET = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Returns the body by windows, the same way as 'PartReader' does.
+class StringReader : public io::IReader
+{
+public:
+	explicit StringReader(std::string_view data) : _data(data)
+	{
+	}
+
+	ssize_t read_line(std::string& buffer) override
+	{
+		throw NotImplementedException("StringReader::read_line(std::string& buffer)", _ERROR_DETAILS_);
+	}
+
+	ssize_t read(std::string& buffer, size_t max_count) override
+	{
+		buffer.assign(this->_data.substr(0, std::min(max_count, WINDOW_SIZE)));
+		this->_data.remove_prefix(buffer.size());
+		return (ssize_t)buffer.size();
+	}
+
+	bool close_reader() override
+	{
+		return true;
+	}
+
+private:
+	std::string_view _data;
+};
+
+// Encodes random bytes to lines of 76 characters separated by CRLF.
+static std::string make_base64_body()
+{
+	std::mt19937_64 random(42);
+	std::string result;
+	result.reserve(DATA_SIZE / 3 * 4 + DATA_SIZE / 57 * 2 + 80);
+	size_t line_size = 0;
+	for (size_t i = 0; i < DATA_SIZE; i += 3)
+	{
+		auto value = random();
+		for (size_t j = 0; j < 4; j++)
+		{
+			result.push_back(BASE64_ALPHABET[value >> (j * 6) & 63]);
+		}
+
+		line_size += 4;
+		if (line_size == 76)
+		{
+			result.append("\r\n");
+			line_size = 0;
+		}
+	}
+
+	return result;
+}
+
+// Text with escaped non-ASCII characters and soft line breaks.
+static std::string make_quote_printable_body()
+{
+	std::string_view line = "Lorem ipsum dolor sit amet, =C3=A9t=C3=A9 consectetur adipiscing elit, sed=\r\n";
+	std::string result;
+	result.reserve(DATA_SIZE + line.size());
+	while (result.size() < DATA_SIZE)
+	{
+		result.append(line);
+	}
+
+	result.append("do.\r\n");
+	return result;
+}
+
+template <typename ReaderT>
+static size_t decode_body(std::string_view body)
+{
+	ReaderT reader(std::make_shared<StringReader>(body));
+	std::string buffer;
+	size_t total = 0;
+	while (reader.read(buffer, WINDOW_SIZE) > 0)
+	{
+		total += buffer.size();
+	}
+
+	return total;
+}
+
+static size_t naive_decode_base64(std::string_view body)
+{
+	std::string result;
+	unsigned int value = 0;
+	int bits = 0;
+	for (char c : body)
+	{
+		auto position = BASE64_ALPHABET.find(c);
+		if (position == std::string::npos)
+		{
+			continue;
+		}
+
+		value = value << 6 | (unsigned int)position;
+		bits += 6;
+		if (bits >= 8)
+		{
+			bits -= 8;
+			result.push_back((char)(value >> bits & 0xFF));
+		}
+	}
+
+	return result.size();
+}
+
+static size_t naive_decode_quote_printable(std::string_view body)
+{
+	std::string result;
+	for (size_t i = 0; i < body.size(); i++)
+	{
+		if (body[i] != '=')
+		{
+			result.push_back(body[i]);
+		}
+		else if (body.substr(i + 1, 2) == "\r\n")
+		{
+			i += 2;
+		}
+		else
+		{
+			result.push_back((char)std::stoi(std::string(body.substr(i + 1, 2)), nullptr, 16));
+			i += 2;
+		}
+	}
+
+	return result.size();
+}
+
+static void print_throughput(size_t size, double ns_per_op)
+{
+	std::printf("%56s %.1f MB/s\n", "", (double)size / ns_per_op * 1e9 / 1e6);
+}
+
+int main()
+{
+	auto base64_body = make_base64_body();
+	auto ns_per_op = bench::run("Base64Reader", 5, [&]() {
+		bench::do_not_optimize(decode_body<http::mime::multipart::Base64Reader>(base64_body));
+	});
+	print_throughput(base64_body.size(), ns_per_op);
+
+	ns_per_op = bench::run("naive base64 decoder (reference)", 5, [&]() {
+		bench::do_not_optimize(naive_decode_base64(base64_body));
+	});
+	print_throughput(base64_body.size(), ns_per_op);
+
+	auto quote_printable_body = make_quote_printable_body();
+	ns_per_op = bench::run("QuotePrintableReader", 5, [&]() {
+		bench::do_not_optimize(decode_body<http::mime::multipart::QuotePrintableReader>(quote_printable_body));
+	});
+	print_throughput(quote_printable_body.size(), ns_per_op);
+
+	ns_per_op = bench::run("naive quoted-printable decoder (reference)", 5, [&]() {
+		bench::do_not_optimize(naive_decode_quote_printable(quote_printable_body));
+	});
+	print_throughput(quote_printable_body.size(), ns_per_op);
+
+	return 0;
+}
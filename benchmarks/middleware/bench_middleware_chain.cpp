@@ -0,0 +1,74 @@
+/**
+ * middleware/bench_middleware_chain.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Compares processing of requests through 6-middleware stack when
+ * the chain is built for every request and when it is built once.
+ */
+
+// Base libraries.
+#include <xalwart.base/logger.h>
+
+// Framework libraries.
+#include "../benchmark.h"
+#include "../../src/conf/settings.h"
+#include "../../src/middleware/chain.h"
+#include "../../src/middleware/clickjacking.h"
+#include "../../src/middleware/common.h"
+#include "../../src/middleware/exception.h"
+#include "../../src/middleware/http.h"
+#include "../../src/middleware/security.h"
+
+using namespace xw;
+
+
+int main()
+{
+	auto logger_config = log::Config();
+	logger_config.disable_all_levels();
+
+	conf::Settings settings;
+	settings.LOGGER = std::make_shared<log::Logger>(logger_config);
+	settings.ALLOWED_HOSTS = {"*"};
+	settings.MIDDLEWARE = {
+		middleware::Exception(&settings),
+		middleware::Security(&settings),
+		middleware::Common(&settings),
+		middleware::ConditionalGet(),
+		middleware::XFrameOptions(&settings),
+		[](const middleware::Function& next) -> middleware::Function
+		{
+			return [next](http::IRequest* request) -> std::unique_ptr<http::IResponse>
+			{
+				auto response = next(request);
+				response->set_header("X-Request-Processed", "1");
+				return response;
+			};
+		}
+	};
+
+	middleware::Function controller = [](http::IRequest*) -> std::unique_ptr<http::IResponse>
+	{
+		return std::make_unique<http::Response>(200, "<p>Hello, World</p>");
+	};
+
+	net::RequestContext context;
+	context.method = "GET";
+	context.path = "/hello/";
+	context.headers = {{"Host", "127.0.0.1"}};
+	http::Request request(context, 99999, 99, 9999, 99, 9999, {});
+
+	const size_t iterations = 200000;
+	bench::run("chain built per request (6 middleware)", iterations, [&]() {
+		auto chain = middleware::build_chain(settings.MIDDLEWARE, controller);
+		bench::do_not_optimize(chain(&request));
+	});
+
+	auto chain = middleware::build_chain(settings.MIDDLEWARE, controller);
+	bench::run("chain built once (6 middleware)", iterations, [&]() {
+		bench::do_not_optimize(chain(&request));
+	});
+
+	return 0;
+}
@@ -0,0 +1,272 @@
+/**
+ * server/bench_http_server.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Serves applications by 'HTTPServer' on the loopback interface. Measures
+ * throughput of hello-world for clients which open a connection per request,
+ * with a single event loop and with an event loop per core, and latency of
+ * 1 KB JSON endpoint with system calls of the server per request, for
+ * clients which open a connection per request and which reuse connections.
+ */
+
+// C++ libraries.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Base libraries.
+#include <xalwart.base/logger.h>
+
+// Framework libraries.
+#include "../benchmark.h"
+#include "../syscall_counter.h"
+#include "../../src/http/request.h"
+#include "../../src/http/response.h"
+#include "../../src/server/http_server.h"
+
+using namespace xw;
+
+
+static const size_t CLIENTS_COUNT = 32;
+static const size_t REQUESTS_COUNT = 20000;
+static const size_t LATENCY_CLIENTS_COUNT = 8;
+static const std::string REQUEST = "GET /hello/ HTTP/1.1\r\nHost: 127.0.0.1\r\nUser-Agent: bench\r\n\r\n";
+static const std::string JSON_REQUEST = "GET /items/ HTTP/1.1\r\n"
+	"Host: 127.0.0.1\r\nUser-Agent: bench\r\nAccept: application/json\r\n\r\n";
+
+// Returns list of items which takes about 1 KB when it is serialized.
+static nlohmann::json make_items()
+{
+	auto items = nlohmann::json::array();
+	for (int i = 0; i < 12; i++)
+	{
+		items.push_back({
+			{"id", i},
+			{"name", "Item #" + std::to_string(i)},
+			{"price", 9.99 + i},
+			{"tags", {"new", "sale"}}
+		});
+	}
+
+	return {{"items", items}, {"count", items.size()}};
+}
+
+// The same steps as 'conf::Application' does, without middleware.
+template <typename ControllerT>
+static server::Handler make_handler(ControllerT controller)
+{
+	return [controller](
+		net::RequestContext* context, const std::map<std::string, std::string>& environment,
+		std::pmr::memory_resource* memory_resource
+	) -> net::StatusCode
+	{
+		context->body->set_limit((ssize_t)context->content_size);
+		auto request = std::allocate_shared<http::RequestView>(
+			std::pmr::polymorphic_allocator<http::RequestView>(memory_resource),
+			*context, 99999, 99, 9999, 99, 9999, environment, memory_resource
+		);
+		auto response = controller(request.get());
+		auto slices = response->serialize_slices();
+		slices.head.append(slices.body);
+		context->response_writer->write(slices.head.c_str(), slices.head.size());
+		return response->get_status();
+	};
+}
+
+static std::unique_ptr<http::IResponse> hello_world(http::IRequest*)
+{
+	return std::make_unique<http::Response>(200, "Hello, World!", "text/plain");
+}
+
+static std::unique_ptr<http::IResponse> items(http::IRequest*)
+{
+	static const auto items = make_items();
+	return std::make_unique<http::JsonResponse>(items);
+}
+
+static int connect_to(uint16_t port)
+{
+	int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+	sockaddr_in address{};
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (::connect(fd, (sockaddr*)&address, sizeof(address)) < 0)
+	{
+		::close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+// Sends `request` and receives the response with 'Content-Length' header.
+//
+// @return the response, or empty string if it is not received completely.
+static std::string exchange(int fd, const std::string& request)
+{
+	if (::send(fd, request.data(), request.size(), MSG_NOSIGNAL) != (ssize_t)request.size())
+	{
+		return "";
+	}
+
+	std::string response;
+	char buffer[4096];
+	size_t response_size = 0;
+	while (response_size == 0 || response.size() < response_size)
+	{
+		auto n = ::recv(fd, buffer, sizeof(buffer), 0);
+		if (n <= 0)
+		{
+			return "";
+		}
+
+		response.append(buffer, n);
+		auto head_end = response.find("\r\n\r\n");
+		if (response_size == 0 && head_end != std::string::npos)
+		{
+			auto length_start = response.find("Content-Length: ") + 16;
+			response_size = head_end + 4 + std::stoul(response.substr(length_start, 16));
+		}
+	}
+
+	return response.size() == response_size ? response : "";
+}
+
+// Returns true if the server closes the connection after `response`,
+// see 'Config::max_requests_per_connection'.
+static bool is_closing(const std::string& response)
+{
+	return response.find("\r\nConnection: close\r\n") < response.find("\r\n\r\n");
+}
+
+static std::unique_ptr<server::HTTPServer> start_server(
+	server::Handler handler, size_t workers_count, std::thread& thread
+)
+{
+	auto logger_config = log::Config();
+	logger_config.disable_all_levels();
+	auto server = std::make_unique<server::HTTPServer>(
+		server::Config{.workers = workers_count}, std::move(handler), std::make_shared<log::Logger>(logger_config)
+	);
+	server->bind("127.0.0.1", 0);
+	thread = std::thread([server = server.get()]() { server->listen(""); });
+	return server;
+}
+
+static void bench_workers(const std::string& name, size_t workers_count)
+{
+	std::thread server_thread;
+	auto server = start_server(make_handler(hello_world), workers_count, server_thread);
+
+	std::atomic<size_t> failed = 0;
+	auto ns_per_op = bench::run(name, 4, [&]() {
+		std::atomic<size_t> next = 0;
+		std::vector<std::thread> clients;
+		for (size_t i = 0; i < CLIENTS_COUNT; i++)
+		{
+			clients.emplace_back([&]() {
+				bench::is_counting_syscalls = false;
+				while (next++ < REQUESTS_COUNT)
+				{
+					int fd = connect_to(server->port());
+					failed += fd < 0 || exchange(fd, REQUEST).empty();
+					::close(fd);
+				}
+			});
+		}
+
+		for (auto& client : clients)
+		{
+			client.join();
+		}
+	});
+	std::printf("%56s %.0f requests/s, %zu failed\n", "", REQUESTS_COUNT / ns_per_op * 1e9, failed.load());
+
+	server->close();
+	server_thread.join();
+}
+
+static void bench_latency(const std::string& name, bool reuses_connections)
+{
+	std::thread server_thread;
+	auto server = start_server(make_handler(items), 1, server_thread);
+
+	std::atomic<size_t> failed = 0;
+	std::vector<std::vector<double>> latencies(LATENCY_CLIENTS_COUNT);
+	auto syscalls_count = bench::syscalls_count.load();
+	std::vector<std::thread> clients;
+	for (auto& client_latencies : latencies)
+	{
+		clients.emplace_back([&]() {
+			bench::is_counting_syscalls = false;
+			int fd = -1;
+			for (size_t i = 0; i < REQUESTS_COUNT / LATENCY_CLIENTS_COUNT; i++)
+			{
+				auto start = std::chrono::steady_clock::now();
+				if (fd < 0)
+				{
+					fd = connect_to(server->port());
+				}
+
+				auto response = fd < 0 ? "" : exchange(fd, JSON_REQUEST);
+				if (!reuses_connections || response.empty() || is_closing(response))
+				{
+					::close(fd);
+					fd = -1;
+				}
+
+				client_latencies.push_back(
+					std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count()
+				);
+				failed += response.empty();
+			}
+
+			::close(fd);
+		});
+	}
+
+	for (auto& client : clients)
+	{
+		client.join();
+	}
+
+	auto syscalls_per_request = (double)(bench::syscalls_count.load() - syscalls_count) / REQUESTS_COUNT;
+	server->close();
+	server_thread.join();
+
+	std::vector<double> all;
+	for (const auto& client_latencies : latencies)
+	{
+		all.insert(all.end(), client_latencies.begin(), client_latencies.end());
+	}
+
+	std::sort(all.begin(), all.end());
+	std::printf(
+		"%-56s %10zu requests %9.1f us p50 %9.1f us p99 %8.1f syscalls/request, %zu failed\n",
+		name.c_str(), all.size(), all[all.size() / 2], all[all.size() * 99 / 100], syscalls_per_request, failed.load()
+	);
+}
+
+int main()
+{
+	auto cores = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+	bench_workers("hello world, 1 event loop", 1);
+	if (cores > 1)
+	{
+		bench_workers("hello world, " + std::to_string(cores) + " event loops", cores);
+	}
+
+	bench_latency("1 KB JSON, connection per request", false);
+	bench_latency("1 KB JSON, persistent connections", true);
+	return 0;
+}
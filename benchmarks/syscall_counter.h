@@ -0,0 +1,108 @@
+/**
+ * syscall_counter.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Replaces socket and epoll functions of libc to count system calls which
+ * are made by the server. Include it into exactly one translation unit of
+ * a benchmark and link the benchmark with 'CMAKE_DL_LIBS'.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <atomic>
+#include <dlfcn.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+
+namespace xw::bench
+{
+
+inline std::atomic<size_t> syscalls_count = 0;
+
+// Threads of clients disable it, so only calls of the server are counted.
+inline thread_local bool is_counting_syscalls = true;
+
+// Returns the function of libc which is replaced.
+template <typename FuncT>
+inline FuncT* next_function(const char* name)
+{
+	return (FuncT*)::dlsym(RTLD_NEXT, name);
+}
+
+inline void count_syscall()
+{
+	if (is_counting_syscalls)
+	{
+		syscalls_count.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+}
+
+extern "C" int accept4(int fd, sockaddr* address, socklen_t* address_size, int flags)
+{
+	static auto* next = xw::bench::next_function<decltype(::accept4)>("accept4");
+	xw::bench::count_syscall();
+	return next(fd, address, address_size, flags);
+}
+
+extern "C" ssize_t recv(int fd, void* buffer, size_t n, int flags)
+{
+	static auto* next = xw::bench::next_function<decltype(::recv)>("recv");
+	xw::bench::count_syscall();
+	return next(fd, buffer, n, flags);
+}
+
+extern "C" ssize_t send(int fd, const void* buffer, size_t n, int flags)
+{
+	static auto* next = xw::bench::next_function<decltype(::send)>("send");
+	xw::bench::count_syscall();
+	return next(fd, buffer, n, flags);
+}
+
+extern "C" int setsockopt(int fd, int level, int name, const void* value, socklen_t size) noexcept
+{
+	static auto* next = xw::bench::next_function<decltype(::setsockopt)>("setsockopt");
+	xw::bench::count_syscall();
+	return next(fd, level, name, value, size);
+}
+
+extern "C" int shutdown(int fd, int how) noexcept
+{
+	static auto* next = xw::bench::next_function<decltype(::shutdown)>("shutdown");
+	xw::bench::count_syscall();
+	return next(fd, how);
+}
+
+extern "C" int close(int fd)
+{
+	static auto* next = xw::bench::next_function<decltype(::close)>("close");
+	xw::bench::count_syscall();
+	return next(fd);
+}
+
+extern "C" int poll(pollfd* descriptors, nfds_t count, int timeout)
+{
+	static auto* next = xw::bench::next_function<decltype(::poll)>("poll");
+	xw::bench::count_syscall();
+	return next(descriptors, count, timeout);
+}
+
+extern "C" int epoll_wait(int epoll, epoll_event* events, int max_count, int timeout)
+{
+	static auto* next = xw::bench::next_function<decltype(::epoll_wait)>("epoll_wait");
+	xw::bench::count_syscall();
+	return next(epoll, events, max_count, timeout);
+}
+
+extern "C" int epoll_ctl(int epoll, int operation, int fd, epoll_event* event) noexcept
+{
+	static auto* next = xw::bench::next_function<decltype(::epoll_ctl)>("epoll_ctl");
+	xw::bench::count_syscall();
+	return next(epoll, operation, fd, event);
+}
@@ -0,0 +1,75 @@
+/**
+ * urls/bench_router.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Compares linear scan of url patterns with compiled router
+ * for 10, 100 and 1000 registered routes.
+ */
+
+// C++ libraries.
+#include <vector>
+
+// Framework libraries.
+#include "../benchmark.h"
+#include "../../src/urls/pattern.h"
+#include "../../src/urls/resolver.h"
+#include "../../src/urls/router.h"
+
+using namespace xw;
+
+
+static std::vector<std::shared_ptr<urls::IPattern>> make_patterns(size_t count)
+{
+	std::vector<std::shared_ptr<urls::IPattern>> patterns;
+	patterns.reserve(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		auto resource = "resource" + std::to_string(i);
+		patterns.push_back(std::make_shared<urls::Pattern<int>>(
+			"/api/" + resource + R"(/<id>(\d+)/?)",
+			[](http::IRequest*, const std::tuple<int>&, const conf::Settings*) -> std::unique_ptr<http::IResponse>
+			{
+				return nullptr;
+			},
+			resource
+		));
+	}
+
+	return patterns;
+}
+
+int main()
+{
+	for (size_t count : {10, 100, 1000})
+	{
+		auto patterns = make_patterns(count);
+		urls::Router router(patterns);
+		auto first_path = std::string("/api/resource0/42/");
+		auto last_path = "/api/resource" + std::to_string(count - 1) + "/42/";
+		auto missing_path = std::string("/api/missing/42/");
+		size_t iterations = 1000000 / count + 1000;
+
+		auto suffix = " (" + std::to_string(count) + " routes)";
+		bench::run("linear scan: first route" + suffix, iterations, [&]() {
+			bench::do_not_optimize(urls::is_valid_path(first_path, patterns));
+		});
+		bench::run("linear scan: last route" + suffix, iterations, [&]() {
+			bench::do_not_optimize(urls::is_valid_path(last_path, patterns));
+		});
+		bench::run("linear scan: not found" + suffix, iterations, [&]() {
+			bench::do_not_optimize(urls::is_valid_path(missing_path, patterns));
+		});
+		bench::run("router: first route" + suffix, iterations, [&]() {
+			bench::do_not_optimize(urls::is_valid_path(first_path, router));
+		});
+		bench::run("router: last route" + suffix, iterations, [&]() {
+			bench::do_not_optimize(urls::is_valid_path(last_path, router));
+		});
+		bench::run("router: not found" + suffix, iterations, [&]() {
+			bench::do_not_optimize(urls::is_valid_path(missing_path, router));
+		});
+	}
+
+	return 0;
+}
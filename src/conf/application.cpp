@@ -17,14 +17,32 @@
 #include "../management/module.h"
 #include "../urls/resolver.h"
 #include "../urls/pattern.h"
+#include "../middleware/chain.h"
 #include "../middleware/exception.h"
 #include "../controllers/static.h"
+#include "../server/connection.h"
 
 
 __CONF_BEGIN__
 
+static inline http::StreamingResponse* _as_streaming_response(http::IResponse* response)
+{
+	auto* streaming_response = dynamic_cast<http::StreamingResponse*>(response);
+	if (!streaming_response)
+	{
+		throw NullPointerException(
+			"Unable to cast response to streaming response, "
+			"check if the response you returned is derived from 'xw::http::StreamingResponse'.",
+			_ERROR_DETAILS_
+		);
+	}
+
+	return streaming_response;
+}
+
 std::shared_ptr<urls::IPattern> _build_static_pattern(
-	const std::string& static_url, const std::string& static_root, const std::string& name
+	const std::string& static_url, const std::string& static_root, const std::string& name,
+	const std::shared_ptr<ctrl::StaticFileCache>& cache
 )
 {
 	if (static_url.empty())
@@ -37,14 +55,14 @@ std::shared_ptr<urls::IPattern> _build_static_pattern(
 		throw ImproperlyConfigured("empty static url name is not permitted", _ERROR_DETAILS_);
 	}
 
-	auto controller_function = [static_root](
+	auto controller_function = [static_root, cache](
 		http::IRequest* request, const std::tuple<std::string>& args, const Settings* settings
 	) -> std::unique_ptr<http::IResponse>
 	{
-		return std::apply([request, static_root, settings](const std::string& p) mutable -> auto
+		return std::apply([request, static_root, settings, cache](const std::string& p) mutable -> auto
 		{
 			require_non_null(settings, "'settings' is nullptr", _ERROR_DETAILS_);
-			ctrl::StaticController controller(static_root, settings, settings->LOGGER.get());
+			ctrl::StaticController controller(static_root, settings, settings->LOGGER.get(), cache);
 			return controller.dispatch(request, p);
 		}, args);
 	};
@@ -88,9 +106,12 @@ Application& Application::configure()
 
 	// Retrieve main module patterns and append them to result.
 	this->build_module_patterns(this->settings->URLPATTERNS);
+	this->build_router();
 
 	this->setup_template_engine();
 	this->setup_middleware();
+	this->middleware_chain = this->build_middleware_chain();
+	this->async_middleware_chain = this->build_async_middleware_chain();
 	this->setup_commands();
 
 	this->is_configured = true;
@@ -179,12 +200,12 @@ std::string Application::get_usage_message() const
 Application::ServerHandler Application::get_application_handler() const
 {
 	return [this](
-		net::RequestContext* context, const std::map<std::string, std::string>& environment
+		net::RequestContext* context, const std::map<std::string, std::string>& environment,
+		std::pmr::memory_resource* memory_resource
 	) -> net::StatusCode
 	{
-		auto request = this->build_request(context, environment);
-		auto middleware_chain = this->build_middleware_chain();
-		auto response = middleware_chain(request.get());
+		auto request = this->build_request(context, environment, memory_resource);
+		auto response = this->middleware_chain(request.get());
 		return this->send_response(context, response);
 	};
 }
@@ -194,26 +215,12 @@ middleware::Function Application::get_controller_handler() const
 	return [this](http::IRequest* request) -> std::unique_ptr<http::IResponse>
 	{
 		require_non_null(request, _ERROR_DETAILS_);
-		auto apply = urls::resolve(request->url().path, this->settings->URLPATTERNS);
+		const auto& path = request->url().path;
+		auto apply = this->settings->ROUTER ?
+			urls::resolve(path, *this->settings->ROUTER) : urls::resolve(path, this->settings->URLPATTERNS);
 		if (apply)
 		{
-			auto response = apply(request, this->settings);
-			if (!response)
-			{
-				if (this->settings->DEBUG)
-				{
-					throw NullPointerException(
-						"Controller returns nullptr on '" + request->method() + "'.",
-						_ERROR_DETAILS_
-					);
-				}
-				else
-				{
-					response = std::make_unique<http::Response>(204);
-				}
-			}
-
-			return response;
+			return this->_non_null_response(request, apply(request, this->settings));
 		}
 
 		return this->get_error_response(request, 404, "The requested resource was not found.");
@@ -222,18 +229,56 @@ middleware::Function Application::get_controller_handler() const
 
 middleware::Function Application::build_middleware_chain() const
 {
-	middleware::Function chain = this->get_controller_handler();
-	auto middleware_count = (long long)this->settings->MIDDLEWARE.size() - 1;
-	for (long long i = middleware_count; i >= 0; i--)
+	return middleware::build_chain(this->settings->MIDDLEWARE, this->get_controller_handler());
+}
+
+middleware::AsyncFunction Application::get_async_controller_handler() const
+{
+	return [this](http::IRequest* request) -> util::Task<std::unique_ptr<http::IResponse>>
 	{
-		auto next_middleware = this->settings->MIDDLEWARE[i];
-		if (next_middleware)
+		require_non_null(request, _ERROR_DETAILS_);
+		const auto& path = request->url().path;
+		auto apply = this->settings->ROUTER ?
+			urls::resolve_async(path, *this->settings->ROUTER) :
+			urls::resolve_async(path, this->settings->URLPATTERNS);
+		if (apply)
 		{
-			chain = next_middleware(chain);
+			co_return this->_non_null_response(request, co_await apply(request, this->settings));
+		}
+
+		co_return this->get_error_response(request, 404, "The requested resource was not found.");
+	};
+}
+
+middleware::AsyncFunction Application::build_async_middleware_chain() const
+{
+	const auto& middleware = this->settings->MIDDLEWARE;
+	for (size_t i = 0; i < middleware.size(); i++)
+	{
+		if (middleware[i] && !middleware[i].is_async())
+		{
+			this->settings->LOGGER->warning(
+				"middleware #" + std::to_string(i) + " has no asynchronous implementation: it blocks "
+				"the event loop of the server while the rest of the chain waits",
+				_ERROR_DETAILS_
+			);
 		}
 	}
 
-	return chain;
+	return middleware::build_async_chain(this->settings->MIDDLEWARE, this->get_async_controller_handler());
+}
+
+Application::AsyncServerHandler Application::get_async_application_handler() const
+{
+	return [this](
+		net::RequestContext* context, const std::map<std::string, std::string>& environment,
+		std::pmr::memory_resource* memory_resource
+	) -> util::Task<net::StatusCode>
+	{
+		auto request = this->build_request(context, environment, memory_resource);
+		auto response = co_await this->async_middleware_chain(request.get());
+		co_return co_await this->send_response_async(context, response);
+	};
 }
 
 void Application::build_module_patterns(std::vector<std::shared_ptr<urls::IPattern>>& patterns) const
@@ -252,47 +297,74 @@ void Application::build_module_patterns(std::vector<std::shared_ptr<urls::IPatte
 }
 
 std::shared_ptr<http::IRequest> Application::build_request(
-	net::RequestContext* context, std::map<std::string, std::string> environment
+	net::RequestContext* context, const std::map<std::string, std::string>& environment,
+	std::pmr::memory_resource* memory_resource
 ) const
 {
 	require_non_null(context, "'context' is nullptr", _ERROR_DETAILS_);
+	require_non_null(memory_resource, "'memory_resource' is nullptr", _ERROR_DETAILS_);
 	context->body->set_limit((ssize_t)context->content_size);
-	return std::make_shared<http::Request>(
+	auto request = std::allocate_shared<http::RequestView>(
+		std::pmr::polymorphic_allocator<http::RequestView>(memory_resource),
 		*context,
 		this->settings->LIMITS.FILE_UPLOAD_MAX_MEMORY_SIZE,
 		this->settings->LIMITS.DATA_UPLOAD_MAX_NUMBER_FIELDS,
 		settings->LIMITS.MAX_HEADER_LENGTH,
 		settings->LIMITS.MAX_HEADERS_COUNT,
 		settings->LIMITS.DATA_UPLOAD_MAX_MEMORY_SIZE,
-		std::move(environment)
+		environment,
+		memory_resource
 	);
+	request->set_upload_directory(this->settings->FILE_UPLOAD_TEMP_DIR);
+	return request;
 }
 
 void Application::build_static_patterns()
 {
 	// Check if static files can be served and create necessary urls.
+	const auto& static_config = this->settings->STATIC;
 	this->add_static_pattern(
-		this->settings->URLPATTERNS, this->settings->STATIC.ROOT, this->settings->STATIC.URL, "static"
+		this->settings->URLPATTERNS, static_config.ROOT, static_config.URL, "static",
+		this->build_static_file_cache(static_config)
 	);
+	const auto& media_config = this->settings->MEDIA;
 	this->add_static_pattern(
-		this->settings->URLPATTERNS, this->settings->MEDIA.ROOT, this->settings->MEDIA.URL, "media"
+		this->settings->URLPATTERNS, media_config.ROOT, media_config.URL, "media",
+		this->build_static_file_cache(media_config)
 	);
 }
 
 void Application::add_static_pattern(
 	std::vector<std::shared_ptr<urls::IPattern>>& patterns,
-	const std::string& root, const std::string& url, const std::string& name
+	const std::string& root, const std::string& url, const std::string& name,
+	const std::shared_ptr<ctrl::StaticFileCache>& cache
 ) const
 {
 	if (!root.empty() && this->_static_is_allowed(url))
 	{
-		patterns.push_back(_build_static_pattern(url, root, name));
+		patterns.push_back(_build_static_pattern(url, root, name, cache));
 	}
 }
 
+std::shared_ptr<ctrl::StaticFileCache> Application::build_static_file_cache(const Static& static_config) const
+{
+	if (static_config.CACHE_MAX_ENTRIES == 0)
+	{
+		return nullptr;
+	}
+
+	return std::make_shared<ctrl::StaticFileCache>(
+		static_config.CACHE_MAX_ENTRIES,
+		static_config.CACHE_MAX_FILE_SIZE,
+		std::chrono::milliseconds(static_config.CACHE_REVALIDATE_INTERVAL)
+	);
+}
+
 void Application::setup_commands()
 {
-	auto core_module = mgmt::CoreModuleConfig(this->settings, std::move(this->get_application_handler()));
+	auto core_module = mgmt::CoreModuleConfig(
+		this->settings, this->get_application_handler(), this->get_async_application_handler()
+	);
 	core_module.configure();
 	this->_append_commands(core_module.get_commands(), core_module.get_name());
 	for (auto& installed_module : this->settings->MODULES)
@@ -353,8 +425,7 @@ net::StatusCode Application::finish_response(net::RequestContext* context, http:
 	}
 	else
 	{
-		auto data = response->serialize();
-		if (!context->response_writer->write(data.c_str(), data.size()))
+		if (!this->write_slices(context, response->serialize_slices()))
 		{
 			this->settings->LOGGER->trace("Unable to send response", _ERROR_DETAILS_);
 		}
@@ -363,30 +434,130 @@ net::StatusCode Application::finish_response(net::RequestContext* context, http:
 	return response->get_status();
 }
 
+bool Application::write_slices(net::RequestContext* context, http::ResponseSlices slices) const
+{
+	// Response writer does not support vectored writes, so a small body
+	// is sent together with headers by a single write and a large one is
+	// written directly from the response content without copying.
+	if (slices.body.size() <= MAX_COALESCED_BODY_SIZE)
+	{
+		slices.head.append(slices.body);
+		return context->response_writer->write(slices.head.c_str(), slices.head.size());
+	}
+
+	return context->response_writer->write(slices.head.c_str(), slices.head.size()) &&
+		context->response_writer->write(slices.body.data(), slices.body.size());
+}
+
 void Application::finish_streaming_response(net::RequestContext* context, http::IResponse* response) const
 {
-	auto* streaming_response = dynamic_cast<http::StreamingResponse*>(response);
-	if (!streaming_response)
+	auto* streaming_response = _as_streaming_response(response);
+	std::string_view chunk;
+	while (!(chunk = streaming_response->get_chunk_view()).empty())
 	{
-		throw NullPointerException(
-			"Unable to cast response to streaming response, "
-			"check if the response you returned is derived from 'xw::http::StreamingResponse'.",
-			_ERROR_DETAILS_
-		);
+		if (!context->response_writer->write(chunk.data(), chunk.size()))
+		{
+			this->settings->LOGGER->trace("Unable to send chunk", _ERROR_DETAILS_);
+			break;
+		}
+	}
+
+	response->close();
+}
+
+util::Task<net::StatusCode> Application::send_response_async(
+	net::RequestContext* context, const std::unique_ptr<http::IResponse>& response
+) const
+{
+	if (!response || !response->is_streaming())
+	{
+		co_return this->send_response(context, response);
 	}
 
-	std::string chunk;
-	while (!(chunk = streaming_response->get_chunk()).empty())
+	require_non_null(context, "'context' is nullptr", _ERROR_DETAILS_);
+	if (!context->response_writer)
 	{
-		if (!context->response_writer->write(chunk.c_str(), chunk.size()))
+		throw NullPointerException("Unable to send response, response writer is nullptr", _ERROR_DETAILS_);
+	}
+
+	co_await this->finish_streaming_response_async(context, response.get());
+	co_return response->get_status();
+}
+
+util::Task<> Application::finish_streaming_response_async(
+	net::RequestContext* context, http::IResponse* response
+) const
+{
+	auto* streaming_response = _as_streaming_response(response);
+
+	// Writers of other servers do not wait, so the response is
+	// written in the same way as the synchronous one.
+	auto* server_writer = dynamic_cast<server::ResponseWriter*>(context->response_writer.get());
+	auto* file_response = dynamic_cast<http::FileResponse*>(response);
+	if (server_writer && file_response)
+	{
+		// Ranges of the file are sent by the kernel without
+		// being read to the memory.
+		auto fd = file_response->file_descriptor();
+		std::optional<http::FileResponse::Part> part;
+		while ((part = file_response->get_next_part()))
+		{
+			const auto& prefix = part->prefix;
+			bool is_written = (prefix.empty() || server_writer->write(prefix.data(), prefix.size())) &&
+				(part->length == 0 || server_writer->write_file(fd, part->offset, part->length));
+			if (!is_written)
+			{
+				this->settings->LOGGER->trace("Unable to send part of file", _ERROR_DETAILS_);
+				break;
+			}
+
+			co_await server_writer->drain();
+		}
+
+		response->close();
+		co_return;
+	}
+
+	std::string_view chunk;
+	while (!(chunk = streaming_response->get_chunk_view()).empty())
+	{
+		if (!context->response_writer->write(chunk.data(), chunk.size()))
 		{
 			this->settings->LOGGER->trace("Unable to send chunk", _ERROR_DETAILS_);
+			break;
+		}
+
+		if (server_writer)
+		{
+			co_await server_writer->drain();
 		}
 	}
 
 	response->close();
 }
 
+std::unique_ptr<http::IResponse> Application::_non_null_response(
+	http::IRequest* request, std::unique_ptr<http::IResponse> response
+) const
+{
+	if (!response)
+	{
+		if (this->settings->DEBUG)
+		{
+			throw NullPointerException(
+				"Controller returns nullptr on '" + request->method() + "'.",
+				_ERROR_DETAILS_
+			);
+		}
+		else
+		{
+			response = std::make_unique<http::Response>(204);
+		}
+	}
+
+	return response;
+}
+
 void Application::_append_command(const std::shared_ptr<cmd::AbstractCommand>& command, const std::string& module_name)
 {
 	if (this->_has_command(command))
@@ -11,6 +11,7 @@
 // C++ libraries.
 #include <algorithm>
 #include <memory>
+#include <memory_resource>
 #include <string>
 
 // Base libraries.
@@ -23,6 +24,8 @@
 #include "./settings.h"
 #include "../middleware/types.h"
 #include "../urls/interfaces.h"
+#include "../controllers/static_file_cache.h"
+#include "../utility/task.h"
 
 
 __CONF_BEGIN__
@@ -40,7 +43,8 @@ inline void _throw_null_pointer_exception(int)
 // TESTME: _build_static_pattern
 // TODO: docs for '_build_static_pattern'
 extern std::shared_ptr<urls::IPattern> _build_static_pattern(
-	const std::string& static_url, const std::string& static_root, const std::string& name=""
+	const std::string& static_url, const std::string& static_root, const std::string& name="",
+	const std::shared_ptr<ctrl::StaticFileCache>& cache=nullptr
 );
 
 extern void initialize_signal_handlers();
@@ -59,8 +63,18 @@ public:
 	void execute(int argc, char** argv) const;
 
 protected:
+	// Memory resource belongs to the request and is released by
+	// the server after the response is sent.
 	using ServerHandler = std::function<net::StatusCode(
-		net::RequestContext*, const std::map<std::string, std::string>& /* environment */
+		net::RequestContext*, const std::map<std::string, std::string>& /* environment */,
+		std::pmr::memory_resource* /* memory_resource */
+	)>;
+
+	// Context, environment and memory resource must be
+	// alive until the task is finished.
+	using AsyncServerHandler = std::function<util::Task<net::StatusCode>(
+		net::RequestContext*, const std::map<std::string, std::string>& /* environment */,
+		std::pmr::memory_resource* /* memory_resource */
 	)>;
 
 	conf::Settings* settings = nullptr;
@@ -69,6 +83,14 @@ protected:
 	// List of commands to run from command line.
 	std::map<std::string, std::shared_ptr<cmd::AbstractCommand>> commands;
 
+	// Middleware chain which is built once during configuration
+	// and shared by all requests, so middleware objects are not
+	// copied on each request.
+	middleware::Function middleware_chain = nullptr;
+
+	// The same as 'middleware_chain', but awaits asynchronous controllers.
+	middleware::AsyncFunction async_middleware_chain = nullptr;
+
 	virtual void execute_command(const std::string& command_name, int argc, char** argv) const;
 
 	[[nodiscard]]
@@ -83,20 +105,52 @@ protected:
 	[[nodiscard]]
 	virtual ServerHandler get_application_handler() const;
 
+	[[nodiscard]]
+	virtual middleware::AsyncFunction get_async_controller_handler() const;
+
+	[[nodiscard]]
+	virtual middleware::AsyncFunction build_async_middleware_chain() const;
+
+	// Returns handler which suspends while controllers wait instead of
+	// blocking the thread, so a server which runs an event loop can
+	// process other requests in the meantime. It is passed to the server
+	// together with the synchronous one, see 'Settings::build_server()'.
+	[[nodiscard]]
+	virtual AsyncServerHandler get_async_application_handler() const;
+
 	virtual void build_module_patterns(std::vector<std::shared_ptr<urls::IPattern>>& patterns) const;
 
+	// Compiles 'settings->URLPATTERNS' into router. Should be called
+	// after all patterns are built, because router does not track
+	// changes of patterns vector.
+	virtual inline void build_router()
+	{
+		this->settings->ROUTER = std::make_shared<urls::Router>(this->settings->URLPATTERNS);
+	}
+
+	// Request and its temporary objects are allocated from `memory_resource`
+	// of the request. The request refers to `context` and `environment`
+	// instead of copying them, so it must be destroyed before they are and
+	// the memory is released.
 	[[nodiscard]]
 	virtual std::shared_ptr<http::IRequest> build_request(
-		net::RequestContext* context, std::map<std::string, std::string> env
+		net::RequestContext* context, const std::map<std::string, std::string>& environment,
+		std::pmr::memory_resource* memory_resource
 	) const;
 
 	virtual void build_static_patterns();
 
 	virtual void add_static_pattern(
 		std::vector<std::shared_ptr<urls::IPattern>>& patterns,
-		const std::string& root, const std::string& url, const std::string& name
+		const std::string& root, const std::string& url, const std::string& name,
+		const std::shared_ptr<ctrl::StaticFileCache>& cache
 	) const;
 
+	// Returns cache for files from `static_config.ROOT`, or nullptr
+	// if the cache is disabled.
+	[[nodiscard]]
+	virtual std::shared_ptr<ctrl::StaticFileCache> build_static_file_cache(const Static& static_config) const;
+
 	virtual void setup_commands();
 
 	virtual void setup_middleware();
@@ -126,9 +180,36 @@ protected:
 
 	virtual net::StatusCode finish_response(net::RequestContext* context, http::IResponse* response) const;
 
+	// Bodies up to this size are copied after headers to be sent
+	// by a single write.
+	static inline constexpr size_t MAX_COALESCED_BODY_SIZE = 16 * 1024;
+
+	// Writes serialized response, returns false if writing failed.
+	virtual bool write_slices(net::RequestContext* context, http::ResponseSlices slices) const;
+
 	virtual void finish_streaming_response(net::RequestContext* context, http::IResponse* response) const;
 
+	// The same as 'send_response()', but the streaming response is
+	// written by 'finish_streaming_response_async()'.
+	virtual util::Task<net::StatusCode> send_response_async(
+		net::RequestContext* context, const std::unique_ptr<http::IResponse>& response
+	) const;
+
+	// Writes chunks of the streaming response as the client reads them:
+	// the next chunk is requested when the server sends the previous
+	// ones, see 'server::ResponseWriter::drain()'.
+	virtual util::Task<> finish_streaming_response_async(
+		net::RequestContext* context, http::IResponse* response
+	) const;
+
 private:
+	// Replaces nullptr returned from controller with Http 204 (No Content)
+	// response, or throws if debug is enabled.
+	[[nodiscard]]
+	std::unique_ptr<http::IResponse> _non_null_response(
+		http::IRequest* request, std::unique_ptr<http::IResponse> response
+	) const;
+
 	[[nodiscard]]
 	bool _static_is_allowed(const std::string& static_url) const
 	{
@@ -29,6 +29,9 @@ YAMLLimitsComponent::YAMLLimitsComponent(Limits& limits)
 	this->register_component(
 		"max_headers_count", std::make_unique<config::YAMLScalarComponent>(limits.MAX_HEADERS_COUNT)
 	);
+	this->register_component(
+		"max_body_size", std::make_unique<config::YAMLScalarComponent>(limits.MAX_BODY_SIZE)
+	);
 }
 
 __CONF_END__
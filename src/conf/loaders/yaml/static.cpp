@@ -28,6 +28,16 @@ YAMLStaticComponent::YAMLStaticComponent(Static& static_, const std::string& bas
 			static_.URL = url.as<std::string>(static_.URL);
 		})
 	);
+	this->register_component(
+		"cache_max_entries", std::make_unique<config::YAMLScalarComponent>(static_.CACHE_MAX_ENTRIES)
+	);
+	this->register_component(
+		"cache_max_file_size", std::make_unique<config::YAMLScalarComponent>(static_.CACHE_MAX_FILE_SIZE)
+	);
+	this->register_component(
+		"cache_revalidate_interval",
+		std::make_unique<config::YAMLScalarComponent>(static_.CACHE_REVALIDATE_INTERVAL)
+	);
 }
 
 __CONF_END__
@@ -103,6 +103,16 @@ public:
 		this->register_component(
 			"static", std::make_unique<YAMLStaticComponent>(settings->STATIC, settings->BASE_DIR.to_string())
 		);
+		this->register_component(
+			"file_upload_temp_dir", std::make_unique<config::YAMLScalarComponent>(
+				[settings](const YAML::Node& directory)
+				{
+					auto string_directory = directory.as<std::string>(settings->FILE_UPLOAD_TEMP_DIR);
+					settings->FILE_UPLOAD_TEMP_DIR = string_directory.empty() || path::Path(string_directory).is_absolute() ?
+						string_directory : path::join(settings->BASE_DIR.to_string(), string_directory);
+				}
+			)
+		);
 		this->register_component("limits", std::make_unique<YAMLLimitsComponent>(settings->LIMITS));
 		this->register_component("prepend_www", std::make_unique<config::YAMLScalarComponent>(settings->PREPEND_WWW));
 		this->register_component("formats", std::make_unique<YAMLFormatsComponent>(settings->FORMATS));
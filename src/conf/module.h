@@ -19,6 +19,7 @@
 #include "./interfaces.h"
 #include "../urls/pattern.h"
 #include "../controllers/controller.h"
+#include "../controllers/async_controller.h"
 #include "../commands/command.h"
 
 
@@ -72,30 +73,47 @@ protected:
 	>
 	inline void url(const std::string& pattern, const std::string& name, ControllerArgs ...controller_args)
 	{
-		ctrl::Handler<RequestArgs...> controller_handler = [controller_args...](
-			http::IRequest* request,
-			const std::tuple<RequestArgs...>& request_args,
-			const Settings* settings_ptr
-		) -> std::unique_ptr<http::IResponse>
+		if constexpr (std::is_base_of_v<ctrl::AsyncController<RequestArgs...>, ControllerType>)
 		{
-			ControllerType controller(
-				require_non_null(settings_ptr, "'settings' is nullptr", _ERROR_DETAILS_)->LOGGER.get(),
-				controller_args...
-			);
-			return std::apply(
-				[&controller, request](RequestArgs ...a) mutable -> auto
-				{
-					return controller.dispatch(request, a...);
-				},
-				request_args
-			);
-		};
-
-		this->_urlpatterns.push_back(std::make_shared<urls::Pattern<RequestArgs...>>(
-			pattern.starts_with("/") ? pattern : "/" + pattern,
-			controller_handler,
-			name.empty() ? demangle(typeid(ControllerType).name()) : name
-		));
+			ctrl::AsyncHandler<RequestArgs...> controller_handler = [controller_args...](
+				http::IRequest* request,
+				const std::tuple<RequestArgs...>& request_args,
+				const Settings* settings_ptr
+			) -> util::Task<std::unique_ptr<http::IResponse>>
+			{
+				return ctrl::_dispatch_async(
+					std::make_unique<ControllerType>(
+						require_non_null(settings_ptr, "'settings' is nullptr", _ERROR_DETAILS_)->LOGGER.get(),
+						controller_args...
+					),
+					request,
+					request_args
+				);
+			};
+			this->_add_pattern<ControllerType, RequestArgs...>(pattern, name, std::move(controller_handler));
+		}
+		else
+		{
+			ctrl::Handler<RequestArgs...> controller_handler = [controller_args...](
+				http::IRequest* request,
+				const std::tuple<RequestArgs...>& request_args,
+				const Settings* settings_ptr
+			) -> std::unique_ptr<http::IResponse>
+			{
+				ControllerType controller(
+					require_non_null(settings_ptr, "'settings' is nullptr", _ERROR_DETAILS_)->LOGGER.get(),
+					controller_args...
+				);
+				return std::apply(
+					[&controller, request](RequestArgs ...a) mutable -> auto
+					{
+						return controller.dispatch(request, a...);
+					},
+					request_args
+				);
+			};
+			this->_add_pattern<ControllerType, RequestArgs...>(pattern, name, std::move(controller_handler));
+		}
 	}
 
 	template <
@@ -113,27 +131,39 @@ protected:
 			throw NullPointerException("controller builder is nullptr", _ERROR_DETAILS_);
 		}
 
-		ctrl::Handler<RequestArgs...> controller_handler = [builder](
-			http::IRequest* request,
-			const std::tuple<RequestArgs...>& request_args,
-			const Settings* settings_ptr
-		) -> std::unique_ptr<http::IResponse>
+		if constexpr (std::is_base_of_v<ctrl::AsyncController<RequestArgs...>, ControllerType>)
 		{
-			auto controller = builder(settings_ptr);
-			return std::apply(
-				[&controller, request](RequestArgs ...a) mutable -> auto
-				{
-					return controller.dispatch(request, a...);
-				},
-				request_args
-			);
-		};
-
-		this->_urlpatterns.push_back(std::make_shared<urls::Pattern<RequestArgs...>>(
-			pattern.starts_with("/") ? pattern : "/" + pattern,
-			controller_handler,
-			name.empty() ? demangle(typeid(ControllerType).name()) : name
-		));
+			ctrl::AsyncHandler<RequestArgs...> controller_handler = [builder](
+				http::IRequest* request,
+				const std::tuple<RequestArgs...>& request_args,
+				const Settings* settings_ptr
+			) -> util::Task<std::unique_ptr<http::IResponse>>
+			{
+				return ctrl::_dispatch_async(
+					std::make_unique<ControllerType>(builder(settings_ptr)), request, request_args
+				);
+			};
+			this->_add_pattern<ControllerType, RequestArgs...>(pattern, name, std::move(controller_handler));
+		}
+		else
+		{
+			ctrl::Handler<RequestArgs...> controller_handler = [builder](
+				http::IRequest* request,
+				const std::tuple<RequestArgs...>& request_args,
+				const Settings* settings_ptr
+			) -> std::unique_ptr<http::IResponse>
+			{
+				auto controller = builder(settings_ptr);
+				return std::apply(
+					[&controller, request](RequestArgs ...a) mutable -> auto
+					{
+						return controller.dispatch(request, a...);
+					},
+					request_args
+				);
+			};
+			this->_add_pattern<ControllerType, RequestArgs...>(pattern, name, std::move(controller_handler));
+		}
 	}
 
 	inline void include(const std::string& module, const std::string& prefix, const std::string& namespace_="")
@@ -197,6 +227,16 @@ private:
 
 		return *result;
 	}
+
+	template <typename ControllerType, typename ...RequestArgs, typename HandlerT>
+	inline void _add_pattern(const std::string& pattern, const std::string& name, HandlerT handler)
+	{
+		this->_urlpatterns.push_back(std::make_shared<urls::Pattern<RequestArgs...>>(
+			pattern.starts_with("/") ? pattern : "/" + pattern,
+			std::move(handler),
+			name.empty() ? demangle(typeid(ControllerType).name()) : name
+		));
+	}
 };
 
 __CONF_END__
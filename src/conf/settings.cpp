@@ -17,9 +17,15 @@
 #include "../render/standard_library.h"
 #include "../middleware/clickjacking.h"
 #include "../middleware/common.h"
+#include "../middleware/compression.h"
 #include "../middleware/http.h"
+#include "../middleware/page_cache.h"
 #include "../middleware/security.h"
 
+#if defined(__linux__)
+#include "../server/http_server.h"
+#endif
+
 
 __CONF_BEGIN__
 
@@ -33,7 +39,9 @@ Settings::Settings(path::Path root_directory) : BASE_DIR(std::move(root_director
 	this->_middleware = {
 		{middleware::XFrameOptions::NAME, middleware::XFrameOptions(this)},
 		{middleware::Common::NAME, middleware::Common(this)},
+		{middleware::Compression::NAME, middleware::Compression()},
 		{middleware::ConditionalGet::NAME, middleware::ConditionalGet()},
+		{middleware::PageCache::NAME, middleware::PageCache()},
 		{middleware::Security::NAME, middleware::Security(this)}
 	};
 
@@ -140,6 +148,12 @@ void Settings::check()
 		err_count++;
 	}
 
+	if (!this->FILE_UPLOAD_TEMP_DIR.empty() && !path::Path(this->FILE_UPLOAD_TEMP_DIR).exists())
+	{
+		this->LOGGER->error("'FILE_UPLOAD_TEMP_DIR' must exist in order to receive large uploads.");
+		err_count++;
+	}
+
 	if (this->SECRET_KEY.empty())
 	{
 		this->LOGGER->error("'SECRET_KEY' must be set in order to use the application.");
@@ -188,6 +202,66 @@ void Settings::check()
 	std::cout << "Done." << std::endl;
 }
 
+std::unique_ptr<server::IServer> Settings::build_server(
+	const std::function<net::StatusCode(
+		net::RequestContext*, const std::map<std::string, std::string>& /* environment */,
+		std::pmr::memory_resource* /* memory_resource */
+	)>& handler,
+	const std::function<util::Task<net::StatusCode>(
+		net::RequestContext*, const std::map<std::string, std::string>& /* environment */,
+		std::pmr::memory_resource* /* memory_resource */
+	)>& async_handler,
+	const Options& options
+)
+{
+	// Applications which override the previous signature keep their server.
+	auto server = this->build_server(
+		[handler](net::RequestContext* context, const std::map<std::string, std::string>& environment)
+		{
+			return handler(context, environment, std::pmr::get_default_resource());
+		},
+		options
+	);
+	if (server)
+	{
+		return server;
+	}
+
+#if defined(__linux__)
+	auto timeout = std::chrono::seconds(options.get<size_t>("timeout_seconds", 5)) +
+		std::chrono::microseconds(options.get<size_t>("timeout_microseconds", 0));
+	auto config = server::Config{
+		.workers = options.get<size_t>("workers", 0),
+		.retries = options.get<size_t>("retries", 5),
+		.timeout = timeout,
+		.keep_alive_timeout = std::chrono::seconds(options.get<size_t>("keep_alive_seconds", 5)),
+		.max_requests_per_connection = options.get<size_t>("max_requests", 1000),
+		.max_header_length = this->LIMITS.MAX_HEADER_LENGTH,
+		.max_headers_count = this->LIMITS.MAX_HEADERS_COUNT,
+		.max_body_size = this->LIMITS.MAX_BODY_SIZE,
+		.upload_directory = this->FILE_UPLOAD_TEMP_DIR
+	};
+	if (async_handler)
+	{
+		return std::make_unique<server::HTTPServer>(config, async_handler, this->LOGGER);
+	}
+
+	return std::make_unique<server::HTTPServer>(config, handler, this->LOGGER);
+#else
+	return nullptr;
+#endif
+}
+
+std::unique_ptr<server::IServer> Settings::build_server(
+	const std::function<net::StatusCode(
+		net::RequestContext*, const std::map<std::string, std::string>& /* environment */
+	)>&,
+	const Options&
+)
+{
+	return nullptr;
+}
+
 std::shared_ptr<IModuleConfig> Settings::build_module(const std::string& full_name) const
 {
 	if (this->_modules.find(full_name) != this->_modules.end())
@@ -9,6 +9,7 @@
 #pragma once
 
 // C++ libraries.
+#include <memory_resource>
 #include <optional>
 
 // Base libraries.
@@ -31,6 +32,8 @@
 #include "./interfaces.h"
 #include "./types.h"
 #include "../middleware/types.h"
+#include "../urls/router.h"
+#include "../utility/task.h"
 
 
 __CONF_BEGIN__
@@ -72,6 +75,11 @@ public:
 	// module from 'MODULES'.
 	std::vector<std::shared_ptr<urls::IPattern>> URLPATTERNS;
 
+	// Router compiled from 'URLPATTERNS' during application
+	// configuration. Is used instead of linear scan of patterns
+	// when resolving request paths, nullptr before configuration.
+	std::shared_ptr<urls::Router> ROUTER = nullptr;
+
 	// List of ModuleConfig-derived objects representing modules.
 	// Order is required. The first item is interpreted as main
 	// module configuration.
@@ -129,6 +137,16 @@ public:
 	// URL example: "http://example.com/static/", "http://static.example.com/".
 	Static STATIC;
 
+	// Absolute path to the directory where uploaded files larger than
+	// 'LIMITS.FILE_UPLOAD_MAX_MEMORY_SIZE' are written. The server spools
+	// large request bodies to it too, so uploads are copied from them by
+	// the kernel. Put it on the same file system as 'MEDIA.ROOT', so saving
+	// of uploads does not copy them. The temporary directory of the system
+	// is used if it is empty.
+	//
+	// Example: "/var/www/example.com/uploads/".
+	std::string FILE_UPLOAD_TEMP_DIR;
+
 	Limits LIMITS = {
 		// Maximum size, in bytes, of a request before it will be streamed to the
 		// file system instead of into memory.
@@ -146,7 +164,12 @@ public:
 		.MAX_HEADER_LENGTH = 65535,
 
 		// Maximum number of headers per request.
-		.MAX_HEADERS_COUNT = 100
+		.MAX_HEADERS_COUNT = 100,
+
+		// Maximum size in bytes of the body of a request. Larger requests are
+		// answered with 413 by the server before the body is received. Zero
+		// means no limit.
+		.MAX_BODY_SIZE = 26214400
 	};
 
 	// Whether to prepend the "www." subdomain to URLs that don't have it.
@@ -291,15 +314,33 @@ public:
 	{
 	}
 
-	virtual inline std::unique_ptr<server::IServer> build_server(
+	// Returns the server which is built by the overload below if it is
+	// overridden, otherwise the built-in 'server::HTTPServer' configured
+	// by options of 'StartServerCommand', or nullptr where epoll is not
+	// available. The built-in server runs `async_handler` on its event
+	// loops, so requests which wait do not block other ones. Override it
+	// to run the application by another server.
+	virtual std::unique_ptr<server::IServer> build_server(
+		const std::function<net::StatusCode(
+			net::RequestContext*, const std::map<std::string, std::string>& /* environment */,
+			std::pmr::memory_resource* /* memory_resource */
+		)>& handler,
+		const std::function<util::Task<net::StatusCode>(
+			net::RequestContext*, const std::map<std::string, std::string>& /* environment */,
+			std::pmr::memory_resource* /* memory_resource */
+		)>& async_handler,
+		const Options& options
+	);
+
+	// Deprecated, override the overload above instead. Servers which are
+	// built by it receive requests without the memory resource, they are
+	// allocated from the default one. Returns nullptr.
+	virtual std::unique_ptr<server::IServer> build_server(
 		const std::function<net::StatusCode(
 			net::RequestContext*, const std::map<std::string, std::string>& /* environment */
 		)>& handler,
 		const Options& options
-	)
-	{
-		return nullptr;
-	}
+	);
 
 	[[nodiscard]]
 	std::shared_ptr<IModuleConfig> build_module(const std::string& full_name) const;
@@ -126,6 +126,17 @@ struct Static
 
 	// URL that handles files from `root` or some another url.
 	std::string URL;
+
+	// Maximum number of files which are kept in memory, set it
+	// to zero to disable the cache.
+	size_t CACHE_MAX_ENTRIES = 256;
+
+	// Maximum size, in bytes, of a file which can be cached.
+	size_t CACHE_MAX_FILE_SIZE = 256 * 1024;
+
+	// Time, in milliseconds, during which cached file is served
+	// without checking it for changes.
+	size_t CACHE_REVALIDATE_INTERVAL = 1000;
 };
 
 // TODO: docs for 'Limits'
@@ -148,6 +159,11 @@ struct Limits
 
 	// Maximum number of headers per request.
 	size_t MAX_HEADERS_COUNT;
+
+	// Maximum size in bytes of the body of a request. Larger requests are
+	// answered with 413 by the server before the body is received. Zero
+	// means no limit.
+	size_t MAX_BODY_SIZE;
 };
 
 // TODO: docs for 'Formats'
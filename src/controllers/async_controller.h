@@ -0,0 +1,273 @@
+/**
+ * controllers/async_controller.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Parent class for controllers which are coroutines.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <memory>
+#include <functional>
+#include <tuple>
+
+// Module definitions.
+#include "./_def_.h"
+
+// Framework libraries.
+#include "./controller.h"
+#include "../utility/task.h"
+
+
+__CONTROLLERS_BEGIN__
+
+template <typename ...ArgsT>
+using AsyncHandler = std::function<util::Task<std::unique_ptr<http::IResponse>>(
+	http::IRequest*, const std::tuple<ArgsT...>&, const conf::Settings*
+)>;
+
+// TESTME: AsyncController<...URLArgsT>
+// Controller which methods are coroutines, so a method which waits for
+// a database or an upstream service suspends instead of blocking the
+// worker thread:
+//
+//	Result get(http::IRequest* request, long int id) const override
+//	{
+//		auto user = co_await this->users->find(id);
+//		co_return std::make_unique<http::JsonResponse>(user.to_json());
+//	}
+//
+// The controller and arguments passed by value live in the frame of the
+// coroutine, so they are valid until the method returns.
+template <typename ...URLArgsT>
+class AsyncController : public BaseController
+{
+public:
+	using Result = util::Task<std::unique_ptr<http::IResponse>>;
+
+	inline explicit AsyncController(const ILogger* logger) : AsyncController<URLArgsT...>({"options"}, logger)
+	{
+	}
+
+	// Processes http GET request.
+	// Can be overridden in derived class, otherwise returns nullptr.
+	//
+	// @param request: pointer to http request.
+	// @param args: requests' url arguments.
+	// @return task which produces pointer to http response instance.
+	virtual inline Result get(http::IRequest* request, URLArgsT ...args) const
+	{
+		co_return nullptr;
+	}
+
+	// Processes http POST request.
+	// Can be overridden in derived class, otherwise returns nullptr.
+	//
+	// @param request: pointer to http request.
+	// @param args: requests' url arguments.
+	// @return task which produces pointer to http response instance.
+	virtual inline Result post(http::IRequest* request, URLArgsT ...args) const
+	{
+		co_return nullptr;
+	}
+
+	// Processes http PUT request.
+	// Can be overridden in derived class, otherwise returns nullptr.
+	//
+	// @param request: pointer to http request.
+	// @param args: requests' url arguments.
+	// @return task which produces pointer to http response instance.
+	virtual inline Result put(http::IRequest* request, URLArgsT ...args) const
+	{
+		co_return nullptr;
+	}
+
+	// Processes http PATCH request.
+	// Can be overridden in derived class, otherwise returns nullptr.
+	//
+	// @param request: pointer to http request.
+	// @param args: requests' url arguments.
+	// @return task which produces pointer to http response instance.
+	virtual inline Result patch(http::IRequest* request, URLArgsT ...args) const
+	{
+		co_return nullptr;
+	}
+
+	// Processes http DELETE request.
+	// Can be overridden in derived class, otherwise returns nullptr.
+	//
+	// @param request: pointer to http request.
+	// @param args: requests' url arguments.
+	// @return task which produces pointer to http response instance.
+	virtual inline Result delete_(http::IRequest* request, URLArgsT ...args) const
+	{
+		co_return nullptr;
+	}
+
+	// Processes http HEAD request.
+	// Can be overridden in derived class, otherwise returns result of 'get()'.
+	//
+	// @param request: pointer to http request.
+	// @param args: requests' url arguments.
+	// @return task which produces pointer to http response instance.
+	virtual inline Result head(http::IRequest* request, URLArgsT ...args) const
+	{
+		co_return co_await this->get(request, args...);
+	}
+
+	// Processes http OPTIONS request.
+	// Can be overridden in derived class, otherwise returns response
+	// with allowed methods.
+	//
+	// @param request: pointer to http request.
+	// @param args: requests' url arguments.
+	// @return task which produces pointer to http response instance.
+	virtual inline Result options(http::IRequest* request, URLArgsT ...args) const
+	{
+		auto response = std::make_unique<http::Response>(200);
+		auto allowed_methods = this->allowed_methods();
+		response->set_header(http::ALLOW, str::join(", ", allowed_methods.begin(), allowed_methods.end()));
+		response->set_header(http::CONTENT_LENGTH, "0");
+		co_return std::move(response);
+	}
+
+	// Processes http TRACE request.
+	// Can be overridden in derived class, otherwise returns nullptr.
+	//
+	// @param request: pointer to http request.
+	// @param args: requests' url arguments.
+	// @return task which produces pointer to http response instance.
+	virtual inline Result trace(http::IRequest* request, URLArgsT ...args) const
+	{
+		co_return nullptr;
+	}
+
+	// The same as 'Controller<...URLArgsT>::get_etag()', but may wait,
+	// for example, for the version of the model to be loaded.
+	//
+	// @param request: pointer to http request.
+	// @param args: requests' url arguments.
+	// @return task which produces ETag or an empty string.
+	virtual inline util::Task<std::string> get_etag(http::IRequest* request, URLArgsT ...args) const
+	{
+		co_return "";
+	}
+
+	// The same as 'Controller<...URLArgsT>::dispatch()', but awaits
+	// methods of the controller.
+	//
+	// @param request: an actual http request from client.
+	// @param args: requests' url arguments.
+	// @return task which produces pointer to http response returned from handler.
+	virtual inline Result dispatch(http::IRequest* request, URLArgsT ...args) const
+	{
+		if (!request)
+		{
+			throw NullPointerException(
+				demangle(typeid(*this).name()) + " instance has not initialized request.", _ERROR_DETAILS_
+			);
+		}
+
+		std::string method = str::to_lower(request->method());
+		if (this->_has_method(method))
+		{
+			co_return this->method_not_allowed_response(request);
+		}
+
+		auto method_task = this->_call_method(method, request, args...);
+		if (!method_task.is_valid())
+		{
+			co_return this->method_not_allowed_response(request);
+		}
+
+		std::string etag;
+		if (method == "get" || method == "head")
+		{
+			etag = co_await this->get_etag(request, args...);
+			auto result = this->_etag_conditional_response(request, etag);
+			if (result)
+			{
+				co_return std::move(result);
+			}
+		}
+
+		auto result = co_await std::move(method_task);
+		if (result && !etag.empty() && !result->has_header(http::E_TAG))
+		{
+			result->set_header(http::E_TAG, etag);
+		}
+
+		co_return std::move(result);
+	}
+
+protected:
+	inline explicit AsyncController(
+		const std::vector<std::string>& allowed_methods, const ILogger* logger
+	) : BaseController(allowed_methods, logger)
+	{
+	}
+
+private:
+	// Returns task of the method which is not started yet,
+	// or an invalid task if the method is unknown.
+	[[nodiscard]]
+	inline Result _call_method(const std::string& method, http::IRequest* request, URLArgsT ...args) const
+	{
+		if (method == "get")
+		{
+			return this->get(request, args...);
+		}
+		else if (method == "post")
+		{
+			return this->post(request, args...);
+		}
+		else if (method == "put")
+		{
+			return this->put(request, args...);
+		}
+		else if (method == "patch")
+		{
+			return this->patch(request, args...);
+		}
+		else if (method == "delete")
+		{
+			return this->delete_(request, args...);
+		}
+		else if (method == "head")
+		{
+			return this->head(request, args...);
+		}
+		else if (method == "options")
+		{
+			return this->options(request, args...);
+		}
+		else if (method == "trace")
+		{
+			return this->trace(request, args...);
+		}
+		else
+		{
+			return Result();
+		}
+	}
+};
+
+// Dispatches the request and keeps `controller` and `args` in the frame
+// of the coroutine until the response is produced.
+template <typename ControllerT, typename ...ArgsT>
+inline util::Task<std::unique_ptr<http::IResponse>> _dispatch_async(
+	std::unique_ptr<ControllerT> controller, http::IRequest* request, std::tuple<ArgsT...> args
+)
+{
+	co_return co_await std::apply(
+		[&controller, request](ArgsT ...a) -> auto
+		{
+			return controller->dispatch(request, a...);
+		},
+		args
+	);
+}
+
+__CONTROLLERS_END__
@@ -23,7 +23,9 @@
 // Framework libraries.
 #include "../http/request.h"
 #include "../http/response.h"
+#include "../http/utility.h"
 #include "../conf/settings.h"
+#include "../utility/cache.h"
 
 
 __CONTROLLERS_BEGIN__
@@ -33,10 +35,118 @@ using Handler = std::function<std::unique_ptr<http::IResponse>(
 	http::IRequest*, const std::tuple<ArgsT...>&, const conf::Settings*
 )>;
 
+// TESTME: BaseController
+// Part of controllers which does not depend on types of url arguments,
+// it is shared by 'Controller<...URLArgsT>' and 'AsyncController<...URLArgsT>'.
+class BaseController
+{
+public:
+	virtual ~BaseController() = default;
+
+	// Builds vector of allowed methods and used for http OPTIONS response.
+	// To make this method return correct allowed methods, pass a vector of
+	// allowed methods names to protected constructor in derived class
+	// initialization.
+	[[nodiscard]]
+	inline std::vector<std::string> allowed_methods() const
+	{
+		std::vector<std::string> result;
+		for (const auto& method : this->allowed_methods_list)
+		{
+			bool found = std::find(
+				this->http_method_names.begin(), this->http_method_names.end(), str::to_lower(method)
+			) != this->http_method_names.end();
+			if (found)
+			{
+				result.push_back(str::to_upper(method));
+			}
+		}
+
+		return result;
+	}
+
+protected:
+	const ILogger* logger = nullptr;
+
+	// Contains all possible http methods which controller can handle.
+	const std::vector<std::string> http_method_names = {
+		"get", "post", "put", "patch", "delete", "head", "options", "trace"
+	};
+
+	// List of methods witch will be returned when 'OPTIONS' is in request.
+	std::vector<std::string> allowed_methods_list{};
+
+	inline explicit BaseController(
+		const std::vector<std::string>& allowed_methods, const ILogger* logger
+	) : logger(logger)
+	{
+		for (const auto& method : allowed_methods)
+		{
+			this->allowed_methods_list.push_back(str::to_lower(method));
+		}
+
+		auto options = std::find(this->allowed_methods_list.begin(), this->allowed_methods_list.end(), "options");
+		if (options == this->allowed_methods_list.end())
+		{
+			this->allowed_methods_list.emplace_back("options");
+		}
+	}
+
+	// Returns Http 405 (Method Not Allowed) response.
+	//
+	// @param request: pointer to http request.
+	// @return pointer to http response returned from handler.
+	[[nodiscard]]
+	inline std::unique_ptr<http::IResponse> method_not_allowed_response(http::IRequest* request) const
+	{
+		if (this->logger)
+		{
+			this->logger->warning(
+				"Method Not Allowed (" + request->method() + "): " + request->url().path, _ERROR_DETAILS_
+			);
+		}
+
+		return std::make_unique<http::NotAllowed>("", this->allowed_methods());
+	}
+
+	// Quotes non-empty `etag` and checks it against conditional headers
+	// of `request`. Returns Http 304 (Not Modified) or Http 412
+	// (Precondition Failed) response if the handler should not be
+	// called, otherwise nullptr.
+	[[nodiscard]]
+	inline std::unique_ptr<http::IResponse> _etag_conditional_response(
+		http::IRequest* request, std::string& etag
+	) const
+	{
+		if (etag.empty())
+		{
+			return nullptr;
+		}
+
+		etag = http::quote_etag(etag);
+		auto result = util::cache::get_conditional_response(request, etag, -1, nullptr);
+		if (result && result->get_status() == 304)
+		{
+			result->set_header(http::E_TAG, etag);
+		}
+
+		return result;
+	}
+
+	// Returns true if `method` is not in the list of allowed methods.
+	[[nodiscard]]
+	inline bool _has_method(const std::string& method) const
+	{
+		return std::find(
+			this->allowed_methods_list.begin(), this->allowed_methods_list.end(), str::to_lower(method)
+		) == this->allowed_methods_list.end();
+	}
+};
+
 // TESTME: Controller<...URLArgsT>
 // TODO: docs for 'Controller<...URLArgsT>'
 template <typename ...URLArgsT>
-class Controller
+class Controller : public BaseController
 {
 public:
 	inline explicit Controller(const ILogger* logger) : Controller<URLArgsT...>({"options"}, logger)
@@ -143,6 +253,24 @@ public:
 		return nullptr;
 	}
 
+	// Returns ETag of the resource, quoted or not, which is cheap to compute,
+	// for example, derived from the version or modification time of the
+	// model. It is checked against conditional headers of GET and HEAD
+	// requests before calling the handler, so Http 304 (Not Modified) or
+	// Http 412 (Precondition Failed) is returned without rendering the body.
+	//
+	// Can be overridden in derived class, otherwise returns an empty string
+	// and the check is skipped.
+	//
+	// @param request: pointer to http request.
+	// @param args: pointer to requests' url arguments.
+	// @return ETag or an empty string.
+	[[nodiscard]]
+	virtual inline std::string get_etag(http::IRequest* request, URLArgsT ...args) const
+	{
+		return "";
+	}
+
 	// Try to dispatch to the right method; if a method doesn't exist,
 	// defer to the error handler. Also defer to the error handler if the
 	// request method isn't on the approved list.
@@ -170,7 +298,22 @@ public:
 			auto method_function = this->_get_method(method);
 			if (method_function)
 			{
+				std::string etag;
+				if (method == "get" || method == "head")
+				{
+					etag = this->get_etag(request, args...);
+					result = this->_etag_conditional_response(request, etag);
+					if (result)
+					{
+						return result;
+					}
+				}
+
 				result = method_function(request, args...);
+				if (result && !etag.empty() && !result->has_header(http::E_TAG))
+				{
+					result->set_header(http::E_TAG, etag);
+				}
 			}
 			else
 			{
@@ -181,81 +324,14 @@ public:
 		return result;
 	}
 
-	// Builds vector of allowed methods and used for http OPTIONS response.
-	// To make this method return correct allowed methods, pass a vector of
-	// allowed methods names to protected constructor in derived class
-	// initialization.
-	[[nodiscard]]
-	inline std::vector<std::string> allowed_methods() const
-	{
-		std::vector<std::string> result;
-		for (const auto& method : this->allowed_methods_list)
-		{
-			bool found = std::find(
-				this->http_method_names.begin(), this->http_method_names.end(), str::to_lower(method)
-			) != this->http_method_names.end();
-			if (found)
-			{
-				result.push_back(str::to_upper(method));
-			}
-		}
-
-		return result;
-	}
-
 protected:
-	const ILogger* logger = nullptr;
-
-	// Contains all possible http methods which controller can handle.
-	const std::vector<std::string> http_method_names = {
-		"get", "post", "put", "patch", "delete", "head", "options", "trace"
-	};
-
-	// List of methods witch will be returned when 'OPTIONS' is in request.
-	std::vector<std::string> allowed_methods_list{};
-
 	inline explicit Controller(
 		const std::vector<std::string>& allowed_methods, const ILogger* logger
-	) : logger(logger)
+	) : BaseController(allowed_methods, logger)
 	{
-		for (const auto& method : allowed_methods)
-		{
-			this->allowed_methods_list.push_back(str::to_lower(method));
-		}
-
-		auto options = std::find(this->allowed_methods_list.begin(), this->allowed_methods_list.end(), "options");
-		if (options == this->allowed_methods_list.end())
-		{
-			this->allowed_methods_list.emplace_back("options");
-		}
-	}
-
-	// Returns Http 405 (Method Not Allowed) response.
-	//
-	// @param request: pointer to http request.
-	// @return pointer to http response returned from handler.
-	[[nodiscard]]
-	inline std::unique_ptr<http::IResponse> method_not_allowed_response(http::IRequest* request) const
-	{
-		if (this->logger)
-		{
-			this->logger->warning(
-				"Method Not Allowed (" + request->method() + "): " + request->url().path, _ERROR_DETAILS_
-			);
-		}
-
-		return std::make_unique<http::NotAllowed>("", this->allowed_methods());
 	}
 
 private:
-	[[nodiscard]]
-	inline bool _has_method(const std::string& method) const
-	{
-		return std::find(
-			this->allowed_methods_list.begin(), this->allowed_methods_list.end(), str::to_lower(method)
-		) == this->allowed_methods_list.end();
-	}
-
 	[[nodiscard]]
 	inline std::function<std::unique_ptr<http::IResponse>(http::IRequest*, URLArgsT...)> _get_method(
 		const std::string& method
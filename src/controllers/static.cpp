@@ -6,15 +6,24 @@
 
 #include "./static.h"
 
+// C++ libraries.
+#include <sys/stat.h>
+
 // Base libraries.
 #include <xalwart.base/path.h>
 
 // Framework libraries.
 #include "../http/mime/media_type.h"
+#include "../http/mime/content_types.h"
+#include "../http/utility.h"
+#include "../utility/cache.h"
 
 
 __CONTROLLERS_BEGIN__
 
+// Is copied before use, because 're::Regex' keeps the result of search.
+static const re::Regex IF_MODIFIED_SINCE_REGEX("([^;]+)(; length=([0-9]+))?", std::regex_constants::icase);
+
 bool was_modified_since(const std::string& header, size_t time, size_t size)
 {
 	bool result = false;
@@ -24,7 +33,7 @@ bool was_modified_since(const std::string& header, size_t time, size_t size)
 	}
 	else
 	{
-		auto rgx = re::Regex("([^;]+)(; length=([0-9]+))?", std::regex_constants::icase);
+		auto rgx = IF_MODIFIED_SINCE_REGEX;
 		if (rgx.search(header))
 		{
 			auto header_time = http::parse_http_datetime(rgx.group(1));
@@ -46,12 +55,162 @@ bool was_modified_since(const std::string& header, size_t time, size_t size)
 	return result;
 }
 
+// Returns the variant which is the most preferred by `accept_encoding`,
+// or nullptr if none of them is acceptable.
+inline const StaticFileCache::Variant* _choose_precompressed_variant(
+	const std::vector<StaticFileCache::Variant>& variants, const std::string& accept_encoding
+)
+{
+	const StaticFileCache::Variant* result = nullptr;
+	double best_quality = 0.0;
+	for (const auto& variant : variants)
+	{
+		auto quality = http::get_encoding_quality(accept_encoding, variant.encoding);
+		if (quality > best_quality)
+		{
+			best_quality = quality;
+			result = &variant;
+		}
+	}
+
+	return result;
+}
+
+std::string find_precompressed_file(
+	const std::string& full_path, const std::string& accept_encoding, std::string& encoding, bool& has_variants
+)
+{
+	has_variants = false;
+	struct stat file_info{};
+	if (::stat(full_path.c_str(), &file_info) != 0 || !S_ISREG(file_info.st_mode))
+	{
+		return "";
+	}
+
+	auto variants = StaticFileCache::find_variants(full_path, file_info.st_mtime);
+	has_variants = !variants.empty();
+	const auto* variant = _choose_precompressed_variant(variants, accept_encoding);
+	if (!variant)
+	{
+		return "";
+	}
+
+	encoding = variant->encoding;
+	return variant->file_path;
+}
+
 std::unique_ptr<http::IResponse> StaticController::get(
 	http::IRequest* request, const std::string& resource_path
 ) const
 {
 	auto full_path = path::join(this->_static_root, resource_path);
-	if (!path::Path(full_path).exists())
+	std::string content_type, encoding;
+	http::mime::guess_content_type(full_path, content_type, encoding);
+	if (content_type.empty())
+	{
+		content_type = http::mime::APPLICATION_OCTET_STREAM;
+	}
+
+	auto file_path = full_path;
+	bool has_variants = false;
+	std::shared_ptr<const StaticFileCache::Entry> file;
+	if (this->_cache)
+	{
+		file = this->_cache->get(full_path);
+	}
+
+	if (encoding.empty())
+	{
+		auto accept_encoding = request->get_header(http::ACCEPT_ENCODING, "");
+		if (file)
+		{
+			// Variants of the cached file are revalidated together with
+			// it, so the file system is not touched on a cache hit.
+			has_variants = !file->variants.empty();
+			const auto* variant = _choose_precompressed_variant(file->variants, accept_encoding);
+			if (variant)
+			{
+				file_path = variant->file_path;
+				encoding = variant->encoding;
+				file = this->_cache->get(file_path);
+			}
+		}
+		else
+		{
+			auto precompressed_file_path = find_precompressed_file(full_path, accept_encoding, encoding, has_variants);
+			if (!precompressed_file_path.empty())
+			{
+				file_path = std::move(precompressed_file_path);
+				if (this->_cache)
+				{
+					file = this->_cache->get(file_path);
+				}
+			}
+		}
+	}
+
+	std::unique_ptr<http::IResponse> response;
+	if (file)
+	{
+		response = this->get_cached_file_response(request, *file, content_type, encoding);
+	}
+
+	if (!response)
+	{
+		response = this->get_file_response(request, file_path, content_type, encoding);
+	}
+
+	if (has_variants)
+	{
+		response->set_header(http::VARY, http::ACCEPT_ENCODING);
+	}
+
+	return response;
+}
+
+std::unique_ptr<http::IResponse> StaticController::get_cached_file_response(
+	http::IRequest* request, const StaticFileCache::Entry& file,
+	const std::string& content_type, const std::string& encoding
+) const
+{
+	// Partial content is served from the file.
+	if (request->has_header(http::RANGE))
+	{
+		return nullptr;
+	}
+
+	auto if_none_match = http::parse_etags(request->get_header(http::IF_NONE_MATCH, ""));
+	bool is_not_modified = if_none_match.empty() ?
+		!was_modified_since(
+			request->get_header(http::IF_MODIFIED_SINCE, ""), file.modification_time, file.content->size()
+		) :
+		!util::cache::internal::if_none_match_passes(file.etag, if_none_match);
+	std::unique_ptr<http::IResponse> response;
+	if (is_not_modified)
+	{
+		response = std::make_unique<http::NotModified>("");
+	}
+	else
+	{
+		response = std::make_unique<http::SharedContentResponse>(file.content, 200, content_type);
+		response->set_header(http::ACCEPT_RANGES, "bytes");
+		if (!encoding.empty())
+		{
+			response->set_header(http::CONTENT_ENCODING, encoding);
+		}
+	}
+
+	response->set_header(http::E_TAG, file.etag);
+	response->set_header(http::LAST_MODIFIED, file.last_modified);
+	return response;
+}
+
+std::unique_ptr<http::IResponse> StaticController::get_file_response(
+	http::IRequest* request, const std::string& file_path,
+	const std::string& content_type, const std::string& encoding
+) const
+{
+	if (!path::Path(file_path).exists())
 	{
 		auto [status, _] = net::get_status_by_code(404);
 		std::string response_content = request->is_json() ?
@@ -60,7 +219,7 @@ std::unique_ptr<http::IResponse> StaticController::get(
 		return std::make_unique<http::NotFound>(response_content);
 	}
 
-	auto stat_info = file_stat(full_path);
+	auto stat_info = file_stat(file_path);
 	if (!was_modified_since(
 		request->get_header(http::IF_MODIFIED_SINCE, ""), stat_info.st_mtime, stat_info.st_size
 	))
@@ -68,20 +227,30 @@ std::unique_ptr<http::IResponse> StaticController::get(
 		return std::make_unique<http::NotModified>("");
 	}
 
-	std::string content_type, encoding;
-	http::mime::guess_content_type(full_path, content_type, encoding);
-	if (content_type.empty())
+	// The same validator as the cached file has, so 'If-Range' matches
+	// regardless of which of both paths served the previous response.
+	auto etag = StaticFileCache::make_etag(stat_info.st_mtime, stat_info.st_size);
+	auto ranges = util::cache::get_requested_ranges(
+		request, etag, stat_info.st_mtime, stat_info.st_size
+	);
+	if (ranges && ranges->empty())
 	{
-		content_type = "application/octet-stream";
+		return std::make_unique<http::RangeNotSatisfiable>(stat_info.st_size);
 	}
 
-	auto response = std::make_unique<http::FileResponse>(full_path, false, 0, content_type);
+	auto response = std::make_unique<http::FileResponse>(file_path, false, 0, content_type);
+	response->set_header(http::E_TAG, etag);
 	response->set_header(http::LAST_MODIFIED, http::http_date(stat_info.st_mtime));
 	if (!encoding.empty())
 	{
 		response->set_header(http::CONTENT_ENCODING, encoding);
 	}
 
+	if (ranges)
+	{
+		response->set_ranges(*ranges);
+	}
+
 	return response;
 }
 
@@ -9,11 +9,17 @@
 
 #pragma once
 
+// C++ libraries.
+#include <string>
+#include <utility>
+#include <vector>
+
 // Module definitions.
 #include "./_def_.h"
 
 // Framework libraries.
 #include "./controller.h"
+#include "./static_file_cache.h"
 
 
 __CONTROLLERS_BEGIN__
@@ -22,6 +28,18 @@ __CONTROLLERS_BEGIN__
 // Checks if something was modified since the user last downloaded it.
 extern bool was_modified_since(const std::string& header, size_t time, size_t size);
 
+// TESTME: find_precompressed_file
+// Looks for precompressed files of `full_path` which are not older than the
+// file itself and chooses the most preferred one by `accept_encoding`.
+//
+// Returns path to the chosen file and sets `encoding` to its content coding,
+// or returns an empty string if there is no acceptable file. `has_variants`
+// is set to true if at least one precompressed file exists, which means
+// that response depends on Accept-Encoding header.
+extern std::string find_precompressed_file(
+	const std::string& full_path, const std::string& accept_encoding, std::string& encoding, bool& has_variants
+);
+
 // TESTME: StaticController
 // TODO: docs for 'StaticController'
 // Serve static files below a given point in the directory structure.
@@ -29,8 +47,9 @@ class StaticController final : public Controller<const std::string&>
 {
 public:
 	inline explicit StaticController(
-		std::string static_root, const conf::Settings* settings, const ILogger* logger
-	) : Controller({"get"}, logger), _static_root(std::move(static_root))
+		std::string static_root, const conf::Settings* settings, const ILogger* logger,
+		std::shared_ptr<StaticFileCache> cache=nullptr
+	) : Controller({"get"}, logger), _static_root(std::move(static_root)), _cache(std::move(cache))
 	{
 		this->settings = require_non_null(settings, "'settings' is nullptr", _ERROR_DETAILS_);
 	}
@@ -41,6 +60,24 @@ public:
 private:
 	const conf::Settings* settings = nullptr;
 	std::string _static_root;
+
+	// Cache of small files which is shared between controllers
+	// of the same static url, can be nullptr.
+	std::shared_ptr<StaticFileCache> _cache;
+
+	// Returns response with content of cached file, or nullptr
+	// if part of the file is requested.
+	[[nodiscard]]
+	std::unique_ptr<http::IResponse> get_cached_file_response(
+		http::IRequest* request, const StaticFileCache::Entry& file,
+		const std::string& content_type, const std::string& encoding
+	) const;
+
+	[[nodiscard]]
+	std::unique_ptr<http::IResponse> get_file_response(
+		http::IRequest* request, const std::string& file_path,
+		const std::string& content_type, const std::string& encoding
+	) const;
 };
 
 __CONTROLLERS_END__
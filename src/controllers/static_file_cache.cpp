@@ -0,0 +1,187 @@
+/**
+ * controllers/static_file_cache.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./static_file_cache.h"
+
+// C++ libraries.
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <sys/stat.h>
+
+// Framework libraries.
+#include "../http/utility.h"
+
+
+__CONTROLLERS_BEGIN__
+
+StaticFileCache::StaticFileCache(
+	size_t max_entries, size_t max_file_size, std::chrono::milliseconds revalidate_interval
+) : _max_entries(max_entries), _max_file_size(max_file_size), _revalidate_interval(revalidate_interval)
+{
+}
+
+std::shared_ptr<const StaticFileCache::Entry> StaticFileCache::get(const std::string& file_path)
+{
+	auto now = std::chrono::steady_clock::now();
+	{
+		std::lock_guard lock(this->_mutex);
+		auto node = this->_nodes.find(file_path);
+		if (node != this->_nodes.end() && now - node->second.checked_at < this->_revalidate_interval)
+		{
+			this->_lru.splice(this->_lru.begin(), this->_lru, node->second.lru_position);
+			return node->second.entry;
+		}
+	}
+
+	// Check the file outside the lock, so other threads can use
+	// the cache while the file system is accessed.
+	struct stat file_info{};
+	if (::stat(file_path.c_str(), &file_info) != 0 || !S_ISREG(file_info.st_mode))
+	{
+		std::lock_guard lock(this->_mutex);
+		this->_erase(file_path);
+		return nullptr;
+	}
+
+	Signature signature{
+		.modification_time = file_info.st_mtime,
+		.size = (size_t)file_info.st_size,
+		.inode = (size_t)file_info.st_ino
+	};
+	auto variants = StaticFileCache::find_variants(file_path, file_info.st_mtime);
+	{
+		std::lock_guard lock(this->_mutex);
+		auto node = this->_nodes.find(file_path);
+		if (node != this->_nodes.end() && node->second.signature == signature)
+		{
+			if (node->second.entry->variants != variants)
+			{
+				// The content is not changed, so it is shared by the new entry.
+				auto entry = std::make_shared<Entry>(*node->second.entry);
+				entry->variants = std::move(variants);
+				node->second.entry = std::move(entry);
+			}
+
+			node->second.checked_at = now;
+			this->_lru.splice(this->_lru.begin(), this->_lru, node->second.lru_position);
+			return node->second.entry;
+		}
+
+		if (signature.size > this->_max_file_size || this->_max_entries == 0)
+		{
+			this->_erase(file_path);
+			return nullptr;
+		}
+	}
+
+	auto entry = StaticFileCache::_load(file_path, signature.modification_time, std::move(variants));
+	if (!entry || entry->content->size() != signature.size)
+	{
+		// The file was changed while it was read, do not cache it.
+		return entry;
+	}
+
+	std::lock_guard lock(this->_mutex);
+	this->_erase(file_path);
+	this->_lru.push_front(file_path);
+	this->_nodes[file_path] = Node{
+		.entry = entry,
+		.signature = signature,
+		.checked_at = now,
+		.lru_position = this->_lru.begin()
+	};
+	while (this->_nodes.size() > this->_max_entries)
+	{
+		this->_erase(this->_lru.back());
+	}
+
+	return entry;
+}
+
+void StaticFileCache::clear()
+{
+	std::lock_guard lock(this->_mutex);
+	this->_nodes.clear();
+	this->_lru.clear();
+}
+
+size_t StaticFileCache::size() const
+{
+	std::lock_guard lock(this->_mutex);
+	return this->_nodes.size();
+}
+
+std::string StaticFileCache::make_etag(time_t modification_time, size_t size)
+{
+	std::ostringstream etag;
+	etag << std::hex << modification_time << "-" << size;
+	return http::quote_etag(etag.str());
+}
+
+std::vector<StaticFileCache::Variant> StaticFileCache::find_variants(
+	const std::string& file_path, time_t modification_time
+)
+{
+	std::vector<Variant> variants;
+	for (const auto& [coding, extension] : PRECOMPRESSED_FILE_EXTENSIONS)
+	{
+		if (file_path.ends_with(extension))
+		{
+			return {};
+		}
+	}
+
+	for (const auto& [coding, extension] : PRECOMPRESSED_FILE_EXTENSIONS)
+	{
+		auto variant_path = file_path + extension;
+		struct stat variant_info{};
+		if (
+			::stat(variant_path.c_str(), &variant_info) == 0 &&
+			S_ISREG(variant_info.st_mode) &&
+			variant_info.st_mtime >= modification_time
+		)
+		{
+			variants.push_back(Variant{.encoding = coding, .file_path = std::move(variant_path)});
+		}
+	}
+
+	return variants;
+}
+
+void StaticFileCache::_erase(const std::string& file_path)
+{
+	auto node = this->_nodes.find(file_path);
+	if (node != this->_nodes.end())
+	{
+		this->_lru.erase(node->second.lru_position);
+		this->_nodes.erase(node);
+	}
+}
+
+std::shared_ptr<const StaticFileCache::Entry> StaticFileCache::_load(
+	const std::string& file_path, time_t modification_time, std::vector<Variant> variants
+)
+{
+	std::ifstream file(file_path, std::ios::binary);
+	if (!file.is_open())
+	{
+		return nullptr;
+	}
+
+	auto content = std::make_shared<std::string>(
+		std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()
+	);
+	auto entry = std::make_shared<Entry>();
+	entry->etag = StaticFileCache::make_etag(modification_time, content->size());
+	entry->last_modified = http::http_date(modification_time);
+	entry->modification_time = modification_time;
+	entry->variants = std::move(variants);
+	entry->content = std::move(content);
+	return entry;
+}
+
+__CONTROLLERS_END__
@@ -0,0 +1,138 @@
+/**
+ * controllers/static_file_cache.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * In-memory LRU cache of small static files.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <chrono>
+#include <ctime>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Module definitions.
+#include "./_def_.h"
+
+
+__CONTROLLERS_BEGIN__
+
+// Content codings of precompressed files with extensions of these files
+// in order of preference. A precompressed file is stored next to the
+// original one, for example: 'app.js.br' for 'app.js'.
+inline const std::vector<std::pair<std::string, std::string>> PRECOMPRESSED_FILE_EXTENSIONS = {
+	{"br", ".br"},
+	{"zstd", ".zst"},
+	{"gzip", ".gz"}
+};
+
+// TESTME: StaticFileCache
+// Bounded LRU cache of static files keyed by the full path of the file.
+//
+// Each entry holds the file content, precomputed validators and the list
+// of precompressed variants of the file. Entry is checked for changes
+// (modification time, size, inode and variants) not more often than once
+// per `revalidate_interval`, so a cache hit within this interval does not
+// touch the file system.
+//
+// The cache is safe to use from multiple threads at the same time.
+class StaticFileCache final
+{
+public:
+	// Precompressed file which is stored next to the original
+	// one, see 'PRECOMPRESSED_FILE_EXTENSIONS'.
+	struct Variant
+	{
+		// Content coding, for example: 'br'.
+		std::string encoding;
+		std::string file_path;
+
+		inline bool operator== (const Variant& other) const = default;
+	};
+
+	struct Entry
+	{
+		std::shared_ptr<const std::string> content;
+
+		// Strong ETag built from modification time and size
+		// of the file, already quoted.
+		std::string etag;
+
+		// Formatted value of Last-Modified header.
+		std::string last_modified;
+
+		time_t modification_time;
+
+		// Precompressed variants of the file in order of preference.
+		std::vector<Variant> variants;
+	};
+
+	StaticFileCache(size_t max_entries, size_t max_file_size, std::chrono::milliseconds revalidate_interval);
+
+	// Returns cached entry of the file, loads the file if it is not cached
+	// or was changed. Returns nullptr if the file does not exist, is not a
+	// regular file or is larger than `max_file_size`.
+	[[nodiscard]]
+	std::shared_ptr<const Entry> get(const std::string& file_path);
+
+	void clear();
+
+	[[nodiscard]]
+	size_t size() const;
+
+	// Returns quoted strong ETag of the file which is computed in the
+	// same way as nginx does, so it does not require hashing of the content.
+	[[nodiscard]]
+	static std::string make_etag(time_t modification_time, size_t size);
+
+	// Returns precompressed variants of `file_path` which are regular files
+	// not older than `modification_time`. A precompressed file itself does
+	// not have variants.
+	[[nodiscard]]
+	static std::vector<Variant> find_variants(const std::string& file_path, time_t modification_time);
+
+private:
+	struct Signature
+	{
+		time_t modification_time;
+		size_t size;
+		size_t inode;
+
+		inline bool operator== (const Signature& other) const = default;
+	};
+
+	struct Node
+	{
+		std::shared_ptr<const Entry> entry;
+		Signature signature;
+		std::chrono::steady_clock::time_point checked_at;
+		std::list<std::string>::iterator lru_position;
+	};
+
+	size_t _max_entries;
+	size_t _max_file_size;
+	std::chrono::milliseconds _revalidate_interval;
+
+	mutable std::mutex _mutex;
+
+	// Most recently used paths are at the front.
+	std::list<std::string> _lru;
+	std::unordered_map<std::string, Node> _nodes;
+
+	void _erase(const std::string& file_path);
+
+	[[nodiscard]]
+	static std::shared_ptr<const Entry> _load(
+		const std::string& file_path, time_t modification_time, std::vector<Variant> variants
+	);
+};
+
+__CONTROLLERS_END__
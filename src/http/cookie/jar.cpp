@@ -0,0 +1,209 @@
+/**
+ * http/cookie/jar.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./jar.h"
+
+// C++ libraries.
+#include <algorithm>
+
+// Base libraries.
+#include <xalwart.base/exceptions.h>
+
+// Framework libraries.
+#include "./parser.h"
+#include "../utility.h"
+
+
+__HTTP_BEGIN__
+
+inline std::string_view _trim_ascii_space(std::string_view value)
+{
+	while (!value.empty() && is_ascii_space(value.front()))
+	{
+		value.remove_prefix(1);
+	}
+
+	while (!value.empty() && is_ascii_space(value.back()))
+	{
+		value.remove_suffix(1);
+	}
+
+	return value;
+}
+
+CookieJar::CookieJar(std::string_view header, std::pmr::memory_resource* memory_resource) :
+	_header(header, memory_resource), _entries(memory_resource), _index(memory_resource),
+	_signed_values(memory_resource)
+{
+	std::string_view header_view = this->_header;
+	auto raw_cookie = _trim_ascii_space(header_view);
+	std::string_view part;
+	while (!raw_cookie.empty())
+	{
+		auto split_index = raw_cookie.find(';');
+		if (split_index != std::string_view::npos && split_index > 0)
+		{
+			part = raw_cookie.substr(0, split_index);
+			raw_cookie = raw_cookie.substr(split_index + 1);
+		}
+		else
+		{
+			part = raw_cookie;
+			raw_cookie = {};
+		}
+
+		part = _trim_ascii_space(part);
+		if (part.empty())
+		{
+			continue;
+		}
+
+		std::string_view name = part, value = part.substr(part.size());
+		auto j = part.find('=');
+		if (j != std::string_view::npos)
+		{
+			value = name.substr(j + 1);
+			name = name.substr(0, j);
+		}
+
+		if (!is_cookie_name_valid(name))
+		{
+			continue;
+		}
+
+		this->_entries.push_back({
+			.name_position = (size_t)(name.data() - header_view.data()),
+			.name_size = name.size(),
+			.value_position = (size_t)(value.data() - header_view.data()),
+			.value_size = value.size()
+		});
+	}
+
+	// Entries with the same name are chained in order of the header,
+	// only the first one of them is indexed.
+	std::pmr::vector<size_t> last_entries(memory_resource);
+	for (size_t i = 0; i < this->_entries.size(); i++)
+	{
+		auto name = this->_name(this->_entries[i]);
+		auto position = this->_index_position(name);
+		if (position < this->_index.size() && this->_name(this->_entries[this->_index[position]]) == name)
+		{
+			this->_entries[last_entries[position]].next = i;
+			last_entries[position] = i;
+		}
+		else
+		{
+			this->_index.insert(this->_index.begin() + (std::ptrdiff_t)position, i);
+			last_entries.insert(last_entries.begin() + (std::ptrdiff_t)position, i);
+		}
+	}
+}
+
+std::optional<std::string_view> CookieJar::get(std::string_view name) const
+{
+	for (auto i = this->_find_first(name); i != NOT_FOUND; i = this->_entries[i].next)
+	{
+		if (this->_is_valid(this->_entries[i]))
+		{
+			return this->_value(this->_entries[i]);
+		}
+	}
+
+	return std::nullopt;
+}
+
+std::vector<Cookie> CookieJar::cookies(std::string_view name) const
+{
+	std::vector<Cookie> result;
+	if (name.empty())
+	{
+		for (const auto& entry : this->_entries)
+		{
+			if (this->_is_valid(entry))
+			{
+				result.emplace_back(std::string(this->_name(entry)), std::string(this->_value(entry)));
+			}
+		}
+	}
+	else
+	{
+		for (auto i = this->_find_first(name); i != NOT_FOUND; i = this->_entries[i].next)
+		{
+			if (this->_is_valid(this->_entries[i]))
+			{
+				result.emplace_back(std::string(name), std::string(this->_value(this->_entries[i])));
+			}
+		}
+	}
+
+	return result;
+}
+
+std::optional<std::string> CookieJar::get_signed(
+	const std::string& name, const std::string& secret_key, const std::string& salt
+) const
+{
+	std::pmr::string key(name, this->_signed_values.get_allocator());
+	key.append(1, '\0').append(salt).append(1, '\0').append(secret_key);
+	auto memoized = this->_signed_values.find(key);
+	if (memoized != this->_signed_values.end())
+	{
+		return memoized->second;
+	}
+
+	std::optional<std::string> result;
+	if (auto value = this->get(name))
+	{
+		try
+		{
+			result = get_cookie_signer(secret_key, name + salt)->unsign(std::string(*value));
+		}
+		catch (const BadSignature&)
+		{
+		}
+	}
+
+	this->_signed_values.emplace(std::move(key), result);
+	return result;
+}
+
+bool CookieJar::_is_valid(const Entry& entry) const
+{
+	if (entry.state == State::NotChecked)
+	{
+		auto [value, ok] = parse_cookie_value(this->_value(entry), true);
+		if (ok)
+		{
+			entry.value_position += value.data() - this->_value(entry).data();
+			entry.value_size = value.size();
+		}
+
+		entry.state = ok ? State::Valid : State::Invalid;
+	}
+
+	return entry.state == State::Valid;
+}
+
+size_t CookieJar::_index_position(std::string_view name) const
+{
+	return std::lower_bound(
+		this->_index.begin(), this->_index.end(), name,
+		[this](size_t entry, std::string_view name) -> bool { return this->_name(this->_entries[entry]) < name; }
+	) - this->_index.begin();
+}
+
+size_t CookieJar::_find_first(std::string_view name) const
+{
+	auto position = this->_index_position(name);
+	if (position < this->_index.size() && this->_name(this->_entries[this->_index[position]]) == name)
+	{
+		return this->_index[position];
+	}
+
+	return NOT_FOUND;
+}
+
+__HTTP_END__
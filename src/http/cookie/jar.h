@@ -0,0 +1,142 @@
+/**
+ * http/cookie/jar.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Cookies of the request which are parsed once.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <map>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Module definitions.
+#include "../_def_.h"
+
+// Framework libraries.
+#include "./cookie.h"
+
+
+__HTTP_BEGIN__
+
+// TESTME: CookieJar
+// Keeps a copy of the "Cookie" header which is split into names and
+// values once. Names are indexed when the jar is created, values are
+// validated only when they are accessed and the result is kept.
+//
+// If multiple cookies have the same name, the first valid one is found.
+//
+// The copy of the header and the index are allocated from `memory_resource`,
+// so the jar of the request is freed with the rest of its memory.
+class CookieJar final
+{
+public:
+	CookieJar() = default;
+
+	explicit CookieJar(
+		std::string_view header, std::pmr::memory_resource* memory_resource=std::pmr::get_default_resource()
+	);
+
+	// Returns the value of the cookie without surrounding double quotes
+	// or `std::nullopt` if the cookie is missing or invalid. The view is
+	// valid while the jar is alive.
+	[[nodiscard]]
+	std::optional<std::string_view> get(std::string_view name) const;
+
+	[[nodiscard]]
+	inline bool contains(std::string_view name) const
+	{
+		return this->get(name).has_value();
+	}
+
+	// Returns valid cookies in order of the header. If `name` is not
+	// empty, only cookies of that name are returned.
+	[[nodiscard]]
+	std::vector<Cookie> cookies(std::string_view name={}) const;
+
+	// Returns the value of the cookie which was set by
+	// 'IResponse::set_signed_cookie()' with the same `secret_key` and
+	// `salt`, or `std::nullopt` if the cookie is missing or its signature
+	// does not match. The signature is checked once for each name and salt.
+	[[nodiscard]]
+	std::optional<std::string> get_signed(
+		const std::string& name, const std::string& secret_key, const std::string& salt=""
+	) const;
+
+	// Returns the count of cookies with valid names,
+	// values are not checked.
+	[[nodiscard]]
+	inline size_t size() const
+	{
+		return this->_entries.size();
+	}
+
+	[[nodiscard]]
+	inline bool empty() const
+	{
+		return this->_entries.empty();
+	}
+
+private:
+	static inline constexpr size_t NOT_FOUND = (size_t)-1;
+
+	enum class State : unsigned char
+	{
+		NotChecked, Valid, Invalid
+	};
+
+	// Offsets in '_header' are kept instead of views,
+	// so the jar can be copied.
+	struct Entry
+	{
+		size_t name_position;
+		size_t name_size;
+		mutable size_t value_position;
+		mutable size_t value_size;
+		mutable State state = State::NotChecked;
+
+		// Next entry with the same name.
+		size_t next = NOT_FOUND;
+	};
+
+	std::pmr::string _header;
+	std::pmr::vector<Entry> _entries;
+
+	// First entries of distinct names sorted by name.
+	std::pmr::vector<size_t> _index;
+
+	// Results of 'get_signed()' by name, salt and secret key.
+	mutable std::pmr::map<std::pmr::string, std::optional<std::string>, std::less<>> _signed_values;
+
+	[[nodiscard]]
+	inline std::string_view _name(const Entry& entry) const
+	{
+		return std::string_view(this->_header).substr(entry.name_position, entry.name_size);
+	}
+
+	[[nodiscard]]
+	inline std::string_view _value(const Entry& entry) const
+	{
+		return std::string_view(this->_header).substr(entry.value_position, entry.value_size);
+	}
+
+	// Validates the value of `entry` on the first call.
+	[[nodiscard]]
+	bool _is_valid(const Entry& entry) const;
+
+	// Returns position in '_index' where `name` is or should be inserted.
+	[[nodiscard]]
+	size_t _index_position(std::string_view name) const;
+
+	// Returns the first entry with `name` or 'NOT_FOUND'.
+	[[nodiscard]]
+	size_t _find_first(std::string_view name) const;
+};
+
+__HTTP_END__
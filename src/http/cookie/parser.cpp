@@ -6,83 +6,36 @@
 
 #include "./parser.h"
 
-// Base libraries.
-#include <xalwart.base/string_utils.h>
+// Framework libraries.
+#include "./jar.h"
 
 
 __HTTP_BEGIN__
 
-std::pair<std::string, bool> parse_cookie_value(std::string raw_val, bool allow_double_quote)
+std::pair<std::string_view, bool> parse_cookie_value(std::string_view raw_val, bool allow_double_quote)
 {
 	if (allow_double_quote && raw_val.size() > 1 && raw_val.front() == '"' && raw_val.back() == '"')
 	{
-		raw_val = str::trim(raw_val, '"');
+		auto begin = raw_val.find_first_not_of('"');
+		raw_val = begin == std::string_view::npos ? raw_val.substr(raw_val.size()) : raw_val.substr(
+			begin, raw_val.find_last_not_of('"') - begin + 1
+		);
 	}
 
 	for (char b : raw_val)
 	{
 		if (!valid_cookie_value_byte(b))
 		{
-			return {"", false};
+			return {{}, false};
 		}
 	}
 
 	return {raw_val, true};
 }
 
-std::vector<Cookie> parse_cookies(std::string raw_cookie, const std::string& filter)
+std::vector<Cookie> parse_cookies(std::string_view raw_cookie, const std::string& filter)
 {
-	std::vector<Cookie> cookies;
-	raw_cookie = str::trim_func(raw_cookie, is_ascii_space);
-	std::string part;
-	while (!raw_cookie.empty())
-	{
-		auto split_index = raw_cookie.find(';');
-		if (split_index != std::string::npos && split_index > 0)
-		{
-			part = raw_cookie.substr(0, split_index);
-			raw_cookie = raw_cookie.substr(split_index + 1);
-		}
-		else
-		{
-			part = raw_cookie;
-			raw_cookie = "";
-		}
-
-		part = str::trim_func(part, is_ascii_space);
-		if (part.empty())
-		{
-			continue;
-		}
-
-		std::string name = part, val;
-		auto j = part.find('=');
-		if (j != std::string::npos)
-		{
-			val = name.substr(j + 1);
-			name = name.substr(0, j);
-		}
-
-		if (!is_cookie_name_valid(name))
-		{
-			continue;
-		}
-
-		if (!filter.empty() && filter != name)
-		{
-			continue;
-		}
-
-		auto [value, ok] = parse_cookie_value(val, true);
-		if (!ok)
-		{
-			continue;
-		}
-
-		cookies.emplace_back(name, value);
-	}
-
-	return cookies;
+	return CookieJar(raw_cookie).cookies(filter);
 }
 
 __HTTP_END__
@@ -12,7 +12,9 @@
 #pragma once
 
 // C++ libraries.
+#include <algorithm>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 
@@ -39,14 +41,16 @@ inline bool valid_cookie_value_byte(char b)
 }
 
 // TESTME: parse_cookie_value
-extern std::pair<std::string, bool> parse_cookie_value(std::string raw_val, bool allow_double_quote);
+// Returns view into `raw_val` without surrounding double quotes
+// and `false` if the value contains invalid bytes.
+extern std::pair<std::string_view, bool> parse_cookie_value(std::string_view raw_val, bool allow_double_quote);
 
 //extern bool is_token_table();
 
 // TESTME: is_cookie_name_valid
-inline bool is_cookie_name_valid(const std::string& raw)
+inline bool is_cookie_name_valid(std::string_view raw)
 {
-	return !raw.empty() && std::find_if(raw.begin(), raw.end(), is_not_token) == std::end(raw);
+	return !raw.empty() && std::find_if(raw.begin(), raw.end(), is_not_token) == raw.end();
 }
 
 // TESTME: parse_cookies
@@ -54,6 +58,6 @@ inline bool is_cookie_name_valid(const std::string& raw)
 // returns the successfully parsed Cookies.
 //
 // if filter isn't empty, only cookies of that name are returned
-extern std::vector<Cookie> parse_cookies(std::string raw_cookie, const std::string& filter);
+extern std::vector<Cookie> parse_cookies(std::string_view raw_cookie, const std::string& filter);
 
 __HTTP_END__
@@ -0,0 +1,302 @@
+/**
+ * http/header_map.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./header_map.h"
+
+// Framework libraries.
+#include "./headers.h"
+
+
+__HTTP_BEGIN__
+
+// Names in order of 'HeaderId'.
+inline constexpr std::array<const char*, HEADER_IDS_COUNT> _HEADER_NAMES = {
+	AGE,
+	ALLOW,
+	ACCEPT_ENCODING,
+	ACCEPT_RANGES,
+	HOST,
+	USER_AGENT,
+	AUTHORIZATION,
+	CACHE_CONTROL,
+	CONTENT_LOCATION,
+	LOCATION,
+	COOKIE,
+	REFERER,
+	CONTENT_TYPE,
+	CONTENT_DISPOSITION,
+	CONTENT_TRANSFER_ENCODING,
+	DATE,
+	EXPIRES,
+	VARY,
+	E_TAG,
+	IF_MATCH,
+	IF_MODIFIED_SINCE,
+	IF_UNMODIFIED_SINCE,
+	IF_NONE_MATCH,
+	IF_RANGE,
+	LAST_MODIFIED,
+	CONTENT_ENCODING,
+	CONTENT_LENGTH,
+	CONTENT_RANGE,
+	RANGE,
+	TRANSFER_ENCODING,
+	REFERRER_POLICY,
+	STRICT_TRANSPORT_SECURITY,
+	X_FRAME_OPTIONS,
+	X_FORWARDED_HOST,
+	X_FORWARDED_PORT,
+	X_FORWARDED_PROTO,
+	X_XSS_PROTECTION,
+	X_CONTENT_TYPE_OPTIONS
+};
+
+inline constexpr char _to_lower(char c)
+{
+	return c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
+}
+
+// FNV-1a hash of lowercase name.
+inline constexpr size_t _hash(std::string_view name)
+{
+	size_t result = 14695981039346656037ULL;
+	for (char c : name)
+	{
+		result = (result ^ (unsigned char)_to_lower(c)) * 1099511628211ULL;
+	}
+
+	return result;
+}
+
+inline constexpr bool _equals(std::string_view left, std::string_view right)
+{
+	if (left.size() != right.size())
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < left.size(); i++)
+	{
+		if (_to_lower(left[i]) != _to_lower(right[i]))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+inline constexpr size_t _HEADER_IDS_TABLE_SIZE = 128;
+inline constexpr unsigned char _EMPTY_SLOT = 0xFF;
+
+// Open addressing table of identifiers which is built at compile time.
+inline constexpr auto _HEADER_IDS_TABLE = []()
+{
+	std::array<unsigned char, _HEADER_IDS_TABLE_SIZE> table{};
+	table.fill(_EMPTY_SLOT);
+	for (size_t id = 0; id < HEADER_IDS_COUNT; id++)
+	{
+		auto slot = _hash(_HEADER_NAMES[id]) % _HEADER_IDS_TABLE_SIZE;
+		while (table[slot] != _EMPTY_SLOT)
+		{
+			slot = (slot + 1) % _HEADER_IDS_TABLE_SIZE;
+		}
+
+		table[slot] = (unsigned char)id;
+	}
+
+	return table;
+}();
+
+inline constexpr size_t _CUSTOM_KEY_BIT = (size_t)1 << (sizeof(size_t) * 8 - 1);
+
+std::optional<HeaderId> get_header_id(std::string_view name)
+{
+	auto slot = _hash(name) % _HEADER_IDS_TABLE_SIZE;
+	while (_HEADER_IDS_TABLE[slot] != _EMPTY_SLOT)
+	{
+		auto id = _HEADER_IDS_TABLE[slot];
+		if (_equals(_HEADER_NAMES[id], name))
+		{
+			return (HeaderId)id;
+		}
+
+		slot = (slot + 1) % _HEADER_IDS_TABLE_SIZE;
+	}
+
+	return std::nullopt;
+}
+
+std::string_view get_header_name(HeaderId id)
+{
+	return _HEADER_NAMES[(size_t)id];
+}
+
+HeaderMap::HeaderMap()
+{
+	this->_positions.fill(NOT_FOUND);
+}
+
+HeaderMap::HeaderMap(std::initializer_list<value_type> headers) : HeaderMap()
+{
+	for (const auto& [name, value] : headers)
+	{
+		this->set(name, value);
+	}
+}
+
+const std::string* HeaderMap::find(std::string_view name) const
+{
+	if (auto id = get_header_id(name))
+	{
+		return this->find(*id);
+	}
+
+	auto position = this->_find_custom(name, _hash(name) | _CUSTOM_KEY_BIT);
+	return position != NOT_FOUND ? &this->_entries[position].second : nullptr;
+}
+
+const std::string* HeaderMap::find(HeaderId id) const
+{
+	auto position = this->_positions[(size_t)id];
+	return position != NOT_FOUND ? &this->_entries[position].second : nullptr;
+}
+
+void HeaderMap::set(std::string_view name, std::string value)
+{
+	if (auto id = get_header_id(name))
+	{
+		this->set(*id, std::move(value));
+		return;
+	}
+
+	auto key = _hash(name) | _CUSTOM_KEY_BIT;
+	auto position = this->_find_custom(name, key);
+	if (position != NOT_FOUND)
+	{
+		this->_entries[position].second = std::move(value);
+	}
+	else
+	{
+		this->_append(name, std::move(value), key);
+	}
+}
+
+void HeaderMap::set(HeaderId id, std::string value)
+{
+	auto position = this->_positions[(size_t)id];
+	if (position != NOT_FOUND)
+	{
+		this->_entries[position].second = std::move(value);
+	}
+	else
+	{
+		this->_positions[(size_t)id] = (unsigned short)this->_entries.size();
+		this->_append(get_header_name(id), std::move(value), (size_t)id);
+	}
+}
+
+bool HeaderMap::erase(std::string_view name)
+{
+	if (auto id = get_header_id(name))
+	{
+		return this->erase(*id);
+	}
+
+	auto position = this->_find_custom(name, _hash(name) | _CUSTOM_KEY_BIT);
+	if (position == NOT_FOUND)
+	{
+		return false;
+	}
+
+	this->_erase_at(position);
+	return true;
+}
+
+bool HeaderMap::erase(HeaderId id)
+{
+	auto position = this->_positions[(size_t)id];
+	if (position == NOT_FOUND)
+	{
+		return false;
+	}
+
+	this->_erase_at(position);
+	return true;
+}
+
+void HeaderMap::serialize(std::string& result) const
+{
+	result.reserve(result.size() + this->serialized_size());
+	for (size_t i = 0; i < this->_entries.size(); i++)
+	{
+		if (i > 0)
+		{
+			result.append("\r\n");
+		}
+
+		result.append(this->_entries[i].first).append(": ").append(this->_entries[i].second);
+	}
+}
+
+size_t HeaderMap::serialized_size() const
+{
+	size_t result = 0;
+	for (const auto& [name, value] : this->_entries)
+	{
+		result += name.size() + value.size() + 4;
+	}
+
+	return result;
+}
+
+size_t HeaderMap::_find_custom(std::string_view name, size_t key) const
+{
+	for (size_t i = 0; i < this->_keys.size(); i++)
+	{
+		if (this->_keys[i] == key && _equals(this->_entries[i].first, name))
+		{
+			return i;
+		}
+	}
+
+	return NOT_FOUND;
+}
+
+void HeaderMap::_append(std::string_view name, std::string value, size_t key)
+{
+	if (this->_entries.empty())
+	{
+		this->_entries.reserve(INITIAL_CAPACITY);
+		this->_keys.reserve(INITIAL_CAPACITY);
+	}
+
+	this->_entries.emplace_back(std::string(name), std::move(value));
+	this->_keys.push_back(key);
+}
+
+void HeaderMap::_erase_at(size_t position)
+{
+	auto key = this->_keys[position];
+	if (!(key & _CUSTOM_KEY_BIT))
+	{
+		this->_positions[key] = NOT_FOUND;
+	}
+
+	this->_entries.erase(this->_entries.begin() + (std::ptrdiff_t)position);
+	this->_keys.erase(this->_keys.begin() + (std::ptrdiff_t)position);
+
+	// Well-known headers after the removed one are shifted.
+	for (size_t i = position; i < this->_keys.size(); i++)
+	{
+		if (!(this->_keys[i] & _CUSTOM_KEY_BIT))
+		{
+			this->_positions[this->_keys[i]] = (unsigned short)i;
+		}
+	}
+}
+
+__HTTP_END__
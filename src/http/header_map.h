@@ -0,0 +1,190 @@
+/**
+ * http/header_map.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Flat case-insensitive container of HTTP headers.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <array>
+#include <initializer_list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Module definitions.
+#include "./_def_.h"
+
+
+__HTTP_BEGIN__
+
+// Identifiers of headers which are declared in 'headers.h'.
+enum class HeaderId : unsigned char
+{
+	Age,
+	Allow,
+	AcceptEncoding,
+	AcceptRanges,
+	Host,
+	UserAgent,
+	Authorization,
+	CacheControl,
+	ContentLocation,
+	Location,
+	Cookie,
+	Referer,
+	ContentType,
+	ContentDisposition,
+	ContentTransferEncoding,
+	Date,
+	Expires,
+	Vary,
+	ETag,
+	IfMatch,
+	IfModifiedSince,
+	IfUnmodifiedSince,
+	IfNoneMatch,
+	IfRange,
+	LastModified,
+	ContentEncoding,
+	ContentLength,
+	ContentRange,
+	Range,
+	TransferEncoding,
+	ReferrerPolicy,
+	StrictTransportSecurity,
+	XFrameOptions,
+	XForwardedHost,
+	XForwardedPort,
+	XForwardedProto,
+	XXSSProtection,
+	XContentTypeOptions
+};
+
+inline constexpr size_t HEADER_IDS_COUNT = (size_t)HeaderId::XContentTypeOptions + 1;
+
+// TESTME: get_header_id
+// Returns identifier of well-known header, the name is compared
+// case-insensitively.
+extern std::optional<HeaderId> get_header_id(std::string_view name);
+
+// TESTME: get_header_name
+// Returns the name of the header as it is declared in 'headers.h'.
+extern std::string_view get_header_name(HeaderId id);
+
+// TESTME: HeaderMap
+// Headers which are kept in a flat vector in order of insertion. Names
+// are compared case-insensitively. Well-known headers are found by
+// identifier in constant time, other headers are found by comparing
+// precomputed hashes of their names.
+//
+// Names of well-known headers are stored in the same form as they are
+// declared in 'headers.h', whatever case is used to set them.
+class HeaderMap final
+{
+public:
+	using value_type = std::pair<std::string, std::string>;
+	using const_iterator = std::vector<value_type>::const_iterator;
+
+	HeaderMap();
+
+	HeaderMap(std::initializer_list<value_type> headers);
+
+	// Returns pointer to value of the header or nullptr
+	// if the header is not set.
+	[[nodiscard]]
+	const std::string* find(std::string_view name) const;
+
+	[[nodiscard]]
+	const std::string* find(HeaderId id) const;
+
+	[[nodiscard]]
+	inline bool contains(std::string_view name) const
+	{
+		return this->find(name) != nullptr;
+	}
+
+	[[nodiscard]]
+	inline bool contains(HeaderId id) const
+	{
+		return this->find(id) != nullptr;
+	}
+
+	// Replaces the value of the header or appends the header.
+	void set(std::string_view name, std::string value);
+
+	void set(HeaderId id, std::string value);
+
+	// Returns `true` if the header was removed.
+	bool erase(std::string_view name);
+
+	bool erase(HeaderId id);
+
+	inline void clear()
+	{
+		this->_entries.clear();
+		this->_keys.clear();
+		this->_positions.fill(NOT_FOUND);
+	}
+
+	[[nodiscard]]
+	inline size_t size() const
+	{
+		return this->_entries.size();
+	}
+
+	[[nodiscard]]
+	inline bool empty() const
+	{
+		return this->_entries.empty();
+	}
+
+	[[nodiscard]]
+	inline const_iterator begin() const
+	{
+		return this->_entries.begin();
+	}
+
+	[[nodiscard]]
+	inline const_iterator end() const
+	{
+		return this->_entries.end();
+	}
+
+	// Appends headers in the form of "Name: value" separated by CRLF
+	// to `result`, without the trailing CRLF.
+	void serialize(std::string& result) const;
+
+	// Returns the count of bytes which 'serialize()' appends.
+	[[nodiscard]]
+	size_t serialized_size() const;
+
+private:
+	static inline constexpr unsigned short NOT_FOUND = 0xFFFF;
+
+	// Most of responses have less headers than this.
+	static inline constexpr size_t INITIAL_CAPACITY = 12;
+
+	std::vector<value_type> _entries;
+
+	// Identifier of well-known header or case-insensitive hash
+	// of the name with the highest bit set, for each entry.
+	std::vector<size_t> _keys;
+
+	// Positions of well-known headers in '_entries'.
+	std::array<unsigned short, HEADER_IDS_COUNT> _positions;
+
+	[[nodiscard]]
+	size_t _find_custom(std::string_view name, size_t key) const;
+
+	void _append(std::string_view name, std::string value, size_t key);
+
+	void _erase_at(size_t position);
+};
+
+__HTTP_END__
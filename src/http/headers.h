@@ -17,56 +17,73 @@
 
 __HTTP_BEGIN__
 
-inline const char* ALLOW = "Allow";
+inline constexpr const char* AGE = "Age";
 
-inline const char* HOST = "Host";
+inline constexpr const char* ALLOW = "Allow";
 
-inline const char* USER_AGENT = "User-Agent";
+inline constexpr const char* ACCEPT_ENCODING = "Accept-Encoding";
 
-inline const char* CACHE_CONTROL = "Cache-Control";
+inline constexpr const char* ACCEPT_RANGES = "Accept-Ranges";
 
-inline const char* CONTENT_LOCATION = "Content-Location";
+inline constexpr const char* HOST = "Host";
 
-inline const char* LOCATION = "Location";
+inline constexpr const char* USER_AGENT = "User-Agent";
 
-inline const char* COOKIE = "Cookie";
+inline constexpr const char* AUTHORIZATION = "Authorization";
 
-inline const char* REFERER = "Referer";
+inline constexpr const char* CACHE_CONTROL = "Cache-Control";
 
-inline const char* CONTENT_TYPE = "Content-Type";
+inline constexpr const char* CONTENT_LOCATION = "Content-Location";
 
-inline const char* CONTENT_DISPOSITION = "Content-Disposition";
+inline constexpr const char* LOCATION = "Location";
 
-inline const char* CONTENT_TRANSFER_ENCODING = "Content-Transfer-Encoding";
+inline constexpr const char* COOKIE = "Cookie";
 
-inline const char* DATE = "Date";
+inline constexpr const char* REFERER = "Referer";
 
-inline const char* EXPIRES = "Expires";
+inline constexpr const char* CONTENT_TYPE = "Content-Type";
 
-inline const char* VARY = "Vary";
+inline constexpr const char* CONTENT_DISPOSITION = "Content-Disposition";
 
-inline const char* E_TAG = "ETag";
+inline constexpr const char* CONTENT_TRANSFER_ENCODING = "Content-Transfer-Encoding";
 
-inline const char* IF_MATCH = "If-Match";
-inline const char* IF_MODIFIED_SINCE = "If-Modified-Since";
-inline const char* IF_UNMODIFIED_SINCE = "If-Unmodified-Since";
-inline const char* IF_NONE_MATCH = "If-None-Match";
+inline constexpr const char* DATE = "Date";
 
-inline const char* LAST_MODIFIED = "Last-Modified";
+inline constexpr const char* EXPIRES = "Expires";
 
-inline const char* CONTENT_ENCODING = "Content-Encoding";
+inline constexpr const char* VARY = "Vary";
 
-inline const char* CONTENT_LENGTH = "Content-Length";
+inline constexpr const char* E_TAG = "ETag";
 
-inline const char* REFERRER_POLICY = "Referrer-Policy";
+inline constexpr const char* IF_MATCH = "If-Match";
+inline constexpr const char* IF_MODIFIED_SINCE = "If-Modified-Since";
+inline constexpr const char* IF_UNMODIFIED_SINCE = "If-Unmodified-Since";
+inline constexpr const char* IF_NONE_MATCH = "If-None-Match";
+inline constexpr const char* IF_RANGE = "If-Range";
 
-inline const char* STRICT_TRANSPORT_SECURITY = "Strict-Transport-Security";
+inline constexpr const char* LAST_MODIFIED = "Last-Modified";
 
-inline const char* X_FRAME_OPTIONS = "X-Frame-Options";
-inline const char* X_FORWARDED_HOST = "X-Forwarded-Host";
-inline const char* X_FORWARDED_PORT = "X-Forwarded-Port";
-inline const char* X_FORWARDED_PROTO = "X-Forwarded-Proto";
-inline const char* X_XSS_PROTECTION = "X-XSS-Protection";
-inline const char* X_CONTENT_TYPE_OPTIONS = "X-Content-Type-Options";
+inline constexpr const char* CONTENT_ENCODING = "Content-Encoding";
+
+inline constexpr const char* CONTENT_LENGTH = "Content-Length";
+
+inline constexpr const char* CONTENT_RANGE = "Content-Range";
+
+inline constexpr const char* RANGE = "Range";
+
+inline constexpr const char* TRANSFER_ENCODING = "Transfer-Encoding";
+
+inline constexpr const char* CONNECTION = "Connection";
+
+inline constexpr const char* REFERRER_POLICY = "Referrer-Policy";
+
+inline constexpr const char* STRICT_TRANSPORT_SECURITY = "Strict-Transport-Security";
+
+inline constexpr const char* X_FRAME_OPTIONS = "X-Frame-Options";
+inline constexpr const char* X_FORWARDED_HOST = "X-Forwarded-Host";
+inline constexpr const char* X_FORWARDED_PORT = "X-Forwarded-Port";
+inline constexpr const char* X_FORWARDED_PROTO = "X-Forwarded-Proto";
+inline constexpr const char* X_XSS_PROTECTION = "X-XSS-Protection";
+inline constexpr const char* X_CONTENT_TYPE_OPTIONS = "X-Content-Type-Options";
 
 __HTTP_END__
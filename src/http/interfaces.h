@@ -9,8 +9,11 @@
 #pragma once
 
 // C++ libraries.
+#include <functional>
 #include <string>
+#include <string_view>
 #include <map>
+#include <memory_resource>
 #include <vector>
 #include <optional>
 
@@ -27,8 +30,27 @@
 #include "../conf/types.h"
 
 
+__HTTP_MIME_BEGIN__
+
+// Defined in 'mime/media_type.h'.
+struct MediaType;
+
+__HTTP_MIME_END__
+
+
+__HTTP_MIME_MULTIPART_BEGIN__
+
+// Defined in 'mime/multipart/part.h'.
+struct Part;
+
+__HTTP_MIME_MULTIPART_END__
+
+
 __HTTP_BEGIN__
 
+// Defined in 'cookie/jar.h'.
+class CookieJar;
+
 class IRequest
 {
 public:
@@ -78,12 +100,22 @@ public:
 	[[nodiscard]]
 	virtual std::string get_header(const std::string& key, const std::string& default_value) const = 0;
 
+	// Returns value of the header without copying it, or an empty
+	// view if the header is missing.
+	[[nodiscard]]
+	virtual std::string_view get_header_view(const std::string& key) const = 0;
+
 	// TODO: docs for 'set_header'
 	virtual void set_header(const std::string& key, const std::string& value) = 0;
 
 	[[nodiscard]]
 	virtual bool is_json() const = 0;
 
+	// Returns parsed Content-Type header, or "application/octet-stream"
+	// if it is missing. The header is parsed once per request.
+	[[nodiscard]]
+	virtual const mime::MediaType& media_type() const = 0;
+
 	// 'cookies' parses and returns the HTTP cookies sent with the request.
 	[[nodiscard]]
 	virtual std::vector<Cookie> cookies() const = 0;
@@ -95,6 +127,19 @@ public:
 	[[nodiscard]]
 	virtual std::optional<Cookie> cookie(const std::string& name) const = 0;
 
+	// Returns cookies of the request. The "Cookie" header is
+	// parsed once per request.
+	[[nodiscard]]
+	virtual const CookieJar& cookie_jar() const = 0;
+
+	// Returns the value of the cookie which was set by
+	// 'IResponse::set_signed_cookie()', or `std::nullopt` if the cookie
+	// is missing or its signature does not match.
+	[[nodiscard]]
+	virtual std::optional<std::string> get_signed_cookie(
+		const std::string& name, const std::string& secret_key, const std::string& salt=""
+	) const = 0;
+
 	// 'referer' returns the referring URL, if sent in the request.
 	//
 	// 'referer' is misspelled as in the request itself, a mistake from the
@@ -110,6 +155,12 @@ public:
 
 	virtual const mime::multipart::Form& multipart_form() = 0;
 
+	// Reads multipart/form-data body part by part without keeping it in
+	// memory, see 'mime::multipart::BodyReader::read_parts()'. The body
+	// is read once, so it can not be combined with 'multipart_form()':
+	// 'RuntimeError' is thrown by the second of these calls.
+	virtual void read_multipart(const std::function<bool(mime::multipart::Part&)>& handler) = 0;
+
 	virtual nlohmann::json json() = 0;
 
 	[[nodiscard]]
@@ -139,6 +190,29 @@ public:
 
 	[[nodiscard]]
 	virtual bool is_secure(const std::optional<conf::Secure::Header>& secure_proxy_ssl_header) const = 0;
+
+	// Returns memory resource for temporary objects which do not outlive
+	// the request, for example, 'std::pmr::string'. Memory is released in
+	// one shot after the response is sent.
+	[[nodiscard]]
+	virtual std::pmr::memory_resource* memory_resource() const = 0;
+};
+
+// Serialized response which is split into slices to be written one
+// after another without joining them. The body is a view into content
+// owned by response, so the response must outlive the slices.
+struct ResponseSlices
+{
+	// Status line, headers and empty line which ends the header block.
+	std::string head;
+
+	std::string_view body;
+
+	[[nodiscard]]
+	inline size_t size() const
+	{
+		return this->head.size() + this->body.size();
+	}
 };
 
 // TODO: docs for 'IResponse'
@@ -204,6 +278,10 @@ public:
 
 	[[nodiscard]]
 	virtual std::string serialize() = 0;
+
+	// Serializes response without copying the content.
+	[[nodiscard]]
+	virtual ResponseSlices serialize_slices() = 0;
 };
 
 __HTTP_END__
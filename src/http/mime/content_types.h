@@ -27,4 +27,7 @@ inline constexpr const wchar_t* APPLICATION_OCTET_STREAM_L = L"application/octet
 inline constexpr const char* MULTIPART_FORM_DATA = "multipart/form-data";
 inline constexpr const wchar_t* MULTIPART_FORM_DATA_L = L"multipart/form-data";
 
+inline constexpr const char* MULTIPART_BYTERANGES = "multipart/byteranges";
+inline constexpr const wchar_t* MULTIPART_BYTERANGES_L = L"multipart/byteranges";
+
 __HTTP_MIME_END__
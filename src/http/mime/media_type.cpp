@@ -6,10 +6,13 @@
 
 #include "./media_type.h"
 
+// C++ libraries.
+#include <algorithm>
+#include <optional>
+
 // Base libraries.
 #include <xalwart.base/path.h>
 #include <xalwart.base/exceptions.h>
-#include <xalwart.base/encoding.h>
 
 
 __HTTP_MIME_BEGIN__
@@ -99,43 +102,164 @@ void guess_content_type(const std::string& _path, std::string& type, std::string
 	}
 }
 
-std::tuple<std::wstring, std::wstring> _consume_token(const std::wstring& s)
+inline bool _is_space(char c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+inline std::string_view _trim_left(std::string_view s)
+{
+	while (!s.empty() && _is_space(s.front()))
+	{
+		s.remove_prefix(1);
+	}
+
+	return s;
+}
+
+inline std::string_view _trim(std::string_view s)
+{
+	s = _trim_left(s);
+	while (!s.empty() && _is_space(s.back()))
+	{
+		s.remove_suffix(1);
+	}
+
+	return s;
+}
+
+inline std::string _to_lower(std::string_view s)
+{
+	std::string result(s);
+	std::transform(result.begin(), result.end(), result.begin(), [](char c) -> char
+	{
+		return c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
+	});
+	return result;
+}
+
+inline int _unhex(char c)
+{
+	if (c >= '0' && c <= '9')
+	{
+		return c - '0';
+	}
+
+	if (c >= 'a' && c <= 'f')
+	{
+		return c - 'a' + 10;
+	}
+
+	if (c >= 'A' && c <= 'F')
+	{
+		return c - 'A' + 10;
+	}
+
+	return -1;
+}
+
+// Decodes "%XX" sequences, returns `std::nullopt` if some '%' is
+// not followed by two hexadecimal digits.
+inline std::optional<std::string> _percent_hex_unescape(std::string_view s)
+{
+	std::string result;
+	result.reserve(s.size());
+	for (size_t i = 0; i < s.size(); i++)
+	{
+		if (s[i] != '%')
+		{
+			result += s[i];
+			continue;
+		}
+
+		if (i + 2 >= s.size() || _unhex(s[i + 1]) < 0 || _unhex(s[i + 2]) < 0)
+		{
+			return std::nullopt;
+		}
+
+		result += (char)(_unhex(s[i + 1]) << 4 | _unhex(s[i + 2]));
+		i += 2;
+	}
+
+	return result;
+}
+
+// Decodes value of the form "charset'language'encoded" from RFC 2231,
+// only US-ASCII and UTF-8 charsets are supported.
+inline std::optional<std::string> _decode_rfc2231(std::string_view value)
 {
-	auto not_pos = str::find_if(s.begin(), s.end(), _is_not_token_char);
-	if (str::is_end_position(not_pos))
+	auto first_quote = value.find('\'');
+	auto second_quote = first_quote == std::string_view::npos ? first_quote : value.find('\'', first_quote + 1);
+	if (second_quote == std::string_view::npos)
 	{
-		return {s, L""};
+		return std::nullopt;
 	}
 
-	if (not_pos == 0)
+	auto charset = _to_lower(value.substr(0, first_quote));
+	if (charset != "us-ascii" && charset != "utf-8")
+	{
+		return std::nullopt;
+	}
+
+	return _percent_hex_unescape(value.substr(second_quote + 1));
+}
+
+using _Parameters = std::vector<std::pair<std::string, std::string>>;
+
+inline const std::string* _find_parameter(const _Parameters& parameters, std::string_view name)
+{
+	for (const auto& [key, value] : parameters)
+	{
+		if (key == name)
+		{
+			return &value;
+		}
+	}
+
+	return nullptr;
+}
+
+inline void _set_parameter(_Parameters& parameters, std::string name, std::string value)
+{
+	for (auto& [key, old_value] : parameters)
 	{
-		return {L"", s};
+		if (key == name)
+		{
+			old_value = std::move(value);
+			return;
+		}
 	}
 
+	parameters.emplace_back(std::move(name), std::move(value));
+}
+
+std::pair<std::string_view, std::string_view> _consume_token(std::string_view s)
+{
+	auto not_pos = std::find_if(s.begin(), s.end(), _is_not_token_char) - s.begin();
 	return {s.substr(0, not_pos), s.substr(not_pos)};
 }
 
-std::tuple<std::wstring, std::wstring> _consume_value(const std::wstring& s)
+std::pair<std::string, std::string_view> _consume_value(std::string_view s)
 {
 	if (s.empty())
 	{
-		return {L"", L""};
+		return {"", ""};
 	}
 
 	if (s[0] != '"')
 	{
-		return _consume_token(s);
+		auto [token, rest] = _consume_token(s);
+		return {std::string(token), rest};
 	}
 
 	// parse a quoted-string
-	std::wstring buffer;
-	auto s_len = s.size();
-	for (size_t i = 1; i < s_len; i++)
+	std::string buffer;
+	for (size_t i = 1; i < s.size(); i++)
 	{
 		auto r = s[i];
 		if (r == '"')
 		{
-			return {buffer, s.substr(i + 1)};
+			return {std::move(buffer), s.substr(i + 1)};
 		}
 
 		// When MSIE sends a full file path (in "intranet mode"), it does not
@@ -148,7 +272,7 @@ std::tuple<std::wstring, std::wstring> _consume_value(const std::wstring& s)
 		// and intended as a literal backslash. This makes Go servers deal better
 		// with MSIE without affecting the way they handle conforming MIME
 		// generators.
-		if (r == '\\' && i + 1 < s_len && _is_t_special(s[i + 1]))
+		if (r == '\\' && i + 1 < s.size() && _is_t_special(s[i + 1]))
 		{
 			buffer += s[i + 1];
 			i++;
@@ -157,17 +281,17 @@ std::tuple<std::wstring, std::wstring> _consume_value(const std::wstring& s)
 
 		if (r == '\r' || r == '\n')
 		{
-			return {L"", s};
+			return {"", s};
 		}
 
-		buffer += s[i];
+		buffer += r;
 	}
 
 	// Did not find end quote
-	return {L"", s};
+	return {"", s};
 }
 
-void _check_media_type_disposition(const std::wstring& s)
+void _check_media_type_disposition(std::string_view s)
 {
 	auto [type, rest] = _consume_token(s);
 	if (type.empty())
@@ -197,174 +321,152 @@ void _check_media_type_disposition(const std::wstring& s)
 	}
 }
 
-std::tuple<std::wstring, std::wstring, std::wstring> _consume_media_parameter(const std::wstring& s)
+std::tuple<std::string, std::string, std::string_view> _consume_media_parameter(std::string_view s)
 {
-	auto rest = str::trim_left_func(s, encoding::is_space);
+	auto rest = _trim_left(s);
 	if (!rest.starts_with(';'))
 	{
-		return {L"", L"", s};
+		return {"", "", s};
 	}
 
-	rest = rest.substr(1); // consume semicolon
-	rest = str::trim_left_func(rest, encoding::is_space);
-	auto result = _consume_token(rest);
-	auto parameter = std::get<0>(result);
-	rest = std::get<1>(result);
-	parameter = str::to_lower(parameter);
+	rest = _trim_left(rest.substr(1)); // consume semicolon
+	auto [parameter, parameter_rest] = _consume_token(rest);
 	if (parameter.empty())
 	{
-		return {L"", L"", s};
+		return {"", "", s};
 	}
 
-	rest = str::trim_left_func(rest, encoding::is_space);
+	rest = _trim_left(parameter_rest);
 	if (!rest.starts_with('='))
 	{
-		return {L"", L"", s};
+		return {"", "", s};
 	}
 
-	rest = rest.substr(1); // consume equals sign
-	rest = str::trim_left_func(rest, encoding::is_space);
-	auto [value, rest2] = _consume_value(rest);
-	if (value.empty() && rest2 == rest)
+	rest = _trim_left(rest.substr(1)); // consume equals sign
+	auto [value, value_rest] = _consume_value(rest);
+	if (value.empty() && value_rest == rest)
 	{
-		return {L"", L"", s};
+		return {"", "", s};
 	}
 
-	rest = rest2;
-	return {parameter, value, rest};
+	return {_to_lower(parameter), std::move(value), value_rest};
 }
 
-std::tuple<std::wstring, std::map<std::wstring, std::wstring>, bool> parse_media_type(std::wstring content_type)
+const std::string* MediaType::get(std::string_view name) const
 {
-	auto semicolon_position = content_type.find(';');
-	auto media_type = str::trim(str::to_lower(content_type.substr(0, semicolon_position)), ' ');
-	_check_media_type_disposition(media_type);
-	std::map<std::wstring, std::wstring> params;
-
-	// Map of base parameter name -> parameter name -> value
-	// for parameters containing a '*' character.
-	std::map<std::wstring, std::map<std::wstring, std::wstring>> continuation;
+	return _find_parameter(this->parameters, name);
+}
 
-	if (semicolon_position != std::wstring::npos)
-	{
-		content_type = content_type.substr(semicolon_position);
-	}
-	else
-	{
-		content_type = L"";
-	}
+MediaType parse_media_type(std::string_view value)
+{
+	MediaType result;
+	auto semicolon_position = value.find(';');
+	result.type = _to_lower(_trim(value.substr(0, semicolon_position)));
+	_check_media_type_disposition(result.type);
+	value = semicolon_position != std::string_view::npos ? value.substr(semicolon_position) : std::string_view();
 
-	while (!content_type.empty())
+	// Base parameter name -> parameter name -> value
+	// for parameters containing a '*' character.
+	std::vector<std::pair<std::string, _Parameters>> continuation;
+	while (!value.empty())
 	{
-		content_type = str::trim_left_func(content_type, encoding::is_space);
-		if (content_type.empty())
+		value = _trim_left(value);
+		if (value.empty())
 		{
 			break;
 		}
 
-		auto [key, value, rest] = _consume_media_parameter(content_type);
+		auto [key, parameter_value, rest] = _consume_media_parameter(value);
 		if (key.empty())
 		{
-			if (str::trim(rest, ' ') == L";")
+			if (_trim(rest) == ";")
 			{
 				// Ignore trailing semicolons.
 				// Not an error.
-				return {media_type, params, true};
+				return result;
 			}
 
 			// Parse error.
-			return {media_type, {}, false};
+			result.parameters.clear();
+			result.ok = false;
+			return result;
 		}
 
-		auto& params_map = params;
-		auto idx = key.find('*');
-		if (idx != std::string::npos)
+		auto* parameters = &result.parameters;
+		auto star_position = key.find('*');
+		if (star_position != std::string::npos)
 		{
-			auto base_name = key.substr(0, idx);
-			if (!continuation.contains(base_name))
+			auto base_name = std::string_view(key).substr(0, star_position);
+			auto pieces = std::find_if(continuation.begin(), continuation.end(), [base_name](const auto& item)
+			{
+				return item.first == base_name;
+			});
+			if (pieces == continuation.end())
 			{
-				continuation[base_name] = {};
-				params_map = continuation[base_name];
+				pieces = continuation.emplace(continuation.end(), base_name, _Parameters{});
 			}
+
+			parameters = &pieces->second;
 		}
 
-		if (params_map.contains(key))
+		if (_find_parameter(*parameters, key))
 		{
 			// Duplicate parameter name is bogus.
 			throw ParseError("mime: duplicate parameter name", _ERROR_DETAILS_);
 		}
 
-		params_map[key] = value;
-		content_type = rest;
+		parameters->emplace_back(std::move(key), std::move(parameter_value));
+		value = rest;
 	}
 
 	// Stitch together any continuations or things with stars
 	// (i.e. RFC 2231 things with stars: "foo*0" or "foo*")
-	std::wstring buffer;
-	for (const auto& pair : continuation)
+	for (const auto& [key, pieces] : continuation)
 	{
-		auto key = pair.first;
-		auto piece_map = pair.second;
-		auto single_part_key = key + L"*";
-		if (piece_map.contains(single_part_key))
+		auto single_part_key = key + "*";
+		if (auto single_part = _find_parameter(pieces, single_part_key))
 		{
-			auto [decoded_content_type, ok] = encoding::decode2231(piece_map.at(single_part_key));
-			if (ok)
+			if (auto decoded = _decode_rfc2231(*single_part))
 			{
-				params[key] = decoded_content_type;
+				_set_parameter(result.parameters, key, std::move(*decoded));
 			}
 
 			continue;
 		}
 
-		buffer.clear();
+		std::string buffer;
 		auto valid = false;
 		for (size_t n = 0; ; n++)
 		{
-			auto simple_part = key + L"*" + std::to_wstring(n);
-			if (piece_map.contains(simple_part))
+			auto simple_part_key = single_part_key + std::to_string(n);
+			if (auto simple_part = _find_parameter(pieces, simple_part_key))
 			{
 				valid = true;
-				buffer += piece_map.at(simple_part);
+				buffer += *simple_part;
 				continue;
 			}
 
-			auto encoded_part = simple_part + L"*";
-			if (!piece_map.contains(encoded_part))
+			auto encoded_part = _find_parameter(pieces, simple_part_key + "*");
+			if (!encoded_part)
 			{
 				break;
 			}
 
 			valid = true;
-			auto v = piece_map.at(encoded_part);
-			if (n == 0)
+			auto decoded = n == 0 ? _decode_rfc2231(*encoded_part) : _percent_hex_unescape(*encoded_part);
+			if (decoded)
 			{
-				auto [decoded_value, ok] = encoding::decode2231(v);
-				if (ok)
-				{
-					buffer += decoded_value;
-				}
-			}
-			else
-			{
-				try
-				{
-					auto decoded_value = encoding::percent_hex_unescape(str::wstring_to_string(v));
-					buffer += str::string_to_wstring(decoded_value);
-				}
-				catch (const ValueError&)
-				{
-				}
+				buffer += *decoded;
 			}
 		}
 
 		if (valid)
 		{
-			params[key] = buffer;
+			_set_parameter(result.parameters, key, std::move(buffer));
 		}
 	}
 
-	return {media_type, params, true};
+	return result;
 }
 
 __HTTP_MIME_END__
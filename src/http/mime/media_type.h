@@ -10,8 +10,11 @@
 
 // C++ libraries.
 #include <string>
+#include <string_view>
 #include <map>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 // Base libraries.
 #include <xalwart.base/string_utils.h>
@@ -50,10 +53,9 @@ extern void guess_content_type(const std::string& _path, std::string& type, std:
 // TESTME: _is_t_special
 //
 // The original implementation is in Golang 1.15.8: mime/grammar.go
-inline bool _is_t_special(wchar_t c)
+inline bool _is_t_special(char c)
 {
-	std::wstring s = L"()<>@,;:\\\"/[]?=";
-	return s.find(c) != std::wstring::npos;
+	return std::string_view(R"(()<>@,;:\"/[]?=)").find(c) != std::string_view::npos;
 }
 
 // TESTME: _is_token_char
@@ -61,7 +63,7 @@ inline bool _is_t_special(wchar_t c)
 // 1521 and RFC 2045.
 //
 // The original implementation is in Golang 1.15.8: mime/grammar.go
-inline bool _is_token_char(wchar_t c)
+inline bool _is_token_char(char c)
 {
 	// token := 1*<any (US-ASCII) CHAR except SPACE, CTLs, or tspecials>
 	return c > 0x20 && c < 0x7f && !_is_t_special(c);
@@ -70,7 +72,7 @@ inline bool _is_token_char(wchar_t c)
 // TESTME: _is_not_token_char
 //
 // The original implementation is in Golang 1.15.8: mime/mediatype.go
-inline bool _is_not_token_char(wchar_t c)
+inline bool _is_not_token_char(char c)
 {
 	return !_is_token_char(c);
 }
@@ -82,7 +84,7 @@ inline bool _is_not_token_char(wchar_t c)
 // failure to consume at least one character.
 //
 // The original implementation is in Golang 1.15.8: mime/mediatype.go
-extern std::tuple<std::wstring, std::wstring> _consume_token(const std::wstring& s);
+extern std::pair<std::string_view, std::string_view> _consume_token(std::string_view s);
 
 // TESTME: _consume_value
 // Consumes a "value" per RFC 2045, where a value is
@@ -92,30 +94,53 @@ extern std::tuple<std::wstring, std::wstring> _consume_token(const std::wstring&
 // {"", v}.
 //
 // The original implementation is in Golang 1.15.8: mime/mediatype.go
-extern std::tuple<std::wstring, std::wstring> _consume_value(const std::wstring& s);
+extern std::pair<std::string, std::string_view> _consume_value(std::string_view s);
 
 // TESTME: check_media_type_disposition
 //
 // The original implementation is in Golang 1.15.8: mime/mediatype.go
-extern void _check_media_type_disposition(const std::wstring& s);
+extern void _check_media_type_disposition(std::string_view s);
 
 // TESTME: consume_media_parameter
 //
 // The original implementation is in Golang 1.15.8: mime/mediatype.go
-extern std::tuple<std::wstring, std::wstring, std::wstring> _consume_media_parameter(const std::wstring& s);
+extern std::tuple<std::string, std::string, std::string_view> _consume_media_parameter(std::string_view s);
+
+// TESTME: MediaType
+// Media type with parameters, see 'parse_media_type()'.
+struct MediaType
+{
+	// Lowercase type without parameters, i.e. "text/html".
+	std::string type;
+
+	// Parameters in order of appearance. Names are lowercase,
+	// the case of values is preserved.
+	std::vector<std::pair<std::string, std::string>> parameters;
+
+	// Is `false` if parameters are malformed, `parameters`
+	// are empty in this case.
+	bool ok = true;
+
+	// Returns the value of parameter by lowercase `name`
+	// or nullptr if it is missing.
+	[[nodiscard]]
+	const std::string* get(std::string_view name) const;
+};
 
 // TESTME: parse_media_type
 //
 // Parses a media type value and any optional
 // parameters, per RFC 1521. Media types are the values in
 // Content-Type and Content-Disposition headers (RFC 2183).
-// On success, parse_media_type returns the media type converted
-// to lowercase and trimmed of white space map.
-// The returned map, params, maps from the lowercase
-// attribute to the attribute value with its case preserved.
+// Throws 'ValueError' if the media type itself is invalid and
+// 'ParseError' if some parameter is duplicated.
+//
+// The value is parsed in place, only the type, names and values of
+// parameters are copied. RFC 2231 continuations and charsets of
+// parameters are decoded.
 //
 // The original implementation is in Golang 1.15.8: mime/mediatype.go
-extern std::tuple<std::wstring, std::map<std::wstring, std::wstring>, bool> parse_media_type(std::wstring content_type);
+extern MediaType parse_media_type(std::string_view value);
 
 inline std::string _get_from_string_map(
 	const std::map<std::string, std::string>& map, const std::string& key, const std::string& default_
@@ -7,17 +7,295 @@
 #include "./base64_reader.h"
 
 // C++ libraries.
-// TODO:
+#include <array>
 
-// Base libraries.
-// TODO:
-
-// Framework libraries.
-// TODO:
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 
 __HTTP_MIME_MULTIPART_BEGIN__
 
+inline constexpr unsigned char _INVALID_BASE64 = 0xFF;
+
+inline constexpr auto _BASE64_VALUES = []()
+{
+	std::array<unsigned char, 256> table{};
+	table.fill(_INVALID_BASE64);
+	constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	for (size_t i = 0; i < alphabet.size(); i++)
+	{
+		table[(unsigned char)alphabet[i]] = (unsigned char)i;
+	}
+
+	return table;
+}();
+
+inline constexpr auto _BASE64_WHITESPACE = []()
+{
+	std::array<bool, 256> table{};
+	table[' '] = table['\t'] = table['\r'] = table['\n'] = table['\f'] = table['\v'] = true;
+	return table;
+}();
+
+#if defined(__GNUC__) && defined(__x86_64__)
+
+// Kernels decode 16 or 32 characters at once and return the count of
+// decoded characters. They stop before the block which contains padding
+// or invalid characters, so it is decoded by the scalar loop. Each store
+// writes 4 bytes more than it decodes, so the input which is not decoded
+// by a kernel is at least 8 characters.
+//
+// See "Faster Base64 Encoding and Decoding Using AVX2 Instructions"
+// by W. Mula and D. Lemire.
+using _Base64Kernel = size_t (*)(const char* input, size_t size, char* output);
+
+__attribute__((target("sse4.1")))
+inline size_t _decode_base64_sse(const char* input, size_t size, char* output)
+{
+	// Character is invalid if bits of lookups by both of its nibbles intersect.
+	const auto lut_lo = _mm_setr_epi8(
+		0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A
+	);
+	const auto lut_hi = _mm_setr_epi8(
+		0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+	);
+
+	// Offsets from characters to their values by the high nibble, '/' is 1.
+	const auto lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+	const auto mask_2f = _mm_set1_epi8(0x2F);
+	const auto pack_shuffle = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+	size_t position = 0;
+	for (; position + 16 + 8 <= size; position += 16)
+	{
+		auto block = _mm_loadu_si128((const __m128i*)(input + position));
+		auto hi_nibbles = _mm_and_si128(_mm_srli_epi32(block, 4), mask_2f);
+		auto lo = _mm_shuffle_epi8(lut_lo, _mm_and_si128(block, mask_2f));
+		auto hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+		if (!_mm_testz_si128(lo, hi))
+		{
+			break;
+		}
+
+		auto roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(_mm_cmpeq_epi8(block, mask_2f), hi_nibbles));
+		auto values = _mm_add_epi8(block, roll);
+
+		// Four 6-bit values are merged into 24 bits of each 32-bit lane.
+		auto merged = _mm_madd_epi16(
+			_mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140)), _mm_set1_epi32(0x00011000)
+		);
+		_mm_storeu_si128((__m128i*)(output + position / 4 * 3), _mm_shuffle_epi8(merged, pack_shuffle));
+	}
+
+	return position;
+}
+
+__attribute__((target("avx2")))
+inline size_t _decode_base64_avx2(const char* input, size_t size, char* output)
+{
+	const auto lut_lo = _mm256_setr_epi8(
+		0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+		0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A
+	);
+	const auto lut_hi = _mm256_setr_epi8(
+		0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+		0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+	);
+	const auto lut_roll = _mm256_setr_epi8(
+		0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0
+	);
+	const auto mask_2f = _mm256_set1_epi8(0x2F);
+	const auto pack_shuffle = _mm256_setr_epi8(
+		2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+		2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1
+	);
+	size_t position = 0;
+	for (; position + 32 + 8 <= size; position += 32)
+	{
+		auto block = _mm256_loadu_si256((const __m256i*)(input + position));
+		auto hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(block, 4), mask_2f);
+		auto lo = _mm256_shuffle_epi8(lut_lo, _mm256_and_si256(block, mask_2f));
+		auto hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+		if (!_mm256_testz_si256(lo, hi))
+		{
+			break;
+		}
+
+		auto roll = _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(_mm256_cmpeq_epi8(block, mask_2f), hi_nibbles));
+		auto values = _mm256_add_epi8(block, roll);
+		auto merged = _mm256_madd_epi16(
+			_mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140)), _mm256_set1_epi32(0x00011000)
+		);
+		merged = _mm256_shuffle_epi8(merged, pack_shuffle);
+
+		// Each 128-bit lane has 12 decoded bytes.
+		auto destination = output + position / 4 * 3;
+		_mm_storeu_si128((__m128i*)destination, _mm256_castsi256_si128(merged));
+		_mm_storeu_si128((__m128i*)(destination + 12), _mm256_extracti128_si256(merged, 1));
+	}
+
+	return position;
+}
+
+inline _Base64Kernel _select_base64_kernel()
+{
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+	{
+		return _decode_base64_avx2;
+	}
+
+	if (__builtin_cpu_supports("sse4.1"))
+	{
+		return _decode_base64_sse;
+	}
+
+	return nullptr;
+}
+
+#endif
+
+// Copies `input` without whitespace to `output` and returns the count
+// of copied characters. Blocks of 16 characters without line breaks are
+// copied at once where SSE2 is available.
+inline size_t _remove_base64_whitespace(std::string_view input, char* output)
+{
+	auto* destination = output;
+	size_t position = 0;
+#if defined(__SSE2__) && defined(__GNUC__)
+	const auto min_character = _mm_set1_epi8('!');
+	for (; position + 16 <= input.size(); position += 16)
+	{
+		auto block = _mm_loadu_si128((const __m128i*)(input.data() + position));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(block, min_character), block)) == 0xFFFF)
+		{
+			_mm_storeu_si128((__m128i*)destination, block);
+			destination += 16;
+			continue;
+		}
+
+		// Whitespace is removed without branches.
+		for (size_t i = position; i < position + 16; i++)
+		{
+			*destination = input[i];
+			destination += !_BASE64_WHITESPACE[(unsigned char)input[i]];
+		}
+	}
+#endif
+
+	for (; position < input.size(); position++)
+	{
+		*destination = input[position];
+		destination += !_BASE64_WHITESPACE[(unsigned char)input[position]];
+	}
+
+	return destination - output;
+}
+
+size_t _decode_base64(std::string_view input, char* output, bool& is_padded)
+{
+	size_t position = 0;
+	size_t written = 0;
+
+#if defined(__GNUC__) && defined(__x86_64__)
+	static const auto kernel = _select_base64_kernel();
+	if (kernel)
+	{
+		position = kernel(input.data(), input.size(), output);
+		written = position / 4 * 3;
+	}
+#endif
+
+	for (; position + 4 <= input.size(); position += 4)
+	{
+		auto a = _BASE64_VALUES[(unsigned char)input[position]];
+		auto b = _BASE64_VALUES[(unsigned char)input[position + 1]];
+		auto c = _BASE64_VALUES[(unsigned char)input[position + 2]];
+		auto d = _BASE64_VALUES[(unsigned char)input[position + 3]];
+		if (input[position + 3] == '=')
+		{
+			// The last quantum of the data.
+			is_padded = true;
+			if (input[position + 2] == '=')
+			{
+				c = 0;
+			}
+
+			if ((a | b | c) & 0x80)
+			{
+				break;
+			}
+
+			output[written++] = (char)(a << 2 | b >> 4);
+			if (input[position + 2] != '=')
+			{
+				output[written++] = (char)(b << 4 | c >> 2);
+			}
+
+			return written;
+		}
+
+		if ((a | b | c | d) & 0x80)
+		{
+			break;
+		}
+
+		output[written++] = (char)(a << 2 | b >> 4);
+		output[written++] = (char)(b << 4 | c >> 2);
+		output[written++] = (char)(c << 6 | d);
+	}
+
+	if (position + 4 <= input.size())
+	{
+		throw ParseError("multipart: invalid base64 data", _ERROR_DETAILS_);
+	}
+
+	return written;
+}
+
+bool Base64Reader::decode_block(std::string& output)
+{
+	auto n = this->reader->read(this->_block, this->block_size);
+	if (n <= 0)
+	{
+		// EOF, the last quantum may be not padded.
+		if (!this->_is_padded && !this->_characters.empty())
+		{
+			if (this->_characters.size() == 1)
+			{
+				throw ParseError("multipart: invalid base64 data", _ERROR_DETAILS_);
+			}
+
+			this->_characters.append(4 - this->_characters.size(), '=');
+			auto offset = output.size();
+			output.resize(offset + 3);
+			output.resize(offset + _decode_base64(this->_characters, output.data() + offset, this->_is_padded));
+			this->_characters.clear();
+		}
+
+		return false;
+	}
+
+	if (this->_is_padded)
+	{
+		// The rest of the body is skipped.
+		return true;
+	}
 
+	auto size = this->_characters.size();
+	this->_characters.resize(size + this->_block.size());
+	this->_characters.resize(size + _remove_base64_whitespace(this->_block, this->_characters.data() + size));
+	size = this->_characters.size() / 4 * 4;
+	auto offset = output.size();
+	output.resize(offset + size / 4 * 3);
+	output.resize(offset + _decode_base64(
+		std::string_view(this->_characters).substr(0, size), output.data() + offset, this->_is_padded
+	));
+	this->_characters.erase(0, size);
+	return true;
+}
 
 __HTTP_MIME_MULTIPART_END__
@@ -3,9 +3,7 @@
  *
  * Copyright (c) 2021 Yuriy Lisovskiy
  *
- * TODO: purpose
- *
- * Implementation is based on Golang 1.15.8: mime/quoteprintable/reader.go
+ * Streaming decoder of "base64" Content-Transfer-Encoding.
  */
 
 #pragma once
@@ -13,45 +11,47 @@
 // C++ libraries.
 #include <string>
 #include <memory>
-
-// Base libraries.
-#include <xalwart.base/io.h>
-#include <xalwart.base/exceptions.h>
+#include <string_view>
 
 // Module definitions.
 #include "./_def_.h"
 
+// Framework libraries.
+#include "./decoding_reader.h"
+
 
 __HTTP_MIME_MULTIPART_BEGIN__
 
-// TESTME: Base64Reader
-// TODO: docs for 'Base64Reader'
-class Base64Reader : public io::IReader
+// TESTME: _decode_base64
+// Decodes complete quanta of four characters from `input` to `output`
+// which must have room for `input.size() / 4 * 3` bytes. Decoding stops
+// after the quantum with padding. Blocks of characters are decoded with
+// AVX2 or SSE4.1 if the processor supports them. Returns the count of
+// written bytes, throws 'ParseError' if `input` contains invalid characters.
+extern size_t _decode_base64(std::string_view input, char* output, bool& is_padded);
+
+// Decodes the body of the part which is encoded as specified in RFC 2045,
+// section 6.8. Line breaks and other whitespace are ignored, anything
+// after the padding is skipped.
+class Base64Reader : public DecodingReader
 {
 public:
-	inline explicit Base64Reader(std::shared_ptr<io::IReader> /*reader*/)
+	inline explicit Base64Reader(std::shared_ptr<io::IReader> reader, size_t block_size=DEFAULT_BLOCK_SIZE) :
+		DecodingReader(std::move(reader), block_size)
 	{
-		// TODO:
-		throw NotImplementedException("QuotePrintableReader()", _ERROR_DETAILS_);
 	}
 
-	inline ssize_t read_line(std::string& buffer) override
-	{
-		// TODO:
-		throw NotImplementedException("read_line()", _ERROR_DETAILS_);
-	}
+protected:
+	bool decode_block(std::string& output) override;
 
-	inline ssize_t read(std::string& buffer, size_t max_count) override
-	{
-		// TODO:
-		throw NotImplementedException("read()", _ERROR_DETAILS_);
-	}
+private:
+	std::string _block;
 
-	inline bool close_reader() override
-	{
-		// TODO:
-		throw NotImplementedException("close_reader()", _ERROR_DETAILS_);
-	}
+	// Characters of the encoding which do not form a complete quantum
+	// yet, whitespace is removed.
+	std::string _characters;
+
+	bool _is_padded = false;
 };
 
 __HTTP_MIME_MULTIPART_END__
@@ -6,13 +6,11 @@
 
 #include "./body_reader.h"
 
-// C++ libraries.
-#include <filesystem>
-
 // Base libraries.
-#include <xalwart.base/path.h>
+#include <xalwart.base/net/_def_.h>
 
 // Framework libraries.
+#include "./part_reader.h"
 #include "../../exceptions.h"
 
 
@@ -38,100 +36,67 @@ Form BodyReader::read_form(long long int max_memory)
 
 	// Reserve an additional 10 MB for non-file parts.
 	auto max_value_bytes = max_memory + (10 << 20);
-	while (true)
+	this->read_parts([&](Part& part) -> bool
 	{
-		auto part = this->next_part();
-		if (!part)
-		{
-			// EOF
-			break;
-		}
-
-		auto name = part->form_name();
+		auto name = part.form_name();
 		if (name.empty())
 		{
-			continue;
+			return true;
 		}
 
 		std::string buffer;
-		auto filename = part->file_name();
+		auto filename = part.file_name();
 		if (filename.empty())
 		{
 			// value, store as string in memory
-			auto n = part->read(buffer, max_value_bytes + 1);
+			auto n = part.read(buffer, max_value_bytes + 1);
 			max_value_bytes -= n;
 			if (max_value_bytes < 0)
 			{
 				throw exc::PayloadTooLarge("message is too large", _ERROR_DETAILS_);
 			}
 
-			this->remaining_content_length -= n;
 			form.values.add(name, buffer);
-			continue;
+			return true;
 		}
 
 		// file, store in memory or on disk
 		auto fh = std::make_shared<FileHeader>();
 		fh->filename = filename;
-		fh->header = part->header;
-		auto n = part->read(buffer, max_memory + 1);
-		this->check_part_upload_size(part.get(), fh.get());
-		this->remaining_content_length -= n;
+		fh->header = part.header;
+		auto n = part.read(buffer, max_memory + 1);
+		this->check_part_upload_size(&part, fh.get());
 		if (n > max_memory)
 		{
-			// too big, write to disk and flush buffer
-			auto size = n;
-			auto file = path::temp_file("", "multipart-", true);
-			if (file->is_open())
-			{
-				try
-				{
-					file->write(buffer);
-					while (true)
-					{
-						auto n_ = part->read(buffer, max_memory + 1);
-						this->check_part_upload_size(part.get(), fh.get());
-						size += n_;
-						if (n_ == 0)
-						{
-							// EOF
-							break;
-						}
-
-						this->remaining_content_length -= n;
-					}
-
-					file->save();
-					file->close();
-				}
-				catch (const FileError& exc)
-				{
-					if (path::Path(file->path()).exists())
-					{
-						std::filesystem::remove(file->path());
-					}
-
-					throw FileError(exc);
-				}
-			}
-
-			fh->tmp_file = file->path();
-			fh->size = size;
+			// too big, write to disk in chunks
+			fh->size = this->write_to_temp_file(&part, fh.get(), buffer);
 		}
 		else
 		{
-			fh->content = buffer;
-			fh->size = buffer.size();
+			fh->content = std::move(buffer);
+			fh->size = n;
 			max_memory -= n;
 			max_value_bytes -= n;
 		}
 
 		form.files.add(name, std::move(fh));
-	}
+		return true;
+	});
 
 	return form;
 }
 
+void BodyReader::read_parts(const std::function<bool(Part&)>& handler)
+{
+	while (auto part = this->next_part())
+	{
+		if (!handler(*part))
+		{
+			break;
+		}
+	}
+}
+
 std::shared_ptr<Part> BodyReader::next_part(bool raw_part)
 {
 	if (this->dash_boundary == "--")
@@ -139,6 +104,13 @@ std::shared_ptr<Part> BodyReader::next_part(bool raw_part)
 		throw ParseError("multipart: boundary is empty", _ERROR_DETAILS_);
 	}
 
+	if (this->current_part)
+	{
+		// The rest of the previous part is not needed.
+		this->current_part->skip();
+		this->current_part = nullptr;
+	}
+
 	auto expect_new_part = false;
 	while (true)
 	{
@@ -231,6 +203,7 @@ bool BodyReader::is_boundary_delimiter_line(const std::string& line)
 	{
 		this->nl = this->nl.substr(1);
 		this->nl_dash_boundary = this->nl_dash_boundary.substr(1);
+		this->nl_dash_boundary_matcher = BoundaryMatcher(this->nl_dash_boundary);
 	}
 
 	return rest == this->nl;
@@ -244,4 +217,43 @@ void BodyReader::check_part_upload_size(Part* part, FileHeader* header) const
 	}
 }
 
+ssize_t BodyReader::write_to_temp_file(Part* part, FileHeader* header, const std::string& content) const
+{
+	header->tmp_file = std::make_shared<TemporaryFile>(this->upload_directory);
+	try
+	{
+		// The body of the part which is not decoded is a range of the spooled
+		// body, so it is only scanned for the boundary and then copied.
+		auto* spooled = dynamic_cast<const ISpooledReader*>(this->buffered_reader.get());
+		if (spooled && spooled->spooled_file() && dynamic_cast<PartReader*>(part->reader.get()))
+		{
+			auto start = spooled->spooled_position() - content.size();
+			std::string chunk;
+			while (part->read_some(chunk, net::DEFAULT_BUFFER_SIZE))
+			{
+				this->check_part_upload_size(part, header);
+			}
+
+			header->tmp_file->append(*spooled->spooled_file(), start, spooled->spooled_position() - start);
+		}
+		else
+		{
+			header->tmp_file->write(content);
+			std::string chunk;
+			while (part->read_some(chunk, net::DEFAULT_BUFFER_SIZE))
+			{
+				this->check_part_upload_size(part, header);
+				header->tmp_file->write(chunk);
+			}
+		}
+	}
+	catch (...)
+	{
+		header->tmp_file.reset();
+		throw;
+	}
+
+	return (ssize_t)header->tmp_file->size();
+}
+
 __HTTP_MIME_MULTIPART_END__
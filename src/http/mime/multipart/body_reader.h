@@ -11,6 +11,7 @@
 #pragma once
 
 // C++ libraries.
+#include <functional>
 #include <memory>
 #include <string>
 
@@ -21,6 +22,7 @@
 #include "./_def_.h"
 
 // Framework libraries.
+#include "./boundary_matcher.h"
 #include "./file_header.h"
 #include "./part.h"
 #include "./form.h"
@@ -39,6 +41,10 @@ struct BodyReader final
 	ssize_t remaining_content_length;
 	std::shared_ptr<io::ILimitedBufferedReader> buffered_reader;
 
+	// Directory of temporary files, the temporary directory
+	// of the system is used if it is empty.
+	std::string upload_directory;
+
 	std::shared_ptr<Part> current_part;
 	int parts_read{};
 
@@ -47,6 +53,9 @@ struct BodyReader final
 	std::string dash_boundary_dash; // "--boundary--"
 	std::string dash_boundary;      // "--boundary"
 
+	// Finds 'nl_dash_boundary' in the body of parts.
+	BoundaryMatcher nl_dash_boundary_matcher;
+
 	inline BodyReader(
 		std::shared_ptr<io::ILimitedBufferedReader> reader, const std::string& boundary, ssize_t content_length,
 		ssize_t max_file_upload_size, ssize_t max_fields_count, ssize_t max_header_length, ssize_t max_headers_count
@@ -60,10 +69,19 @@ struct BodyReader final
 		this->nl_dash_boundary = b.substr(0, b.size() - 2);
 		this->dash_boundary_dash = b.substr(2);
 		this->dash_boundary = b.substr(2, b.size() - 4);
+		this->nl_dash_boundary_matcher = BoundaryMatcher(this->nl_dash_boundary);
 	}
 
+	// Reads all parts, values and files up to `max_memory` bytes are kept
+	// in memory, larger files are written to temporary files.
 	Form read_form(long long int max_memory);
 
+	// Calls `handler` for each part as soon as its headers are read.
+	// The handler reads the body of the part with 'Part::read_some()',
+	// the rest of the body is skipped before the next part. Reading
+	// stops when `handler` returns `false` or when parts are over.
+	void read_parts(const std::function<bool(Part&)>& handler);
+
 	// Returns the next part in the multipart or `nullptr` on error.
 	// When there are no more parts, `nullptr` is returned.
 	//
@@ -86,6 +104,12 @@ struct BodyReader final
 	bool is_boundary_delimiter_line(const std::string& line);
 
 	void check_part_upload_size(Part* part, FileHeader* header) const;
+
+	// Writes `content` and the rest of the body of `part` to a temporary
+	// file in 'upload_directory' in chunks and returns the count of
+	// written bytes. If the body is spooled, see 'ISpooledReader', the
+	// part is copied from the spooled file instead.
+	ssize_t write_to_temp_file(Part* part, FileHeader* header, const std::string& content) const;
 };
 
 __HTTP_MIME_MULTIPART_END__
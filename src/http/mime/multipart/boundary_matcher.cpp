@@ -0,0 +1,46 @@
+/**
+ * http/mime/multipart/boundary_matcher.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./boundary_matcher.h"
+
+// C++ libraries.
+#include <cstring>
+
+
+__HTTP_MIME_MULTIPART_BEGIN__
+
+BoundaryMatcher::BoundaryMatcher(std::string boundary) : _boundary(std::move(boundary))
+{
+	auto size = this->_boundary.size();
+	this->_shifts.fill(size);
+	for (size_t i = 0; i + 1 < size; i++)
+	{
+		this->_shifts[(unsigned char)this->_boundary[i]] = size - 1 - i;
+	}
+}
+
+size_t BoundaryMatcher::find(std::string_view text, size_t from) const
+{
+	auto size = this->_boundary.size();
+	if (size == 0)
+	{
+		return from <= text.size() ? from : std::string_view::npos;
+	}
+
+	const auto* pattern = this->_boundary.data();
+	auto last = pattern[size - 1];
+	for (auto i = from; i + size <= text.size(); i += this->_shifts[(unsigned char)text[i + size - 1]])
+	{
+		if (text[i + size - 1] == last && std::memcmp(text.data() + i, pattern, size - 1) == 0)
+		{
+			return i;
+		}
+	}
+
+	return std::string_view::npos;
+}
+
+__HTTP_MIME_MULTIPART_END__
@@ -0,0 +1,51 @@
+/**
+ * http/mime/multipart/boundary_matcher.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Search of the boundary in the body of multipart request.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <array>
+#include <string>
+#include <string_view>
+
+// Module definitions.
+#include "./_def_.h"
+
+
+__HTTP_MIME_MULTIPART_BEGIN__
+
+// Finds the boundary with Boyer-Moore-Horspool algorithm. The last byte
+// of the window is compared first, and the window is shifted by up to the
+// size of the boundary if it does not match, so the bytes of the body are
+// mostly skipped instead of being compared one by one.
+class BoundaryMatcher final
+{
+public:
+	BoundaryMatcher() = default;
+
+	explicit BoundaryMatcher(std::string boundary);
+
+	// Returns position of the first occurrence of the boundary in `text`
+	// at or after `from`, or 'std::string_view::npos'.
+	[[nodiscard]]
+	size_t find(std::string_view text, size_t from=0) const;
+
+	[[nodiscard]]
+	inline const std::string& boundary() const
+	{
+		return this->_boundary;
+	}
+
+private:
+	std::string _boundary;
+
+	// Shifts of the window by the last byte of it.
+	std::array<size_t, 256> _shifts{};
+};
+
+__HTTP_MIME_MULTIPART_END__
@@ -0,0 +1,53 @@
+/**
+ * http/mime/multipart/decoding_reader.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./decoding_reader.h"
+
+
+__HTTP_MIME_MULTIPART_BEGIN__
+
+DecodingReader::DecodingReader(std::shared_ptr<io::IReader> reader, size_t block_size) :
+	reader(std::move(reader)), block_size(block_size)
+{
+	if (!this->reader)
+	{
+		throw NullPointerException("'reader' is nullptr", _ERROR_DETAILS_);
+	}
+
+	if (this->block_size == 0)
+	{
+		throw ArgumentError("'block_size' must be greater than zero", _ERROR_DETAILS_);
+	}
+}
+
+ssize_t DecodingReader::read(std::string& buffer, size_t max_count)
+{
+	buffer.clear();
+	while (buffer.size() < max_count)
+	{
+		if (this->_decoded_position == this->_decoded.size())
+		{
+			if (this->_is_finished)
+			{
+				// EOF
+				break;
+			}
+
+			this->_decoded.clear();
+			this->_decoded_position = 0;
+			this->_is_finished = !this->decode_block(this->_decoded);
+			continue;
+		}
+
+		auto count = std::min(max_count - buffer.size(), this->_decoded.size() - this->_decoded_position);
+		buffer.append(this->_decoded, this->_decoded_position, count);
+		this->_decoded_position += count;
+	}
+
+	return (ssize_t)buffer.size();
+}
+
+__HTTP_MIME_MULTIPART_END__
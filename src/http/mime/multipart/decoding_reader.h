@@ -0,0 +1,64 @@
+/**
+ * http/mime/multipart/decoding_reader.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Base of readers which decode Content-Transfer-Encoding of the part.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <string>
+#include <memory>
+
+// Base libraries.
+#include <xalwart.base/io.h>
+#include <xalwart.base/exceptions.h>
+
+// Module definitions.
+#include "./_def_.h"
+
+
+__HTTP_MIME_MULTIPART_BEGIN__
+
+// Implements `io::IReader` by decoding the wrapped reader block by block,
+// so the memory which is used does not depend on the size of the body.
+// Decoded bytes which do not fit into `max_count` of 'read()' are kept
+// for the next call.
+class DecodingReader : public io::IReader
+{
+public:
+	// Size of the block which is read from the wrapped reader at once.
+	static inline constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+	explicit DecodingReader(std::shared_ptr<io::IReader> reader, size_t block_size=DEFAULT_BLOCK_SIZE);
+
+	inline ssize_t read_line(std::string& buffer) override
+	{
+		throw NotImplementedException("DecodingReader::read_line(std::string& buffer)", _ERROR_DETAILS_);
+	}
+
+	ssize_t read(std::string& buffer, size_t max_count) override;
+
+	// The wrapped reader belongs to the part, so it is not closed.
+	inline bool close_reader() override
+	{
+		return true;
+	}
+
+protected:
+	std::shared_ptr<io::IReader> reader;
+	size_t block_size;
+
+	// Reads the next block from 'reader' and appends decoded bytes
+	// to `output`. Returns `false` when the wrapped reader is over.
+	virtual bool decode_block(std::string& output) = 0;
+
+private:
+	std::string _decoded;
+	size_t _decoded_position = 0;
+	bool _is_finished = false;
+};
+
+__HTTP_MIME_MULTIPART_END__
@@ -13,6 +13,7 @@
 // C++ libraries.
 #include <string>
 #include <map>
+#include <memory>
 
 // Module definitions.
 #include "./_def_.h"
@@ -33,15 +34,19 @@ public:
 	unsigned long long int size;
 
 	std::string content;
-	std::string tmp_file;
+
+	// File which is used instead of `content` if the part
+	// does not fit into memory, it is removed with the last
+	// reference to it.
+	std::shared_ptr<TemporaryFile> tmp_file;
 
 	// Opens and returns the `FileHeader`'s associated `UploadedFile`.
 	[[nodiscard]]
 	inline UploadedFile open() const
 	{
-		if (this->content.empty())
+		if (this->tmp_file)
 		{
-			return UploadedFile::from_path(this->tmp_file);
+			return UploadedFile::from_file(this->tmp_file);
 		}
 
 		return UploadedFile::from_content(this->content);
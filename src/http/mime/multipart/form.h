@@ -13,7 +13,6 @@
 // C++ libraries.
 #include <string>
 #include <memory>
-#include <filesystem>
 
 // Base libraries.
 #include <xalwart.base/collections/multimap.h>
@@ -34,21 +33,25 @@ __HTTP_MIME_MULTIPART_BEGIN__
 // and are accessible via the `FileHeader`'s `open` method.
 // Its `values` parts are stored as strings.
 // Both are keyed by field name.
+//
+// Temporary files are removed when the form is destroyed, unless
+// they are still referred to by opened `UploadedFile`s.
 struct Form final
 {
 	collections::multimap<std::string, std::string> values;
 	collections::multimap<std::string, std::shared_ptr<FileHeader>> files;
 
-	// Removes any temporary files associated with a `Form`.
+	// Releases any temporary files associated with a `Form`
+	// before it is destroyed.
 	inline void remove_all() const
 	{
 		for (const auto& fhs : this->files)
 		{
 			for (const auto& fh : fhs.second)
 			{
-				if (fh && !fh->tmp_file.empty())
+				if (fh)
 				{
-					std::filesystem::remove(fh->tmp_file);
+					fh->tmp_file.reset();
 				}
 			}
 		}
@@ -8,6 +8,7 @@
 
 // Base libraries.
 #include <xalwart.base/exceptions.h>
+#include <xalwart.base/net/_def_.h>
 #include <xalwart.base/net/utility.h>
 #include <xalwart.base/path.h>
 
@@ -16,7 +17,6 @@
 #include "./quote_printable_reader.h"
 #include "./base64_reader.h"
 #include "./part_reader.h"
-#include "../media_type.h"
 #include "../../headers.h"
 
 
@@ -60,72 +60,90 @@ std::string Part::form_name()
 {
 	// See https://tools.ietf.org/html/rfc2183 section 2 for EBNF
 	// of Content-Disposition value format.
-	if (!this->disposition_params.has_value())
+	if (!this->disposition.has_value())
 	{
 		this->parse_content_disposition();
 	}
 
-	if (this->disposition != L"form-data")
+	if (this->disposition->type != "form-data")
 	{
 		return "";
 	}
 
-	if (!this->disposition_params->contains(L"name"))
+	auto name = this->disposition->get("name");
+	if (!name)
 	{
 		throw KeyError("disposition does not contain 'name'", _ERROR_DETAILS_);
 	}
 
-	return str::wstring_to_string(this->disposition_params->at(L"name"));
+	return *name;
 }
 
 std::string Part::file_name()
 {
-	if (!this->disposition_params.has_value())
+	if (!this->disposition.has_value())
 	{
 		this->parse_content_disposition();
 	}
 
-	auto filename = this->disposition_params->contains(L"filename") ?
-		str::wstring_to_string(this->disposition_params->at(L"filename")) : "";
-	if (filename.empty())
+	auto filename = this->disposition->get("filename");
+	if (!filename || filename->empty())
 	{
 		return "";
 	}
 
 	// RFC 7578, Section 4.2 requires that if a filename is provided, the
 	// directory path information must not be used.
-	return path::Path(filename).basename();
+	return path::Path(*filename).basename();
 }
 
 ssize_t Part::read(std::string& buffer, size_t max_count)
 {
-	auto bytes_to_read = std::min<ssize_t>(this->remaining_content_length, (ssize_t)max_count);
 	ssize_t total_bytes_read = 0;
-	std::string bytes;
-	while (bytes_to_read > 0)
+	std::string chunk;
+	while (total_bytes_read < (ssize_t)max_count)
 	{
-		auto n_ = this->reader->read(bytes, bytes_to_read);
-		if (n_ == 0)
+		auto n = this->read_some(chunk, max_count - total_bytes_read);
+		if (n == 0)
 		{
 			// EOF
 			break;
 		}
 
-		total_bytes_read += n_;
-		bytes_to_read -= n_;
-		buffer += bytes;
-		this->remaining_content_length -= n_;
+		total_bytes_read += n;
+		buffer.append(chunk);
 	}
 
 	return total_bytes_read;
 }
 
+ssize_t Part::read_some(std::string& chunk, size_t max_count)
+{
+	auto bytes_to_read = std::min<ssize_t>(this->remaining_content_length, (ssize_t)max_count);
+	if (bytes_to_read <= 0)
+	{
+		chunk.clear();
+		return 0;
+	}
+
+	auto n = this->reader->read(chunk, bytes_to_read);
+	this->remaining_content_length -= n;
+	this->multipart_reader->remaining_content_length -= n;
+	return n;
+}
+
+void Part::skip()
+{
+	std::string chunk;
+	while (this->read_some(chunk, net::DEFAULT_BUFFER_SIZE) > 0)
+	{
+	}
+}
+
 void Part::parse_content_disposition()
 {
-	auto content_disposition = str::string_to_wstring(this->get_header(CONTENT_DISPOSITION, ""));
-	auto [disposition_string, disposition_map, ok] = mime::parse_media_type(content_disposition);
-	this->disposition = disposition_string;
-	this->disposition_params = ok ? disposition_map : std::map<std::wstring, std::wstring>{};
+	auto header = this->header.find(CONTENT_DISPOSITION);
+	this->disposition = mime::parse_media_type(header != this->header.end() ? header->second : "");
 }
 
 void Part::populate_headers()
@@ -14,6 +14,7 @@
 #include <string>
 #include <memory>
 #include <map>
+#include <optional>
 
 // Base libraries.
 #include <xalwart.base/io.h>
@@ -22,6 +23,9 @@
 // Module definitions.
 #include "./_def_.h"
 
+// Framework libraries.
+#include "../media_type.h"
+
 
 __HTTP_MIME_MULTIPART_BEGIN__
 
@@ -40,8 +44,8 @@ struct Part final
 	// wrapper around such a reader, decoding the Content-Transfer-Encoding
 	std::shared_ptr<io::IReader> reader = nullptr;
 
-	std::wstring disposition;
-	std::optional<std::map<std::wstring, std::wstring>> disposition_params;
+	// Parsed Content-Disposition header, see 'parse_content_disposition()'.
+	std::optional<MediaType> disposition;
 
 	std::map<std::string, std::string> header;
 	BodyReader* multipart_reader = nullptr;
@@ -78,8 +82,17 @@ struct Part final
 		}
 	}
 
+	// Appends up to `max_count` bytes of the body to `buffer`.
 	ssize_t read(std::string& buffer, size_t max_count);
 
+	// Replaces `chunk` with at most `max_count` next bytes of the body,
+	// so the body can be processed in bounded memory. Returns zero when
+	// the body is over.
+	ssize_t read_some(std::string& chunk, size_t max_count);
+
+	// Reads the rest of the body without keeping it.
+	void skip();
+
 	[[nodiscard]]
 	inline ssize_t get_total() const
 	{
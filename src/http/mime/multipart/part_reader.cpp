@@ -20,36 +20,47 @@ ssize_t PartReader::read(std::string& buffer, size_t max_count)
 {
 	auto mr = this->part->multipart_reader;
 
-	std::string peek;
+	// The body which is already known to be before the boundary is
+	// read without scanning it again, see 'Part::n'.
 	bool ok = true;
 	while (this->part->n == 0 && ok)
 	{
 		auto buffered = mr->buffered_reader->buffered();
-		mr->buffered_reader->peek(peek, buffered);
-		auto [n, is_ok] = _scan_until_boundary(peek, mr->dash_boundary, mr->nl_dash_boundary, this->part->total);
+		mr->buffered_reader->peek(this->peek_buffer, buffered);
+		auto [n, is_ok] = _scan_until_boundary(
+			this->peek_buffer, mr->dash_boundary, mr->nl_dash_boundary_matcher, this->part->total
+		);
 		this->part->n = n;
 		ok = is_ok;
 		if (this->part->n == 0 && ok)
 		{
+			if (mr->buffered_reader->limit() <= 0)
+			{
+				// The rest of the body is buffered already and it does
+				// not contain the delimiter, more data will not come.
+				throw ParseError("multipart: unexpected end of body, boundary is missing", _ERROR_DETAILS_);
+			}
+
 			// Force buffered I/O to read more into buffer.
 			auto count = std::min<size_t>(buffered + mr->buffered_reader->limit(), max_count);
 			count = std::min(count, net::DEFAULT_BUFFER_SIZE);
-			mr->buffered_reader->peek(peek, count);
+			mr->buffered_reader->peek(this->peek_buffer, count);
 		}
 	}
 
 	if (this->part->n == 0)
 	{
+		buffer.clear();
 		return 0;
 	}
 
-	auto n = mr->buffered_reader->read(buffer, this->part->n);
+	auto n = mr->buffered_reader->read(buffer, std::min<size_t>(this->part->n, max_count));
 	this->part->total += n;
 	this->part->n -= n;
 	return n;
 }
 
-ssize_t _match_after_prefix(const std::string& buf, const std::string& prefix)
+ssize_t _match_after_prefix(std::string_view buf, std::string_view prefix)
 {
 	if (buf.size() == prefix.size())
 	{
@@ -66,7 +77,7 @@ ssize_t _match_after_prefix(const std::string& buf, const std::string& prefix)
 }
 
 std::pair<ssize_t, bool> _scan_until_boundary(
-	const std::string& buf, const std::string& dash_boundary, const std::string& nl_dash_boundary, ssize_t total
+	std::string_view buf, std::string_view dash_boundary, const BoundaryMatcher& nl_dash_boundary, ssize_t total
 )
 {
 	if (total == 0)
@@ -92,13 +103,14 @@ std::pair<ssize_t, bool> _scan_until_boundary(
 	}
 
 	// Search for "\n--boundary".
-	auto i = buf.find(nl_dash_boundary);
-	if (i != std::string::npos)
+	std::string_view boundary = nl_dash_boundary.boundary();
+	auto i = nl_dash_boundary.find(buf);
+	if (i != std::string_view::npos)
 	{
-		switch (_match_after_prefix(buf.substr(i), nl_dash_boundary))
+		switch (_match_after_prefix(buf.substr(i), boundary))
 		{
 			case -1:
-				return {i + nl_dash_boundary.size(), true};
+				return {i + boundary.size(), true};
 			case 0:
 				return {i, true};
 			case +1:
@@ -106,7 +118,7 @@ std::pair<ssize_t, bool> _scan_until_boundary(
 		}
 	}
 
-	if (nl_dash_boundary.starts_with(buf))
+	if (boundary.starts_with(buf))
 	{
 		return {0, true};
 	}
@@ -115,10 +127,12 @@ std::pair<ssize_t, bool> _scan_until_boundary(
 	// and so must be part of the body.
 	// Also if the section from the final \n onward is not a prefix of the boundary,
 	// it too must be part of the body.
-	i = buf.find_last_of(nl_dash_boundary[0]);
-	if (i != std::string::npos && nl_dash_boundary.starts_with(buf.substr(i)))
+	// Only the tail which is not longer than the boundary is searched.
+	auto tail_start = buf.size() > boundary.size() ? buf.size() - boundary.size() : 0;
+	i = buf.substr(tail_start).find_last_of(boundary[0]);
+	if (i != std::string_view::npos && boundary.starts_with(buf.substr(tail_start + i)))
 	{
-		return {i, true};
+		return {tail_start + i, true};
 	}
 
 	return {buf.size(), true};
@@ -12,6 +12,7 @@
 
 // C++ libraries.
 #include <string>
+#include <string_view>
 
 // Base libraries.
 #include <xalwart.base/io.h>
@@ -20,6 +21,9 @@
 // Module definitions.
 #include "./_def_.h"
 
+// Framework libraries.
+#include "./boundary_matcher.h"
+
 
 __HTTP_MIME_MULTIPART_BEGIN__
 
@@ -54,6 +58,10 @@ public:
 
 protected:
 	Part* part;
+
+	// Bytes which are peeked from the buffered reader,
+	// kept between calls to reuse the memory.
+	std::string peek_buffer;
 };
 
 // TESTME: _match_after_prefix
@@ -69,18 +77,16 @@ protected:
 // For example, "--foobar" does not match "--foo".
 // It returns 0 more input needs to be read to make the decision,
 // meaning that `buf.size() == prefix.size()`.
-extern ssize_t _match_after_prefix(const std::string& buf, const std::string& prefix);
+extern ssize_t _match_after_prefix(std::string_view buf, std::string_view prefix);
 
-// TESTME: _scan_until_boundary
-//
 // Scans `buf` to identify how much of it can be safely
 // returned as part of the `Part` body.
 // `dash_boundary` is "--boundary".
-// `nl_dash_boundary` is "\r\n--boundary" or "\n--boundary", depending on what mode we are in.
+// `nl_dash_boundary` finds "\r\n--boundary" or "\n--boundary", depending on what mode we are in.
 // The comments below (and the name) assume "\n--boundary", but either is accepted.
 // total is the number of bytes read out so far. If total == 0, then a leading "--boundary" is recognized.
 extern std::pair<ssize_t, bool> _scan_until_boundary(
-	const std::string& buf, const std::string& dash_boundary, const std::string& nl_dash_boundary, ssize_t total
+	std::string_view buf, std::string_view dash_boundary, const BoundaryMatcher& nl_dash_boundary, ssize_t total
 );
 
 __HTTP_MIME_MULTIPART_END__
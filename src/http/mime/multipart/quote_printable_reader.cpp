@@ -7,17 +7,195 @@
 #include "./quote_printable_reader.h"
 
 // C++ libraries.
-// TODO:
+#include <array>
 
-// Base libraries.
-// TODO:
 
-// Framework libraries.
-// TODO:
+__HTTP_MIME_MULTIPART_BEGIN__
 
+inline bool _is_qp_discard_whitespace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
 
-__HTTP_MIME_MULTIPART_BEGIN__
+// Bytes which are copied to the output as is.
+inline constexpr auto _QP_PLAIN_BYTES = []()
+{
+	std::array<bool, 256> table{};
+	for (int c = 0; c < 256; c++)
+	{
+		table[c] = c >= ' ' && c != '=' && c != 0x7F;
+	}
+
+	table['\t'] = table['\r'] = table['\n'] = true;
+	return table;
+}();
+
+inline int _from_hex(char c)
+{
+	if (c >= '0' && c <= '9')
+	{
+		return c - '0';
+	}
+	else if (c >= 'A' && c <= 'F')
+	{
+		return c - 'A' + 10;
+	}
+	else if (c >= 'a' && c <= 'f')
+	{
+		return c - 'a' + 10;
+	}
+
+	return -1;
+}
+
+bool QuotePrintableReader::decode_block(std::string& output)
+{
+	auto n = this->reader->read(this->_block, this->block_size);
+	if (n <= 0)
+	{
+		// EOF, the last line may have no line break.
+		if (!this->_line.empty())
+		{
+			QuotePrintableReader::_decode_line(this->_line, true, output);
+			this->_line.clear();
+		}
+
+		return false;
+	}
+
+	std::string_view block = this->_block;
+	output.reserve(output.size() + block.size());
+	if (!this->_line.empty())
+	{
+		auto end = block.find('\n');
+		if (end == std::string_view::npos)
+		{
+			this->_line.append(block);
+			if (this->_line.size() > this->block_size)
+			{
+				this->_decode_long_line(output);
+			}
+
+			return true;
+		}
+
+		this->_line.append(block.substr(0, end + 1));
+		QuotePrintableReader::_decode_line(this->_line, false, output);
+		this->_line.clear();
+		block.remove_prefix(end + 1);
+	}
+
+	for (auto end = block.find('\n'); end != std::string_view::npos; end = block.find('\n'))
+	{
+		QuotePrintableReader::_decode_line(block.substr(0, end + 1), false, output);
+		block.remove_prefix(end + 1);
+	}
+
+	this->_line.assign(block);
+	return true;
+}
+
+void QuotePrintableReader::_decode_line(std::string_view line, bool is_last, std::string& output)
+{
+	auto has_lf = line.ends_with('\n');
+	auto has_crlf = line.ends_with("\r\n");
+	auto whole_line = line;
+	while (!line.empty() && _is_qp_discard_whitespace(line.back()))
+	{
+		line.remove_suffix(1);
+	}
+
+	if (line.ends_with('='))
+	{
+		// Soft line break.
+		auto right_stripped = whole_line.substr(line.size());
+		line.remove_suffix(1);
+		if (
+			!right_stripped.starts_with('\n') && !right_stripped.starts_with("\r\n") &&
+			!(right_stripped.empty() && !line.empty() && is_last)
+		)
+		{
+			throw ParseError(
+				"quotedprintable: invalid bytes after =: '" + std::string(right_stripped) + "'", _ERROR_DETAILS_
+			);
+		}
+
+		QuotePrintableReader::_decode_bytes(line, output);
+	}
+	else
+	{
+		QuotePrintableReader::_decode_bytes(line, output);
+		if (has_lf)
+		{
+			output.append(has_crlf ? "\r\n" : "\n");
+		}
+	}
+}
+
+void QuotePrintableReader::_decode_bytes(std::string_view bytes, std::string& output)
+{
+	size_t i = 0;
+	while (i < bytes.size())
+	{
+		// Runs of plain bytes are appended at once.
+		auto start = i;
+		while (i < bytes.size() && _QP_PLAIN_BYTES[(unsigned char)bytes[i]])
+		{
+			i++;
+		}
+
+		output.append(bytes.data() + start, i - start);
+		if (i == bytes.size())
+		{
+			break;
+		}
+
+		if (bytes[i] != '=')
+		{
+			throw ParseError(
+				"quotedprintable: invalid unescaped byte " + std::to_string((unsigned char)bytes[i]) + " in body",
+				_ERROR_DETAILS_
+			);
+		}
+
+		auto high = i + 1 < bytes.size() ? _from_hex(bytes[i + 1]) : -1;
+		auto low = i + 2 < bytes.size() ? _from_hex(bytes[i + 2]) : -1;
+		if (high >= 0 && low >= 0)
+		{
+			output.push_back((char)(high << 4 | low));
+			i += 3;
+			continue;
+		}
+
+		if (i + 1 >= bytes.size() || bytes[i + 1] == '\r' || bytes[i + 1] == '\n')
+		{
+			throw ParseError("quotedprintable: invalid hex byte after =", _ERROR_DETAILS_);
+		}
+
+		// Accept a single '=' followed by other characters (non-hex).
+		output.push_back('=');
+		i++;
+	}
+}
+
+void QuotePrintableReader::_decode_long_line(std::string& output)
+{
+	// Trailing whitespace and the last two bytes are kept, so
+	// the end of the line and "=XX" are decoded later.
+	auto end = this->_line.find_last_not_of(" \t\r");
+	if (end == std::string::npos || end < 2)
+	{
+		return;
+	}
 
+	end--;
+	while (end > 0 && (this->_line[end - 1] == '=' || (end > 1 && this->_line[end - 2] == '=')))
+	{
+		end--;
+	}
 
+	QuotePrintableReader::_decode_bytes(std::string_view(this->_line).substr(0, end), output);
+	this->_line.erase(0, end);
+}
 
 __HTTP_MIME_MULTIPART_END__
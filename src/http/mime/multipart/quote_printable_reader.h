@@ -3,7 +3,7 @@
  *
  * Copyright (c) 2021 Yuriy Lisovskiy
  *
- * TODO: purpose
+ * Streaming decoder of "quoted-printable" Content-Transfer-Encoding.
  *
  * Implementation is based on Golang 1.15.8: mime/quoteprintable/reader.go
  */
@@ -12,49 +12,51 @@
 
 // C++ libraries.
 #include <string>
+#include <string_view>
 #include <memory>
 
-// Base libraries.
-#include <xalwart.base/io.h>
-#include <xalwart.base/exceptions.h>
-
 // Module definitions.
 #include "./_def_.h"
 
 // Framework libraries.
-// TODO:
+#include "./decoding_reader.h"
 
 
 __HTTP_MIME_MULTIPART_BEGIN__
 
-// TESTME: QuotePrintableReader
-// TODO: docs for 'QuotePrintableReader'
-class QuotePrintableReader : public io::IReader
+// Decodes the body of the part which is encoded as specified in RFC 2045,
+// section 6.7. Lines are decoded as soon as they are complete, trailing
+// whitespace and soft line breaks are removed. As an extension to the RFC,
+// bytes >= 0x80, lowercase hexadecimal digits and '=' which is not followed
+// by hexadecimal digits are accepted.
+class QuotePrintableReader : public DecodingReader
 {
 public:
-	inline explicit QuotePrintableReader(std::shared_ptr<io::IReader> /*reader*/)
+	inline explicit QuotePrintableReader(
+		std::shared_ptr<io::IReader> reader, size_t block_size=DEFAULT_BLOCK_SIZE
+	) : DecodingReader(std::move(reader), block_size)
 	{
-		// TODO:
-		throw NotImplementedException("QuotePrintableReader()", _ERROR_DETAILS_);
 	}
 
-	inline ssize_t read_line(std::string& buffer) override
-	{
-		// TODO:
-		throw NotImplementedException("read_line()", _ERROR_DETAILS_);
-	}
+protected:
+	bool decode_block(std::string& output) override;
 
-	inline ssize_t read(std::string& buffer, size_t max_count) override
-	{
-		// TODO:
-		throw NotImplementedException("read()", _ERROR_DETAILS_);
-	}
+private:
+	std::string _block;
 
-	inline bool close_reader() override
-	{
-		// TODO:
-		throw NotImplementedException("close_reader()", _ERROR_DETAILS_);
-	}
+	// Beginning of the line which is not complete yet.
+	std::string _line;
+
+	// Decodes the line with the line break, `is_last` is `true` if the
+	// body is over.
+	static void _decode_line(std::string_view line, bool is_last, std::string& output);
+
+	// Decodes bytes without processing of the end of the line.
+	static void _decode_bytes(std::string_view bytes, std::string& output);
+
+	// Decodes the beginning of '_line' which is longer than the block,
+	// so memory does not grow if the body has no line breaks.
+	void _decode_long_line(std::string& output);
 };
 
 __HTTP_MIME_MULTIPART_END__
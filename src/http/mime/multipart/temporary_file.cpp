@@ -0,0 +1,298 @@
+/**
+ * http/mime/multipart/temporary_file.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./temporary_file.h"
+
+// C++ libraries.
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Base libraries.
+#include <xalwart.base/exceptions.h>
+
+
+__HTTP_MIME_MULTIPART_BEGIN__
+
+inline constexpr size_t _COPY_BUFFER_SIZE = 64 * 1024;
+
+inline std::string _error_message(const std::string& message)
+{
+	return message + ": " + std::strerror(errno);
+}
+
+inline void _write_all(int file_descriptor, const char* data, size_t size)
+{
+	while (size > 0)
+	{
+		auto n = ::write(file_descriptor, data, size);
+		if (n < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			throw FileError(_error_message("unable to write to file"), _ERROR_DETAILS_);
+		}
+
+		data += n;
+		size -= n;
+	}
+}
+
+// Copies `count` bytes of `from` starting at `offset` to the current position
+// of `to` in the kernel, if it is not supported, through a buffer.
+inline void _copy_range(int from, off_t offset, int to, size_t count)
+{
+	auto end = offset + (off_t)count;
+#if defined(__linux__)
+	while (offset < end)
+	{
+		auto n = ::copy_file_range(from, &offset, to, nullptr, end - offset, 0);
+		if (n < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if (n <= 0)
+		{
+			// Not supported by the kernel or by file systems,
+			// or the source is shorter, which 'pread()' reports.
+			break;
+		}
+	}
+#endif
+	std::string buffer(std::min((size_t)(end - offset), _COPY_BUFFER_SIZE), '\0');
+	while (offset < end)
+	{
+		auto n = ::pread(from, buffer.data(), std::min((size_t)(end - offset), buffer.size()), offset);
+		if (n < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if (n <= 0)
+		{
+			throw FileError(_error_message("unable to read temporary file"), _ERROR_DETAILS_);
+		}
+
+		_write_all(to, buffer.data(), n);
+		offset += n;
+	}
+}
+
+TemporaryFile::TemporaryFile(const std::string& directory)
+{
+	auto target_directory = directory.empty() ? std::filesystem::temp_directory_path().string() : directory;
+#if defined(O_TMPFILE)
+	this->_file_descriptor = ::open(target_directory.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, FILE_MODE);
+	if (this->_file_descriptor >= 0)
+	{
+		return;
+	}
+
+	// The file system does not support files without a name.
+#endif
+	auto path = (std::filesystem::path(target_directory) / "multipart-XXXXXX").string();
+	this->_file_descriptor = ::mkostemp(path.data(), O_CLOEXEC);
+	if (this->_file_descriptor < 0)
+	{
+		throw FileError(
+			_error_message("unable to create temporary file in '" + target_directory + "'"), _ERROR_DETAILS_
+		);
+	}
+
+	this->_path = std::move(path);
+}
+
+TemporaryFile::~TemporaryFile()
+{
+	::close(this->_file_descriptor);
+	if (!this->_path.empty() && !this->_is_saved)
+	{
+		::unlink(this->_path.c_str());
+	}
+}
+
+void TemporaryFile::write(std::string_view data)
+{
+	_write_all(this->_file_descriptor, data.data(), data.size());
+	this->_size += data.size();
+}
+
+void TemporaryFile::append(const TemporaryFile& source, size_t offset, size_t count)
+{
+	if (offset + count > source._size)
+	{
+		throw FileError("range is out of the source file", _ERROR_DETAILS_);
+	}
+
+	try
+	{
+		_copy_range(source._file_descriptor, (off_t)offset, this->_file_descriptor, count);
+	}
+	catch (...)
+	{
+		// The position of the descriptor is not known after the failed
+		// copy, so the size is taken from the file.
+		struct stat info{};
+		if (::fstat(this->_file_descriptor, &info) == 0)
+		{
+			this->_size = info.st_size;
+		}
+
+		throw;
+	}
+
+	this->_size += count;
+}
+
+std::string TemporaryFile::read() const
+{
+	std::string result(this->_size, '\0');
+	size_t position = 0;
+	while (position < result.size())
+	{
+		auto n = ::pread(
+			this->_file_descriptor, result.data() + position, result.size() - position, (off_t)position
+		);
+		if (n < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if (n <= 0)
+		{
+			throw FileError(_error_message("unable to read temporary file"), _ERROR_DETAILS_);
+		}
+
+		position += n;
+	}
+
+	return result;
+}
+
+size_t TemporaryFile::read(size_t offset, char* buffer, size_t count) const
+{
+	while (true)
+	{
+		auto n = ::pread(this->_file_descriptor, buffer, count, (off_t)offset);
+		if (n >= 0)
+		{
+			return n;
+		}
+
+		if (errno != EINTR)
+		{
+			throw FileError(_error_message("unable to read temporary file"), _ERROR_DETAILS_);
+		}
+	}
+}
+
+void TemporaryFile::save(const std::string& to)
+{
+	if (!this->_is_saved)
+	{
+		// Moving fails if `to` is on another file system,
+		// then the file is copied.
+		if (this->_path.empty())
+		{
+			this->_is_saved = this->_link(to);
+		}
+		else if (::fchmod(this->_file_descriptor, FILE_MODE) == 0 && ::rename(this->_path.c_str(), to.c_str()) == 0)
+		{
+			// The descriptor refers to the saved file now.
+			this->_path = to;
+			this->_is_saved = true;
+		}
+
+		if (this->_is_saved)
+		{
+			return;
+		}
+	}
+
+	this->_copy(to);
+}
+
+bool TemporaryFile::_link(const std::string& to) const
+{
+#if defined(O_TMPFILE)
+	// Linking by the descriptor with AT_EMPTY_PATH requires
+	// privileges, the link in procfs does not.
+	auto descriptor_path = "/proc/self/fd/" + std::to_string(this->_file_descriptor);
+	if (::linkat(AT_FDCWD, descriptor_path.c_str(), AT_FDCWD, to.c_str(), AT_SYMLINK_FOLLOW) == 0)
+	{
+		return true;
+	}
+
+	if (errno != EEXIST)
+	{
+		return false;
+	}
+
+	// Existing files are not replaced by 'linkat()', so the file is linked
+	// next to `to` and renamed over it.
+	auto neighbour = to + ".upload-" + std::to_string(::getpid()) + "-" + std::to_string(this->_file_descriptor);
+	if (::linkat(AT_FDCWD, descriptor_path.c_str(), AT_FDCWD, neighbour.c_str(), AT_SYMLINK_FOLLOW) != 0)
+	{
+		return false;
+	}
+
+	if (::rename(neighbour.c_str(), to.c_str()) != 0)
+	{
+		::unlink(neighbour.c_str());
+		return false;
+	}
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+void TemporaryFile::_copy(const std::string& to) const
+{
+	// The file was saved to `to` before, so the destination already has the
+	// content, and opening it with 'O_TRUNC' would truncate the source.
+	struct stat source_info{}, destination_info{};
+	if (
+		::stat(to.c_str(), &destination_info) == 0 && ::fstat(this->_file_descriptor, &source_info) == 0 &&
+		source_info.st_dev == destination_info.st_dev && source_info.st_ino == destination_info.st_ino
+	)
+	{
+		return;
+	}
+
+	auto file_descriptor = ::open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, FILE_MODE);
+	if (file_descriptor < 0)
+	{
+		throw FileError(_error_message("unable to open file '" + to + "'"), _ERROR_DETAILS_);
+	}
+
+	try
+	{
+		_copy_range(this->_file_descriptor, 0, file_descriptor, this->_size);
+	}
+	catch (...)
+	{
+		::close(file_descriptor);
+		throw;
+	}
+
+	if (::close(file_descriptor) != 0)
+	{
+		throw FileError(_error_message("unable to save file '" + to + "'"), _ERROR_DETAILS_);
+	}
+}
+
+__HTTP_MIME_MULTIPART_END__
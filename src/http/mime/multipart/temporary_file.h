@@ -0,0 +1,120 @@
+/**
+ * http/mime/multipart/temporary_file.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * File to which large uploads are spooled.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <string>
+#include <string_view>
+
+// Module definitions.
+#include "./_def_.h"
+
+
+__HTTP_MIME_MULTIPART_BEGIN__
+
+// TESTME: TemporaryFile
+// Keeps the descriptor of the file which is created in `directory`. Where
+// O_TMPFILE is supported the file has no name, so the system removes it
+// with the last descriptor even if the process is killed, otherwise it is
+// a named file which is removed by the destructor.
+//
+// The first 'save()' moves the file to its destination with 'linkat()' or
+// 'rename()'. If the destination is on another file system or the file was
+// saved before, it is copied by the kernel with 'copy_file_range()'.
+class TemporaryFile final
+{
+public:
+	// Permissions of the saved file, the umask is applied
+	// to files without a name.
+	static inline constexpr unsigned int FILE_MODE = 0644;
+
+	// Creates the file in the temporary directory of the system
+	// if `directory` is empty.
+	explicit TemporaryFile(const std::string& directory="");
+
+	TemporaryFile(const TemporaryFile&) = delete;
+
+	TemporaryFile& operator=(const TemporaryFile&) = delete;
+
+	~TemporaryFile();
+
+	// Appends `data` to the file.
+	void write(std::string_view data);
+
+	// Appends `count` bytes of `source` starting at `offset` to the file.
+	// They are copied in the kernel, if it is not supported, the bytes
+	// are copied through a buffer.
+	//
+	// @throws FileError if `source` is shorter or the file can not be written.
+	void append(const TemporaryFile& source, size_t offset, size_t count);
+
+	// Returns the whole content of the file.
+	[[nodiscard]]
+	std::string read() const;
+
+	// Reads up to `count` bytes starting at `offset` to `buffer`.
+	//
+	// @return count of bytes which are read, zero at the end of the file.
+	size_t read(size_t offset, char* buffer, size_t count) const;
+
+	// Saves the file to `to`, which is replaced if it exists. Saving
+	// to the path where the file is already saved does nothing.
+	void save(const std::string& to);
+
+	// Returns the path of the named file or an empty string.
+	[[nodiscard]]
+	inline const std::string& path() const
+	{
+		return this->_path;
+	}
+
+	[[nodiscard]]
+	inline size_t size() const
+	{
+		return this->_size;
+	}
+
+private:
+	int _file_descriptor = -1;
+	std::string _path;
+	size_t _size = 0;
+
+	// If `true`, the next 'save()' copies the file.
+	bool _is_saved = false;
+
+	// Links the file without a name to `to`.
+	[[nodiscard]]
+	bool _link(const std::string& to) const;
+
+	// Copies the file to `to` in the kernel, if it is not
+	// supported, the file is copied through a buffer.
+	void _copy(const std::string& to) const;
+};
+
+// TESTME: ISpooledReader
+// Reader of the body which is spooled to 'TemporaryFile', so the uploaded
+// files are copied from it with 'TemporaryFile::append()' instead of being
+// written through memory, see 'BodyReader::write_to_temp_file()'.
+class ISpooledReader
+{
+public:
+	virtual ~ISpooledReader() = default;
+
+	// Returns the file which the body is spooled to or `nullptr`
+	// if the body is in memory.
+	[[nodiscard]]
+	virtual const TemporaryFile* spooled_file() const = 0;
+
+	// Returns the position in 'spooled_file()' of the
+	// next byte of the body which is not read yet.
+	[[nodiscard]]
+	virtual size_t spooled_position() const = 0;
+};
+
+__HTTP_MIME_MULTIPART_END__
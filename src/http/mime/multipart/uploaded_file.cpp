@@ -6,6 +6,9 @@
 
 #include "./uploaded_file.h"
 
+// C++ libraries.
+#include <filesystem>
+
 
 __HTTP_MIME_MULTIPART_BEGIN__
 
@@ -23,6 +26,7 @@ UploadedFile::UploadedFile(const UploadedFile& other)
 	if (this != &other)
 	{
 		this->_read_from_name = other._read_from_name;
+		this->_file = other._file;
 		this->_size = other._size;
 		if (this->_size > 0)
 		{
@@ -36,6 +40,7 @@ UploadedFile& UploadedFile::operator= (const UploadedFile& other)
 	if (this != &other)
 	{
 		this->_read_from_name = other._read_from_name;
+		this->_file = other._file;
 		this->_size = other._size;
 		if (this->_size > 0)
 		{
@@ -48,6 +53,11 @@ UploadedFile& UploadedFile::operator= (const UploadedFile& other)
 
 std::string UploadedFile::content()
 {
+	if (this->_file)
+	{
+		return this->_file->read();
+	}
+
 	if (!this->_read_from_name.empty())
 	{
 		File file(this->_read_from_name, File::OpenMode::ReadBinary);
@@ -65,6 +75,20 @@ std::string UploadedFile::content()
 
 void UploadedFile::save(const std::string& to)
 {
+	if (this->_file)
+	{
+		this->_file->save(to);
+		return;
+	}
+
+	if (!this->_read_from_name.empty())
+	{
+		std::filesystem::copy_file(
+			this->_read_from_name, to, std::filesystem::copy_options::overwrite_existing
+		);
+		return;
+	}
+
 	File file(to, File::OpenMode::WriteBinary);
 	file.open();
 	if (file.is_open())
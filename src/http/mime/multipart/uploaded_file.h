@@ -8,12 +8,18 @@
 
 #pragma once
 
+// C++ libraries.
+#include <memory>
+
 // Base modules.
 #include <xalwart.base/file.h>
 
 // Module definitions.
 #include "./_def_.h"
 
+// Framework libraries.
+#include "./temporary_file.h"
+
 
 __HTTP_MIME_MULTIPART_BEGIN__
 
@@ -25,6 +31,7 @@ private:
 	std::string _read_from_name;
 	size_t _size{};
 	std::string _data;
+	std::shared_ptr<TemporaryFile> _file;
 
 	inline explicit UploadedFile(const std::string& name)
 	{
@@ -44,6 +51,14 @@ public:
 		return UploadedFile(content.size(), content);
 	}
 
+	// The file is shared, so it exists while it is used.
+	inline static UploadedFile from_file(std::shared_ptr<TemporaryFile> file)
+	{
+		UploadedFile result;
+		result._file = std::move(file);
+		return result;
+	}
+
 	UploadedFile() = default;
 
 	UploadedFile(const UploadedFile& other);
@@ -55,21 +70,24 @@ public:
 	[[nodiscard]]
 	inline std::string read_from_name() const
 	{
-		return this->_read_from_name;
+		return this->_file ? this->_file->path() : this->_read_from_name;
 	}
 
 	[[nodiscard]]
 	inline size_t size() const
 	{
-		return this->_size;
+		return this->_file ? this->_file->size() : this->_size;
 	}
 
 	[[nodiscard]]
 	inline bool exists() const
 	{
-		return this->_size != 0;
+		return this->size() != 0;
 	}
 
+	// Saves the file without reading it to memory if it is not
+	// created from content. The first save of the temporary file
+	// moves it to `to`, see 'TemporaryFile::save()'.
 	void save(const std::string& to);
 };
 
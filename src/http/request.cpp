@@ -12,6 +12,7 @@
 
 // Framework libraries.
 #include "./exceptions.h"
+#include "./header_map.h"
 #include "./mime/media_type.h"
 
 
@@ -22,12 +23,38 @@ Request::Request(
 	ssize_t max_file_upload_size, ssize_t max_fields_count,
 	ssize_t max_header_length, ssize_t max_headers_count,
 	long long int multipart_max_memory,
-	std::map<std::string, std::string> environment
+	std::map<std::string, std::string> environment,
+	std::pmr::memory_resource* memory_resource
 ) : _method(context.method),
 	_headers(context.headers), _body_reader(context.body), _content_length((ssize_t)context.content_size),
 	max_file_upload_size(max_file_upload_size), max_fields_count(max_fields_count),
 	max_headers_count(max_headers_count), max_header_length(max_header_length),
-	multipart_max_memory(multipart_max_memory), _environment(std::move(environment))
+	multipart_max_memory(multipart_max_memory), _environment(std::move(environment)),
+	_memory_resource(memory_resource ? memory_resource : std::pmr::get_default_resource())
+{
+	this->_initialize(context);
+}
+
+Request::Request(
+	const net::RequestContext& context,
+	ssize_t max_file_upload_size, ssize_t max_fields_count,
+	ssize_t max_header_length, ssize_t max_headers_count,
+	long long int multipart_max_memory,
+	const std::map<std::string, std::string>* headers,
+	const std::map<std::string, std::string>* environment,
+	std::pmr::memory_resource* memory_resource
+) : _method(context.method), _body_reader(context.body), _content_length((ssize_t)context.content_size),
+	max_file_upload_size(max_file_upload_size), max_fields_count(max_fields_count),
+	max_headers_count(max_headers_count), max_header_length(max_header_length),
+	multipart_max_memory(multipart_max_memory),
+	_memory_resource(memory_resource ? memory_resource : std::pmr::get_default_resource()),
+	_borrowed_headers(require_non_null(headers, "'headers' is nullptr", _ERROR_DETAILS_)),
+	_borrowed_environment(require_non_null(environment, "'environment' is nullptr", _ERROR_DETAILS_))
+{
+	this->_initialize(context);
+}
+
+void Request::_initialize(const net::RequestContext& context)
 {
 	if (!valid_method(this->_method))
 	{
@@ -39,7 +66,11 @@ Request::Request(
 		.major = context.protocol_version.major,
 		.minor = context.protocol_version.minor
 	};
-	this->_url = std::move(parse_url(context.path + (context.query.empty() ? "" : "?" + context.query)));
+
+	// The server has already split the query from the path,
+	// so it is not joined and parsed again.
+	this->_url = parse_url(context.path);
+	this->_url.raw_query = context.query;
 	this->_url.host = remove_empty_port(this->_url.host);
 	this->_host = this->_url.host;
 }
@@ -89,34 +120,79 @@ std::string Request::get_host(
 	throw exc::DisallowedHost(msg, _ERROR_DETAILS_);
 }
 
+const mime::MediaType& Request::media_type() const
+{
+	if (!this->_media_type.has_value())
+	{
+		// RFC 7231, section 3.1.1.5 - empty type
+		// MAY be treated as application/octet-stream
+		auto content_type = this->get_header_view(CONTENT_TYPE);
+		this->_media_type = mime::parse_media_type(
+			content_type.empty() ? std::string_view(mime::APPLICATION_OCTET_STREAM) : content_type
+		);
+	}
+
+	return *this->_media_type;
+}
+
+const CookieJar& Request::cookie_jar() const
+{
+	if (!this->_cookie_jar.has_value())
+	{
+		this->_cookie_jar.emplace(this->get_header_view(COOKIE), this->_memory_resource);
+	}
+
+	return *this->_cookie_jar;
+}
+
+void Request::read_multipart(const std::function<bool(mime::multipart::Part&)>& handler)
+{
+	if (this->_is_multipart_read || this->_multipart_form.has_value())
+	{
+		throw RuntimeError(
+			"multipart body of the request is already read, 'read_multipart()' can be called once "
+			"and can not be combined with 'multipart_form()'",
+			_ERROR_DETAILS_
+		);
+	}
+
+	// The body is consumed even if reading fails.
+	this->_is_multipart_read = true;
+	this->_multipart_reader(false)->read_parts(handler);
+}
+
 std::unique_ptr<mime::multipart::BodyReader> Request::_multipart_reader(bool allow_mixed) const
 {
-	auto content_type = this->get_header(CONTENT_TYPE, "");
-	if (content_type.empty())
+	if (!this->has_header(CONTENT_TYPE))
 	{
 		throw exc::NotMultipart(
 			"request content is not '" + std::string(mime::MULTIPART_FORM_DATA) + "'", _ERROR_DETAILS_
 		);
 	}
 
-	auto [media_type, parameters, ok] = mime::parse_media_type(str::string_to_wstring(content_type));
-	if (!ok || !(media_type == mime::MULTIPART_FORM_DATA_L || allow_mixed && media_type == L"multipart/mixed"))
+	const auto& media_type = this->media_type();
+	if (
+		!media_type.ok ||
+		!(media_type.type == mime::MULTIPART_FORM_DATA || allow_mixed && media_type.type == "multipart/mixed")
+	)
 	{
 		throw exc::NotMultipart(
 			"request content is not '" + std::string(mime::MULTIPART_FORM_DATA) + "'", _ERROR_DETAILS_
 		);
 	}
 
-	if (!parameters.contains(L"boundary"))
+	auto boundary = media_type.get("boundary");
+	if (!boundary)
 	{
 		throw exc::HttpError(400, "missing start boundary", _ERROR_DETAILS_);
 	}
 
-	auto boundary = str::wstring_to_string(parameters.at(L"boundary"));
-	return std::make_unique<mime::multipart::BodyReader>(
-		this->_body_reader, boundary, std::stoll(this->get_header(CONTENT_LENGTH, "0")),
+	auto reader = std::make_unique<mime::multipart::BodyReader>(
+		this->_body_reader, *boundary, std::stoll(this->get_header(CONTENT_LENGTH, "0")),
 		this->max_file_upload_size, this->max_fields_count, this->max_header_length, this->max_headers_count
 	);
+	reader->upload_directory = this->_upload_directory;
+	return reader;
 }
 
 std::string Request::_get_raw_host(
@@ -125,18 +201,18 @@ std::string Request::_get_raw_host(
 ) const
 {
 	std::string raw_host;
-	if (use_x_forwarded_host && this->_headers.contains(http::X_FORWARDED_HOST))
+	if (use_x_forwarded_host && this->has_header(http::X_FORWARDED_HOST))
 	{
-		raw_host = this->_headers.at(http::X_FORWARDED_HOST);
+		raw_host = this->get_header(http::X_FORWARDED_HOST);
 	}
 	else
 	{
-		if (!this->_environment.contains(net::meta::SERVER_NAME))
+		if (!this->environment().contains(net::meta::SERVER_NAME))
 		{
 			throw KeyError("'environment' does not contain " + std::string(net::meta::SERVER_NAME));
 		}
 
-		raw_host = this->_environment.at(net::meta::SERVER_NAME);
+		raw_host = this->environment().at(net::meta::SERVER_NAME);
 		auto port = this->_get_port(use_x_forwarded_port);
 		if (port != (this->is_secure(secure_proxy_ssl_header) ? "443" : "80"))
 		{
@@ -150,23 +226,48 @@ std::string Request::_get_raw_host(
 std::string Request::_get_port(bool use_x_forwarded_port) const
 {
 	std::string port;
-	if (use_x_forwarded_port && this->_headers.contains(http::X_FORWARDED_PORT))
+	if (use_x_forwarded_port && this->has_header(http::X_FORWARDED_PORT))
 	{
-		port = this->_headers.at(http::X_FORWARDED_PORT);
+		port = this->get_header(http::X_FORWARDED_PORT);
 	}
 	else
 	{
-		if (!this->_environment.contains(net::meta::SERVER_PORT))
+		if (!this->environment().contains(net::meta::SERVER_PORT))
 		{
 			throw KeyError("'environment' does not contain " + std::string(net::meta::SERVER_PORT));
 		}
 
-		port = this->_environment.at(net::meta::SERVER_PORT);
+		port = this->environment().at(net::meta::SERVER_PORT);
 	}
 
 	return port;
 }
 
+const std::string* Request::_find_header(const std::string& key) const
+{
+	const auto& headers = this->_get_headers();
+	auto header = headers.find(key);
+	if (header != headers.end())
+	{
+		return &header->second;
+	}
+
+	if (auto id = get_header_id(key))
+	{
+		auto name = get_header_name(*id);
+		if (name != key)
+		{
+			header = headers.find(std::string(name));
+			if (header != headers.end())
+			{
+				return &header->second;
+			}
+		}
+	}
+
+	return nullptr;
+}
+
 void Request::_parse_form()
 {
 	if (!this->_form.has_value())
@@ -205,6 +306,13 @@ void Request::_parse_multipart_form()
 		return;
 	}
 
+	if (this->_is_multipart_read)
+	{
+		throw RuntimeError(
+			"multipart body of the request is already read by 'read_multipart()'", _ERROR_DETAILS_
+		);
+	}
+
 	auto reader = this->_multipart_reader(false);
 	auto target_form = reader->read_form(this->multipart_max_memory);
 	for (const auto& pair : target_form.values)
@@ -302,8 +410,7 @@ std::tuple<std::string, bool> read_body_to_string(
 		throw exc::HttpError(400, "missing form body", _ERROR_DETAILS_);
 	}
 
-	auto parsed_content_type = parse_content_type(request);
-	if (parsed_content_type == target_content_type)
+	if (request->media_type().type == target_content_type)
 	{
 		auto content_length_string = request->get_header(CONTENT_LENGTH, "");
 		if (!content_length_string.empty())
@@ -348,21 +455,7 @@ Query parse_post_form(http::IRequest* request, io::ILimitedBufferedReader* body_
 
 std::string parse_content_type(http::IRequest* request)
 {
-	auto content_type = request->get_header(CONTENT_TYPE, "");
-
-	// RFC 7231, section 3.1.1.5 - empty type
-	// MAY be treated as application/octet-stream
-	if (content_type.empty())
-	{
-		content_type = mime::APPLICATION_OCTET_STREAM;
-	}
-
-	auto media_type_result = mime::parse_media_type(str::string_to_wstring(content_type));
-
-	// Return the first item of the result.
-	// In case of some parse error, the first item will be
-	// assigned to Content-Type header value.
-	return str::wstring_to_string(std::get<0>(media_type_result));
+	return request->media_type().type;
 }
 
 __HTTP_END__
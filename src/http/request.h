@@ -14,6 +14,7 @@
 #include <map>
 #include <vector>
 #include <memory>
+#include <memory_resource>
 #include <optional>
 #include <functional>
 
@@ -28,9 +29,12 @@
 
 // Framework libraries.
 #include "./headers.h"
+#include "./header_map.h"
 #include "./cookie/parser.h"
+#include "./cookie/jar.h"
 #include "./mime/multipart/body_reader.h"
 #include "./mime/content_types.h"
+#include "./mime/media_type.h"
 #include "./interfaces.h"
 
 
@@ -46,7 +50,8 @@ public:
 		ssize_t max_file_upload_size, ssize_t max_fields_count,
 		ssize_t max_header_length, ssize_t max_headers_count,
 		long long int multipart_max_memory,
-		std::map<std::string, std::string> environment
+		std::map<std::string, std::string> environment,
+		std::pmr::memory_resource* memory_resource=nullptr
 	);
 
 	[[nodiscard]]
@@ -70,7 +75,7 @@ public:
 	[[nodiscard]]
 	inline const std::map<std::string, std::string>& headers() const final
 	{
-		return this->_headers;
+		return this->_get_headers();
 	}
 
 	// 'user_agent' returns the client's User-Agent, if sent in the request.
@@ -84,40 +89,63 @@ public:
 	[[nodiscard]]
 	inline bool has_header(const std::string& key) const final
 	{
-		return this->_headers.contains(key);
+		return this->_find_header(key) != nullptr;
 	}
 
 	// TODO: docs for 'get_header'
 	[[nodiscard]]
 	inline std::string get_header(const std::string& key, const std::string& default_value="") const final
 	{
-		return this->_headers.contains(key) ? this->_headers.at(key) : default_value;
+		auto header = this->_find_header(key);
+		return header ? *header : default_value;
 	}
 
-	// TODO: docs for 'set_header'
+	// Returns view into value of the header without copying it, or an
+	// empty view if the header is missing. The view is valid until the
+	// header is changed.
+	[[nodiscard]]
+	inline std::string_view get_header_view(const std::string& key) const final
+	{
+		auto header = this->_find_header(key);
+		return header ? std::string_view(*header) : std::string_view();
+	}
+
+	// Headers of the server are copied before the first change,
+	// see 'RequestView'.
 	inline void set_header(const std::string& key, const std::string& value) final
 	{
-		if (this->_headers.contains(key))
+		if (this->_borrowed_headers)
+		{
+			this->_headers = *this->_borrowed_headers;
+			this->_borrowed_headers = nullptr;
+		}
+
+		this->_headers.insert_or_assign(key, value);
+		auto id = get_header_id(key);
+		if (id == HeaderId::ContentType)
 		{
-			this->_headers[key] = value;
+			this->_media_type.reset();
 		}
-		else
+		else if (id == HeaderId::Cookie)
 		{
-			this->_headers.insert(std::make_pair(key, value));
+			this->_cookie_jar.reset();
 		}
 	}
 
 	[[nodiscard]]
 	inline bool is_json() const final
 	{
-		return this->get_header(CONTENT_TYPE, "").find(mime::APPLICATION_JSON) != std::string::npos;
+		return this->get_header_view(CONTENT_TYPE).find(mime::APPLICATION_JSON) != std::string_view::npos;
 	}
 
+	[[nodiscard]]
+	const mime::MediaType& media_type() const final;
+
 	// 'cookies' parses and returns the HTTP cookies sent with the request.
 	[[nodiscard]]
 	inline std::vector<Cookie> cookies() const final
 	{
-		return parse_cookies(this->get_header(COOKIE, ""), "");
+		return this->cookie_jar().cookies();
 	}
 
 	// 'cookie' returns the named cookie provided in the request or
@@ -127,13 +155,26 @@ public:
 	[[nodiscard]]
 	inline std::optional<Cookie> cookie(const std::string& name) const final
 	{
-		auto cookies = parse_cookies(this->get_header(COOKIE), name);
-		if (cookies.empty())
+		auto value = this->cookie_jar().get(name);
+		if (!value)
 		{
 			return {};
 		}
 
-		return cookies[0];
+		return Cookie(name, std::string(*value));
+	}
+
+	[[nodiscard]]
+	const CookieJar& cookie_jar() const final;
+
+	// Signatures are checked once per request for
+	// each name and salt, see 'CookieJar::get_signed()'.
+	[[nodiscard]]
+	inline std::optional<std::string> get_signed_cookie(
+		const std::string& name, const std::string& secret_key, const std::string& salt=""
+	) const final
+	{
+		return this->cookie_jar().get_signed(name, secret_key, salt);
 	}
 
 	// 'referer' returns the referring URL, if sent in the request.
@@ -162,6 +203,8 @@ public:
 		return this->_multipart_form.value();
 	}
 
+	void read_multipart(const std::function<bool(mime::multipart::Part&)>& handler) final;
+
 	inline nlohmann::json json() final
 	{
 		this->_parse_json_data();
@@ -189,7 +232,7 @@ public:
 	[[nodiscard]]
 	inline const std::map<std::string, std::string>& environment() const final
 	{
-		return this->_environment;
+		return this->_borrowed_environment ? *this->_borrowed_environment : this->_environment;
 	}
 
 	// TODO: docs for 'scheme'
@@ -209,6 +252,35 @@ public:
 		return this->scheme(secure_proxy_ssl_header) == "https";
 	}
 
+	// Returns the resource which is passed to constructor, or
+	// the default one if it is not set.
+	[[nodiscard]]
+	inline std::pmr::memory_resource* memory_resource() const final
+	{
+		return this->_memory_resource;
+	}
+
+	// Sets the directory where file parts which do not fit into
+	// `multipart_max_memory` are written, see 'FILE_UPLOAD_TEMP_DIR'
+	// setting. The temporary directory of the system is used by default.
+	inline void set_upload_directory(std::string directory)
+	{
+		this->_upload_directory = std::move(directory);
+	}
+
+protected:
+	// Refers to `headers` and `environment` instead of copying them,
+	// see 'RequestView'.
+	explicit Request(
+		const net::RequestContext& context,
+		ssize_t max_file_upload_size, ssize_t max_fields_count,
+		ssize_t max_header_length, ssize_t max_headers_count,
+		long long int multipart_max_memory,
+		const std::map<std::string, std::string>* headers,
+		const std::map<std::string, std::string>* environment,
+		std::pmr::memory_resource* memory_resource
+	);
+
 private:
 	// Specifies the URI being requested.
 	//
@@ -264,6 +336,12 @@ private:
 	// '_json' is parsed request body when Content-Type is 'application/json'.
 	std::optional<nlohmann::json> _json;
 
+	// Parsed Content-Type, see 'media_type()'.
+	mutable std::optional<mime::MediaType> _media_type;
+
+	// Parsed Cookie header, see 'cookie_jar()'.
+	mutable std::optional<CookieJar> _cookie_jar;
+
 	// '_host' specifies the host on which the
 	// URL is sought. For HTTP/1 (per RFC 7230, section 5.4), this
 	// is either the value of the "Host" header or the host name
@@ -289,11 +367,23 @@ private:
 	// TODO: docs for Request::environment
 	std::map<std::string, std::string> _environment;
 
+	std::pmr::memory_resource* _memory_resource;
+
+	// Headers and environment of the server which are used
+	// instead of own copies, nullptr if they are copied.
+	const std::map<std::string, std::string>* _borrowed_headers = nullptr;
+	const std::map<std::string, std::string>* _borrowed_environment = nullptr;
+
 	ssize_t max_file_upload_size;
 	ssize_t max_fields_count;
 	ssize_t max_header_length;
 	ssize_t max_headers_count;
 	ssize_t multipart_max_memory;
+	std::string _upload_directory;
+
+	// Set when the body is read by 'read_multipart()', so it
+	// can not be parsed by 'multipart_form()' after that.
+	bool _is_multipart_read = false;
 
 	// '_parse_form' populates '_form'.
 	//
@@ -337,6 +427,43 @@ private:
 	// TODO: dos for 'get_port'
 	[[nodiscard]]
 	std::string _get_port(bool use_x_forwarded_port) const;
+
+	[[nodiscard]]
+	inline const std::map<std::string, std::string>& _get_headers() const
+	{
+		return this->_borrowed_headers ? *this->_borrowed_headers : this->_headers;
+	}
+
+	// Looks up the header by `key` as it is, then well-known headers
+	// by their canonical names, so "content-type" finds "Content-Type".
+	[[nodiscard]]
+	const std::string* _find_header(const std::string& key) const;
+
+	// Validates the method and parses the URL of `context`.
+	void _initialize(const net::RequestContext& context);
+};
+
+// TESTME: RequestView
+// Request which refers to headers of `context` and to `environment`
+// instead of copying them, so both of them must outlive the request,
+// like they do in the handler of the server. Headers are copied only
+// if they are changed by 'set_header()'.
+class RequestView final : public Request
+{
+public:
+	inline explicit RequestView(
+		const net::RequestContext& context,
+		ssize_t max_file_upload_size, ssize_t max_fields_count,
+		ssize_t max_header_length, ssize_t max_headers_count,
+		long long int multipart_max_memory,
+		const std::map<std::string, std::string>& environment,
+		std::pmr::memory_resource* memory_resource=nullptr
+	) : Request(
+		context, max_file_upload_size, max_fields_count, max_header_length, max_headers_count,
+		multipart_max_memory, &context.headers, &environment, memory_resource
+	)
+	{
+	}
 };
 
 // TESTME: valid_method
@@ -382,7 +509,8 @@ extern std::tuple<std::string, bool> read_body_to_string(
 extern Query parse_post_form(http::IRequest* request, io::ILimitedBufferedReader* body_reader);
 
 // TESTME: 'get_content_type'
-// TODO: docs for 'get_content_type'
+// Returns lowercase media type of Content-Type header without
+// parameters, see 'IRequest::media_type()'.
 extern std::string parse_content_type(http::IRequest* request);
 
 __HTTP_END__
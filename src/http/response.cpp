@@ -6,6 +6,14 @@
 
 #include "./response.h"
 
+// C++ libraries.
+#include <cstdio>
+#include <random>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 // Base libraries.
 #include <xalwart.base/path.h>
 #include <xalwart.base/string_utils.h>
@@ -22,7 +30,7 @@ __HTTP_BEGIN__
 
 AbstractResponse::AbstractResponse(
 	unsigned short int status, std::string content_type, std::string reason, std::string charset
-) : streaming(false), headers({}), closed(false), reason_phrase(std::move(reason)), charset(std::move(charset))
+) : streaming(false), closed(false), reason_phrase(std::move(reason)), charset(std::move(charset))
 {
 	if (status != 0)
 	{
@@ -69,7 +77,7 @@ void AbstractResponse::set_cookie(const Cookie& cookie)
 
 void AbstractResponse::set_signed_cookie(const std::string& secret_key, const std::string& salt, const Cookie& cookie)
 {
-	auto signed_value = get_cookie_signer(secret_key, cookie.name() + salt).sign(cookie.value());
+	auto signed_value = get_cookie_signer(secret_key, cookie.name() + salt)->sign(cookie.value());
 	this->set_cookie(Cookie(
 		cookie.name(), signed_value, cookie.max_age(), cookie.domain(),
 		cookie.path(), cookie.is_secure(), cookie.is_http_only(), cookie.same_site()
@@ -102,28 +110,16 @@ std::string AbstractResponse::get_reason_phrase() const
 
 std::string AbstractResponse::serialize_headers() const
 {
-	auto expr = [](const std::pair<std::string, std::string>& _p) -> std::string
-	{
-		return _p.first + ": " + _p.second;
-	};
-
 	std::string result;
-	for (auto it = this->headers.begin(); it != this->headers.end(); it++)
+	this->headers.serialize(result);
+	for (const auto& [_, cookie] : this->cookies)
 	{
-		result.append(expr(*it));
-		if (std::next(it) != this->headers.end())
+		if (!result.empty())
 		{
 			result.append("\r\n");
 		}
-	}
 
-	for (auto it = this->cookies.begin(); it != this->cookies.end(); it++)
-	{
-		result.append(it->second.to_string());
-		if (std::next(it) != this->cookies.end())
-		{
-			result.append("\r\n");
-		}
+		result.append(cookie.to_string());
 	}
 
 	return result;
@@ -131,13 +127,24 @@ std::string AbstractResponse::serialize_headers() const
 
 std::string BaseResponse::serialize()
 {
-	auto content = this->get_content();
-	this->set_header(DATE, dt::Datetime::utc_now().strftime("%a, %d %b %Y %T GMT"));
-	this->set_header(CONTENT_LENGTH, std::to_string(content.size()));
+	auto slices = this->serialize_slices();
+	slices.head.append(slices.body);
+	return std::move(slices.head);
+}
+
+ResponseSlices BaseResponse::serialize_slices()
+{
+	auto body = this->get_body_view();
+	this->headers.set(HeaderId::Date, dt::Datetime::utc_now().strftime("%a, %d %b %Y %T GMT"));
+	this->headers.set(HeaderId::ContentLength, std::to_string(body.size()));
 	auto reason_phrase = this->get_reason_phrase();
 	auto headers = this->serialize_headers();
-	return "HTTP/1.1 " + std::to_string(this->status) + " " + reason_phrase + "\r\n" +
-	   headers + "\r\n\r\n" + content;
+
+	ResponseSlices slices{.body = body};
+	slices.head.reserve(headers.size() + reason_phrase.size() + 20);
+	slices.head.append("HTTP/1.1 ").append(std::to_string(this->status)).append(" ").append(reason_phrase);
+	slices.head.append("\r\n").append(headers).append("\r\n\r\n");
+	return slices;
 }
 
 FileResponse::FileResponse(
@@ -152,72 +159,177 @@ FileResponse::FileResponse(
     _total_bytes_read(0),
     _as_attachment(as_attachment),
 	_file_path(std::move(file_path)),
-	_headers_is_got(false)
+	_file_size(0),
+	_file_descriptor(-1),
+	_mapped_file(nullptr),
+	_is_mapping_tried(false),
+	_headers_is_got(false),
+	_segment_index(0),
+	_segment_position(0),
+	_segment_prefix_is_sent(false)
 {
-	if (!path::Path(this->_file_path).exists())
+	this->_file_descriptor = ::open(this->_file_path.c_str(), O_RDONLY);
+	struct stat file_info{};
+	if (this->_file_descriptor < 0 || ::fstat(this->_file_descriptor, &file_info) != 0)
 	{
+		this->_close_file();
 		throw exc::FileDoesNotExist("file '" + this->_file_path + "' does not exist", _ERROR_DETAILS_);
 	}
-	else
+
+	// The size of directories and devices is not the size of their content.
+	if (!S_ISREG(file_info.st_mode))
 	{
-		// Initializing file stream.
-		this->_file_stream = std::ifstream(this->_file_path, std::ifstream::binary | std::ios::ate);
-		this->_file_size = this->_file_stream.tellg();
-		this->_file_stream.seekg(0);
+		this->_close_file();
+		throw exc::FileDoesNotExist("'" + this->_file_path + "' is not a regular file", _ERROR_DETAILS_);
 	}
+
+	this->_file_size = file_info.st_size;
+	this->_segments = {Segment{.prefix = "", .offset = 0, .length = this->_file_size}};
+}
+
+FileResponse::~FileResponse()
+{
+	this->_close_file();
 }
 
 std::string FileResponse::get_chunk()
 {
-	std::string chunk;
+	return std::string(this->get_chunk_view());
+}
+
+std::string_view FileResponse::get_chunk_view()
+{
 	if (!this->_headers_is_got)
 	{
-		chunk = this->_get_headers_chunk();
 		this->_headers_is_got = true;
+		this->chunk_buffer = this->_get_headers_chunk();
+		return this->chunk_buffer;
 	}
-	else
+
+	while (this->_segment_index < this->_segments.size())
 	{
-		size_t bytes_to_read;
-		if ((this->_total_bytes_read + FileResponse::CHUNK_SIZE) > this->_file_size)
+		const auto& segment = this->_segments[this->_segment_index];
+		if (!this->_segment_prefix_is_sent)
 		{
-			bytes_to_read = this->_file_size - this->_total_bytes_read;
-		}
-		else
-		{
-			bytes_to_read = FileResponse::CHUNK_SIZE;
+			this->_segment_prefix_is_sent = true;
+			if (!segment.prefix.empty())
+			{
+				this->_bytes_read = segment.prefix.size();
+				return segment.prefix;
+			}
 		}
 
+		auto bytes_to_read = std::min(FileResponse::CHUNK_SIZE, segment.length - this->_segment_position);
 		if (bytes_to_read > 0)
 		{
-			chunk = std::string(FileResponse::CHUNK_SIZE, '\0');
-
-			this->_file_stream.read(chunk.data(), bytes_to_read);
-			this->_bytes_read = this->_file_stream.gcount();
-			this->_total_bytes_read += this->_bytes_read;
+			auto chunk = this->_read_file(segment.offset + this->_segment_position, bytes_to_read);
+			if (!chunk.empty())
+			{
+				this->_segment_position += chunk.size();
+				this->_bytes_read = chunk.size();
+				this->_total_bytes_read += chunk.size();
+				return chunk;
+			}
 		}
+
+		this->_segment_index++;
+		this->_segment_position = 0;
+		this->_segment_prefix_is_sent = false;
 	}
 
-	return chunk.substr(0, this->_bytes_read);
+	this->_bytes_read = 0;
+	return {};
 }
 
-void FileResponse::_set_headers()
+std::optional<FileResponse::Part> FileResponse::get_next_part()
 {
-	auto encoding_map = std::map<std::string, std::string>({
-		{"bzip2", "application/x-bzip"},
-		{"gzip", "application/gzip"},
-		{"xz", "application/x-xz"}
-	});
-	this->set_header(CONTENT_LENGTH, std::to_string(path::get_size(this->_file_path)));
-	if (this->get_header(CONTENT_TYPE, "").starts_with("text/html"))
+	if (!this->_headers_is_got)
+	{
+		this->_headers_is_got = true;
+		this->chunk_buffer = this->_get_headers_chunk();
+		return Part{.prefix = this->chunk_buffer, .offset = 0, .length = 0};
+	}
+
+	if (this->_segment_index == this->_segments.size())
+	{
+		this->_bytes_read = 0;
+		return std::nullopt;
+	}
+
+	const auto& segment = this->_segments[this->_segment_index++];
+	this->_bytes_read = segment.prefix.size() + segment.length;
+	this->_total_bytes_read += segment.length;
+	return Part{.prefix = segment.prefix, .offset = segment.offset, .length = segment.length};
+}
+
+void FileResponse::set_ranges(const std::vector<ByteRange>& ranges)
+{
+	if (this->_headers_is_got)
+	{
+		throw RuntimeError("ranges should be set before the response is sent", _ERROR_DETAILS_);
+	}
+
+	if (ranges.empty())
 	{
-		std::string content_type, encoding;
-		mime::guess_content_type(this->_file_path, content_type, encoding);
-		if (encoding_map.contains(encoding))
+		throw ArgumentError("at least one range is required", _ERROR_DETAILS_);
+	}
+
+	auto total_size = "/" + std::to_string(this->_file_size);
+	auto content_range = [&total_size](const ByteRange& range) -> std::string
+	{
+		return "bytes " + std::to_string(range.first) + "-" + std::to_string(range.last) + total_size;
+	};
+
+	this->_segments.clear();
+	for (const auto& range : ranges)
+	{
+		if (range.first > range.last || range.last >= this->_file_size)
 		{
-			content_type = encoding_map.at(encoding);
+			throw ArgumentError("range '" + content_range(range) + "' is not satisfiable", _ERROR_DETAILS_);
 		}
 
-		this->set_header(CONTENT_TYPE, !content_type.empty() ? content_type : "application/octet-stream");
+		this->_segments.push_back(Segment{.prefix = "", .offset = range.first, .length = range.length()});
+	}
+
+	this->status = 206;
+	this->reason_phrase = "";
+	if (ranges.size() == 1)
+	{
+		this->set_header(CONTENT_RANGE, content_range(ranges.front()));
+		return;
+	}
+
+	char boundary[17];
+	auto random_value = std::mt19937_64(std::random_device{}())();
+	std::snprintf(boundary, sizeof(boundary), "%016llx", (unsigned long long)random_value);
+	auto part_content_type = this->_get_file_content_type();
+	for (size_t i = 0; i < ranges.size(); i++)
+	{
+		this->_segments[i].prefix = (i > 0 ? "\r\n--" : "--") + std::string(boundary) + "\r\n" +
+			CONTENT_TYPE + ": " + part_content_type + "\r\n" +
+			CONTENT_RANGE + ": " + content_range(ranges[i]) + "\r\n\r\n";
+	}
+
+	this->_segments.push_back(Segment{
+		.prefix = "\r\n--" + std::string(boundary) + "--\r\n", .offset = 0, .length = 0
+	});
+	this->remove_header(CONTENT_RANGE);
+	this->set_header(CONTENT_TYPE, std::string(mime::MULTIPART_BYTERANGES) + "; boundary=" + boundary);
+}
+
+void FileResponse::_set_headers()
+{
+	size_t content_length = 0;
+	for (const auto& segment : this->_segments)
+	{
+		content_length += segment.prefix.size() + segment.length;
+	}
+
+	this->set_header(CONTENT_LENGTH, std::to_string(content_length));
+	this->set_header(ACCEPT_RANGES, "bytes");
+	if (this->get_header(CONTENT_TYPE, "").starts_with("text/html"))
+	{
+		this->set_header(CONTENT_TYPE, this->_get_file_content_type());
 	}
 
 	std::string disposition = this->_as_attachment ? "attachment" : "inline";
@@ -235,6 +347,29 @@ void FileResponse::_set_headers()
 	this->set_header(CONTENT_DISPOSITION, disposition + "; " + file_expr);
 }
 
+std::string FileResponse::_get_file_content_type() const
+{
+	auto content_type = this->get_header(CONTENT_TYPE, "");
+	if (!content_type.starts_with("text/html"))
+	{
+		return content_type;
+	}
+
+	auto encoding_map = std::map<std::string, std::string>({
+		{"bzip2", "application/x-bzip"},
+		{"gzip", "application/gzip"},
+		{"xz", "application/x-xz"}
+	});
+	std::string guessed_content_type, encoding;
+	mime::guess_content_type(this->_file_path, guessed_content_type, encoding);
+	if (encoding_map.contains(encoding))
+	{
+		guessed_content_type = encoding_map.at(encoding);
+	}
+
+	return !guessed_content_type.empty() ? guessed_content_type : mime::APPLICATION_OCTET_STREAM;
+}
+
 std::string FileResponse::_get_headers_chunk()
 {
 	auto reason_phrase = this->get_reason_phrase();
@@ -247,6 +382,62 @@ std::string FileResponse::_get_headers_chunk()
 	return headers_chunk;
 }
 
+std::string_view FileResponse::_read_file(size_t offset, size_t length)
+{
+	if (!this->_is_mapping_tried)
+	{
+		this->_is_mapping_tried = true;
+		if (this->_file_size <= FileResponse::MAX_MAPPED_FILE_SIZE)
+		{
+			auto* mapped_file = ::mmap(nullptr, this->_file_size, PROT_READ, MAP_PRIVATE, this->_file_descriptor, 0);
+			if (mapped_file != MAP_FAILED)
+			{
+				::posix_madvise(mapped_file, this->_file_size, POSIX_MADV_SEQUENTIAL);
+				this->_mapped_file = (const char*)mapped_file;
+			}
+		}
+	}
+
+	if (this->_mapped_file)
+	{
+		// Access to pages of the mapping beyond the end of the file raises
+		// SIGBUS, so if the file was truncated, the mapping is dropped and
+		// the rest is read by 'pread()' which stops at the end of the file.
+		struct stat file_info{};
+		if (::fstat(this->_file_descriptor, &file_info) == 0 && (size_t)file_info.st_size >= offset + length)
+		{
+			return {this->_mapped_file + offset, length};
+		}
+
+		::munmap((void*)this->_mapped_file, this->_file_size);
+		this->_mapped_file = nullptr;
+	}
+
+	if (this->_file_descriptor < 0)
+	{
+		return {};
+	}
+
+	this->chunk_buffer.resize(length);
+	auto bytes_read = ::pread(this->_file_descriptor, this->chunk_buffer.data(), length, (off_t)offset);
+	return {this->chunk_buffer.data(), bytes_read > 0 ? (size_t)bytes_read : 0};
+}
+
+void FileResponse::_close_file()
+{
+	if (this->_mapped_file)
+	{
+		::munmap((void*)this->_mapped_file, this->_file_size);
+		this->_mapped_file = nullptr;
+	}
+
+	if (this->_file_descriptor >= 0)
+	{
+		::close(this->_file_descriptor);
+		this->_file_descriptor = -1;
+	}
+}
+
 RedirectBase::RedirectBase(
 	const std::string& redirect_to,
 	unsigned short int status,
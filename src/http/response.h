@@ -10,9 +10,10 @@
 
 // C++ libraries.
 #include <set>
-#include <fstream>
 #include <memory>
 #include <map>
+#include <optional>
+#include <string_view>
 
 // Base libraries.
 #include <xalwart.base/exceptions.h>
@@ -24,7 +25,9 @@
 // Framework libraries.
 #include "./interfaces.h"
 #include "./headers.h"
+#include "./header_map.h"
 #include "./exceptions.h"
+#include "./utility.h"
 #include "./mime/content_types.h"
 
 
@@ -32,7 +35,7 @@ __HTTP_BEGIN__
 
 // TESTME: ResponseBase
 // TODO: docs for 'ResponseBase'
-// An HTTP response base class with dictionary-accessed headers.
+// An HTTP response base class with case-insensitive headers.
 class AbstractResponse : public IResponse
 {
 public:
@@ -45,25 +48,18 @@ public:
 	[[nodiscard]]
 	inline std::string get_header(const std::string& key, const std::string& default_value) const final
 	{
-		return this->has_header(key) ? this->headers.at(key) : default_value;
+		auto value = this->headers.find(key);
+		return value ? *value : default_value;
 	}
 
 	inline void set_header(const std::string& key, const std::string& value) final
 	{
-		if (this->has_header(key))
-		{
-			this->headers[key] = value;
-		}
-
-		this->headers.insert(std::make_pair(key, value));
+		this->headers.set(key, value);
 	}
 
 	inline void remove_header(const std::string& key) final
 	{
-		if (this->has_header(key))
-		{
-			this->headers.erase(key);
-		}
+		this->headers.erase(key);
 	}
 
 	[[nodiscard]]
@@ -72,6 +68,12 @@ public:
 		return this->headers.contains(key);
 	}
 
+	[[nodiscard]]
+	inline const HeaderMap& get_headers() const
+	{
+		return this->headers;
+	}
+
 	void set_cookie(const Cookie& cookie) final;
 
 	void set_signed_cookie(const std::string& secret_key, const std::string& salt, const Cookie& cookie) final;
@@ -144,7 +146,7 @@ public:
 	}
 
 protected:
-	std::map<std::string, std::string> headers;
+	HeaderMap headers;
 	std::map<std::string, Cookie> cookies;
 	bool closed;
 	unsigned short int status;
@@ -200,6 +202,57 @@ public:
 	}
 
 	std::string serialize() override;
+
+	ResponseSlices serialize_slices() override;
+
+	// Replaces the body which is sent with `content` encoded by `encoding`,
+	// for example, compressed by 'middleware::Compression'. Content of the
+	// response itself is not changed, so 'get_content()' still returns
+	// the original content.
+	inline void set_encoded_content(std::string content, const std::string& encoding)
+	{
+		this->encoded_content = std::move(content);
+		this->set_header(CONTENT_ENCODING, encoding);
+	}
+
+	[[nodiscard]]
+	inline bool has_encoded_content() const
+	{
+		return this->encoded_content.has_value();
+	}
+
+	// Returns view into serialized content without copying it
+	// when it is possible, see 'content_view()'.
+	[[nodiscard]]
+	inline std::string_view get_content_view()
+	{
+		return this->content_view();
+	}
+
+	// Returns view into the body which is sent: encoded
+	// content if it is set, otherwise the content.
+	[[nodiscard]]
+	inline std::string_view get_body_view()
+	{
+		return this->encoded_content ? std::string_view(*this->encoded_content) : this->content_view();
+	}
+
+protected:
+	// Keeps serialized content when derived class does not hold it as string.
+	std::string content_buffer;
+
+	// Body which is sent instead of content, see 'set_encoded_content()'.
+	std::optional<std::string> encoded_content;
+
+	// Returns view into content which stays valid until response is changed
+	// or destroyed. By default, the result of 'get_content()' is kept in
+	// 'content_buffer', override it if content is already stored as string.
+	[[nodiscard]]
+	virtual inline std::string_view content_view()
+	{
+		this->content_buffer = this->get_content();
+		return this->content_buffer;
+	}
 };
 
 // TESTME: Response
@@ -253,6 +306,62 @@ public:
 
 protected:
 	std::string content;
+
+	[[nodiscard]]
+	inline std::string_view content_view() override
+	{
+		return this->content;
+	}
+};
+
+// TESTME: SharedContentResponse
+// An HTTP response class with immutable content which is shared with
+// other responses (for example, cached files) and is never copied.
+class SharedContentResponse : public BaseResponse
+{
+public:
+	explicit SharedContentResponse(
+		std::shared_ptr<const std::string> content,
+		unsigned short int status=200,
+		const std::string& content_type="",
+		const std::string& reason="",
+		const std::string& charset=""
+	) : BaseResponse(status, content_type, reason, charset), shared_content(std::move(content))
+	{
+		require_non_null(this->shared_content.get(), "'content' is nullptr", _ERROR_DETAILS_);
+	}
+
+	[[nodiscard]]
+	inline size_t content_length() const override
+	{
+		return this->shared_content->size();
+	}
+
+	// Replaces shared content with own copy of `new_content`.
+	inline void set_content(const std::string& new_content) override
+	{
+		this->shared_content = std::make_shared<const std::string>(new_content);
+	}
+
+	[[nodiscard]]
+	inline std::string get_content() const override
+	{
+		return *this->shared_content;
+	}
+
+	inline void write(const std::string& data) override
+	{
+		this->set_content(*this->shared_content + data);
+	}
+
+protected:
+	std::shared_ptr<const std::string> shared_content;
+
+	[[nodiscard]]
+	inline std::string_view content_view() override
+	{
+		return *this->shared_content;
+	}
 };
 
 // TESTME: JsonResponse
@@ -280,20 +389,28 @@ public:
 	{
 	}
 
+	[[nodiscard]]
+	inline size_t content_length() const override
+	{
+		return this->dumped_content().size();
+	}
+
 	inline void set_content(const std::string& content) override
 	{
 		this->json_content = nlohmann::json::parse(content);
+		this->dumped_json_content.reset();
 	}
 
 	inline void set_content(const nlohmann::json& data)
 	{
 		this->json_content = data;
+		this->dumped_json_content.reset();
 	}
 
 	[[nodiscard]]
 	inline std::string get_content() const override
 	{
-		return this->json_content.dump();
+		return this->dumped_content();
 	}
 
 	[[nodiscard]]
@@ -317,10 +434,32 @@ public:
 		}
 
 		this->json_content.push_back(data);
+		this->dumped_json_content.reset();
 	}
 
 protected:
 	nlohmann::json json_content;
+
+	// JSON content is dumped once and reused for computing of
+	// length, ETag and for sending until content is changed.
+	mutable std::optional<std::string> dumped_json_content;
+
+	[[nodiscard]]
+	inline const std::string& dumped_content() const
+	{
+		if (!this->dumped_json_content)
+		{
+			this->dumped_json_content = this->json_content.dump();
+		}
+
+		return *this->dumped_json_content;
+	}
+
+	[[nodiscard]]
+	inline std::string_view content_view() override
+	{
+		return this->dumped_content();
+	}
 };
 
 // TESTME: StreamingResponse
@@ -372,11 +511,44 @@ public:
 		);
 	}
 
+	inline ResponseSlices serialize_slices() final
+	{
+		throw RuntimeError(
+			"This 'xw::http::StreamingResponse' or its child instance cannot be serialized", _ERROR_DETAILS_
+		);
+	}
+
 	virtual std::string get_chunk() = 0;
+
+	// Returns the next chunk as a view which is valid until the next call,
+	// an empty view means the end of the stream. By default, the result of
+	// 'get_chunk()' is kept in 'chunk_buffer', override it to avoid copying.
+	virtual inline std::string_view get_chunk_view()
+	{
+		this->chunk_buffer = this->get_chunk();
+		return this->chunk_buffer;
+	}
+
+protected:
+	std::string chunk_buffer;
 };
 
 // TESTME: FileResponse
 // TODO: docs for 'FileResponse'
+//
+// File which is not larger than 'MAX_MAPPED_FILE_SIZE' is mapped into
+// memory when the first chunk is requested, and chunks are returned as
+// views into the mapping, so file content is not copied into strings when
+// the response is sent using 'get_chunk_view()'. Larger files are read by
+// chunks with 'pread()'. A writer which sends ranges of the file by itself
+// uses 'get_next_part()' instead, then the file is neither read nor mapped.
+//
+// The size of the mapped file is checked before each chunk, so a file
+// which is truncated while it is sent is read with 'pread()' and the body
+// ends early instead of crashing the process with SIGBUS. The file must
+// not be truncated while the returned view is in use.
+//
+// Response can be restricted to ranges of file using 'set_ranges()'.
 class FileResponse final : public StreamingResponse
 {
 public:
@@ -389,8 +561,48 @@ public:
 		const std::string& charset=""
 	);
 
+	FileResponse(const FileResponse&) = delete;
+
+	FileResponse& operator=(const FileResponse&) = delete;
+
+	~FileResponse() override;
+
 	std::string get_chunk() override;
 
+	std::string_view get_chunk_view() override;
+
+	// Text which is followed by the range of the file in the response.
+	struct Part
+	{
+		std::string_view prefix;
+		size_t offset;
+		size_t length;
+	};
+
+	// Returns the head of the response as the prefix of the first part,
+	// then parts of the body, or 'std::nullopt' after the last one. Ranges
+	// of 'file_descriptor()' are not read, so the writer can send them
+	// by 'sendfile()'. Should not be mixed with 'get_chunk_view()'.
+	std::optional<Part> get_next_part();
+
+	[[nodiscard]]
+	inline int file_descriptor() const
+	{
+		return this->_file_descriptor;
+	}
+
+	// Restricts the response to the given satisfiable ranges of file (see
+	// 'http::parse_range()') and sets 206 status code. A single range is
+	// sent as is, multiple ranges are sent as 'multipart/byteranges' body.
+	// Should be called before the first chunk is requested.
+	void set_ranges(const std::vector<ByteRange>& ranges);
+
+	[[nodiscard]]
+	inline size_t file_size() const
+	{
+		return this->_file_size;
+	}
+
 	inline void flush() override
 	{
 	}
@@ -404,7 +616,7 @@ public:
 	[[nodiscard]]
 	inline bool seekable() const override
 	{
-		return false;
+		return true;
 	}
 
 	[[nodiscard]]
@@ -416,11 +628,12 @@ public:
 	void close() override
 	{
 		StreamingResponse::close();
-		this->_file_stream.close();
+		this->_close_file();
 	}
 
 private:
 	static const size_t CHUNK_SIZE = 1024 * 1024;   // 1 mb per chunk
+	static const size_t MAX_MAPPED_FILE_SIZE = 64 * 1024 * 1024;
 
 	bool _as_attachment;
 	std::string _file_path;
@@ -428,14 +641,41 @@ private:
 	size_t _bytes_read;
 	size_t _total_bytes_read;
 	size_t _file_size;
-	std::ifstream _file_stream;
+	int _file_descriptor;
+
+	// Whole file mapped into memory, nullptr if file is not mapped yet,
+	// is empty, is too large, was truncated or can not be mapped, in
+	// these cases chunks are read into 'chunk_buffer'.
+	const char* _mapped_file;
+	bool _is_mapping_tried;
 
 	// Identifies whether headers where read or not.
 	bool _headers_is_got;
 
+	// Part of response body: text which is sent before
+	// the range of file.
+	struct Segment
+	{
+		std::string prefix;
+		size_t offset;
+		size_t length;
+	};
+
+	std::vector<Segment> _segments;
+	size_t _segment_index;
+	size_t _segment_position;
+	bool _segment_prefix_is_sent;
+
 	void _set_headers();
 
+	[[nodiscard]]
+	std::string _get_file_content_type() const;
+
 	std::string _get_headers_chunk();
+
+	std::string_view _read_file(size_t offset, size_t length);
+
+	void _close_file();
 };
 
 // TESTME: RedirectBase
@@ -569,6 +809,19 @@ public:
 	}
 };
 
+// TESTME: RangeNotSatisfiable
+// TODO: docs for 'RangeNotSatisfiable'
+class RangeNotSatisfiable : public Response
+{
+public:
+	inline explicit RangeNotSatisfiable(
+		size_t size, const std::string& content="", const std::string& content_type="", const std::string& charset=""
+	) : Response(content, 416, content_type, "", charset)
+	{
+		this->set_header(http::CONTENT_RANGE, "bytes */" + std::to_string(size));
+	}
+};
+
 // TESTME: ServerError
 // TODO: docs for 'ServerError'
 class ServerError : public Response
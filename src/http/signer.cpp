@@ -6,13 +6,32 @@
 
 #include "./signer.h"
 
+// C++ libraries.
+#include <unordered_map>
+
 // Base libraries.
 #include <xalwart.base/exceptions.h>
-#include <xalwart.base/string_utils.h>
+
+// Crypto libraries.
+#include <openssl/crypto.h>
 
 
 __HTTP_BEGIN__
 
+// Count of default algorithms which are kept by each thread.
+inline constexpr size_t _MAX_THREAD_ALGORITHMS = 64;
+
+// Equivalent of 'SEP_UNSAFE_REGEX' for a single character.
+inline bool _is_unsafe_separator(char sep)
+{
+	return (sep >= 'A' && sep <= 'z') || (sep >= '0' && sep <= '9') || sep == '-' || sep == '_' || sep == '=';
+}
+
+bool constant_time_equals(std::string_view left, std::string_view right)
+{
+	return left.size() == right.size() && CRYPTO_memcmp(left.data(), right.data(), left.size()) == 0;
+}
+
 Signer::Signer(const std::string& key, char sep, const std::string& salt)
 {
 	if (key.empty())
@@ -23,8 +42,7 @@ Signer::Signer(const std::string& key, char sep, const std::string& salt)
 	this->_key = key;
 	this->_sep = sep;
 	this->_str_sep = std::string(1, this->_sep);
-	auto sep_unsafe_regex = SEP_UNSAFE_REGEX;
-	if (sep_unsafe_regex.match(this->_str_sep))
+	if (_is_unsafe_separator(this->_sep))
 	{
 		throw ValueError(
 			"Unsafe Signer separator: " + this->_str_sep + " (cannot be empty or consist of only A-z0-9-_=)",
@@ -33,35 +51,86 @@ Signer::Signer(const std::string& key, char sep, const std::string& salt)
 	}
 
 	this->_salt = salt.empty() ? "xw::util::crypto::Signer" : salt;
+
+	// The same key is derived by 'salted_hmac_hex_digest()'.
+	auto hash_function = _get_default_algorithm("")->get_digest_function();
+	this->_salted_key = hash_function(this->_salt + "signer" + this->_key);
 }
 
 std::string Signer::signature(const std::string& value, crypto::ISignatureAlgorithm* algorithm) const
 {
-	std::unique_ptr<crypto::ISignatureAlgorithm> default_algorithm = nullptr;
-	if (!algorithm)
+	if (algorithm)
 	{
-		default_algorithm = _get_default_algorithm("");
+		return salted_hmac_hex_digest(this->_salt + "signer", value, this->_key, algorithm);
 	}
 
-	return salted_hmac_hex_digest(
-		this->_salt + "signer", value, this->_key, algorithm ? algorithm : default_algorithm.get()
-	);
+	return this->_default_algorithm().sign_to_hex(value);
 }
 
-std::string Signer::unsign(const std::string& signed_value, crypto::ISignatureAlgorithm* algorithm)
+std::string Signer::unsign(const std::string& signed_value, crypto::ISignatureAlgorithm* algorithm) const
 {
 	if (signed_value.find(this->_sep) == std::string::npos)
 	{
 		throw BadSignature("no '" + this->_str_sep + "' found in value", _ERROR_DETAILS_);
 	}
 
-	auto value_sig = str::rsplit(signed_value, this->_sep, 1);
-	if (value_sig[1] == this->signature(value_sig[0], algorithm))
+	auto value = this->_unsign(signed_value, algorithm);
+	if (!value)
+	{
+		throw BadSignature("signature '" + this->_str_sep + "' does not match", _ERROR_DETAILS_);
+	}
+
+	return std::move(*value);
+}
+
+std::vector<std::optional<std::string>> Signer::unsign_all(
+	const std::vector<std::string>& signed_values, crypto::ISignatureAlgorithm* algorithm
+) const
+{
+	std::vector<std::optional<std::string>> result;
+	result.reserve(signed_values.size());
+	for (const auto& signed_value : signed_values)
+	{
+		result.push_back(this->_unsign(signed_value, algorithm));
+	}
+
+	return result;
+}
+
+crypto::ISignatureAlgorithm& Signer::_default_algorithm() const
+{
+	thread_local std::unordered_map<std::string, std::unique_ptr<crypto::ISignatureAlgorithm>> algorithms;
+	auto algorithm = algorithms.find(this->_salted_key);
+	if (algorithm == algorithms.end())
+	{
+		if (algorithms.size() >= _MAX_THREAD_ALGORITHMS)
+		{
+			algorithms.clear();
+		}
+
+		algorithm = algorithms.emplace(this->_salted_key, _get_default_algorithm(this->_salted_key)).first;
+	}
+
+	return *algorithm->second;
+}
+
+std::optional<std::string> Signer::_unsign(
+	std::string_view signed_value, crypto::ISignatureAlgorithm* algorithm
+) const
+{
+	auto position = signed_value.rfind(this->_sep);
+	if (position == std::string_view::npos)
+	{
+		return std::nullopt;
+	}
+
+	auto value = std::string(signed_value.substr(0, position));
+	if (!constant_time_equals(signed_value.substr(position + 1), this->signature(value, algorithm)))
 	{
-		return value_sig[0];
+		return std::nullopt;
 	}
 
-	throw BadSignature("signature '" + this->_str_sep + "' does not match", _ERROR_DETAILS_);
+	return value;
 }
 
 std::string salted_hmac_hex_digest(
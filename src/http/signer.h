@@ -8,6 +8,12 @@
 
 #pragma once
 
+// C++ libraries.
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
 // Base libraries.
 #include <xalwart.base/re/regex.h>
 
@@ -23,8 +29,15 @@ __HTTP_BEGIN__
 
 inline static const re::Regex SEP_UNSAFE_REGEX = re::Regex(R"([A-z0-9-_=]*)");
 
+// TESTME: constant_time_equals
+// Compares strings in time which depends only on their sizes,
+// so signatures can not be guessed byte by byte.
+extern bool constant_time_equals(std::string_view left, std::string_view right);
+
 // TESTME: Signer
-// TODO: docs for 'Signer'
+// Signs values with 'HMAC' of the key which is derived from the salt and
+// the secret key. The key is derived once when the signer is created and
+// the default algorithm which is keyed with it is reused by each thread.
 class Signer final
 {
 public:
@@ -39,13 +52,37 @@ public:
 		return value + this->_sep + this->signature(value, algorithm);
 	}
 
-	std::string unsign(const std::string& signed_value, crypto::ISignatureAlgorithm* algorithm=nullptr);
+	// Returns the value without signature or throws 'BadSignature'.
+	[[nodiscard]]
+	std::string unsign(const std::string& signed_value, crypto::ISignatureAlgorithm* algorithm=nullptr) const;
+
+	// Returns the value without signature for each of `signed_values`,
+	// or `std::nullopt` if the signature does not match.
+	[[nodiscard]]
+	std::vector<std::optional<std::string>> unsign_all(
+		const std::vector<std::string>& signed_values, crypto::ISignatureAlgorithm* algorithm=nullptr
+	) const;
 
 private:
 	std::string _key;
 	char _sep;
 	std::string _str_sep;
 	std::string _salt;
+
+	// Key of the default algorithm, see 'salted_hmac_hex_digest()'.
+	std::string _salted_key;
+
+	// Returns the default algorithm of the current thread which
+	// is keyed with '_salted_key'.
+	[[nodiscard]]
+	crypto::ISignatureAlgorithm& _default_algorithm() const;
+
+	// Returns `std::nullopt` if the separator is missing
+	// or the signature does not match.
+	[[nodiscard]]
+	std::optional<std::string> _unsign(
+		std::string_view signed_value, crypto::ISignatureAlgorithm* algorithm
+	) const;
 };
 
 // TESTME: _get_default_algorithm
@@ -6,9 +6,238 @@
 
 #include "./url.h"
 
+// C++ libraries.
+#include <array>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 // Base libraries.
 #include <xalwart.base/exceptions.h>
-#include <xalwart.base/encoding.h>
+
+
+__HTTP_INTERNAL_BEGIN__
+
+inline constexpr bool _compute_should_escape(unsigned char c, EscapeMode mode)
+{
+	// §2.3 Unreserved characters (alphanum)
+	if ('a' <= c && c <= 'z' || 'A' <= c && c <= 'Z' || '0' <= c && c <= '9')
+	{
+		return false;
+	}
+
+	if (mode == EscapeMode::EncodeHost || mode == EscapeMode::EncodeZone)
+	{
+		// §3.2.2 Host allows
+		// sub-delims = "!" / "$" / "&" / "'" / "(" / ")" / "*" / "+" / "," / ";" / "="
+		// as part of reg-name.
+		// We add : because we include :port as part of host.
+		// We add [ ] because we include [ipv6]:port as part of host.
+		// We add < > because they're the only characters left that
+		// we could possibly allow, and Parse will reject them if we
+		// escape them (because hosts can't use %-encoding for
+		// ASCII bytes).
+		switch (c)
+		{
+			case '!':
+			case '$':
+			case '&':
+			case '\'':
+			case '(':
+			case ')':
+			case '*':
+			case '+':
+			case ',':
+			case ';':
+			case '=':
+			case ':':
+			case '[':
+			case ']':
+			case '<':
+			case '>':
+			case '"':
+				return false;
+		}
+	}
+
+	switch (c)
+	{
+		// §2.3 Unreserved characters (mark)
+		case '-':
+		case '_':
+		case '.':
+		case '~':
+			return false;
+
+		// §2.2 Reserved characters (reserved)
+		case '$':
+		case '&':
+		case '+':
+		case ',':
+		case '/':
+		case ':':
+		case ';':
+		case '=':
+		case '?':
+		case '@':
+			// Different sections of the URL allow a few of
+			// the reserved characters to appear unescaped.
+			switch (mode)
+			{
+				case EscapeMode::EncodePath: // §3.3
+					// The RFC allows : @ & = + $ but saves / ; , for assigning
+					// meaning to individual path segments. This package
+					// only manipulates the path as a whole, so we allow those
+					// last three as well. That leaves only ? to escape.
+					return c == '?';
+				case EscapeMode::EncodePathSegment: // §3.3
+					// The RFC allows : @ & = + $ but saves / ; , for assigning
+					// meaning to individual path segments.
+					return c == '/' || c == ';' || c == ',' || c == '?';
+				case EscapeMode::EncodeUserPassword: // §3.2.1
+					// The RFC allows ';', ':', '&', '=', '+', '$', and ',' in
+					// userinfo, so we must escape only '@', '/', and '?'.
+					// The parsing of userinfo treats ':' as special so we must escape
+					// that too.
+					return c == '@' || c == '/' || c == '?' || c == ':';
+				case EscapeMode::EncodeQueryComponent: // §3.4
+					// The RFC reserves (so we must escape) everything.
+					return true;
+				case EscapeMode::EncodeFragment: // §4.1
+					// The RFC text is silent but the grammar allows
+					// everything, so escape nothing.
+					return false;
+				default:
+					break;
+			}
+	}
+
+	if (mode == EscapeMode::EncodeFragment)
+	{
+		// RFC 3986 §2.2 allows not escaping sub-delims. A subset of sub-delims are
+		// included in reserved from RFC 2396 §2.2. The remaining sub-delims do not
+		// need to be escaped. To minimize potential breakage, we apply two restrictions:
+		// (1) we always escape sub-delims outside of the fragment, and (2) we always
+		// escape single quote to avoid breaking callers that had previously assumed that
+		// single quotes would be escaped. See issue #19917.
+		switch (c)
+		{
+			case '!':
+			case '(':
+			case ')':
+			case '*':
+				return false;
+		}
+	}
+
+	// Everything else must be escaped.
+	return true;
+}
+
+inline constexpr size_t _ESCAPE_MODES_COUNT = (size_t)EscapeMode::EncodePathSegment + 1;
+
+// Bit of each mode is set for bytes which must be escaped in this mode.
+inline constexpr auto _ESCAPE_TABLE = []()
+{
+	std::array<unsigned char, 256> table{};
+	for (size_t c = 0; c < table.size(); c++)
+	{
+		for (size_t mode = 0; mode < _ESCAPE_MODES_COUNT; mode++)
+		{
+			if (_compute_should_escape((unsigned char)c, (EscapeMode)mode))
+			{
+				table[c] |= (unsigned char)(1 << mode);
+			}
+		}
+	}
+
+	return table;
+}();
+
+inline bool _should_escape(unsigned char c, EscapeMode mode)
+{
+	return (_ESCAPE_TABLE[c] >> (size_t)mode) & 1;
+}
+
+inline constexpr unsigned char _NOT_HEX = 0xFF;
+
+inline constexpr auto _HEX_VALUES = []()
+{
+	std::array<unsigned char, 256> table{};
+	table.fill(_NOT_HEX);
+	for (unsigned char c = 0; c < 10; c++)
+	{
+		table['0' + c] = c;
+	}
+
+	for (unsigned char c = 0; c < 6; c++)
+	{
+		table['a' + c] = 10 + c;
+		table['A' + c] = 10 + c;
+	}
+
+	return table;
+}();
+
+inline unsigned char _unhex(char c)
+{
+	return _HEX_VALUES[(unsigned char)c];
+}
+
+// Returns position of the first '%', or '+' if `with_plus` is set,
+// starting from `position`, or size of `s` if there are none. Blocks
+// of 16 bytes are checked at once where SSE2 is available.
+inline size_t _find_escape(std::string_view s, size_t position, bool with_plus)
+{
+	// Escapes often follow each other.
+	if (position < s.size() && (s[position] == '%' || (with_plus && s[position] == '+')))
+	{
+		return position;
+	}
+
+#if defined(__SSE2__) && defined(__GNUC__)
+	const auto percents = _mm_set1_epi8('%');
+	const auto pluses = _mm_set1_epi8(with_plus ? '+' : '%');
+	for (; position + 16 <= s.size(); position += 16)
+	{
+		auto block = _mm_loadu_si128((const __m128i*)(s.data() + position));
+		auto mask = _mm_movemask_epi8(_mm_or_si128(
+			_mm_cmpeq_epi8(block, percents), _mm_cmpeq_epi8(block, pluses)
+		));
+		if (mask != 0)
+		{
+			return position + __builtin_ctz((unsigned int)mask);
+		}
+	}
+#endif
+	for (; position < s.size(); position++)
+	{
+		if (s[position] == '%' || (with_plus && s[position] == '+'))
+		{
+			return position;
+		}
+	}
+
+	return s.size();
+}
+
+// Returns `true` if `s` is not changed neither by unescaping nor by
+// escaping in `mode`, which is the case for most of paths.
+inline bool _is_plain(std::string_view s, EscapeMode mode)
+{
+	return std::none_of(s.begin(), s.end(), [mode](unsigned char c) -> bool
+	{
+		return c == '%' || _should_escape(c, mode);
+	});
+}
+
+inline char _to_lower(char c)
+{
+	return c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
+}
+
+__HTTP_INTERNAL_END__
 
 
 __HTTP_BEGIN__
@@ -36,26 +265,28 @@ std::string Query::encode() const
 	return buf;
 }
 
-Query parse_query(std::string query)
+Query parse_query(std::string_view query)
 {
+	// The rest of query is not copied for each parameter,
+	// only the key and the value are.
 	Query m;
 	while (!query.empty())
 	{
 		auto key = query;
 		auto i = key.find('&');
-		if (i == std::string::npos)
+		if (i == std::string_view::npos)
 		{
 			i = key.find(';');
 		}
 
-		if (i != std::string::npos)
+		if (i != std::string_view::npos)
 		{
 			query = key.substr(i + 1);
 			key = key.substr(0, i);
 		}
 		else
 		{
-			query = "";
+			query = {};
 		}
 
 		if (key.empty())
@@ -63,17 +294,15 @@ Query parse_query(std::string query)
 			continue;
 		}
 
-		std::string value;
+		std::string_view value;
 		i = key.find('=');
-		if (i != std::string::npos)
+		if (i != std::string_view::npos)
 		{
 			value = key.substr(i + 1);
 			key = key.substr(0, i);
 		}
 
-		key = query_unescape(std::string(key));
-		value = query_unescape(value);
-		m.add(std::string(key), value);
+		m.add(query_unescape(key), query_unescape(value));
 	}
 
 	return m;
@@ -81,6 +310,13 @@ Query parse_query(std::string query)
 
 void URL::set_path(const std::string& p)
 {
+	if (internal::_is_plain(p, internal::EscapeMode::EncodePath))
+	{
+		this->path = p;
+		this->raw_path.clear();
+		return;
+	}
+
 	this->path = internal::unescape(p, internal::EscapeMode::EncodePath);
 	this->raw_path = p == internal::escape(this->path, internal::EscapeMode::EncodePath) ? "" : p;
 }
@@ -112,6 +348,13 @@ std::string URL::escaped_path() const
 
 void URL::set_fragment(const std::string& f)
 {
+	if (internal::_is_plain(f, internal::EscapeMode::EncodeFragment))
+	{
+		this->fragment = f;
+		this->raw_fragment.clear();
+		return;
+	}
+
 	this->fragment = internal::unescape(f, internal::EscapeMode::EncodeFragment);
 	this->raw_fragment = f == internal::escape(this->fragment, internal::EscapeMode::EncodeFragment) ? "" : f;
 }
@@ -285,16 +528,16 @@ std::string URL::request_uri() const
 	return result;
 }
 
-URL parse_url(const std::string& raw_url)
+URL parse_url(std::string_view raw_url)
 {
-	auto [string_url, fragment] = internal::split(raw_url, '#', true);
-	auto url = internal::parse_url(str::string_to_wstring(string_url), false);
-	if (fragment.empty())
+	auto i = raw_url.find('#');
+	auto url = internal::parse_url(raw_url.substr(0, i), false);
+	if (i == std::string_view::npos || i + 1 == raw_url.size())
 	{
 		return url;
 	}
 
-	url.set_fragment(fragment);
+	url.set_fragment(std::string(raw_url.substr(i + 1)));
 	return url;
 }
 
@@ -341,126 +584,15 @@ std::pair<std::string, std::string> split_host_port(const std::string& host_port
 
 bool should_escape(unsigned char c, EscapeMode mode)
 {
-	// §2.3 Unreserved characters (alphanum)
-	if ('a' <= c && c <= 'z' || 'A' <= c && c <= 'Z' || '0' <= c && c <= '9')
-	{
-		return false;
-	}
-
-	if (mode == EscapeMode::EncodeHost || mode == EscapeMode::EncodeZone)
-	{
-		// §3.2.2 Host allows
-		// sub-delims = "!" / "$" / "&" / "'" / "(" / ")" / "*" / "+" / "," / ";" / "="
-		// as part of reg-name.
-		// We add : because we include :port as part of host.
-		// We add [ ] because we include [ipv6]:port as part of host.
-		// We add < > because they're the only characters left that
-		// we could possibly allow, and Parse will reject them if we
-		// escape them (because hosts can't use %-encoding for
-		// ASCII bytes).
-		switch (c)
-		{
-			case '!':
-			case '$':
-			case '&':
-			case '\'':
-			case '(':
-			case ')':
-			case '*':
-			case '+':
-			case ',':
-			case ';':
-			case '=':
-			case ':':
-			case '[':
-			case ']':
-			case '<':
-			case '>':
-			case '"':
-				return false;
-		}
-	}
-
-	switch (c)
-	{
-		// §2.3 Unreserved characters (mark)
-		case '-':
-		case '_':
-		case '.':
-		case '~':
-			return false;
-
-		// §2.2 Reserved characters (reserved)
-		case '$':
-		case '&':
-		case '+':
-		case ',':
-		case '/':
-		case ':':
-		case ';':
-		case '=':
-		case '?':
-		case '@':
-			// Different sections of the URL allow a few of
-			// the reserved characters to appear unescaped.
-			switch (mode)
-			{
-				case EscapeMode::EncodePath: // §3.3
-					// The RFC allows : @ & = + $ but saves / ; , for assigning
-					// meaning to individual path segments. This package
-					// only manipulates the path as a whole, so we allow those
-					// last three as well. That leaves only ? to escape.
-					return c == '?';
-				case EscapeMode::EncodePathSegment: // §3.3
-					// The RFC allows : @ & = + $ but saves / ; , for assigning
-					// meaning to individual path segments.
-					return c == '/' || c == ';' || c == ',' || c == '?';
-				case EscapeMode::EncodeUserPassword: // §3.2.1
-					// The RFC allows ';', ':', '&', '=', '+', '$', and ',' in
-					// userinfo, so we must escape only '@', '/', and '?'.
-					// The parsing of userinfo treats ':' as special so we must escape
-					// that too.
-					return c == '@' || c == '/' || c == '?' || c == ':';
-				case EscapeMode::EncodeQueryComponent: // §3.4
-					// The RFC reserves (so we must escape) everything.
-					return true;
-				case EscapeMode::EncodeFragment: // §4.1
-					// The RFC text is silent but the grammar allows
-					// everything, so escape nothing.
-					return false;
-				default:
-					break;
-			}
-	}
-
-	if (mode == EscapeMode::EncodeFragment)
-	{
-		// RFC 3986 §2.2 allows not escaping sub-delims. A subset of sub-delims are
-		// included in reserved from RFC 2396 §2.2. The remaining sub-delims do not
-		// need to be escaped. To minimize potential breakage, we apply two restrictions:
-		// (1) we always escape sub-delims outside of the fragment, and (2) we always
-		// escape single quote to avoid breaking callers that had previously assumed that
-		// single quotes would be escaped. See issue #19917.
-		switch (c)
-		{
-			case '!':
-			case '(':
-			case ')':
-			case '*':
-				return false;
-		}
-	}
-
-	// Everything else must be escaped.
-	return true;
+	return _should_escape(c, mode);
 }
 
-std::string escape(const std::string& string, EscapeMode mode)
+std::string escape(std::string_view string, EscapeMode mode)
 {
-	unsigned int space_count = 0, hex_count = 0;
+	size_t space_count = 0, hex_count = 0;
 	for (unsigned char c : string)
 	{
-		if (should_escape(c, mode))
+		if (_should_escape(c, mode))
 		{
 			if (c == ' ' && mode == EscapeMode::EncodeQueryComponent)
 			{
@@ -475,163 +607,145 @@ std::string escape(const std::string& string, EscapeMode mode)
 
 	if (space_count == 0 && hex_count == 0)
 	{
-		return string;
+		return std::string(string);
 	}
 
-	auto required = string.size() + 2 * hex_count;
-	auto* t = new char[required];
-	t[required] = '\0';
-	try
+	std::string result;
+	result.reserve(string.size() + 2 * hex_count);
+	for (unsigned char c : string)
 	{
-		if (hex_count == 0)
+		if (c == ' ' && mode == EscapeMode::EncodeQueryComponent)
 		{
-			for (size_t i = 0; i < string.size(); i++)
-			{
-				t[i] = string[i] == ' ' ? '+' : string[i];
-			}
-
-			auto result = std::string(t);
-			delete[] t;
-			return result;
+			result += '+';
 		}
-
-		size_t j = 0;
-		for (unsigned char c : string)
+		else if (_should_escape(c, mode))
 		{
-			if (c == ' ' && mode == EscapeMode::EncodeQueryComponent)
-			{
-				t[j] = '+';
-				j++;
-			}
-			else if (should_escape(c, mode))
-			{
-				t[j] = '%';
-				t[j + 1] = UPPER_HEX[c >> 4];
-				t[j + 2] = UPPER_HEX[c & 15];
-				j += 3;
-			}
-			else
-			{
-				t[j] = (unsigned char)c;
-				j++;
-			}
+			result += '%';
+			result += UPPER_HEX[c >> 4];
+			result += UPPER_HEX[c & 15];
+		}
+		else
+		{
+			result += (char)c;
 		}
-
-		auto result = std::string(t);
-		delete[] t;
-		return result;
 	}
-	catch (const std::exception& exc)
+
+	return result;
+}
+
+// Throws 'EscapeError' if '%' at `i` is not followed by two hex digits.
+inline void _check_escape(std::string_view s, size_t i)
+{
+	if (i + 2 >= s.size() || _unhex(s[i + 1]) == _NOT_HEX || _unhex(s[i + 2]) == _NOT_HEX)
 	{
-		delete[] t;
-		throw exc;
+		throw EscapeError(std::string(s.substr(i, 3)), _ERROR_DETAILS_);
 	}
 }
 
-std::string unescape(std::string s, EscapeMode mode)
+std::string unescape(std::string_view s, EscapeMode mode)
 {
+	bool is_query = mode == EscapeMode::EncodeQueryComponent;
+
 	// Count %, check that they're well-formed.
 	size_t n = 0;
 	bool has_plus = false;
-	for (size_t i = 0; i < s.size(); i++)
+	if (mode == EscapeMode::EncodeHost || mode == EscapeMode::EncodeZone)
 	{
-		switch (s[i])
+		for (size_t i = 0; i < s.size();)
 		{
-			case '%':
-				n++;
-				if (i + 2 >= s.size() || !encoding::is_hex(s[i + 1]) || !encoding::is_hex(s[i + 2]))
+			if (s[i] != '%')
+			{
+				if ((unsigned char)s[i] < 0x80 && _should_escape(s[i], mode))
 				{
-					s = s.substr(i);
-					if (s.size() > 3)
-					{
-						s = s.substr(0, 3);
-					}
-
-					throw EscapeError(s, _ERROR_DETAILS_);
+					throw EscapeError("invalid host: " + std::string(s.substr(i, 1)), _ERROR_DETAILS_);
 				}
 
-				// Per https://tools.ietf.org/html/rfc3986#page-21
-				// in the host component %-encoding can only be used
-				// for non-ASCII bytes.
-				// But https://tools.ietf.org/html/rfc6874#section-2
-				// introduces %25 being allowed to escape a percent sign
-				// in IPv6 scoped-address literals. Yay.
-				if (mode == EscapeMode::EncodeHost && encoding::unhex(s[i + 1]) < 8 && s.substr(i, 3) != "%25")
-				{
-					throw EscapeError(s.substr(i, 3), _ERROR_DETAILS_);
-				}
+				i++;
+				continue;
+			}
 
-				if (mode == EscapeMode::EncodeZone)
-				{
-					// RFC 6874 says basically "anything goes" for zone identifiers
-					// and that even non-ASCII can be redundantly escaped,
-					// but it seems prudent to restrict %-escaped bytes here to those
-					// that are valid host name bytes in their unescaped form.
-					// That is, you can use escaping in the zone identifier but not
-					// to introduce bytes you couldn't just write directly.
-					// But Windows puts spaces here! Yay.
-					auto v = (encoding::unhex(s[i + 1]) << 4) | encoding::unhex(s[i + 2]);
-					if (s.substr(i, 3) != "%25" && v != ' ' && should_escape(v, EscapeMode::EncodeHost))
-					{
-						throw EscapeError(s.substr(i, 3), _ERROR_DETAILS_);
-					}
-				}
+			n++;
+			_check_escape(s, i);
+
+			// Per https://tools.ietf.org/html/rfc3986#page-21
+			// in the host component %-encoding can only be used
+			// for non-ASCII bytes.
+			// But https://tools.ietf.org/html/rfc6874#section-2
+			// introduces %25 being allowed to escape a percent sign
+			// in IPv6 scoped-address literals. Yay.
+			auto escaped = s.substr(i, 3);
+			if (mode == EscapeMode::EncodeHost && _unhex(s[i + 1]) < 8 && escaped != "%25")
+			{
+				throw EscapeError(std::string(escaped), _ERROR_DETAILS_);
+			}
 
-				i += 3;
-				break;
-			case '+':
-				has_plus = mode == EscapeMode::EncodeQueryComponent;
-				i++;
-				break;
-			default:
-				if (
-					(mode == EscapeMode::EncodeHost || mode == EscapeMode::EncodeZone) &&
-					(unsigned char)s[i] < 0x80 && should_escape(s[i], mode)
-				)
+			if (mode == EscapeMode::EncodeZone)
+			{
+				// RFC 6874 says basically "anything goes" for zone identifiers
+				// and that even non-ASCII can be redundantly escaped,
+				// but it seems prudent to restrict %-escaped bytes here to those
+				// that are valid host name bytes in their unescaped form.
+				// That is, you can use escaping in the zone identifier but not
+				// to introduce bytes you couldn't just write directly.
+				// But Windows puts spaces here! Yay.
+				auto v = (unsigned char)(_unhex(s[i + 1]) << 4 | _unhex(s[i + 2]));
+				if (escaped != "%25" && v != ' ' && _should_escape(v, EscapeMode::EncodeHost))
 				{
-					throw EscapeError("invalid host: " + s.substr(i, 1), _ERROR_DETAILS_);
+					throw EscapeError(std::string(escaped), _ERROR_DETAILS_);
 				}
+			}
 
+			i += 3;
+		}
+	}
+	else
+	{
+		// Other bytes are not checked, so they are skipped in blocks.
+		for (auto i = _find_escape(s, 0, is_query); i < s.size(); i = _find_escape(s, i, is_query))
+		{
+			if (s[i] == '%')
+			{
+				n++;
+				_check_escape(s, i);
+				i += 3;
+			}
+			else
+			{
+				has_plus = true;
 				i++;
-				break;
+			}
 		}
 	}
 
 	if (n == 0 && !has_plus)
 	{
-		return s;
+		return std::string(s);
 	}
 
+	// Runs of bytes between escapes are copied as they are.
 	std::string t;
 	t.reserve(s.size() - 2 * n);
-	for (size_t i = 0; i < s.size(); i++)
+	size_t start = 0;
+	for (auto i = _find_escape(s, 0, is_query); i < s.size(); i = _find_escape(s, start, is_query))
 	{
-		switch (s[i])
+		t.append(s.data() + start, i - start);
+		if (s[i] == '%')
 		{
-			case '%':
-				t += (char)(encoding::unhex(s[i + 1]) << 4 | encoding::unhex(s[i + 2]));
-				i += 2;
-				break;
-			case '+':
-				if (mode == EscapeMode::EncodeQueryComponent)
-				{
-					t += ' ';
-				}
-				else
-				{
-					t += '+';
-				}
-				break;
-			default:
-				t += s[i];
-				break;
+			t += (char)(_unhex(s[i + 1]) << 4 | _unhex(s[i + 2]));
+			start = i + 3;
+		}
+		else
+		{
+			t += ' ';
+			start = i + 1;
 		}
 	}
 
+	t.append(s.data() + start, s.size() - start);
 	return t;
 }
 
-bool valid_encoded(const std::string& s, EscapeMode mode)
+bool valid_encoded(std::string_view s, EscapeMode mode)
 {
 	for (char c : s)
 	{
@@ -665,7 +779,7 @@ bool valid_encoded(const std::string& s, EscapeMode mode)
 				// ok - percent encoded, will decode
 				break;
 			default:
-				if (should_escape(c, mode))
+				if (_should_escape(c, mode))
 				{
 					return false;
 				}
@@ -693,7 +807,7 @@ std::pair<std::string, std::string> split(const std::string& s, char sep, bool c
 	return {s.substr(0, i), s.substr(i)};
 }
 
-std::pair<std::wstring, std::wstring> get_scheme(const std::wstring& raw_url)
+std::pair<std::string_view, std::string_view> get_scheme(std::string_view raw_url)
 {
 	for (size_t i = 0; i < raw_url.size(); i++)
 	{
@@ -706,7 +820,7 @@ std::pair<std::wstring, std::wstring> get_scheme(const std::wstring& raw_url)
 		{
 			if (i == 0)
 			{
-				return {L"", raw_url};
+				return {{}, raw_url};
 			}
 		}
 		else if (c == ':')
@@ -722,11 +836,11 @@ std::pair<std::wstring, std::wstring> get_scheme(const std::wstring& raw_url)
 		{
 			// we have encountered an invalid character,
 			// so there is no valid scheme
-			return {L"", raw_url};
+			return {{}, raw_url};
 		}
 	}
 
-	return {L"", raw_url};
+	return {{}, raw_url};
 }
 
 std::string parse_host(std::string host)
@@ -921,7 +1035,7 @@ std::pair<URL::UserInfo, std::string> parse_authority(const std::string& authori
 	return {user, host};
 }
 
-URL parse_url(const std::wstring& raw_url, bool via_request)
+URL parse_url(std::string_view raw_url, bool via_request)
 {
 	if (string_contains_ctl_byte(raw_url))
 	{
@@ -934,7 +1048,7 @@ URL parse_url(const std::wstring& raw_url, bool via_request)
 	}
 
 	URL url;
-	if (raw_url == L"*")
+	if (raw_url == "*")
 	{
 		url.path = "*";
 		return url;
@@ -943,17 +1057,21 @@ URL parse_url(const std::wstring& raw_url, bool via_request)
 	// Split off possible leading "http:", "mailto:", etc.
 	// Cannot contain escaped characters.
 	auto [scheme, rest] = get_scheme(raw_url);
-	url.scheme = str::wstring_to_string(str::to_lower(scheme));
-	if (rest.ends_with(L"?") && std::count(rest.begin(),  rest.end(), '?') == 1)
+	url.scheme.resize(scheme.size());
+	std::transform(scheme.begin(), scheme.end(), url.scheme.begin(), _to_lower);
+	if (rest.ends_with('?') && std::count(rest.begin(), rest.end(), '?') == 1)
 	{
 		url.force_query = true;
-		rest = rest.substr(0, rest.size() - 1);
+		rest.remove_suffix(1);
 	}
 	else
 	{
-		auto [new_rest, raw_query] = split(str::wstring_to_string(rest), '?', true);
-		rest = str::string_to_wstring(new_rest);
-		url.raw_query = raw_query;
+		auto i = rest.find('?');
+		if (i != std::string_view::npos)
+		{
+			url.raw_query = rest.substr(i + 1);
+			rest = rest.substr(0, i);
+		}
 	}
 
 	if (!rest.starts_with('/'))
@@ -961,7 +1079,7 @@ URL parse_url(const std::wstring& raw_url, bool via_request)
 		if (!url.scheme.empty())
 		{
 			// We consider rootless paths per RFC 3986 as opaque.
-			url.opaque = str::wstring_to_string(rest);
+			url.opaque = rest;
 			return url;
 		}
 
@@ -978,17 +1096,18 @@ URL parse_url(const std::wstring& raw_url, bool via_request)
 		// in which case the first path segment cannot contain a colon (":") character.
 		auto colon = rest.find(':');
 		auto slash = rest.find('/');
-		if (colon != std::string::npos && (slash == std::string::npos || colon < slash))
+		if (colon != std::string_view::npos && (slash == std::string_view::npos || colon < slash))
 		{
 			throw ParseError("first path segment in URL cannot contain colon", _ERROR_DETAILS_);
 		}
 	}
 
-	if ((!url.scheme.empty() || !via_request && !rest.starts_with(L"///")) && rest.starts_with(L"//"))
+	if ((!url.scheme.empty() || !via_request && !rest.starts_with("///")) && rest.starts_with("//"))
 	{
-		auto [authority, new_rest] = split(str::wstring_to_string(rest.substr(2)), '/', false);
-		rest = str::string_to_wstring(new_rest);
-		auto [user, host] = parse_authority(authority);
+		auto authority = rest.substr(2);
+		auto slash = authority.find('/');
+		rest = slash != std::string_view::npos ? authority.substr(slash) : std::string_view();
+		auto [user, host] = parse_authority(std::string(authority.substr(0, slash)));
 		url.user = user;
 		url.host = host;
 	}
@@ -997,7 +1116,7 @@ URL parse_url(const std::wstring& raw_url, bool via_request)
 	// 'raw_path' is a hint of the encoding of 'path'. We don't want to set it if
 	// the default escaping of 'path' is equivalent, to help make sure that people
 	// don't rely on it in general.
-	url.set_path(str::wstring_to_string(rest));
+	url.set_path(std::string(rest));
 	return url;
 }
 
@@ -17,6 +17,7 @@
 
 // C++ libraries.
 #include <string>
+#include <string_view>
 
 // Base libraries.
 #include <xalwart.base/collections/multimap.h>
@@ -45,21 +46,23 @@ enum class EscapeMode
 // TESTME: should_escape
 // Return true if the specified character should be escaped when
 // appearing in a URL string, according to RFC 3986.
+//
+// Answers are precomputed for all bytes and modes at compile time.
 extern bool should_escape(unsigned char c, EscapeMode mode);
 
 // TESTME: escape
-extern std::string escape(const std::string& string, EscapeMode mode);
+extern std::string escape(std::string_view string, EscapeMode mode);
 
 // TESTME: unescape
 // Unescapes a string; the mode specifies
 // which section of the URL string is being unescaped.
-extern std::string unescape(std::string string, EscapeMode mode);
+extern std::string unescape(std::string_view string, EscapeMode mode);
 
 // TESTME: valid_encoded
 // Checks whether 's' is a valid encoded path or fragment,
 // according to mode. It must not contain any bytes that
 // require escaping during encoding.
-extern bool valid_encoded(const std::string& s, EscapeMode mode);
+extern bool valid_encoded(std::string_view s, EscapeMode mode);
 
 // TESTME: split
 // Splits 's' into two substrings separated by the first occurrence of
@@ -68,11 +71,12 @@ extern bool valid_encoded(const std::string& s, EscapeMode mode);
 extern std::pair<std::string, std::string> split(const std::string& s, char sep, bool cut_sep=true);
 
 // TESTME: get_scheme
-extern std::pair<std::wstring, std::wstring> get_scheme(const std::wstring& raw_url);
+// Returns views into 'raw_url'.
+extern std::pair<std::string_view, std::string_view> get_scheme(std::string_view raw_url);
 
 // TESTME: string_contains_ctl_byte
 // Reports whether s contains any ASCII control character.
-inline bool string_contains_ctl_byte(const std::wstring& s)
+inline bool string_contains_ctl_byte(std::string_view s)
 {
 	return std::any_of(s.begin(), s.end(), [](unsigned char b) -> bool { return b < ' ' || b == 0x7f; });
 }
@@ -107,7 +111,7 @@ struct Query : public collections::Multimap<std::string, std::string>
 // TESTME: query_escape
 // 'query_escape' escapes the string so it can be safely placed
 // inside a URL query.
-inline std::string query_escape(const std::string& s)
+inline std::string query_escape(std::string_view s)
 {
 	return internal::escape(s, internal::EscapeMode::EncodeQueryComponent);
 }
@@ -118,7 +122,7 @@ inline std::string query_escape(const std::string& s)
 // hex-decoded byte 0xAB.
 // It throws an error if any % is not followed by two hexadecimal
 // digits.
-inline std::string query_unescape(const std::string& s)
+inline std::string query_unescape(std::string_view s)
 {
 	return internal::unescape(s, internal::EscapeMode::EncodeQueryComponent);
 }
@@ -133,7 +137,7 @@ inline std::string query_unescape(const std::string& s)
 // Query is expected to be a list of key=value settings separated by
 // ampersands or semicolons. A setting without an equals sign is
 // interpreted as a key set to an empty value.
-extern Query parse_query(std::string query);
+extern Query parse_query(std::string_view query);
 
 // TESTME: Url
 struct URL final
@@ -172,7 +176,7 @@ struct URL final
 	std::string host;
 	std::string path;
 	std::string raw_path;
-	bool force_query;
+	bool force_query = false;
 	std::string raw_query;
 	std::string fragment;
 	std::string raw_fragment;
@@ -277,7 +281,7 @@ struct URL final
 // (starting with a scheme). Trying to parse a hostname and path
 // without a scheme is invalid but may not necessarily return an
 // error, due to parsing ambiguities.
-URL parse_url(const std::string& raw_url);
+URL parse_url(std::string_view raw_url);
 
 __HTTP_END__
 
@@ -288,6 +292,8 @@ __HTTP_INTERNAL_BEGIN__
 extern std::pair<URL::UserInfo, std::string> parse_authority(const std::string& authority);
 
 // TESTME: parse
-extern URL parse_url(const std::wstring& raw_url, bool via_request);
+// Parses the URL without fragment byte by byte, no copy of
+// 'raw_url' is made except for the fields of the result.
+extern URL parse_url(std::string_view raw_url, bool via_request);
 
 __HTTP_INTERNAL_END__
@@ -6,6 +6,12 @@
 
 #include "./utility.h"
 
+// C++ libraries.
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <unordered_map>
+
 // Base libraries.
 #include <xalwart.base/string_utils.h>
 
@@ -86,6 +92,29 @@ void escape_leading_slashes(std::string& url)
 	}
 }
 
+// Salt of cookie signers includes the name of the cookie,
+// so the count of them is limited.
+inline constexpr size_t _MAX_THREAD_COOKIE_SIGNERS = 256;
+
+std::shared_ptr<const Signer> get_cookie_signer(const std::string& secret_key, const std::string& salt)
+{
+	thread_local std::unordered_map<std::string, std::shared_ptr<const Signer>> signers;
+	auto key = secret_key;
+	key.append(1, '\0').append(salt);
+	auto signer = signers.find(key);
+	if (signer == signers.end())
+	{
+		if (signers.size() >= _MAX_THREAD_COOKIE_SIGNERS)
+		{
+			signers.clear();
+		}
+
+		signer = signers.emplace(std::move(key), std::make_shared<const Signer>(secret_key, ':', salt)).first;
+	}
+
+	return signer->second;
+}
+
 long parse_http_date(const std::string& date)
 {
 	if (date.empty())
@@ -178,4 +207,171 @@ std::vector<std::string> parse_etags(const std::string& etag_str)
 	return result;
 }
 
+std::optional<std::vector<ByteRange>> parse_range(const std::string& header, size_t size)
+{
+	auto value = str::trim(header);
+	if (!value.starts_with("bytes="))
+	{
+		return std::nullopt;
+	}
+
+	auto parse_position = [](const std::string& position, size_t& result) -> bool
+	{
+		auto is_digit = [](char c) -> bool { return c >= '0' && c <= '9'; };
+		if (position.empty() || !std::all_of(position.begin(), position.end(), is_digit))
+		{
+			return false;
+		}
+
+		auto [_, error_code] = std::from_chars(position.data(), position.data() + position.size(), result);
+		return error_code == std::errc();
+	};
+
+	auto range_specs = str::split(value.substr(6), ',');
+	if (range_specs.size() > MAX_BYTE_RANGES)
+	{
+		return std::nullopt;
+	}
+
+	std::vector<ByteRange> ranges;
+	bool has_specs = false;
+	for (const auto& range_spec : range_specs)
+	{
+		auto spec = str::trim(range_spec);
+		if (spec.empty())
+		{
+			continue;
+		}
+
+		has_specs = true;
+		auto dash_pos = spec.find('-');
+		if (dash_pos == std::string::npos)
+		{
+			return std::nullopt;
+		}
+
+		auto first_str = spec.substr(0, dash_pos);
+		auto last_str = spec.substr(dash_pos + 1);
+		size_t first = 0, last = 0;
+		if (first_str.empty())
+		{
+			// Suffix range: the last N bytes.
+			if (!parse_position(last_str, last))
+			{
+				return std::nullopt;
+			}
+
+			if (last > 0 && size > 0)
+			{
+				ranges.push_back({.first = size - std::min(last, size), .last = size - 1});
+			}
+		}
+		else
+		{
+			if (!parse_position(first_str, first))
+			{
+				return std::nullopt;
+			}
+
+			if (last_str.empty())
+			{
+				last = size > 0 ? size - 1 : 0;
+			}
+			else if (!parse_position(last_str, last) || last < first)
+			{
+				return std::nullopt;
+			}
+
+			if (first < size)
+			{
+				ranges.push_back({.first = first, .last = std::min(last, size - 1)});
+			}
+		}
+	}
+
+	if (!has_specs)
+	{
+		return std::nullopt;
+	}
+
+	return ranges;
+}
+
+double get_encoding_quality(const std::string& accept_encoding, const std::string& coding)
+{
+	auto target = str::to_lower(coding);
+	std::optional<double> quality, any_quality;
+	for (const auto& item : str::split(accept_encoding, ','))
+	{
+		auto parameters = str::split(item, ';');
+		if (parameters.empty())
+		{
+			continue;
+		}
+
+		auto name = str::to_lower(str::trim(parameters[0]));
+		if (name.empty())
+		{
+			continue;
+		}
+
+		double item_quality = 1.0;
+		for (size_t i = 1; i < parameters.size(); i++)
+		{
+			auto parameter = str::trim(parameters[i]);
+			if (parameter.starts_with("q=") || parameter.starts_with("Q="))
+			{
+				char* end = nullptr;
+				auto value = parameter.substr(2);
+				item_quality = std::strtod(value.c_str(), &end);
+				if (value.empty() || end != value.c_str() + value.size())
+				{
+					item_quality = 0.0;
+				}
+
+				item_quality = std::clamp(item_quality, 0.0, 1.0);
+			}
+		}
+
+		// 'x-gzip' is an alias of 'gzip', see section 4.2.3 of RFC 7230.
+		if (name == target || (name == "x-gzip" && target == "gzip"))
+		{
+			quality = item_quality;
+		}
+		else if (name == "*")
+		{
+			any_quality = item_quality;
+		}
+	}
+
+	if (quality)
+	{
+		return *quality;
+	}
+
+	if (any_quality)
+	{
+		return *any_quality;
+	}
+
+	return target == "identity" ? 1.0 : 0.0;
+}
+
+std::string select_encoding(const std::string& accept_encoding, const std::vector<std::string>& available)
+{
+	std::string result;
+	double best_quality = 0.0;
+	for (const auto& coding : available)
+	{
+		auto quality = get_encoding_quality(accept_encoding, coding);
+		if (quality > best_quality)
+		{
+			best_quality = quality;
+			result = coding;
+		}
+	}
+
+	return result;
+}
+
 __HTTP_END__
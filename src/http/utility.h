@@ -13,6 +13,11 @@
 #include <xalwart.base/re/arg_regex.h>
 #include <xalwart.base/utility.h>
 
+// C++ libraries.
+#include <memory>
+#include <optional>
+#include <vector>
+
 // Module definitions.
 #include "./_def_.h"
 
@@ -103,13 +108,12 @@ extern bool is_same_domain(const std::string& host, const std::string& pattern);
 extern void escape_leading_slashes(std::string& url);
 
 // TESTME: get_cookie_signer
-// TODO: docs for 'get_cookie_signer'
-inline Signer get_cookie_signer(
+// Returns signer of cookies. Signers are kept by each thread, so the
+// key is not derived again for the same secret key and salt. The signer
+// is shared, so it outlives eviction of the thread's cached signers.
+extern std::shared_ptr<const Signer> get_cookie_signer(
 	const std::string& secret_key, const std::string& salt="xw::http::get_cookie_signer"
-)
-{
-	return Signer("" + secret_key, ':', salt);
-}
+);
 
 // TESTME: parse_http_date
 // Parse a date format as specified by HTTP RFC7231 section 7.1.1.1.
@@ -131,6 +135,50 @@ extern std::string quote_etag(const std::string& e_tag);
 // or {"*"} if all ETags should be matched.
 extern std::vector<std::string> parse_etags(const std::string& etag_str);
 
+// TESTME: ByteRange
+// Inclusive range of bytes of representation.
+struct ByteRange
+{
+	size_t first;
+	size_t last;
+
+	[[nodiscard]]
+	inline size_t length() const
+	{
+		return this->last - this->first + 1;
+	}
+
+	inline bool operator== (const ByteRange& other) const = default;
+};
+
+// Maximum number of ranges in Range header which are served,
+// header with more ranges is ignored.
+inline constexpr size_t MAX_BYTE_RANGES = 16;
+
+// TESTME: parse_range
+// Parse the value of Range header as defined in section 2.1 of RFC 7233
+// for representation of `size` bytes. Ranges are returned in the order
+// they are requested and are clipped to the representation.
+//
+// Return std::nullopt if the header is empty, malformed, uses unit other
+// than "bytes" or contains more than `MAX_BYTE_RANGES` ranges, so it must
+// be ignored. Return an empty vector if none of ranges is satisfiable.
+extern std::optional<std::vector<ByteRange>> parse_range(const std::string& header, size_t size);
+
+// TESTME: get_encoding_quality
+// Returns the quality value which is assigned to content coding in
+// Accept-Encoding header as defined in section 5.3.4 of RFC 7231.
+// Zero means that the coding is not acceptable. 'identity' coding
+// is acceptable unless it is explicitly excluded.
+extern double get_encoding_quality(const std::string& accept_encoding, const std::string& coding);
+
+// TESTME: select_encoding
+// Returns the content coding from `available` which has the highest
+// quality in Accept-Encoding header, or an empty string if none of them
+// is acceptable. Codings with equal quality are preferred in the order
+// they are given in `available`.
+extern std::string select_encoding(const std::string& accept_encoding, const std::vector<std::string>& available);
+
 __HTTP_END__
 
 
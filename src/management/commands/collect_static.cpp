@@ -0,0 +1,226 @@
+/**
+ * management/commands/collect_static.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./collect_static.h"
+
+// C++ libraries.
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Framework libraries.
+#include "../../controllers/static.h"
+#include "../../http/mime/media_type.h"
+#include "../../utility/compression.h"
+
+
+__MANAGEMENT_COMMANDS_BEGIN__
+
+inline bool _is_precompressed_file(const std::filesystem::path& file_path)
+{
+	auto extension = file_path.extension().string();
+	return std::any_of(
+		ctrl::PRECOMPRESSED_FILE_EXTENSIONS.begin(), ctrl::PRECOMPRESSED_FILE_EXTENSIONS.end(),
+		[&extension](const auto& item) -> bool { return item.second == extension; }
+	);
+}
+
+CollectStaticCommand::CollectStaticCommand(conf::Settings* settings) : Command(
+	"collect-static", "Collects static files into 'static.root' directory",
+	require_non_null(settings, "settings is nullptr", _ERROR_DETAILS_)->LOGGER
+)
+{
+	this->_settings = settings;
+}
+
+void CollectStaticCommand::add_flags()
+{
+	xw::cmd::Command::add_flags();
+	this->_source_flag = this->flag_set->make_string(
+		"s", "source", "", "Directory to copy static files from"
+	);
+	this->_compress_flag = this->flag_set->make_bool(
+		"z", "compress", false, "Write precompressed variants of text files next to them"
+	);
+	this->_workers_flag = this->flag_set->make_unsigned_long(
+		"w", "workers", std::max(std::thread::hardware_concurrency(), 1u), "Parallel workers count for compression"
+	);
+}
+
+bool CollectStaticCommand::handle()
+{
+	if (xw::cmd::Command::handle())
+	{
+		return true;
+	}
+
+	const auto& root = this->_settings->STATIC.ROOT;
+	if (root.empty())
+	{
+		throw CommandError("collect-static: 'static.root' is not set", _ERROR_DETAILS_);
+	}
+
+	auto source = this->_source_flag->get();
+	if (!source.empty())
+	{
+		if (!std::filesystem::is_directory(source))
+		{
+			throw CommandError("collect-static: '" + source + "' is not a directory", _ERROR_DETAILS_);
+		}
+
+		this->_collect(source, root);
+	}
+
+	if (this->_compress_flag->get())
+	{
+		if (!this->_workers_flag->valid())
+		{
+			throw CommandError(
+				this->_workers_flag->get_raw() + " is invalid workers count", _ERROR_DETAILS_
+			);
+		}
+
+		this->_compress(root, std::max(this->_workers_flag->get(), 1ul));
+	}
+
+	return true;
+}
+
+void CollectStaticCommand::_collect(const std::filesystem::path& source, const std::filesystem::path& root) const
+{
+	std::filesystem::create_directories(root);
+	std::filesystem::copy(
+		source, root,
+		std::filesystem::copy_options::recursive | std::filesystem::copy_options::update_existing
+	);
+	this->_settings->LOGGER->info("Static files are copied from '" + source.string() + "'");
+}
+
+void CollectStaticCommand::_compress(const std::filesystem::path& root, size_t workers_count) const
+{
+	std::vector<std::filesystem::path> files;
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(root))
+	{
+		if (entry.is_regular_file() && !_is_precompressed_file(entry.path()))
+		{
+			std::string content_type, encoding;
+			http::mime::guess_content_type(entry.path().string(), content_type, encoding);
+			if (encoding.empty() && util::compression::is_compressible(content_type))
+			{
+				files.push_back(entry.path());
+			}
+		}
+	}
+
+	std::atomic<size_t> next_file = 0;
+	std::atomic<size_t> written_files = 0;
+	std::mutex error_mutex;
+	std::string error;
+	auto worker = [&]() -> void
+	{
+		for (auto i = next_file++; i < files.size(); i = next_file++)
+		{
+			try
+			{
+				written_files += this->_compress_file(files[i]);
+			}
+			catch (const std::exception& exc)
+			{
+				std::lock_guard lock(error_mutex);
+				if (error.empty())
+				{
+					error = files[i].string() + ": " + exc.what();
+				}
+
+				next_file = files.size();
+			}
+		}
+	};
+
+	std::vector<std::thread> workers;
+	workers_count = std::min(workers_count, std::max(files.size(), (size_t)1));
+	for (size_t i = 1; i < workers_count; i++)
+	{
+		workers.emplace_back(worker);
+	}
+
+	worker();
+	for (auto& thread : workers)
+	{
+		thread.join();
+	}
+
+	if (!error.empty())
+	{
+		throw CommandError("collect-static: unable to compress " + error, _ERROR_DETAILS_);
+	}
+
+	this->_settings->LOGGER->info(
+		"Checked " + std::to_string(files.size()) + " files, " +
+		std::to_string(written_files.load()) + " precompressed files are written"
+	);
+}
+
+size_t CollectStaticCommand::_compress_file(const std::filesystem::path& file_path) const
+{
+	auto modification_time = std::filesystem::last_write_time(file_path);
+	std::string content;
+	size_t written_files = 0;
+	const auto& encodings = util::compression::supported_encodings();
+	for (const auto& [coding, extension] : ctrl::PRECOMPRESSED_FILE_EXTENSIONS)
+	{
+		if (std::find(encodings.begin(), encodings.end(), coding) == encodings.end())
+		{
+			continue;
+		}
+
+		auto variant_path = file_path.string() + extension;
+		std::error_code error_code;
+		auto variant_modification_time = std::filesystem::last_write_time(variant_path, error_code);
+		if (!error_code && variant_modification_time >= modification_time)
+		{
+			continue;
+		}
+
+		if (content.empty())
+		{
+			std::ifstream file(file_path, std::ios::binary);
+			content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		}
+
+		auto compressed = util::compression::compress(coding, content, util::compression::Level::Best);
+		if (compressed.size() >= content.size())
+		{
+			// Compression does not pay off, the stale variant must
+			// not be served instead of the file.
+			std::filesystem::remove(variant_path, error_code);
+			continue;
+		}
+
+		// The variant is written to temporary file and renamed, so it
+		// never is served partially written.
+		auto temporary_path = variant_path + ".tmp";
+		{
+			std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+			file.write(compressed.data(), (std::streamsize)compressed.size());
+			if (!file)
+			{
+				throw FileError("unable to write '" + temporary_path + "'", _ERROR_DETAILS_);
+			}
+		}
+
+		std::filesystem::rename(temporary_path, variant_path);
+		written_files++;
+	}
+
+	return written_files;
+}
+
+__MANAGEMENT_COMMANDS_END__
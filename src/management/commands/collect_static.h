@@ -0,0 +1,58 @@
+/**
+ * management/commands/collect_static.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Command to collect static files into 'static.root' directory.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <filesystem>
+#include <string>
+
+// Module definitions.
+#include "./_def_.h"
+
+// Framework libraries.
+#include "../../conf/settings.h"
+#include "../../commands/command.h"
+#include "../../commands/flags/default.h"
+
+
+__MANAGEMENT_COMMANDS_BEGIN__
+
+// TESTME: CollectStaticCommand
+// Copies files from source directory to 'static.root'. With '--compress'
+// flag writes precompressed '.br', '.zst' and '.gz' variants of text files
+// next to them, so 'StaticController' can serve them without compressing
+// on each request. Files are compressed in parallel.
+class CollectStaticCommand final : public xw::cmd::Command
+{
+public:
+	explicit CollectStaticCommand(conf::Settings* settings);
+
+protected:
+	void add_flags() final;
+
+	bool handle() final;
+
+private:
+	std::shared_ptr<xw::cmd::flags::StringFlag> _source_flag = nullptr;
+	std::shared_ptr<xw::cmd::flags::BoolFlag> _compress_flag = nullptr;
+	std::shared_ptr<xw::cmd::flags::UnsignedLongFlag> _workers_flag = nullptr;
+
+	conf::Settings* _settings = nullptr;
+
+	void _collect(const std::filesystem::path& source, const std::filesystem::path& root) const;
+
+	void _compress(const std::filesystem::path& root, size_t workers_count) const;
+
+	// Writes precompressed variants of the file which are missing or
+	// older than the file. Returns the number of written files.
+	[[nodiscard]]
+	size_t _compress_file(const std::filesystem::path& file_path) const;
+};
+
+__MANAGEMENT_COMMANDS_END__
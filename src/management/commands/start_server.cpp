@@ -15,13 +15,18 @@ __MANAGEMENT_COMMANDS_BEGIN__
 
 StartServerCommand::StartServerCommand(
 	conf::Settings* settings, std::function<net::StatusCode(
-		net::RequestContext*, const std::map<std::string, std::string>& /* environment */
-	)> handler
+		net::RequestContext*, const std::map<std::string, std::string>& /* environment */,
+		std::pmr::memory_resource* /* memory_resource */
+	)> handler,
+	std::function<util::Task<net::StatusCode>(
+		net::RequestContext*, const std::map<std::string, std::string>& /* environment */,
+		std::pmr::memory_resource* /* memory_resource */
+	)> async_handler
 ) : Command(
 		"start-server", "Starts a web application",
 		require_non_null(settings, "settings is nullptr", _ERROR_DETAILS_)->LOGGER
 	),
-	_handler_function(std::move(handler))
+	_handler_function(std::move(handler)), _async_handler_function(std::move(async_handler))
 {
 	this->_settings = settings;
 
@@ -39,6 +44,23 @@ StartServerCommand::StartServerCommand(
 	);
 }
 
+StartServerCommand::StartServerCommand(
+	conf::Settings* settings, const std::function<net::StatusCode(
+		net::RequestContext*, const std::map<std::string, std::string>& /* environment */
+	)>& handler
+) : StartServerCommand(
+		settings,
+		[handler](
+			net::RequestContext* context, const std::map<std::string, std::string>& environment,
+			std::pmr::memory_resource*
+		)
+		{
+			return handler(context, environment);
+		}
+	)
+{
+}
+
 Options StartServerCommand::get_options() const
 {
 	auto options = Command::get_options();
@@ -46,6 +68,8 @@ Options StartServerCommand::get_options() const
 	options.set("retries", std::to_string(this->_retries_count));
 	options.set("timeout_seconds", std::to_string(this->_timeout_seconds));
 	options.set("timeout_microseconds", std::to_string(this->_timeout_microseconds));
+	options.set("keep_alive_seconds", std::to_string(this->_keep_alive_seconds));
+	options.set("max_requests", std::to_string(this->_max_requests_count));
 	return options;
 }
 
@@ -62,7 +86,7 @@ void StartServerCommand::add_flags()
 		"p", "port", this->DEFAULT_PORT, "Server port"
 	);
 	this->_workers_flag = this->flag_set->make_unsigned_long(
-		"t", "workers", this->DEFAULT_WORKERS_COUNT, "Parallel workers count"
+		"t", "workers", this->DEFAULT_WORKERS_COUNT, "Parallel workers count, 0 means count of cores"
 	);
 	this->_timeout_seconds_flag = this->flag_set->make_unsigned_long(
 		"s", "timeout-seconds", this->DEFAULT_TIMEOUT_SECONDS, "Seconds timeout"
@@ -76,6 +100,14 @@ void StartServerCommand::add_flags()
 	this->_retries_count_flag = this->flag_set->make_unsigned_long(
 		"r", "retries", this->DEFAULT_RETRIES_COUNT, "Max retries count to bind socket"
 	);
+	this->_keep_alive_seconds_flag = this->flag_set->make_unsigned_long(
+		"k", "keep-alive-seconds", this->DEFAULT_KEEP_ALIVE_SECONDS,
+		"Seconds to wait for the next request over the connection, 0 disables persistent connections"
+	);
+	this->_max_requests_count_flag = this->flag_set->make_unsigned_long(
+		"q", "max-requests", this->DEFAULT_MAX_REQUESTS_COUNT,
+		"Max requests count per connection, 0 means no limit"
+	);
 }
 
 bool StartServerCommand::handle()
@@ -94,7 +126,9 @@ bool StartServerCommand::handle()
 	}
 
 	this->_parse_args();
-	auto server = this->_settings->build_server(this->_handler_function, this->get_options());
+	auto server = this->_settings->build_server(
+		this->_handler_function, this->_async_handler_function, this->get_options()
+	);
 	try
 	{
 		if (!server)
@@ -238,6 +272,26 @@ void StartServerCommand::_parse_args()
 	}
 
 	this->_retries_count = this->_retries_count_flag->get();
+
+	if (!this->_keep_alive_seconds_flag->valid())
+	{
+		throw CommandError(
+			"keep-alive seconds is not a valid positive integer: " + this->_keep_alive_seconds_flag->get_raw(),
+			_ERROR_DETAILS_
+		);
+	}
+
+	this->_keep_alive_seconds = this->_keep_alive_seconds_flag->get();
+
+	if (!this->_max_requests_count_flag->valid())
+	{
+		throw CommandError(
+			"max requests count is not a valid positive integer: " + this->_max_requests_count_flag->get_raw(),
+			_ERROR_DETAILS_
+		);
+	}
+
+	this->_max_requests_count = this->_max_requests_count_flag->get();
 }
 
 __MANAGEMENT_COMMANDS_END__
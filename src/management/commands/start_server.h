@@ -8,6 +8,9 @@
 
 #pragma once
 
+// C++ libraries.
+#include <memory_resource>
+
 // Base libraries.
 #include <xalwart.base/net/request_context.h>
 #include <xalwart.base/re/regex.h>
@@ -19,6 +22,7 @@
 #include "../../conf/settings.h"
 #include "../../commands/command.h"
 #include "../../commands/flags/default.h"
+#include "../../utility/task.h"
 
 
 __MANAGEMENT_COMMANDS_BEGIN__
@@ -30,8 +34,21 @@ class StartServerCommand : public xw::cmd::Command
 public:
 	explicit StartServerCommand(
 		conf::Settings* settings, std::function<net::StatusCode(
+			net::RequestContext*, const std::map<std::string, std::string>& /* environment */,
+			std::pmr::memory_resource* /* memory_resource */
+		)> handler,
+		std::function<util::Task<net::StatusCode>(
+			net::RequestContext*, const std::map<std::string, std::string>& /* environment */,
+			std::pmr::memory_resource* /* memory_resource */
+		)> async_handler=nullptr
+	);
+
+	// Deprecated, requests of `handler` are allocated
+	// from the default memory resource.
+	StartServerCommand(
+		conf::Settings* settings, const std::function<net::StatusCode(
 			net::RequestContext*, const std::map<std::string, std::string>& /* environment */
-		)> handler
+		)>& handler
 	);
 
 	// Returns command flags.
@@ -50,10 +67,18 @@ private:
 	const std::string DEFAULT_IPV4_HOST = "127.0.0.1";
 	const std::string DEFAULT_IPV6_HOST = "[::1]";
 	const uint16_t DEFAULT_PORT = 8000;
-	const size_t DEFAULT_WORKERS_COUNT = 16;
+
+	// It was 16 threads of the pool, which blocked on slow clients. Workers
+	// are event loops which never wait for a socket, so more of them than
+	// cores do not help: zero means a worker per core, see
+	// 'server::Config::workers'.
+	const size_t DEFAULT_WORKERS_COUNT = 0;
+
 	const size_t DEFAULT_TIMEOUT_SECONDS = 5;
 	const size_t DEFAULT_TIMEOUT_MICROSECONDS = 0;
 	const size_t DEFAULT_RETRIES_COUNT = 5;
+	const size_t DEFAULT_KEEP_ALIVE_SECONDS = 5;
+	const size_t DEFAULT_MAX_REQUESTS_COUNT = 1000;
 
 	std::string _host;
 	uint16_t _port = DEFAULT_PORT;
@@ -62,6 +87,8 @@ private:
 	size_t _timeout_seconds = DEFAULT_TIMEOUT_SECONDS;
 	size_t _timeout_microseconds = DEFAULT_TIMEOUT_MICROSECONDS;
 	size_t _retries_count = DEFAULT_RETRIES_COUNT;
+	size_t _keep_alive_seconds = DEFAULT_KEEP_ALIVE_SECONDS;
+	size_t _max_requests_count = DEFAULT_MAX_REQUESTS_COUNT;
 
 	std::shared_ptr<xw::cmd::flags::StringFlag> _addr_port_flag;
 	std::shared_ptr<xw::cmd::flags::StringFlag> _addr_flag;
@@ -71,15 +98,23 @@ private:
 	std::shared_ptr<xw::cmd::flags::UnsignedLongFlag> _timeout_microseconds_flag;
 	std::shared_ptr<xw::cmd::flags::BoolFlag> _use_ipv6_flag;
 	std::shared_ptr<xw::cmd::flags::UnsignedLongFlag> _retries_count_flag;
+	std::shared_ptr<xw::cmd::flags::UnsignedLongFlag> _keep_alive_seconds_flag;
+	std::shared_ptr<xw::cmd::flags::UnsignedLongFlag> _max_requests_count_flag;
 
 	re::Regex _ipv4_ipv6_port_regex;
 	re::Regex _ipv4_regex;
 	re::Regex _ipv6_regex;
 
 	std::function<net::StatusCode(
-		net::RequestContext*, const std::map<std::string, std::string>& /* environment */
+		net::RequestContext*, const std::map<std::string, std::string>& /* environment */,
+		std::pmr::memory_resource* /* memory_resource */
 	)> _handler_function;
 
+	std::function<util::Task<net::StatusCode>(
+		net::RequestContext*, const std::map<std::string, std::string>& /* environment */,
+		std::pmr::memory_resource* /* memory_resource */
+	)> _async_handler_function;
+
 	conf::Settings* _settings = nullptr;
 
 	void _parse_args();
@@ -9,6 +9,7 @@
 // Framework libraries.
 #include "./commands/start_server.h"
 #include "./commands/migrate.h"
+#include "./commands/collect_static.h"
 
 
 __MANAGEMENT_BEGIN__
@@ -16,7 +17,8 @@ __MANAGEMENT_BEGIN__
 void CoreModuleConfig::commands()
 {
 	this->command<cmd::MigrateCommand>(this->settings);
-	this->command<cmd::StartServerCommand>(this->settings, this->_handler_function);
+	this->command<cmd::StartServerCommand>(this->settings, this->_handler_function, this->_async_handler_function);
+	this->command<cmd::CollectStaticCommand>(this->settings);
 }
 
 __MANAGEMENT_END__
@@ -11,6 +11,7 @@
 // C++ libraries.
 #include <memory>
 #include <memory>
+#include <memory_resource>
 #include <string>
 
 // Base libraries.
@@ -21,6 +22,7 @@
 
 // Framework libraries.
 #include "../conf/module.h"
+#include "../utility/task.h"
 
 
 __MANAGEMENT_BEGIN__
@@ -31,14 +33,24 @@ class CoreModuleConfig final : public conf::ModuleConfig
 {
 private:
 	using HandlerFunction = std::function<net::StatusCode(
-		net::RequestContext*, const std::map<std::string, std::string>& /* environment */
+		net::RequestContext*, const std::map<std::string, std::string>& /* environment */,
+		std::pmr::memory_resource* /* memory_resource */
+	)>;
+
+	using AsyncHandlerFunction = std::function<util::Task<net::StatusCode>(
+		net::RequestContext*, const std::map<std::string, std::string>& /* environment */,
+		std::pmr::memory_resource* /* memory_resource */
 	)>;
 
 	HandlerFunction _handler_function;
+	AsyncHandlerFunction _async_handler_function;
 
 public:
-	explicit CoreModuleConfig(conf::Settings* settings, HandlerFunction handler) :
-		ModuleConfig("xw::mgmt::CoreModuleConfig", settings), _handler_function(std::move(handler))
+	explicit CoreModuleConfig(
+		conf::Settings* settings, HandlerFunction handler, AsyncHandlerFunction async_handler=nullptr
+	) :
+		ModuleConfig("xw::mgmt::CoreModuleConfig", settings),
+		_handler_function(std::move(handler)), _async_handler_function(std::move(async_handler))
 	{
 	}
 
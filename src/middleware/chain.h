@@ -0,0 +1,61 @@
+/**
+ * middleware/chain.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Composition of middleware list into single function.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <vector>
+
+// Module definitions.
+#include "./_def_.h"
+
+// Framework libraries.
+#include "./types.h"
+
+
+__MIDDLEWARE_BEGIN__
+
+// TESTME: build_chain
+// Wraps `handler` into `middleware` in reverse order, so the first item
+// of `middleware` is the first to process the request and the last to
+// process the response. Empty handlers are skipped.
+//
+// Each middleware is copied into the chain, so the chain should be built
+// once and reused instead of being built for every request.
+inline Function build_chain(const std::vector<Handler>& middleware, Function handler)
+{
+	for (auto it = middleware.rbegin(); it != middleware.rend(); it++)
+	{
+		if (*it)
+		{
+			handler = (*it)(handler);
+		}
+	}
+
+	return handler;
+}
+
+// TESTME: build_async_chain
+// The same as 'build_chain()' for asynchronous handler. Middleware
+// without asynchronous implementation waits for the rest of the chain.
+//
+// Tasks returned by the chain refer to it, so the chain must outlive them.
+inline AsyncFunction build_async_chain(const std::vector<Handler>& middleware, AsyncFunction handler)
+{
+	for (auto it = middleware.rbegin(); it != middleware.rend(); it++)
+	{
+		if (*it)
+		{
+			handler = (*it)(handler);
+		}
+	}
+
+	return handler;
+}
+
+__MIDDLEWARE_END__
@@ -16,21 +16,34 @@ Function XFrameOptions::operator() (const Function& next) const
 {
 	return [*this, next](http::IRequest* request) -> std::unique_ptr<http::IResponse>
 	{
-		auto response = next(request);
-
-		// Set it if it's not already in the response.
-		if (!response->has_header(http::X_FRAME_OPTIONS))
-		{
-			require_non_null(
-				response.get(),
-				"Got nullptr response in '" + std::string(NAME) +
-				"' middleware while setting " + std::string(http::X_FRAME_OPTIONS)
-			);
-			response->set_header(http::X_FRAME_OPTIONS, this->get_x_frame_options_value(request, response.get()));
-		}
-
-		return response;
+		return this->process_response(request, next(request));
 	};
 }
 
+AsyncFunction XFrameOptions::operator() (const AsyncFunction& next) const
+{
+	return [*this, next](http::IRequest* request) -> util::Task<std::unique_ptr<http::IResponse>>
+	{
+		co_return this->process_response(request, co_await next(request));
+	};
+}
+
+std::unique_ptr<http::IResponse> XFrameOptions::process_response(
+	http::IRequest* request, std::unique_ptr<http::IResponse> response
+) const
+{
+	// Set it if it's not already in the response.
+	if (!response->has_header(http::X_FRAME_OPTIONS))
+	{
+		require_non_null(
+			response.get(),
+			"Got nullptr response in '" + std::string(NAME) +
+			"' middleware while setting " + std::string(http::X_FRAME_OPTIONS)
+		);
+		response->set_header(http::X_FRAME_OPTIONS, this->get_x_frame_options_value(request, response.get()));
+	}
+
+	return response;
+}
+
 __MIDDLEWARE_END__
@@ -45,6 +45,8 @@ public:
 
 	virtual Function operator() (const Function& next) const;
 
+	virtual AsyncFunction operator() (const AsyncFunction& next) const;
+
 	// Get the value to set for the X-Frame-Options header. Use the value from
 	// the `setting->get_x_frame_options()` result.
 	//
@@ -56,6 +58,12 @@ public:
 	{
 		return this->settings->X_FRAME_OPTIONS.to_string();
 	}
+
+protected:
+	// Sets the X-Frame-Options header if it is not set yet.
+	virtual std::unique_ptr<http::IResponse> process_response(
+		http::IRequest* request, std::unique_ptr<http::IResponse> response
+	) const;
 };
 
 __MIDDLEWARE_END__
@@ -39,18 +39,48 @@ Function Common::operator() (const Function& next) const
 	};
 }
 
+AsyncFunction Common::operator() (const AsyncFunction& next) const
+{
+	return [*this, next](http::IRequest* request) -> util::Task<std::unique_ptr<http::IResponse>>
+	{
+		auto response = this->preprocess(request);
+		if (response)
+		{
+			co_return std::move(response);
+		}
+
+		response = co_await next(request);
+		auto postprocess_response = this->postprocess(request, response.get());
+		if (postprocess_response)
+		{
+			co_return std::move(postprocess_response);
+		}
+
+		co_return std::move(response);
+	};
+}
+
 bool Common::should_redirect_with_slash(http::IRequest* request) const
 {
 	const auto& request_url = request->url();
 	if (this->settings->APPEND_SLASH && !request_url.path.ends_with("/"))
 	{
-		return !urls::is_valid_path(request_url.path, this->settings->URLPATTERNS) &&
-			urls::is_valid_path(request_url.path + "/", this->settings->URLPATTERNS);
+		return !this->is_valid_path(request_url.path) && this->is_valid_path(request_url.path + "/");
 	}
 
 	return false;
 }
 
+bool Common::is_valid_path(const std::string& path) const
+{
+	if (this->settings->ROUTER)
+	{
+		return urls::is_valid_path(path, *this->settings->ROUTER);
+	}
+
+	return urls::is_valid_path(path, this->settings->URLPATTERNS);
+}
+
 std::string Common::get_full_path_with_slash(http::IRequest* request) const
 {
 	auto new_path = request->url().full_path(true);
@@ -44,6 +44,8 @@ public:
 
 	virtual Function operator() (const Function& next) const;
 
+	virtual AsyncFunction operator() (const AsyncFunction& next) const;
+
 protected:
 	[[nodiscard]]
 	virtual inline std::unique_ptr<http::IResponse> get_response_redirect(
@@ -57,6 +59,11 @@ protected:
 	// the request path turns an invalid path into a valid one.
 	virtual bool should_redirect_with_slash(http::IRequest* request) const;
 
+	// Return `true` if the given path can be resolved using compiled router
+	// or `settings->URLPATTERNS` if the router is not built yet.
+	[[nodiscard]]
+	virtual bool is_valid_path(const std::string& path) const;
+
 	// Return the full path of the `request` with a trailing slash appended.
 	// Throws a `RuntimeError` if `settings->DEBUG` is `true` and request method is
 	// POST, PUT, or PATCH.
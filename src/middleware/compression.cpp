@@ -0,0 +1,253 @@
+/**
+ * middleware/compression.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./compression.h"
+
+// C++ libraries.
+#include <algorithm>
+#include <charconv>
+
+// Base libraries.
+#include <xalwart.base/string_utils.h>
+
+// Framework libraries.
+#include "../http/utility.h"
+#include "../utility/cache.h"
+
+
+__MIDDLEWARE_BEGIN__
+
+inline std::string _to_hex(size_t value)
+{
+	char buffer[2 * sizeof(size_t) + 1];
+	auto [end, _] = std::to_chars(buffer, buffer + sizeof(buffer), value, 16);
+	return {buffer, end};
+}
+
+CompressedStreamingResponse::CompressedStreamingResponse(
+	std::unique_ptr<http::StreamingResponse> response,
+	std::unique_ptr<util::compression::Compressor> compressor,
+	const std::string& encoding
+) : StreamingResponse(
+		require_non_null(response.get(), "'response' is nullptr", _ERROR_DETAILS_)->get_status(),
+		response->content_type(), response->get_reason_phrase(), response->get_charset()
+	),
+	_response(std::move(response)),
+	_compressor(std::move(compressor))
+{
+	require_non_null(this->_compressor.get(), "'compressor' is nullptr", _ERROR_DETAILS_);
+
+	// Validators and caching headers are copied, so they are
+	// available for middleware which is applied after this one.
+	for (const auto* header : {http::E_TAG, http::LAST_MODIFIED, http::CACHE_CONTROL, http::EXPIRES, http::VARY})
+	{
+		if (this->_response->has_header(header))
+		{
+			this->set_header(header, this->_response->get_header(header, ""));
+		}
+	}
+
+	this->set_header(http::CONTENT_ENCODING, encoding);
+	this->set_header(http::TRANSFER_ENCODING, "chunked");
+}
+
+std::string_view CompressedStreamingResponse::get_chunk_view()
+{
+	if (!this->_headers_is_got)
+	{
+		this->_headers_is_got = true;
+		this->chunk_buffer = this->_patch_headers_chunk(this->_response->get_chunk_view());
+		this->_bytes_read = this->chunk_buffer.size();
+		return this->chunk_buffer;
+	}
+
+	this->chunk_buffer.clear();
+	while (!this->_is_finished && this->chunk_buffer.empty())
+	{
+		auto chunk = this->_response->get_chunk_view();
+		if (chunk.empty())
+		{
+			this->_is_finished = true;
+			this->_append_chunk(this->_compressor->finish());
+			this->chunk_buffer.append("0\r\n\r\n");
+		}
+		else
+		{
+			// Flushing after each chunk allows client to process data
+			// as soon as it is produced by the wrapped response.
+			auto compressed = this->_compressor->compress(chunk);
+			compressed.append(this->_compressor->flush());
+			this->_append_chunk(compressed);
+		}
+	}
+
+	this->_bytes_read = this->chunk_buffer.size();
+	return this->chunk_buffer;
+}
+
+std::string CompressedStreamingResponse::_patch_headers_chunk(std::string_view headers_chunk) const
+{
+	auto end_pos = headers_chunk.find("\r\n\r\n");
+	if (end_pos != std::string_view::npos)
+	{
+		headers_chunk = headers_chunk.substr(0, end_pos);
+	}
+
+	std::string result;
+	size_t line_start = 0;
+	bool is_status_line = true;
+	while (line_start <= headers_chunk.size())
+	{
+		auto line_end = std::min(headers_chunk.find("\r\n", line_start), headers_chunk.size());
+		auto line = headers_chunk.substr(line_start, line_end - line_start);
+		line_start = line_end + 2;
+		if (!is_status_line)
+		{
+			// Headers of this response and Content-Length are skipped.
+			auto name = line.substr(0, line.find(':'));
+			if (line.empty() || this->headers.contains(name) || http::get_header_id(name) == http::HeaderId::ContentLength)
+			{
+				continue;
+			}
+		}
+
+		is_status_line = false;
+		result.append(line).append("\r\n");
+	}
+
+	return result + this->serialize_headers() + "\r\n\r\n";
+}
+
+void CompressedStreamingResponse::_append_chunk(std::string_view data)
+{
+	if (!data.empty())
+	{
+		this->chunk_buffer.append(_to_hex(data.size())).append("\r\n").append(data).append("\r\n");
+	}
+}
+
+Compression::Compression(size_t min_length, util::compression::Level level) :
+	min_length(min_length), level(level)
+{
+	const auto& supported_encodings = util::compression::supported_encodings();
+	for (const auto* encoding : {"zstd", "br", "gzip", "deflate"})
+	{
+		if (std::find(supported_encodings.begin(), supported_encodings.end(), encoding) != supported_encodings.end())
+		{
+			this->encodings.emplace_back(encoding);
+		}
+	}
+}
+
+Function Compression::operator() (const Function& next) const
+{
+	return [*this, next](http::IRequest* request) -> std::unique_ptr<http::IResponse>
+	{
+		return this->process_response(request, next(request));
+	};
+}
+
+AsyncFunction Compression::operator() (const AsyncFunction& next) const
+{
+	return [*this, next](http::IRequest* request) -> util::Task<std::unique_ptr<http::IResponse>>
+	{
+		co_return this->process_response(request, co_await next(request));
+	};
+}
+
+std::unique_ptr<http::IResponse> Compression::process_response(
+	http::IRequest* request, std::unique_ptr<http::IResponse> response
+) const
+{
+	if (!response || !this->should_compress(request, response))
+	{
+		return response;
+	}
+
+	util::cache::patch_vary_headers(response.get(), {http::ACCEPT_ENCODING});
+	auto encoding = this->select_encoding(request);
+	if (encoding.empty())
+	{
+		return response;
+	}
+
+	return this->compress(request, std::move(response), encoding);
+}
+
+bool Compression::should_compress(http::IRequest* request, const std::unique_ptr<http::IResponse>& response) const
+{
+	if (
+		response->has_header(http::CONTENT_ENCODING) ||
+		response->has_header(http::CONTENT_RANGE) ||
+		response->get_status() == 206 ||
+		!util::compression::is_compressible(response->content_type())
+	)
+	{
+		return false;
+	}
+
+	for (const auto& directive : str::split(response->get_header(http::CACHE_CONTROL, ""), ','))
+	{
+		if (str::to_lower(str::trim(directive)) == "no-transform")
+		{
+			return false;
+		}
+	}
+
+	if (response->is_streaming())
+	{
+		// Compressed chunks are sent using chunked transfer
+		// coding, which is not supported by HTTP/1.0.
+		return request->proto().at_least(1, 1) && dynamic_cast<http::StreamingResponse*>(response.get());
+	}
+
+	return response->content_length() >= this->min_length && dynamic_cast<http::BaseResponse*>(response.get());
+}
+
+std::string Compression::select_encoding(http::IRequest* request) const
+{
+	return http::select_encoding(request->get_header(http::ACCEPT_ENCODING, ""), this->encodings);
+}
+
+std::unique_ptr<http::IResponse> Compression::compress(
+	http::IRequest* request, std::unique_ptr<http::IResponse> response, const std::string& encoding
+) const
+{
+	// Compressed body is only semantically equivalent
+	// to the original one.
+	auto etag = response->get_header(http::E_TAG, "");
+	if (!etag.empty() && !etag.starts_with("W/"))
+	{
+		response->set_header(http::E_TAG, "W/" + etag);
+	}
+
+	if (response->is_streaming())
+	{
+		auto* streaming_response = dynamic_cast<http::StreamingResponse*>(response.release());
+		return std::make_unique<CompressedStreamingResponse>(
+			std::unique_ptr<http::StreamingResponse>(streaming_response),
+			util::compression::make_compressor(encoding, this->level),
+			encoding
+		);
+	}
+
+	auto* base_response = dynamic_cast<http::BaseResponse*>(response.get());
+	auto content = base_response->get_content();
+	auto compressed = util::compression::compress(encoding, content, this->level);
+	if (compressed.size() < content.size())
+	{
+		base_response->set_encoded_content(std::move(compressed), encoding);
+	}
+	else if (!etag.empty())
+	{
+		// The original body is sent.
+		response->set_header(http::E_TAG, etag);
+	}
+
+	return response;
+}
+
+__MIDDLEWARE_END__
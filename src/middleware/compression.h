@@ -0,0 +1,154 @@
+/**
+ * middleware/compression.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Compress content for clients which support compression.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <memory>
+#include <string>
+#include <vector>
+
+// Module definitions.
+#include "./_def_.h"
+
+// Framework libraries.
+#include "./types.h"
+#include "../utility/compression.h"
+
+
+__MIDDLEWARE_BEGIN__
+
+// TESTME: CompressedStreamingResponse
+// Streaming response which compresses chunks of another streaming
+// response as they are produced and sends them using chunked transfer
+// coding, so the whole body is never kept in memory.
+//
+// Headers and cookies of the wrapped response are sent except Content-Length
+// and headers which are set to this response, for example, Content-Encoding.
+class CompressedStreamingResponse final : public http::StreamingResponse
+{
+public:
+	CompressedStreamingResponse(
+		std::unique_ptr<http::StreamingResponse> response,
+		std::unique_ptr<util::compression::Compressor> compressor,
+		const std::string& encoding
+	);
+
+	std::string get_chunk() override
+	{
+		return std::string(this->get_chunk_view());
+	}
+
+	std::string_view get_chunk_view() override;
+
+	inline void flush() override
+	{
+		this->_response->flush();
+	}
+
+	[[nodiscard]]
+	inline bool readable() const override
+	{
+		return this->_response->readable();
+	}
+
+	[[nodiscard]]
+	inline bool seekable() const override
+	{
+		return false;
+	}
+
+	[[nodiscard]]
+	inline unsigned long int tell() const override
+	{
+		return this->_bytes_read;
+	}
+
+	inline void close() override
+	{
+		StreamingResponse::close();
+		this->_response->close();
+	}
+
+private:
+	std::unique_ptr<http::StreamingResponse> _response;
+	std::unique_ptr<util::compression::Compressor> _compressor;
+	bool _headers_is_got = false;
+	bool _is_finished = false;
+	unsigned long int _bytes_read = 0;
+
+	// Removes Content-Length and overridden headers from
+	// the headers chunk of the wrapped response.
+	[[nodiscard]]
+	std::string _patch_headers_chunk(std::string_view headers_chunk) const;
+
+	// Appends `data` to 'chunk_buffer' as a chunk of chunked
+	// transfer coding.
+	void _append_chunk(std::string_view data);
+};
+
+// TESTME: Compression
+/** Compress content if the client supports it, 'zstd', 'br', 'gzip' and
+ * 'deflate' codings are negotiated using Accept-Encoding header.
+ *
+ * Set the Vary header accordingly, so that caches will base their storage
+ * on the Accept-Encoding header. A strong ETag of compressed response is
+ * made weak, because the compressed body is only semantically equivalent
+ * to the original one. Place this middleware before 'ConditionalGet', so
+ * the ETag is computed before compression.
+ *
+ * Streaming responses are compressed chunk by chunk. Responses with
+ * Content-Encoding, partial content and 'Cache-Control: no-transform'
+ * are sent as is.
+ */
+class Compression
+{
+public:
+	static inline constexpr const char* NAME = "xw::middleware::Compression";
+
+	// Content shorter than this is not worth compressing.
+	static inline constexpr size_t DEFAULT_MIN_LENGTH = 200;
+
+	explicit Compression(
+		size_t min_length=DEFAULT_MIN_LENGTH,
+		util::compression::Level level=util::compression::Level::Default
+	);
+
+	virtual ~Compression() = default;
+
+	virtual Function operator() (const Function& next) const;
+
+	virtual AsyncFunction operator() (const AsyncFunction& next) const;
+
+protected:
+	size_t min_length;
+	util::compression::Level level;
+
+	// Supported codings in order of server's preference.
+	std::vector<std::string> encodings;
+
+	// Return `true` if content of `response` can be compressed.
+	[[nodiscard]]
+	virtual bool should_compress(http::IRequest* request, const std::unique_ptr<http::IResponse>& response) const;
+
+	// Returns the coding which is preferred by client or an
+	// empty string if no coding is acceptable.
+	[[nodiscard]]
+	virtual std::string select_encoding(http::IRequest* request) const;
+
+	// Compresses `response` if it is possible and accepted by client.
+	virtual std::unique_ptr<http::IResponse> process_response(
+		http::IRequest* request, std::unique_ptr<http::IResponse> response
+	) const;
+
+	virtual std::unique_ptr<http::IResponse> compress(
+		http::IRequest* request, std::unique_ptr<http::IResponse> response, const std::string& encoding
+	) const;
+};
+
+__MIDDLEWARE_END__
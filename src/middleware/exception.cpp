@@ -13,41 +13,71 @@ Function Exception::operator() (const Function& next) const
 {
 	return [*this, next](http::IRequest* request) -> std::unique_ptr<http::IResponse>
 	{
-		net::StatusCode error_status_code = 500;
-		std::string message;
 		try
 		{
 			return next(request);
 		}
-		catch (const http::exc::HttpError& exc)
+		catch (...)
 		{
-			error_status_code = exc.status_code();
-			message = exc.get_message();
+			return this->current_exception_to_response(request);
 		}
-		catch (const BaseException& exc)
-		{
-			if (this->settings->LOGGER)
-			{
-				this->settings->LOGGER->error(exc);
-			}
+	};
+}
 
-			message = exc.get_message();
+AsyncFunction Exception::operator() (const AsyncFunction& next) const
+{
+	return [*this, next](http::IRequest* request) -> util::Task<std::unique_ptr<http::IResponse>>
+	{
+		std::unique_ptr<http::IResponse> response;
+		try
+		{
+			response = co_await next(request);
 		}
-		catch (const std::exception& exc)
+		catch (...)
 		{
-			if (this->settings->LOGGER)
-			{
-				this->settings->LOGGER->error(exc.what(), _ERROR_DETAILS_);
-			}
-
-			message = exc.what();
+			response = this->current_exception_to_response(request);
 		}
 
-		require_non_null(request, _ERROR_DETAILS_);
-		return this->error_to_response(error_status_code, message, request->is_json());
+		co_return std::move(response);
 	};
 }
 
+std::unique_ptr<http::IResponse> Exception::current_exception_to_response(http::IRequest* request) const
+{
+	net::StatusCode error_status_code = 500;
+	std::string message;
+	try
+	{
+		throw;
+	}
+	catch (const http::exc::HttpError& exc)
+	{
+		error_status_code = exc.status_code();
+		message = exc.get_message();
+	}
+	catch (const BaseException& exc)
+	{
+		if (this->settings->LOGGER)
+		{
+			this->settings->LOGGER->error(exc);
+		}
+
+		message = exc.get_message();
+	}
+	catch (const std::exception& exc)
+	{
+		if (this->settings->LOGGER)
+		{
+			this->settings->LOGGER->error(exc.what(), _ERROR_DETAILS_);
+		}
+
+		message = exc.what();
+	}
+
+	require_non_null(request, _ERROR_DETAILS_);
+	return this->error_to_response(error_status_code, message, request->is_json());
+}
+
 std::unique_ptr<http::IResponse> Exception::error_to_response(
 	net::StatusCode status_code, const std::string& message, bool is_json
 ) const
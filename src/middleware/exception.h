@@ -41,6 +41,8 @@ public:
 
 	Function operator() (const Function& next) const;
 
+	AsyncFunction operator() (const AsyncFunction& next) const;
+
 protected:
 	inline static const net::Status DEFAULT_ERROR_STATUS = {
 		500, "Internal Server Error", "Server got itself in trouble"
@@ -66,6 +68,12 @@ protected:
 		return this->settings->render_html_error_template(status, message);
 	}
 
+	// Converts exception which is being handled to error response.
+	// Exceptions which are not derived from 'std::exception' are
+	// rethrown.
+	[[nodiscard]]
+	std::unique_ptr<http::IResponse> current_exception_to_response(http::IRequest* request) const;
+
 	[[nodiscard]]
 	std::unique_ptr<http::IResponse> error_to_response(
 		net::StatusCode status_code, const std::string& message, bool is_json
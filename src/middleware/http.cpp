@@ -19,36 +19,49 @@ Function ConditionalGet::operator() (const Function& next) const
 {
 	return [*this, next](http::IRequest* request) -> std::unique_ptr<http::IResponse>
 	{
-		auto response = next(request);
+		return this->process_response(request, next(request));
+	};
+}
 
-		// It's too late to prevent an unsafe request with a 412 response, and
-		// for a HEAD request, the response body is always empty so computing
-		// an accurate ETag isn't possible.
-		if (str::to_upper(request->method()) != "GET")
-		{
-			return response;
-		}
+AsyncFunction ConditionalGet::operator() (const AsyncFunction& next) const
+{
+	return [*this, next](http::IRequest* request) -> util::Task<std::unique_ptr<http::IResponse>>
+	{
+		co_return this->process_response(request, co_await next(request));
+	};
+}
 
-		if (this->needs_etag(response) && !response->has_header(http::E_TAG))
-		{
-			util::cache::set_response_etag(response.get());
-		}
+std::unique_ptr<http::IResponse> ConditionalGet::process_response(
+	http::IRequest* request, std::unique_ptr<http::IResponse> response
+) const
+{
+	// It's too late to prevent an unsafe request with a 412 response, and
+	// for a HEAD request, the response body is always empty so computing
+	// an accurate ETag isn't possible.
+	if (str::to_upper(request->method()) != "GET")
+	{
+		return response;
+	}
+
+	if (this->needs_etag(response) && !response->has_header(http::E_TAG))
+	{
+		util::cache::set_response_etag(response.get(), this->etag_function);
+	}
 
-		auto etag = response->get_header(http::E_TAG, "");
-		long last_modified = http::parse_http_date(response->get_header(http::LAST_MODIFIED, ""));
-		if (!etag.empty() || last_modified != -1)
+	auto etag = response->get_header(http::E_TAG, "");
+	long last_modified = http::parse_http_date(response->get_header(http::LAST_MODIFIED, ""));
+	if (!etag.empty() || last_modified != -1)
+	{
+		auto conditional_response = util::cache::get_conditional_response(
+			request, etag, last_modified, response.get()
+		);
+		if (conditional_response)
 		{
-			auto conditional_response = util::cache::get_conditional_response(
-				request, etag, last_modified, response.get()
-			);
-			if (conditional_response)
-			{
-				return conditional_response;
-			}
+			return conditional_response;
 		}
+	}
 
-		return response;
-	};
+	return response;
 }
 
 bool ConditionalGet::needs_etag(const std::unique_ptr<http::IResponse>& response) const
@@ -8,11 +8,15 @@
 
 #pragma once
 
+// Base libraries.
+#include <xalwart.base/exceptions.h>
+
 // Module definitions
 #include "./_def_.h"
 
 // Framework libraries.
 #include "./types.h"
+#include "../utility/cache.h"
 
 
 __MIDDLEWARE_BEGIN__
@@ -21,17 +25,39 @@ __MIDDLEWARE_BEGIN__
 /** Handle conditional GET operations. If the response has an ETag or
  * Last-Modified header and the request has If-None-Match or If-Modified-Since,
  * replace the response with HttpNotModified. Add an ETag header if needed.
+ *
+ * ETag is computed by `etag_function` from the serialized content, which is
+ * then reused for sending, by default a fast non-cryptographic hash is used.
  */
 class ConditionalGet
 {
 public:
 	static inline constexpr const char* NAME = "xw::middleware::ConditionalGet";
 
-	ConditionalGet() = default;
+	inline explicit ConditionalGet(util::cache::ETagFunction etag_function=util::cache::hash_etag) :
+		etag_function(std::move(etag_function))
+	{
+		if (!this->etag_function)
+		{
+			throw ArgumentError("'etag_function' is nullptr", _ERROR_DETAILS_);
+		}
+	}
+
+	virtual ~ConditionalGet() = default;
 
 	virtual Function operator() (const Function& next) const;
 
+	virtual AsyncFunction operator() (const AsyncFunction& next) const;
+
 protected:
+	util::cache::ETagFunction etag_function;
+
+	// Sets ETag of `response` to GET request and returns
+	// Http 304 (Not Modified) response if it matches.
+	virtual std::unique_ptr<http::IResponse> process_response(
+		http::IRequest* request, std::unique_ptr<http::IResponse> response
+	) const;
+
 	// Return true if an ETag header should be added to response.
 	[[nodiscard]]
 	virtual bool needs_etag(const std::unique_ptr<http::IResponse>& response) const;
@@ -0,0 +1,587 @@
+/**
+ * middleware/page_cache.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./page_cache.h"
+
+// C++ libraries.
+#include <algorithm>
+#include <charconv>
+
+// Base libraries.
+#include <xalwart.base/exceptions.h>
+#include <xalwart.base/string_utils.h>
+
+// Framework libraries.
+#include "../utility/cache.h"
+
+
+__MIDDLEWARE_BEGIN__
+
+inline std::optional<long> _parse_seconds(std::string_view value)
+{
+	long result = 0;
+	auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), result);
+	if (error != std::errc() || end != value.data() + value.size())
+	{
+		return std::nullopt;
+	}
+
+	return result;
+}
+
+// Lets other request regenerate the page if the one which regenerates
+// it fails or its coroutine is destroyed before it is finished.
+struct _UpdateGuard final
+{
+	PageCacheStorage* storage;
+	const std::string& key;
+	PageCacheStorage::VariantKeyFunction variant_key_function;
+	bool is_done = false;
+
+	inline ~_UpdateGuard()
+	{
+		if (!this->is_done)
+		{
+			this->storage->release(this->key, this->variant_key_function);
+		}
+	}
+};
+
+size_t CachedPage::size() const
+{
+	// Fixed part approximates the page itself and
+	// bookkeeping of the storage.
+	size_t result = sizeof(CachedPage) + 128 + this->reason_phrase.size() + this->charset.size();
+	for (const auto& [name, value] : this->headers)
+	{
+		result += name.size() + value.size() + 64;
+	}
+
+	return result + this->content->size();
+}
+
+void PageCacheStorage::Flight::wait()
+{
+	std::unique_lock lock(this->_mutex);
+	this->_condition.wait_until(lock, this->_deadline, [this] { return this->_is_finished; });
+}
+
+void PageCacheStorage::Flight::finish()
+{
+	std::vector<std::pair<util::EventLoop*, std::coroutine_handle<>>> waiters;
+	{
+		std::lock_guard lock(this->_mutex);
+		this->_is_finished = true;
+		waiters.swap(this->_waiters);
+	}
+
+	this->_condition.notify_all();
+	for (auto& [loop, handle] : waiters)
+	{
+		loop->schedule(handle);
+	}
+}
+
+bool PageCacheStorage::Flight::_add_waiter(std::coroutine_handle<> handle)
+{
+	std::lock_guard lock(this->_mutex);
+	if (this->_is_finished)
+	{
+		return false;
+	}
+
+	this->_waiters.emplace_back(&util::EventLoop::current(), handle);
+	return true;
+}
+
+PageCacheStorage::PageCacheStorage(
+	size_t max_size, size_t shards_count, std::chrono::milliseconds stale_timeout
+) : _stale_timeout(stale_timeout)
+{
+	if (shards_count == 0)
+	{
+		throw ArgumentError("'shards_count' must be greater than zero", _ERROR_DETAILS_);
+	}
+
+	this->_max_shard_size = max_size / shards_count;
+	for (size_t i = 0; i < shards_count; i++)
+	{
+		this->_shards.push_back(std::make_unique<Shard>());
+	}
+}
+
+PageCacheStorage::Lookup PageCacheStorage::get(
+	const std::string& key, const VariantKeyFunction& variant_key_function, bool can_wait
+)
+{
+	auto now = std::chrono::steady_clock::now();
+	auto& shard = this->_get_shard(key);
+	std::lock_guard lock(shard.mutex);
+	auto node = shard.nodes.find(key);
+	if (node == shard.nodes.end())
+	{
+		return PageCacheStorage::_miss(shard, key, can_wait, now);
+	}
+
+	auto variant_key = variant_key_function(node->second.vary_headers);
+	auto variant = node->second.variants.find(variant_key);
+	if (variant == node->second.variants.end())
+	{
+		return PageCacheStorage::_miss(shard, _make_flight_key(key, variant_key), can_wait, now);
+	}
+
+	shard.lru.splice(shard.lru.begin(), shard.lru, node->second.lru_position);
+	auto& page = variant->second.page;
+	if (now < page->expires_at)
+	{
+		return {.page = page, .should_update = false};
+	}
+
+	if (now >= page->expires_at + this->_stale_timeout)
+	{
+		// The page is too old to be served while it is regenerated.
+		return PageCacheStorage::_miss(shard, _make_flight_key(key, variant_key), can_wait, now);
+	}
+
+	auto& updating_until = variant->second.updating_until;
+	if (updating_until && now < *updating_until)
+	{
+		return {.page = page, .should_update = false};
+	}
+
+	updating_until = now + UPDATE_TIMEOUT;
+	return {.page = page, .should_update = true};
+}
+
+void PageCacheStorage::set(
+	const std::string& key, std::vector<std::string> vary_headers,
+	const std::string& variant_key, std::shared_ptr<const CachedPage> page
+)
+{
+	require_non_null(page.get(), "'page' is nullptr", _ERROR_DETAILS_);
+	auto page_size = page->size() + key.size() + variant_key.size();
+	auto& shard = this->_get_shard(key);
+	std::lock_guard lock(shard.mutex);
+	PageCacheStorage::_finish_flight(shard, key);
+	PageCacheStorage::_finish_flight(shard, _make_flight_key(key, variant_key));
+	auto node = shard.nodes.find(key);
+	if (page_size > this->_max_shard_size)
+	{
+		if (node != shard.nodes.end())
+		{
+			PageCacheStorage::_erase(shard, node);
+		}
+
+		return;
+	}
+
+	if (node == shard.nodes.end())
+	{
+		shard.lru.push_front(key);
+		node = shard.nodes.emplace(key, Node{.lru_position = shard.lru.begin()}).first;
+	}
+	else
+	{
+		shard.lru.splice(shard.lru.begin(), shard.lru, node->second.lru_position);
+	}
+
+	if (node->second.vary_headers != vary_headers)
+	{
+		// Stored variants are selected by other headers.
+		shard.size -= node->second.size;
+		node->second.size = 0;
+		node->second.variants.clear();
+		node->second.vary_headers = std::move(vary_headers);
+	}
+
+	auto variant = node->second.variants.find(variant_key);
+	if (variant != node->second.variants.end())
+	{
+		auto old_size = variant->second.page->size() + key.size() + variant_key.size();
+		node->second.size -= old_size;
+		shard.size -= old_size;
+		node->second.variants.erase(variant);
+	}
+
+	node->second.variants.emplace(variant_key, Variant{.page = std::move(page)});
+	node->second.size += page_size;
+	shard.size += page_size;
+	while (shard.size > this->_max_shard_size)
+	{
+		PageCacheStorage::_erase(shard, shard.nodes.find(shard.lru.back()));
+	}
+}
+
+void PageCacheStorage::release(const std::string& key, const VariantKeyFunction& variant_key_function)
+{
+	auto& shard = this->_get_shard(key);
+	std::lock_guard lock(shard.mutex);
+	PageCacheStorage::_finish_flight(shard, key);
+	auto node = shard.nodes.find(key);
+	if (node != shard.nodes.end())
+	{
+		auto variant_key = variant_key_function(node->second.vary_headers);
+		PageCacheStorage::_finish_flight(shard, _make_flight_key(key, variant_key));
+		auto variant = node->second.variants.find(variant_key);
+		if (variant != node->second.variants.end())
+		{
+			variant->second.updating_until.reset();
+		}
+	}
+}
+
+void PageCacheStorage::remove(const std::string& key, const VariantKeyFunction& variant_key_function)
+{
+	auto& shard = this->_get_shard(key);
+	std::lock_guard lock(shard.mutex);
+	PageCacheStorage::_finish_flight(shard, key);
+	auto node = shard.nodes.find(key);
+	if (node != shard.nodes.end())
+	{
+		auto variant_key = variant_key_function(node->second.vary_headers);
+		PageCacheStorage::_finish_flight(shard, _make_flight_key(key, variant_key));
+		auto variant = node->second.variants.find(variant_key);
+		if (variant != node->second.variants.end())
+		{
+			auto size = variant->second.page->size() + key.size() + variant_key.size();
+			node->second.size -= size;
+			shard.size -= size;
+			node->second.variants.erase(variant);
+		}
+
+		if (node->second.variants.empty())
+		{
+			PageCacheStorage::_erase(shard, node);
+		}
+	}
+}
+
+void PageCacheStorage::clear()
+{
+	for (auto& shard : this->_shards)
+	{
+		std::lock_guard lock(shard->mutex);
+		for (auto& [flight_key, flight] : shard->flights)
+		{
+			flight->finish();
+		}
+
+		shard->flights.clear();
+		shard->nodes.clear();
+		shard->lru.clear();
+		shard->size = 0;
+	}
+}
+
+size_t PageCacheStorage::size() const
+{
+	size_t result = 0;
+	for (const auto& shard : this->_shards)
+	{
+		std::lock_guard lock(shard->mutex);
+		result += shard->size;
+	}
+
+	return result;
+}
+
+PageCacheStorage::Shard& PageCacheStorage::_get_shard(const std::string& key) const
+{
+	return *this->_shards[std::hash<std::string>{}(key) % this->_shards.size()];
+}
+
+PageCacheStorage::Lookup PageCacheStorage::_miss(
+	Shard& shard, std::string flight_key, bool can_wait, std::chrono::steady_clock::time_point now
+)
+{
+	auto flight = shard.flights.find(flight_key);
+	if (flight != shard.flights.end() && !flight->second->is_expired(now))
+	{
+		return {.page = nullptr, .should_update = false, .flight = can_wait ? flight->second : nullptr};
+	}
+
+	if (flight != shard.flights.end())
+	{
+		// Generation of the page which has not finished until
+		// the deadline is considered as failed.
+		flight->second->finish();
+		shard.flights.erase(flight);
+	}
+
+	shard.flights.emplace(std::move(flight_key), std::make_shared<Flight>(now + UPDATE_TIMEOUT));
+	return {.page = nullptr, .should_update = true};
+}
+
+void PageCacheStorage::_finish_flight(Shard& shard, const std::string& flight_key)
+{
+	auto flight = shard.flights.find(flight_key);
+	if (flight != shard.flights.end())
+	{
+		flight->second->finish();
+		shard.flights.erase(flight);
+	}
+}
+
+void PageCacheStorage::_erase(Shard& shard, std::unordered_map<std::string, Node>::iterator node)
+{
+	shard.size -= node->second.size;
+	shard.lru.erase(node->second.lru_position);
+	shard.nodes.erase(node);
+}
+
+PageCache::PageCache(std::chrono::seconds timeout, size_t max_size, size_t shards_count) :
+	timeout(timeout),
+	storage(std::make_shared<PageCacheStorage>(max_size, shards_count, std::chrono::milliseconds(timeout)))
+{
+}
+
+Function PageCache::operator() (const Function& next) const
+{
+	return [*this, next](http::IRequest* request) -> std::unique_ptr<http::IResponse>
+	{
+		if (!this->should_cache_request(request))
+		{
+			return next(request);
+		}
+
+		auto key = this->make_key(request);
+		auto lookup = this->storage->get(key, this->variant_key_function(request));
+		if (lookup.flight)
+		{
+			lookup.flight->wait();
+			lookup = this->storage->get(key, this->variant_key_function(request), false);
+		}
+
+		if (lookup.page && !lookup.should_update)
+		{
+			return PageCache::make_response(*lookup.page);
+		}
+
+		if (!lookup.should_update)
+		{
+			// Other request still generates the page.
+			return next(request);
+		}
+
+		// The expired page is served until other request regenerates it.
+		_UpdateGuard update_guard{this->storage.get(), key, this->variant_key_function(request)};
+		auto response = next(request);
+		update_guard.is_done = true;
+		return this->cache_response(request, key, lookup.page != nullptr, std::move(response));
+	};
+}
+
+AsyncFunction PageCache::operator() (const AsyncFunction& next) const
+{
+	return [*this, next](http::IRequest* request) -> util::Task<std::unique_ptr<http::IResponse>>
+	{
+		if (!this->should_cache_request(request))
+		{
+			co_return co_await next(request);
+		}
+
+		auto key = this->make_key(request);
+		auto lookup = this->storage->get(key, this->variant_key_function(request));
+		if (lookup.flight)
+		{
+			// The thread is not blocked, the request which generates
+			// the page can be processed by the same event loop.
+			co_await lookup.flight->wait_async();
+			lookup = this->storage->get(key, this->variant_key_function(request), false);
+		}
+
+		if (lookup.page && !lookup.should_update)
+		{
+			co_return PageCache::make_response(*lookup.page);
+		}
+
+		if (!lookup.should_update)
+		{
+			co_return co_await next(request);
+		}
+
+		_UpdateGuard update_guard{this->storage.get(), key, this->variant_key_function(request)};
+		auto response = co_await next(request);
+		update_guard.is_done = true;
+		co_return this->cache_response(request, key, lookup.page != nullptr, std::move(response));
+	};
+}
+
+std::unique_ptr<http::IResponse> PageCache::cache_response(
+	http::IRequest* request, const std::string& key, bool is_cached, std::unique_ptr<http::IResponse> response
+) const
+{
+	auto cache_timeout = response ? this->get_cache_timeout(response) : std::nullopt;
+	if (!cache_timeout)
+	{
+		if (is_cached)
+		{
+			// The resource can not be cached anymore.
+			this->storage->remove(key, this->variant_key_function(request));
+		}
+		else
+		{
+			this->storage->release(key, this->variant_key_function(request));
+		}
+
+		return response;
+	}
+
+	auto vary_headers = PageCache::get_vary_headers(response);
+	if (!PageCache::is_cookie_safe(request, vary_headers))
+	{
+		// The page can be personalized by cookies and it would be
+		// served to other users; keep the page which is cached for
+		// requests without cookies, if any.
+		this->storage->release(key, this->variant_key_function(request));
+		return response;
+	}
+
+	if (!response->has_header(http::E_TAG))
+	{
+		util::cache::set_response_etag(response.get());
+	}
+
+	auto variant_key = PageCache::make_variant_key(request, vary_headers);
+	this->storage->set(
+		key, std::move(vary_headers), variant_key,
+		PageCache::make_page(dynamic_cast<http::BaseResponse*>(response.get()), *cache_timeout)
+	);
+	return response;
+}
+
+bool PageCache::should_cache_request(http::IRequest* request) const
+{
+	auto method = str::to_upper(request->method());
+	return (method == "GET" || method == "HEAD") && !request->has_header(http::AUTHORIZATION);
+}
+
+std::optional<std::chrono::seconds> PageCache::get_cache_timeout(
+	const std::unique_ptr<http::IResponse>& response
+) const
+{
+	if (
+		response->get_status() != 200 ||
+		response->is_streaming() ||
+		!response->get_cookies().empty() ||
+		!dynamic_cast<http::BaseResponse*>(response.get())
+	)
+	{
+		return std::nullopt;
+	}
+
+	auto vary_headers = PageCache::get_vary_headers(response);
+	if (std::find(vary_headers.begin(), vary_headers.end(), "*") != vary_headers.end())
+	{
+		return std::nullopt;
+	}
+
+	std::optional<long> max_age, shared_max_age;
+	for (const auto& item : str::split(response->get_header(http::CACHE_CONTROL, ""), ','))
+	{
+		auto directive = str::to_lower(str::trim(item));
+		if (directive == "private" || directive == "no-cache" || directive == "no-store")
+		{
+			return std::nullopt;
+		}
+		else if (directive.starts_with("max-age="))
+		{
+			max_age = _parse_seconds(std::string_view(directive).substr(8));
+		}
+		else if (directive.starts_with("s-maxage="))
+		{
+			shared_max_age = _parse_seconds(std::string_view(directive).substr(9));
+		}
+	}
+
+	auto result = shared_max_age ? std::chrono::seconds(*shared_max_age) : (
+		max_age ? std::chrono::seconds(*max_age) : this->timeout
+	);
+	if (result.count() <= 0)
+	{
+		return std::nullopt;
+	}
+
+	return result;
+}
+
+bool PageCache::is_cookie_safe(http::IRequest* request, const std::vector<std::string>& vary_headers)
+{
+	if (!request->has_header(http::COOKIE))
+	{
+		return true;
+	}
+
+	return std::any_of(vary_headers.begin(), vary_headers.end(), [](const std::string& header) -> bool
+	{
+		return str::to_lower(header) == "cookie";
+	});
+}
+
+std::string PageCache::make_key(http::IRequest* request) const
+{
+	return str::to_upper(request->method()) + " " + request->get_header(http::HOST, "") +
+		request->url().full_path();
+}
+
+std::string PageCache::make_variant_key(http::IRequest* request, const std::vector<std::string>& vary_headers)
+{
+	std::string result;
+	for (const auto& header : vary_headers)
+	{
+		result.append(request->get_header_view(header)).append("\n");
+	}
+
+	return result;
+}
+
+std::vector<std::string> PageCache::get_vary_headers(const std::unique_ptr<http::IResponse>& response)
+{
+	std::vector<std::string> result;
+	for (const auto& header : str::split(response->get_header(http::VARY, ""), ','))
+	{
+		auto name = str::trim(header);
+		if (!name.empty())
+		{
+			result.push_back(name);
+		}
+	}
+
+	return result;
+}
+
+std::shared_ptr<const CachedPage> PageCache::make_page(http::BaseResponse* response, std::chrono::seconds timeout)
+{
+	auto now = std::chrono::steady_clock::now();
+	auto page = std::make_shared<CachedPage>();
+	page->status = response->get_status();
+	page->reason_phrase = response->get_reason_phrase();
+	page->charset = response->get_charset();
+	page->headers = response->get_headers();
+	page->headers.erase(http::DATE);
+	page->headers.erase(http::CONTENT_LENGTH);
+	page->content = std::make_shared<const std::string>(response->get_body_view());
+	page->stored_at = now;
+	page->expires_at = now + timeout;
+	return page;
+}
+
+std::unique_ptr<http::IResponse> PageCache::make_response(const CachedPage& page)
+{
+	auto response = std::make_unique<http::SharedContentResponse>(
+		page.content, page.status, "", page.reason_phrase, page.charset
+	);
+	for (const auto& [name, value] : page.headers)
+	{
+		response->set_header(name, value);
+	}
+
+	auto age = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - page.stored_at);
+	response->set_header(http::AGE, std::to_string(age.count()));
+	return response;
+}
+
+__MIDDLEWARE_END__
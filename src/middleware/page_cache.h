@@ -0,0 +1,338 @@
+/**
+ * middleware/page_cache.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * In-memory cache of whole pages.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Module definitions.
+#include "./_def_.h"
+
+// Framework libraries.
+#include "./types.h"
+#include "../http/header_map.h"
+#include "../utility/event_loop.h"
+
+
+__MIDDLEWARE_BEGIN__
+
+// Response which is stored in 'PageCacheStorage'.
+struct CachedPage
+{
+	unsigned short int status;
+	std::string reason_phrase;
+	std::string charset;
+
+	// Headers of the response except Date and Content-Length.
+	http::HeaderMap headers;
+
+	// Body as it is sent, possibly encoded.
+	std::shared_ptr<const std::string> content;
+
+	std::chrono::steady_clock::time_point stored_at;
+	std::chrono::steady_clock::time_point expires_at;
+
+	// Approximate count of bytes used by the page.
+	[[nodiscard]]
+	size_t size() const;
+};
+
+// TESTME: PageCacheStorage
+// LRU cache of pages with a memory budget. It is split into shards which
+// are locked independently, so threads which work with different pages
+// rarely wait for each other.
+//
+// Pages are stored by key of the resource and, within the resource, by
+// values of request headers which are listed in Vary header of the page.
+//
+// An expired page is served to all threads except one which regenerates
+// it, see 'get()', until it is replaced or `stale_timeout` passes. Missing
+// page is generated by one caller too, other ones wait for it.
+class PageCacheStorage final
+{
+public:
+	// Makes the key of variant of the resource from values of
+	// request headers which are listed in Vary header.
+	using VariantKeyFunction = std::function<std::string(const std::vector<std::string>& vary_headers)>;
+
+	// Generation of the missing page which other callers wait for. It is
+	// finished by 'set()', 'release()' or 'remove()' of the page.
+	class Flight final
+	{
+	public:
+		explicit Flight(std::chrono::steady_clock::time_point deadline) : _deadline(deadline)
+		{
+		}
+
+		// Blocks the thread until the flight is finished or its deadline passes.
+		void wait();
+
+		// Suspends the coroutine until the flight is finished. The coroutine
+		// is resumed by the event loop of the thread which awaits.
+		[[nodiscard]]
+		inline auto wait_async()
+		{
+			struct Awaiter
+			{
+				Flight* flight;
+
+				[[nodiscard]]
+				inline bool await_ready() const noexcept
+				{
+					return false;
+				}
+
+				inline bool await_suspend(std::coroutine_handle<> handle) const
+				{
+					return this->flight->_add_waiter(handle);
+				}
+
+				inline void await_resume() const noexcept
+				{
+				}
+			};
+
+			return Awaiter{this};
+		}
+
+		void finish();
+
+		[[nodiscard]]
+		inline bool is_expired(std::chrono::steady_clock::time_point now) const
+		{
+			return now >= this->_deadline;
+		}
+
+	private:
+		std::chrono::steady_clock::time_point _deadline;
+		std::mutex _mutex;
+		std::condition_variable _condition;
+		bool _is_finished = false;
+		std::vector<std::pair<util::EventLoop*, std::coroutine_handle<>>> _waiters;
+
+		// Returns `false` if the flight is already finished
+		// and the coroutine must not be suspended.
+		bool _add_waiter(std::coroutine_handle<> handle);
+	};
+
+	struct Lookup
+	{
+		// Found page, which can be expired, or nullptr.
+		std::shared_ptr<const CachedPage> page;
+
+		// The caller must regenerate the page and 'set()', 'release()'
+		// or 'remove()' it.
+		bool should_update = false;
+
+		// The page is missing and other caller generates it: wait for the
+		// flight and call 'get()' again.
+		std::shared_ptr<Flight> flight;
+	};
+
+	PageCacheStorage(size_t max_size, size_t shards_count, std::chrono::milliseconds stale_timeout);
+
+	// Returns fresh page, or expired page if other thread regenerates it.
+	// If the page is missing or expired and nobody regenerates it, the
+	// caller is responsible for regeneration. If the missing page is
+	// generated by other caller, returns the flight to wait for when
+	// `can_wait` is true, otherwise neither page nor flight.
+	[[nodiscard]]
+	Lookup get(const std::string& key, const VariantKeyFunction& variant_key_function, bool can_wait=true);
+
+	// Stores the page and marks it as regenerated. Pages which are larger
+	// than the budget of one shard are not stored.
+	void set(
+		const std::string& key, std::vector<std::string> vary_headers,
+		const std::string& variant_key, std::shared_ptr<const CachedPage> page
+	);
+
+	// Allows other thread to regenerate the page, call it when
+	// regenerated page can not be stored.
+	void release(const std::string& key, const VariantKeyFunction& variant_key_function);
+
+	// Removes the page, call it when the resource must not be cached anymore.
+	void remove(const std::string& key, const VariantKeyFunction& variant_key_function);
+
+	void clear();
+
+	// Returns approximate count of bytes used by stored pages.
+	[[nodiscard]]
+	size_t size() const;
+
+private:
+	struct Variant
+	{
+		std::shared_ptr<const CachedPage> page;
+
+		// Regeneration of the page which has not finished until
+		// this time is considered as failed.
+		std::optional<std::chrono::steady_clock::time_point> updating_until;
+	};
+
+	struct Node
+	{
+		std::vector<std::string> vary_headers;
+		std::unordered_map<std::string, Variant> variants;
+		size_t size = 0;
+		std::list<std::string>::iterator lru_position;
+	};
+
+	struct Shard
+	{
+		mutable std::mutex mutex;
+
+		// Most recently used keys are at the front.
+		std::list<std::string> lru;
+		std::unordered_map<std::string, Node> nodes;
+		size_t size = 0;
+
+		// Generations of missing pages by key of the resource when
+		// it is missing, and by key of the variant otherwise.
+		std::unordered_map<std::string, std::shared_ptr<Flight>> flights;
+	};
+
+	// Regeneration is retried by other thread after this time.
+	static inline constexpr std::chrono::seconds UPDATE_TIMEOUT{10};
+
+	size_t _max_shard_size;
+	std::chrono::milliseconds _stale_timeout;
+	std::vector<std::unique_ptr<Shard>> _shards;
+
+	[[nodiscard]]
+	Shard& _get_shard(const std::string& key) const;
+
+	[[nodiscard]]
+	static inline std::string _make_flight_key(const std::string& key, const std::string& variant_key)
+	{
+		return key + '\0' + variant_key;
+	}
+
+	// Starts the flight of the missing page if nobody generates it.
+	[[nodiscard]]
+	static Lookup _miss(
+		Shard& shard, std::string flight_key, bool can_wait, std::chrono::steady_clock::time_point now
+	);
+
+	static void _finish_flight(Shard& shard, const std::string& flight_key);
+
+	static void _erase(Shard& shard, std::unordered_map<std::string, Node>::iterator node);
+};
+
+// TESTME: PageCache
+/** Cache responses to GET and HEAD requests in memory, so the controller
+ * is not called while the page is fresh.
+ *
+ * Pages are cached by method, host, full path and values of request
+ * headers which are listed in Vary header of the response. Only
+ * successful non-streaming responses without cookies are cached for
+ * 's-maxage' or 'max-age' seconds of Cache-Control header, or for
+ * `timeout` if it is not set. Responses with 'private', 'no-cache' or
+ * 'no-store' directives and requests with Authorization header are not
+ * cached. Responses to requests with Cookie header are cached only if
+ * Vary header of the response lists Cookie.
+ *
+ * When the page expires, the first request regenerates it and other ones
+ * get the expired page, so the controller is not called by all workers at
+ * the same time. Expired page is served in this way not longer than
+ * `timeout` after expiration. When the page is missing, the first request
+ * generates it and other ones wait for it once; if the page is not stored,
+ * they call the controller themselves.
+ *
+ * Place this middleware after 'Compression' and 'ConditionalGet', so they
+ * process cached pages too. ETag is set before the page is stored, so it
+ * is not computed for every cached response.
+ */
+class PageCache
+{
+public:
+	static inline constexpr const char* NAME = "xw::middleware::PageCache";
+
+	static inline constexpr std::chrono::seconds DEFAULT_TIMEOUT{60};
+	static inline constexpr size_t DEFAULT_MAX_SIZE = 64 * 1024 * 1024;
+	static inline constexpr size_t DEFAULT_SHARDS_COUNT = 16;
+
+	// Copies of the middleware share the same storage.
+	explicit PageCache(
+		std::chrono::seconds timeout=DEFAULT_TIMEOUT,
+		size_t max_size=DEFAULT_MAX_SIZE,
+		size_t shards_count=DEFAULT_SHARDS_COUNT
+	);
+
+	virtual ~PageCache() = default;
+
+	virtual Function operator() (const Function& next) const;
+
+	virtual AsyncFunction operator() (const AsyncFunction& next) const;
+
+protected:
+	std::chrono::seconds timeout;
+	std::shared_ptr<PageCacheStorage> storage;
+
+	// Returns `true` if response to `request` can be taken from cache.
+	[[nodiscard]]
+	virtual bool should_cache_request(http::IRequest* request) const;
+
+	// Returns for how long `response` can be cached, or
+	// `std::nullopt` if it must not be cached.
+	[[nodiscard]]
+	virtual std::optional<std::chrono::seconds> get_cache_timeout(
+		const std::unique_ptr<http::IResponse>& response
+	) const;
+
+	// Returns `false` if `response` can depend on cookies of `request`,
+	// but is not selected by them.
+	[[nodiscard]]
+	static bool is_cookie_safe(http::IRequest* request, const std::vector<std::string>& vary_headers);
+
+	[[nodiscard]]
+	virtual std::string make_key(http::IRequest* request) const;
+
+	[[nodiscard]]
+	static std::string make_variant_key(http::IRequest* request, const std::vector<std::string>& vary_headers);
+
+	[[nodiscard]]
+	static inline PageCacheStorage::VariantKeyFunction variant_key_function(http::IRequest* request)
+	{
+		return [request](const std::vector<std::string>& vary_headers) -> std::string
+		{
+			return PageCache::make_variant_key(request, vary_headers);
+		};
+	}
+
+	// Stores `response` which was produced by the rest of the chain if it
+	// can be cached, otherwise removes the page which is cached by `key`
+	// when `is_cached` is true, or lets other request regenerate it.
+	virtual std::unique_ptr<http::IResponse> cache_response(
+		http::IRequest* request, const std::string& key, bool is_cached, std::unique_ptr<http::IResponse> response
+	) const;
+
+	// Parses Vary header of the response.
+	[[nodiscard]]
+	static std::vector<std::string> get_vary_headers(const std::unique_ptr<http::IResponse>& response);
+
+	[[nodiscard]]
+	static std::shared_ptr<const CachedPage> make_page(
+		http::BaseResponse* response, std::chrono::seconds timeout
+	);
+
+	[[nodiscard]]
+	static std::unique_ptr<http::IResponse> make_response(const CachedPage& page);
+};
+
+__MIDDLEWARE_END__
@@ -33,6 +33,27 @@ Function Security::operator() (const Function& next) const
 	};
 }
 
+AsyncFunction Security::operator() (const AsyncFunction& next) const
+{
+	return [*this, next](http::IRequest* request) -> util::Task<std::unique_ptr<http::IResponse>>
+	{
+		auto response = this->preprocess(request);
+		if (response)
+		{
+			co_return std::move(response);
+		}
+
+		response = co_await next(request);
+		auto postprocess_response = this->postprocess(request, response.get());
+		if (postprocess_response)
+		{
+			co_return std::move(postprocess_response);
+		}
+
+		co_return std::move(response);
+	};
+}
+
 std::unique_ptr<http::IResponse> Security::preprocess(http::IRequest* request) const
 {
 	auto path = str::ltrim(request->url().path, "/");
@@ -43,6 +43,8 @@ public:
 
 	virtual Function operator() (const Function& next) const;
 
+	virtual AsyncFunction operator() (const AsyncFunction& next) const;
+
 protected:
 	conf::Secure secure;
 	std::vector<re::Regex> redirect_exempt;
@@ -0,0 +1,33 @@
+/**
+ * middleware/types.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./types.h"
+
+// Framework libraries.
+#include "../utility/event_loop.h"
+
+
+__MIDDLEWARE_BEGIN__
+
+AsyncFunction Handler::operator() (const AsyncFunction& next) const
+{
+	if (this->_async_middleware)
+	{
+		return this->_async_middleware(next);
+	}
+
+	// The thread is blocked until the rest of the chain is finished.
+	auto function = this->_middleware([next](http::IRequest* request) -> std::unique_ptr<http::IResponse>
+	{
+		return util::EventLoop::current().run_until_complete(next(request));
+	});
+	return [function](http::IRequest* request) -> util::Task<std::unique_ptr<http::IResponse>>
+	{
+		return util::ready_task(function(request));
+	};
+}
+
+__MIDDLEWARE_END__
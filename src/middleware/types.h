@@ -9,7 +9,9 @@
 #pragma once
 
 // C++ libraries.
+#include <functional>
 #include <memory>
+#include <type_traits>
 
 // Module definitions.
 #include "./_def_.h"
@@ -17,11 +19,70 @@
 // Framework libraries.
 #include "../http/request.h"
 #include "../http/response.h"
+#include "../utility/task.h"
 
 
 __MIDDLEWARE_BEGIN__
 
 using Function = std::function<std::unique_ptr<http::IResponse>(http::IRequest* request)>;
-using Handler = std::function<Function(const Function&)>;
+using AsyncFunction = std::function<util::Task<std::unique_ptr<http::IResponse>>(http::IRequest* request)>;
+
+// TESTME: Handler
+// Middleware which wraps the next function of the chain. Any object with
+// `Function operator()(const Function&) const` is a middleware. If it also
+// has `AsyncFunction operator()(const AsyncFunction&) const`, it is used in
+// the asynchronous chain, otherwise the synchronous one is adapted and the
+// rest of the chain is waited for on the event loop of the current thread.
+// The adapted middleware blocks the loop while the rest of the chain waits
+// and fails if it is called by a coroutine which the loop resumes, see
+// 'util::EventLoop::run_until_complete()'.
+class Handler final
+{
+public:
+	inline Handler() = default;
+
+	inline Handler(std::nullptr_t)
+	{
+	}
+
+	template <typename MiddlewareT>
+	requires (
+		!std::is_same_v<std::remove_cvref_t<MiddlewareT>, Handler> &&
+		std::is_invocable_r_v<Function, const MiddlewareT&, const Function&>
+	)
+	inline Handler(MiddlewareT middleware)
+	{
+		if constexpr (std::is_invocable_r_v<AsyncFunction, const MiddlewareT&, const AsyncFunction&>)
+		{
+			this->_async_middleware = middleware;
+		}
+
+		this->_middleware = std::move(middleware);
+	}
+
+	inline Function operator() (const Function& next) const
+	{
+		return this->_middleware(next);
+	}
+
+	AsyncFunction operator() (const AsyncFunction& next) const;
+
+	// Returns true if the middleware processes requests
+	// asynchronously instead of being adapted.
+	[[nodiscard]]
+	inline bool is_async() const
+	{
+		return (bool)this->_async_middleware;
+	}
+
+	inline explicit operator bool() const
+	{
+		return (bool)this->_middleware;
+	}
+
+private:
+	std::function<Function(const Function&)> _middleware;
+	std::function<AsyncFunction(const AsyncFunction&)> _async_middleware;
+};
 
 __MIDDLEWARE_END__
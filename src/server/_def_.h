@@ -0,0 +1,19 @@
+/**
+ * server/_def_.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Definitions of 'server' module.
+ */
+
+#pragma once
+
+#include "../_def_.h"
+
+// xw::server
+#define __SERVER_BEGIN__ __MAIN_NAMESPACE_BEGIN__ namespace server {
+#define __SERVER_END__ } __MAIN_NAMESPACE_END__
+
+// xw::server::meta
+#define __SERVER_META_BEGIN__ __SERVER_BEGIN__ namespace meta {
+#define __SERVER_META_END__ } __SERVER_END__
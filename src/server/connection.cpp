@@ -0,0 +1,512 @@
+/**
+ * server/connection.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./connection.h"
+
+// C++ libraries.
+#include <algorithm>
+#include <cerrno>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Base libraries.
+#include <xalwart.base/exceptions.h>
+
+// Framework libraries.
+#include "./meta.h"
+#include "./parser.h"
+
+
+__SERVER_BEGIN__
+
+// The key is created once, so the count is updated without allocations.
+static inline const std::string _REQUESTS_COUNT_KEY = meta::CONNECTION_REQUESTS_COUNT;
+
+ssize_t BodyReader::read_line(std::string& line)
+{
+	line.clear();
+	while (this->_limit > 0)
+	{
+		this->_fill(1);
+		auto data = this->_get_buffered();
+		auto line_end = data.find('\n');
+		auto count = line_end == std::string_view::npos ? data.size() : line_end + 1;
+		line.append(data.substr(0, count));
+		this->_consume(count);
+		if (line_end != std::string_view::npos)
+		{
+			break;
+		}
+	}
+
+	return (ssize_t)line.size();
+}
+
+ssize_t BodyReader::read(std::string& buffer, size_t max_count)
+{
+	if (this->_limit == 0 || max_count == 0)
+	{
+		buffer.clear();
+		return 0;
+	}
+
+	this->_fill(1);
+	auto count = std::min(this->buffered(), max_count);
+	buffer.assign(this->_get_buffered().substr(0, count));
+	this->_consume(count);
+	return (ssize_t)count;
+}
+
+void BodyReader::peek(std::string& buffer, size_t count)
+{
+	this->_fill(count);
+	buffer.assign(this->_get_buffered().substr(0, count));
+}
+
+size_t BodyReader::buffered() const
+{
+	return this->_get_buffered().size();
+}
+
+ssize_t BodyReader::limit() const
+{
+	return this->_limit - (ssize_t)this->buffered();
+}
+
+const http::mime::multipart::TemporaryFile* BodyReader::spooled_file() const
+{
+	return this->_connection->body_file.get();
+}
+
+void BodyReader::discard()
+{
+	if (this->_connection->body_file)
+	{
+		this->_connection->body_file.reset();
+	}
+	else
+	{
+		this->_connection->consume(this->buffered());
+	}
+
+	this->_buffer.clear();
+	this->_buffer_offset = 0;
+	this->_file_offset = 0;
+	this->_limit = 0;
+}
+
+std::string_view BodyReader::_get_buffered() const
+{
+	auto data = this->_connection->body_file ?
+		std::string_view(this->_buffer).substr(this->_buffer_offset) : this->_connection->unread();
+	return data.substr(0, this->_limit);
+}
+
+void BodyReader::_consume(size_t count)
+{
+	this->_limit -= (ssize_t)count;
+	if (!this->_connection->body_file)
+	{
+		this->_connection->consume(count);
+		return;
+	}
+
+	this->_buffer_offset += count;
+	if (this->_buffer_offset == this->_buffer.size())
+	{
+		this->_buffer.clear();
+		this->_buffer_offset = 0;
+	}
+}
+
+void BodyReader::_fill(size_t count)
+{
+	auto* file = this->_connection->body_file.get();
+	count = std::min(count, (size_t)this->_limit);
+	if (file == nullptr || this->buffered() >= count)
+	{
+		return;
+	}
+
+	// The file is read by chunks, and bytes which are
+	// read already are dropped before the buffer grows.
+	this->_buffer.erase(0, this->_buffer_offset);
+	this->_buffer_offset = 0;
+	auto size = this->_buffer.size();
+	auto target_size = std::min(std::max(count, Connection::READ_CHUNK_SIZE), (size_t)this->_limit);
+	this->_buffer.resize(target_size);
+	while (size < target_size)
+	{
+		auto n = file->read(this->_file_offset, this->_buffer.data() + size, target_size - size);
+		if (n == 0)
+		{
+			this->_buffer.resize(size);
+			throw FileError("spooled request body is truncated", _ERROR_DETAILS_);
+		}
+
+		size += n;
+		this->_file_offset += n;
+	}
+}
+
+bool ResponseWriter::write(const char* data, size_t n)
+{
+	if (!this->_is_head_written)
+	{
+		this->_is_head_written = true;
+		return this->_write_head(data, n);
+	}
+
+	return !this->_is_body_allowed || this->_write(data, n);
+}
+
+bool ResponseWriter::write_file(int fd, size_t offset, size_t n)
+{
+	if (!this->_is_body_allowed)
+	{
+		return true;
+	}
+
+	if (!this->_connection->write_file(fd, offset, n))
+	{
+		this->_connection->is_keep_alive = false;
+		return false;
+	}
+
+	return true;
+}
+
+bool ResponseWriter::_write_head(const char* data, size_t n)
+{
+	auto* connection = this->_connection;
+	auto head = inspect_response_head(std::string_view(data, n));
+	if (head.size == 0)
+	{
+		// The head is written in parts, so it can not be completed and
+		// the end of the response is marked by closing the connection.
+		connection->is_keep_alive = false;
+		return this->_write(data, n);
+	}
+
+	this->_is_body_allowed = connection->context.method != "HEAD";
+	if (head.is_close || (this->_is_body_allowed && !head.is_delimited))
+	{
+		connection->is_keep_alive = false;
+	}
+
+	std::string_view option;
+	if (!connection->is_keep_alive && !head.is_close)
+	{
+		option = "Connection: close\r\n";
+	}
+	else if (connection->is_keep_alive && !head.has_connection && connection->context.protocol_version.minor == 0)
+	{
+		option = "Connection: keep-alive\r\n";
+	}
+
+	auto size = this->_is_body_allowed ? n : head.size;
+	if (option.empty())
+	{
+		return this->_write(data, size);
+	}
+
+	// The option is inserted before the empty line which terminates the head.
+	auto headers_size = head.size - 2;
+	return this->_write(data, headers_size) &&
+		this->_write(option.data(), option.size()) &&
+		this->_write(data + headers_size, size - headers_size);
+}
+
+bool ResponseWriter::_write(const char* data, size_t n)
+{
+	if (!this->_connection->write(data, n))
+	{
+		this->_connection->is_keep_alive = false;
+		return false;
+	}
+
+	return true;
+}
+
+Connection::Connection(int fd) :
+	_fd(fd),
+	_body_reader(std::make_shared<BodyReader>(this)),
+	_response_writer(std::make_shared<ResponseWriter>(this))
+{
+	this->context.body = this->_body_reader;
+	this->context.response_writer = this->_response_writer;
+}
+
+Connection::~Connection()
+{
+	::close(this->_fd);
+}
+
+void Connection::start_request()
+{
+	this->requests_count++;
+	this->environment[_REQUESTS_COUNT_KEY] = std::to_string(this->requests_count);
+	this->is_response_started = false;
+	this->error_status_code = 0;
+	this->_body_reader->set_limit((ssize_t)this->context.content_size);
+	this->_response_writer->reset();
+}
+
+void Connection::consume(size_t count)
+{
+	this->_read_offset += count;
+	if (this->_read_offset == this->_read_buffer.size())
+	{
+		this->_read_buffer.clear();
+		this->_read_offset = 0;
+	}
+}
+
+Connection::IOStatus Connection::receive(size_t max_unread_size)
+{
+	if (this->_read_offset > 0)
+	{
+		this->_read_buffer.erase(0, this->_read_offset);
+		this->_read_offset = 0;
+	}
+
+	this->is_receiving_paused = false;
+	while (true)
+	{
+		if (this->_read_buffer.size() >= max_unread_size)
+		{
+			this->is_receiving_paused = true;
+			return IOStatus::Ok;
+		}
+
+		auto size = this->_read_buffer.size();
+		this->_read_buffer.resize(size + READ_CHUNK_SIZE);
+		auto n = ::recv(this->_fd, this->_read_buffer.data() + size, READ_CHUNK_SIZE, 0);
+		this->_read_buffer.resize(size + std::max<ssize_t>(n, 0));
+		if (n > 0)
+		{
+			// A short read drains the socket, the next call would fail with
+			// EAGAIN, and the end of the stream is reported by EPOLLRDHUP.
+			if ((size_t)n < READ_CHUNK_SIZE)
+			{
+				return IOStatus::Ok;
+			}
+		}
+		else if (n == 0)
+		{
+			return IOStatus::Closed;
+		}
+		else if (errno == EAGAIN || errno == EWOULDBLOCK)
+		{
+			return IOStatus::Ok;
+		}
+		else if (errno != EINTR)
+		{
+			return IOStatus::Error;
+		}
+	}
+}
+
+bool Connection::spool_body(const std::string& directory)
+{
+	if (!this->body_file)
+	{
+		this->body_file = std::make_unique<http::mime::multipart::TemporaryFile>(directory);
+	}
+
+	auto count = std::min(this->unread().size(), this->context.content_size - this->body_file->size());
+	this->body_file->write(this->unread().substr(0, count));
+	this->consume(count);
+	return this->body_file->size() == this->context.content_size;
+}
+
+bool Connection::write(const char* data, size_t n)
+{
+	this->is_response_started = true;
+	if (this->_is_failed)
+	{
+		return false;
+	}
+
+	if (this->_write_file_size > 0)
+	{
+		if (this->flush() == IOStatus::Error || (this->_write_file_size > 0 && !this->_read_file()))
+		{
+			return false;
+		}
+	}
+
+	if (this->_write_buffer.size() - this->_write_offset + n > WRITE_BUFFER_SIZE)
+	{
+		if (this->flush() == IOStatus::Error)
+		{
+			return false;
+		}
+
+		// Large bodies are sent directly instead of being copied
+		// as far as the socket takes them.
+		if (!this->has_pending_writes())
+		{
+			auto sent = this->_send(data, n);
+			if (sent < 0)
+			{
+				return false;
+			}
+
+			data += sent;
+			n -= sent;
+		}
+	}
+
+	// Bytes which are sent already are dropped before the buffer grows.
+	if (this->_write_offset > 0 && n > 0)
+	{
+		this->_write_buffer.erase(0, this->_write_offset);
+		this->_write_offset = 0;
+	}
+
+	this->_write_buffer.append(data, n);
+	return true;
+}
+
+bool Connection::write_file(int fd, size_t offset, size_t n)
+{
+	this->is_response_started = true;
+	if (this->flush() == IOStatus::Error || (this->_write_file_size > 0 && !this->_read_file()))
+	{
+		return false;
+	}
+
+	this->_write_file_fd = fd;
+	this->_write_file_offset = offset;
+	this->_write_file_size = n;
+	return this->flush() == IOStatus::Ok;
+}
+
+Connection::IOStatus Connection::flush()
+{
+	if (this->_is_failed)
+	{
+		return IOStatus::Error;
+	}
+
+	if (this->_write_offset < this->_write_buffer.size())
+	{
+		auto pending = this->_write_buffer.size() - this->_write_offset;
+		auto sent = this->_send(this->_write_buffer.data() + this->_write_offset, pending);
+		if (sent < 0)
+		{
+			return IOStatus::Error;
+		}
+
+		this->_write_offset += sent;
+		if ((size_t)sent < pending)
+		{
+			return IOStatus::Ok;
+		}
+	}
+
+	this->_write_buffer.clear();
+	this->_write_offset = 0;
+	if (this->_write_file_size > 0 && !this->_send_file())
+	{
+		return IOStatus::Error;
+	}
+
+	return IOStatus::Ok;
+}
+
+void Connection::fail()
+{
+	if (!this->_is_failed)
+	{
+		this->_is_failed = true;
+		linger reset{.l_onoff = 1, .l_linger = 0};
+		::setsockopt(this->_fd, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+		::shutdown(this->_fd, SHUT_RDWR);
+	}
+}
+
+ssize_t Connection::_send(const char* data, size_t n)
+{
+	size_t sent = 0;
+	while (sent < n)
+	{
+		auto result = ::send(this->_fd, data + sent, n - sent, MSG_NOSIGNAL);
+		if (result >= 0)
+		{
+			sent += result;
+		}
+		else if (errno == EAGAIN || errno == EWOULDBLOCK)
+		{
+			break;
+		}
+		else if (errno != EINTR)
+		{
+			this->_is_failed = true;
+			return -1;
+		}
+	}
+
+	return (ssize_t)sent;
+}
+
+bool Connection::_send_file()
+{
+	while (this->_write_file_size > 0)
+	{
+		auto offset = (off_t)this->_write_file_offset;
+		auto result = ::sendfile(this->_fd, this->_write_file_fd, &offset, this->_write_file_size);
+		if (result > 0)
+		{
+			this->_write_file_offset += result;
+			this->_write_file_size -= result;
+		}
+		else if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+		{
+			return true;
+		}
+		else if (result == 0 || errno != EINTR)
+		{
+			// The response is incomplete when the file is truncated,
+			// so the connection can not be used anymore.
+			this->_is_failed = true;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool Connection::_read_file()
+{
+	auto size = this->_write_buffer.size();
+	this->_write_buffer.resize(size + this->_write_file_size);
+	while (this->_write_file_size > 0)
+	{
+		auto result = ::pread(
+			this->_write_file_fd, this->_write_buffer.data() + size,
+			this->_write_file_size, (off_t)this->_write_file_offset
+		);
+		if (result > 0)
+		{
+			size += result;
+			this->_write_file_offset += result;
+			this->_write_file_size -= result;
+		}
+		else if (result == 0 || errno != EINTR)
+		{
+			this->_write_buffer.resize(size);
+			this->_is_failed = true;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+__SERVER_END__
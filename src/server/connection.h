@@ -0,0 +1,453 @@
+/**
+ * server/connection.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Client connection with its read and write buffers.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <chrono>
+#include <coroutine>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Base libraries.
+#include <xalwart.base/io.h>
+#include <xalwart.base/net/request_context.h>
+
+// Module definitions.
+#include "./_def_.h"
+
+// Framework libraries.
+#include "./parser.h"
+#include "../http/mime/multipart/temporary_file.h"
+#include "../utility/arena.h"
+#include "../utility/task.h"
+
+
+__SERVER_BEGIN__
+
+class Connection;
+
+// TESTME: BodyReader
+// Reads the body of the current request of the connection. The body is
+// received completely before the handler is called, so the reader never
+// waits for the socket: small bodies are read from the read buffer, large
+// ones from the file they are spooled to, see 'Connection::spool_body()'.
+class BodyReader : public io::ILimitedBufferedReader, public http::mime::multipart::ISpooledReader
+{
+public:
+	inline explicit BodyReader(Connection* connection) : _connection(connection)
+	{
+	}
+
+	ssize_t read_line(std::string& line) override;
+
+	ssize_t read(std::string& buffer, size_t max_count) override;
+
+	inline bool close_reader() override
+	{
+		return true;
+	}
+
+	void peek(std::string& buffer, size_t count) override;
+
+	// Returns count of bytes of the body which are in memory.
+	[[nodiscard]]
+	size_t buffered() const override;
+
+	// Returns count of bytes of the spooled body which
+	// are not read from the file yet.
+	[[nodiscard]]
+	ssize_t limit() const override;
+
+	inline void set_limit(ssize_t limit) override
+	{
+		this->_limit = limit < 0 ? 0 : limit;
+	}
+
+	[[nodiscard]]
+	const http::mime::multipart::TemporaryFile* spooled_file() const override;
+
+	[[nodiscard]]
+	inline size_t spooled_position() const override
+	{
+		return this->_file_offset - (this->_buffer.size() - this->_buffer_offset);
+	}
+
+	// Drops the rest of the body, so the next request can be parsed.
+	void discard();
+
+private:
+	Connection* _connection;
+
+	// Count of bytes of the body which are not read yet.
+	ssize_t _limit = 0;
+
+	// Chunk of the spooled body which is read from the file.
+	std::string _buffer;
+	size_t _buffer_offset = 0;
+
+	// Position of the next chunk in the file.
+	size_t _file_offset = 0;
+
+	// Returns bytes of the body which are in memory and not read yet.
+	[[nodiscard]]
+	std::string_view _get_buffered() const;
+
+	void _consume(size_t count);
+
+	// Reads the spooled body from the file until at least `count`
+	// bytes of it are in memory, or until the end of the body.
+	void _fill(size_t count);
+};
+
+// TESTME: ResponseWriter
+// Writes the response to the connection, see 'Connection::write()'.
+// A coroutine which produces a large response waits for the client to
+// read it, see 'drain()'.
+//
+// The head of the response is expected to be written by the first call.
+// It decides whether the connection is reused: the 'Connection' header is
+// added to the head when the connection is closed after the response, or
+// when HTTP/1.0 client is allowed to send the next request. The body of
+// the response to HEAD request is dropped.
+class ResponseWriter : public io::IWriter
+{
+public:
+	inline explicit ResponseWriter(Connection* connection) : _connection(connection)
+	{
+	}
+
+	bool write(const char* data, size_t n) override;
+
+	// Writes `n` bytes of the file from `offset` as the body of the
+	// response, see 'Connection::write_file()'. The head is expected
+	// to be written before.
+	bool write_file(int fd, size_t offset, size_t n);
+
+	inline bool close_writer() override
+	{
+		return true;
+	}
+
+	// Returns awaitable which suspends the coroutine until the client reads
+	// the response which fills the write buffer, so the next part of it is
+	// produced when it can be sent instead of being kept in memory. It does
+	// not suspend when the buffer has room or the connection failed.
+	[[nodiscard]]
+	auto drain() const;
+
+	// Prepares the writer for the response to the next request.
+	inline void reset()
+	{
+		this->_is_head_written = false;
+		this->_is_body_allowed = true;
+	}
+
+private:
+	Connection* _connection;
+	bool _is_head_written = false;
+	bool _is_body_allowed = true;
+
+	bool _write_head(const char* data, size_t n);
+
+	// Writes to the connection, the connection is not
+	// reused if writing fails.
+	bool _write(const char* data, size_t n);
+};
+
+// TESTME: Connection
+// Non-blocking client socket. The event loop which owns the connection
+// fills the read buffer when the socket is readable and flushes the write
+// buffer when it is writable. Neither the body reader nor the response
+// writer wait for the socket: the body is received before the request is
+// handled, and the response which the socket does not take is kept until
+// the socket is writable, so a slow client does not hold up the loop.
+//
+// The connection is persistent: requests are read one after another
+// until one of them or its response asks to close it.
+class Connection final
+{
+public:
+	enum class IOStatus
+	{
+		// The socket would block.
+		Ok,
+
+		// The peer closed its side of the connection.
+		Closed,
+		Error
+	};
+
+	// Count of written bytes which are not sent yet, after which no more
+	// of the response should be produced until the client reads it, see
+	// 'ResponseWriter::drain()'. Bytes of a single write which the socket
+	// does not take are kept completely, so the buffer may be larger.
+	static inline constexpr size_t WRITE_BUFFER_SIZE = 64 * 1024;
+
+	// Count of bytes which are requested from the socket
+	// or from a spooled file at a time.
+	static inline constexpr size_t READ_CHUNK_SIZE = 16 * 1024;
+
+	// Context of the current request, it is reused by the
+	// requests of the connection.
+	net::RequestContext context;
+
+	// Environment of the server with counters of the connection,
+	// see 'server/meta.h'.
+	std::map<std::string, std::string> environment;
+
+	// Memory of the current request, it is taken from the worker when the
+	// request is handled and returned after the response, see 'Handler'.
+	std::unique_ptr<util::Arena> arena;
+
+	// Nodes of headers of the previous request which are reused
+	// by the next one, see 'parse_request_head()'.
+	HeaderNodes spare_header_nodes;
+
+	// Asynchronous handler of the current request which is suspended,
+	// see 'Worker::_run_async_handler()'.
+	util::Task<> task;
+
+	// The handler of the current request is suspended, so the connection
+	// is not processed, closed or expired until it is finished.
+	bool is_suspended = false;
+
+	// Coroutine of the suspended handler which waits for the client
+	// to read the response, see 'ResponseWriter::drain()'.
+	std::coroutine_handle<> writer_waiter;
+
+	// The worker counts the time of 'writer_waiter', and the connection
+	// is failed if the client does not read the response in time.
+	bool is_writer_waiting = false;
+
+	// Connections which handlers start to wait for their clients, the
+	// worker sets it and takes them after resuming handlers.
+	std::vector<Connection*>* waiting_connections = nullptr;
+
+	// Status code of the error which is thrown by the handler
+	// of the current request, or zero.
+	unsigned short int error_status_code = 0;
+
+	// Time after which the connection is closed. It is set when the
+	// request starts and is not moved by receiving parts of its head, so
+	// a client which sends the head slowly does not keep the connection.
+	// It is moved when a part of the body is received, so an upload which
+	// is longer than the timeout is not cut, and when the client reads a
+	// part of the response.
+	std::chrono::steady_clock::time_point deadline;
+
+	// Position in the list of connections of the event loop.
+	std::list<std::unique_ptr<Connection>>::iterator position;
+
+	// The connection waits for the next request after the response is
+	// sent, and 'position' points to the list of idle connections.
+	bool is_idle = false;
+
+	// Count of requests which are handled, including the current one.
+	size_t requests_count = 0;
+
+	// The next request may be read after the current response,
+	// otherwise the connection is closed.
+	bool is_keep_alive = false;
+
+	// The head of the current request is parsed and consumed
+	// already, but the body is not received yet.
+	bool is_head_parsed = false;
+
+	// File which the body of the current request is spooled to if it
+	// does not fit 'Worker::MAX_BUFFERED_BODY_SIZE', or nullptr.
+	std::unique_ptr<http::mime::multipart::TemporaryFile> body_file;
+
+	enum class State
+	{
+		// Receives and processes requests.
+		Reading,
+
+		// Sends the rest of the last response.
+		Closing,
+
+		// Waits for the peer to close the connection,
+		// see 'Worker::_start_closing()'.
+		Lingering
+	};
+
+	State state = State::Reading;
+
+	// The peer does not send more data.
+	bool is_peer_closed = false;
+
+	// The socket may have bytes which are not received yet, because the
+	// connection was not processed or had no room for them when it was
+	// readable, see 'receive()'.
+	bool is_receiving_paused = false;
+
+	// The peer closed its side of the connection, but bytes which are
+	// sent before it may be left in the socket.
+	bool is_peer_closing = false;
+
+	// At least one byte of the response to the
+	// current request is written.
+	bool is_response_started = false;
+
+	explicit Connection(int fd);
+
+	Connection(const Connection&) = delete;
+	Connection& operator= (const Connection&) = delete;
+
+	~Connection();
+
+	// Prepares the body reader, the response writer and the environment
+	// for the request which 'context' is filled by.
+	void start_request();
+
+	[[nodiscard]]
+	inline int fd() const
+	{
+		return this->_fd;
+	}
+
+	[[nodiscard]]
+	inline BodyReader* body_reader() const
+	{
+		return this->_body_reader.get();
+	}
+
+	// Returns received bytes which are not consumed yet.
+	[[nodiscard]]
+	inline std::string_view unread() const
+	{
+		return std::string_view(this->_read_buffer).substr(this->_read_offset);
+	}
+
+	// Drops `count` bytes from the beginning of 'unread()'.
+	void consume(size_t count);
+
+	// Receives bytes to the read buffer until the socket would block, as
+	// required by edge-triggered notifications, or until 'unread()' has
+	// `max_unread_size` bytes, then the receiving is paused.
+	IOStatus receive(size_t max_unread_size);
+
+	// Moves received bytes of the body of the current request to
+	// 'body_file', creating it in `directory` if needed, so the form
+	// parser copies uploads from it without reading them.
+	//
+	// @return true if the whole body is received.
+	// @throws FileError if the file can not be written.
+	bool spool_body(const std::string& directory);
+
+	// Appends `data` to the write buffer. When the buffer is full, bytes
+	// are sent as far as the socket takes them without waiting, and the
+	// rest is kept until the socket is writable.
+	//
+	// @return false if the connection failed.
+	bool write(const char* data, size_t n);
+
+	// Appends `n` bytes of the file from `offset` to the written ones.
+	// The kernel sends them from the file by 'sendfile()' without copying
+	// them to the memory, so the file must not be closed until they are
+	// sent, see 'is_write_buffer_full()'. If the range of the file which
+	// is written before is not sent yet, it is read to the write buffer.
+	//
+	// @return false if the connection failed or the file can not be read.
+	bool write_file(int fd, size_t offset, size_t n);
+
+	// Sends written bytes until the socket would block.
+	IOStatus flush();
+
+	// Makes writes fail and the peer get a reset, so the handler which
+	// writes the response finishes as soon as possible.
+	void fail();
+
+	[[nodiscard]]
+	inline bool is_failed() const
+	{
+		return this->_is_failed;
+	}
+
+	[[nodiscard]]
+	inline bool has_pending_writes() const
+	{
+		return this->_write_offset < this->_write_buffer.size() || this->_write_file_size > 0;
+	}
+
+	// More of the response should not be produced until the client reads
+	// the written part of it, which includes the whole range of the file.
+	[[nodiscard]]
+	inline bool is_write_buffer_full() const
+	{
+		return this->_write_buffer.size() - this->_write_offset > WRITE_BUFFER_SIZE || this->_write_file_size > 0;
+	}
+
+private:
+	int _fd;
+
+	std::string _read_buffer;
+	size_t _read_offset = 0;
+
+	std::string _write_buffer;
+	size_t _write_offset = 0;
+
+	// Range of the file which follows the write buffer, see 'write_file()'.
+	int _write_file_fd = -1;
+	size_t _write_file_offset = 0;
+	size_t _write_file_size = 0;
+
+	// Sending failed, so nothing is written anymore.
+	bool _is_failed = false;
+
+	std::shared_ptr<BodyReader> _body_reader;
+	std::shared_ptr<ResponseWriter> _response_writer;
+
+	// Sends bytes until the socket would block.
+	//
+	// @return count of bytes which are sent, or -1 on error.
+	ssize_t _send(const char* data, size_t n);
+
+	// Sends the range of the file until the socket would block.
+	//
+	// @return false on error, or if the file is shorter than the range.
+	bool _send_file();
+
+	// Moves the range of the file which is not sent yet to the write
+	// buffer, so bytes which are written after it are sent in order.
+	bool _read_file();
+};
+
+inline auto ResponseWriter::drain() const
+{
+	struct Awaiter
+	{
+		Connection* connection;
+
+		[[nodiscard]]
+		inline bool await_ready() const noexcept
+		{
+			return !this->connection->is_write_buffer_full() ||
+				this->connection->is_failed() ||
+				this->connection->waiting_connections == nullptr;
+		}
+
+		inline void await_suspend(std::coroutine_handle<> handle) const
+		{
+			this->connection->writer_waiter = handle;
+			this->connection->waiting_connections->push_back(this->connection);
+		}
+
+		inline void await_resume() const noexcept
+		{
+		}
+	};
+
+	return Awaiter{this->_connection};
+}
+
+__SERVER_END__
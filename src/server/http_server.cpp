@@ -0,0 +1,308 @@
+/**
+ * server/http_server.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./http_server.h"
+
+// C++ libraries.
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <thread>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Base libraries.
+#include <xalwart.base/exceptions.h>
+#include <xalwart.base/net/meta.h>
+
+
+__SERVER_BEGIN__
+
+// Creates non-blocking socket which listens on `address`. Other
+// sockets may be bound to the same address, see SO_REUSEPORT.
+//
+// @return descriptor of the socket, or -1 with 'errno' set.
+static int _listen_on(const sockaddr* address, socklen_t address_size)
+{
+	int fd = ::socket(address->sa_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+	{
+		return -1;
+	}
+
+	int enable = 1;
+	if (
+		::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) < 0 ||
+		::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) < 0 ||
+		::bind(fd, address, address_size) < 0 ||
+		::listen(fd, SOMAXCONN) < 0
+	)
+	{
+		auto error = errno;
+		::close(fd);
+		errno = error;
+		return -1;
+	}
+
+	return fd;
+}
+
+// Binds `address` without SO_REUSEPORT, so it fails while another server
+// listens on it, even if that server shares it with SO_REUSEPORT. The
+// address is released before listeners are bound.
+//
+// @return zero if the address is free, otherwise the error of binding it.
+static int _check_address(const sockaddr* address, socklen_t address_size)
+{
+	int fd = ::socket(address->sa_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+	{
+		return errno;
+	}
+
+	// Connections of the previous instance which are
+	// not closed yet do not make the address busy.
+	int enable = 1;
+	int error = 0;
+	if (
+		::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) < 0 ||
+		::bind(fd, address, address_size) < 0
+	)
+	{
+		error = errno;
+	}
+
+	::close(fd);
+	return error;
+}
+
+static uint16_t _get_port(const sockaddr_storage& address)
+{
+	return ntohs(
+		address.ss_family == AF_INET6 ?
+			((const sockaddr_in6*)&address)->sin6_port : ((const sockaddr_in*)&address)->sin_port
+	);
+}
+
+// Returns cores which the process is allowed to run on.
+static std::vector<int> _get_allowed_cores()
+{
+	std::vector<int> cores;
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+	if (::sched_getaffinity(0, sizeof(allowed), &allowed) == 0)
+	{
+		for (int core = 0; core < CPU_SETSIZE; core++)
+		{
+			if (CPU_ISSET(core, &allowed))
+			{
+				cores.push_back(core);
+			}
+		}
+	}
+
+	return cores;
+}
+
+HTTPServer::HTTPServer(Config config, Handler handler, std::shared_ptr<ILogger> logger) :
+	_config(config), _handler(std::move(handler)), _logger(std::move(logger))
+{
+	if (!this->_handler)
+	{
+		throw NullPointerException("'handler' is not initialized", _ERROR_DETAILS_);
+	}
+
+	this->_initialize();
+}
+
+HTTPServer::HTTPServer(Config config, AsyncHandler handler, std::shared_ptr<ILogger> logger) :
+	_config(config), _async_handler(std::move(handler)), _logger(std::move(logger))
+{
+	if (!this->_async_handler)
+	{
+		throw NullPointerException("'handler' is not initialized", _ERROR_DETAILS_);
+	}
+
+	this->_initialize();
+}
+
+void HTTPServer::_initialize()
+{
+	require_non_null(this->_logger.get(), "'logger' is nullptr", _ERROR_DETAILS_);
+	if (this->_config.workers == 0)
+	{
+		this->_config.workers = std::max<size_t>(_get_allowed_cores().size(), 1);
+	}
+}
+
+void HTTPServer::bind(const std::string& address, uint16_t port)
+{
+	if (!this->_workers.empty())
+	{
+		throw RuntimeError("server is bound already", _ERROR_DETAILS_);
+	}
+
+	auto host = address;
+	if (host.size() > 1 && host.front() == '[' && host.back() == ']')
+	{
+		host = host.substr(1, host.size() - 2);
+	}
+
+	addrinfo hints{};
+	hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	addrinfo* addresses = nullptr;
+	auto status = ::getaddrinfo(
+		host.empty() ? nullptr : host.c_str(), std::to_string(port).c_str(), &hints, &addresses
+	);
+	if (status != 0)
+	{
+		throw RuntimeError(
+			"unable to resolve '" + address + "': " + std::string(::gai_strerror(status)), _ERROR_DETAILS_
+		);
+	}
+
+	sockaddr_storage socket_address{};
+	socklen_t address_size = addresses->ai_addrlen;
+	std::memcpy(&socket_address, addresses->ai_addr, address_size);
+	::freeaddrinfo(addresses);
+
+	std::vector<int> listeners;
+	size_t retries_count = 0;
+	while (listeners.size() < this->_config.workers)
+	{
+		// Listeners share the address with SO_REUSEPORT, which would
+		// let them share it with another running server as well.
+		auto error = listeners.empty() && port != 0 ?
+			_check_address((sockaddr*)&socket_address, address_size) : 0;
+		if (error == 0)
+		{
+			int fd = _listen_on((sockaddr*)&socket_address, address_size);
+			if (fd >= 0)
+			{
+				if (listeners.empty() && port == 0)
+				{
+					// Other sockets are bound to the port which is chosen for the first one.
+					::getsockname(fd, (sockaddr*)&socket_address, &address_size);
+				}
+
+				listeners.push_back(fd);
+				continue;
+			}
+
+			error = errno;
+		}
+
+		for (auto listener : listeners)
+		{
+			::close(listener);
+		}
+
+		listeners.clear();
+		if (error != EADDRINUSE || retries_count++ == this->_config.retries)
+		{
+			throw RuntimeError(
+				"unable to bind '" + address + ":" + std::to_string(port) + "': " + std::strerror(error),
+				_ERROR_DETAILS_
+			);
+		}
+
+		this->_logger->warning(
+			"Address is in use, probably by another server, retrying in 1 second", _ERROR_DETAILS_
+		);
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+	}
+
+	this->_port = _get_port(socket_address);
+	this->_environment = {
+		{net::meta::SERVER_NAME, address},
+		{net::meta::SERVER_PORT, std::to_string(this->_port)}
+	};
+	for (size_t i = 0; i < listeners.size(); i++)
+	{
+		try
+		{
+			this->_workers.push_back(std::make_unique<Worker>(
+				listeners[i], this->_config, this->_handler, this->_async_handler, this->_environment, this->_logger
+			));
+		}
+		catch (...)
+		{
+			// The failed worker closes its listener.
+			std::for_each(listeners.begin() + (long)i + 1, listeners.end(), ::close);
+			this->_workers.clear();
+			throw;
+		}
+	}
+}
+
+void HTTPServer::listen(const std::string& startup_message)
+{
+	if (this->_workers.empty())
+	{
+		throw RuntimeError("server is not bound", _ERROR_DETAILS_);
+	}
+
+	this->_logger->print(startup_message, ILogger::Color::Default, '\n');
+	auto cores = _get_allowed_cores();
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < this->_workers.size(); i++)
+	{
+		threads.emplace_back([this, worker = this->_workers[i].get()]() -> void
+		{
+			// Unlike 'send()', 'sendfile()' has no flag to suppress the
+			// signal when the peer is closed, so the signal is blocked
+			// and the call fails with EPIPE instead.
+			sigset_t signals;
+			::sigemptyset(&signals);
+			::sigaddset(&signals, SIGPIPE);
+			::pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+			try
+			{
+				worker->run();
+			}
+			catch (const BaseException& exc)
+			{
+				this->_logger->error(exc);
+			}
+			catch (const std::exception& exc)
+			{
+				this->_logger->error(exc.what(), _ERROR_DETAILS_);
+			}
+		});
+
+		// Loops do not share anything, so each of them keeps its
+		// connections in the caches of its own core.
+		if (cores.size() >= this->_workers.size())
+		{
+			cpu_set_t core;
+			CPU_ZERO(&core);
+			CPU_SET(cores[i], &core);
+			::pthread_setaffinity_np(threads.back().native_handle(), sizeof(core), &core);
+		}
+	}
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+}
+
+void HTTPServer::close()
+{
+	for (auto& worker : this->_workers)
+	{
+		worker->stop();
+	}
+}
+
+__SERVER_END__
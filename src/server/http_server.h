@@ -0,0 +1,88 @@
+/**
+ * server/http_server.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * HTTP/1.1 server over epoll with an event loop per core.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Base libraries.
+#include <xalwart.base/interfaces/base.h>
+#include <xalwart.base/interfaces/server.h>
+
+// Module definitions.
+#include "./_def_.h"
+
+// Framework libraries.
+#include "./types.h"
+#include "./worker.h"
+
+
+__SERVER_BEGIN__
+
+// TESTME: HTTPServer
+// Runs 'Config::workers' event loops, see 'Worker'. Each of them has its
+// own listening socket bound to the same address with SO_REUSEPORT, so
+// connections are distributed by the kernel and loops do not contend for
+// a shared accept queue. Threads of loops are pinned to separate cores
+// when there are enough of them.
+//
+// 'listen()' blocks until 'close()' is called from another thread.
+class HTTPServer : public IServer
+{
+public:
+	HTTPServer(Config config, Handler handler, std::shared_ptr<ILogger> logger);
+
+	// Requests are handled by coroutines, so each loop processes other
+	// requests while some of them are suspended.
+	HTTPServer(Config config, AsyncHandler handler, std::shared_ptr<ILogger> logger);
+
+	~HTTPServer() override = default;
+
+	// Creates listening sockets, trying again every second while the
+	// address is in use, see 'Config::retries'. The address which another
+	// server listens on is in use even if it is bound with SO_REUSEPORT.
+	//
+	// @param address: IPv4 or IPv6 address, possibly in brackets, or host name.
+	// @param port: port to listen on, zero means any free port, see 'port()'.
+	void bind(const std::string& address, uint16_t port) override;
+
+	void listen(const std::string& startup_message) override;
+
+	void close() override;
+
+	[[nodiscard]]
+	inline bool is_development() const override
+	{
+		return false;
+	}
+
+	// Returns the port which the server is bound to.
+	[[nodiscard]]
+	inline uint16_t port() const
+	{
+		return this->_port;
+	}
+
+private:
+	Config _config;
+	Handler _handler;
+	AsyncHandler _async_handler;
+	std::shared_ptr<ILogger> _logger;
+	std::map<std::string, std::string> _environment;
+	std::vector<std::unique_ptr<Worker>> _workers;
+	uint16_t _port = 0;
+
+	// Validates the logger and sets the default count of workers.
+	void _initialize();
+};
+
+__SERVER_END__
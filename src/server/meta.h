@@ -0,0 +1,26 @@
+/**
+ * server/meta.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Keys of the environment which are set by 'HTTPServer' for each request
+ * in addition to 'net::meta' ones.
+ */
+
+#pragma once
+
+// Module definitions.
+#include "./_def_.h"
+
+
+__SERVER_META_BEGIN__
+
+// Identifier of the connection which the request is received over,
+// it is unique within the process.
+inline constexpr const char* CONNECTION_ID = "CONNECTION_ID";
+
+// Count of requests which are received over the connection,
+// including the current one, so it is "1" for the first request.
+inline constexpr const char* CONNECTION_REQUESTS_COUNT = "CONNECTION_REQUESTS_COUNT";
+
+__SERVER_META_END__
@@ -0,0 +1,419 @@
+/**
+ * server/parser.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./parser.h"
+
+// C++ libraries.
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+
+// Framework libraries.
+#include "../http/headers.h"
+#include "../http/header_map.h"
+
+
+__SERVER_BEGIN__
+
+// Nodes of headers with larger values are not kept for the next request,
+// so idle connections do not hold memory of huge headers.
+inline constexpr size_t _MAX_SPARE_HEADER_SIZE = 4096;
+
+// Returns true if `c` may be used in a method or a header name, see
+// 'tchar' in RFC 7230, section 3.2.6.
+static inline bool _is_token_char(char c)
+{
+	switch (c)
+	{
+		case '!': case '#': case '$': case '%': case '&': case '\'': case '*':
+		case '+': case '-': case '.': case '^': case '_': case '`': case '|': case '~':
+			return true;
+		default:
+			return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+	}
+}
+
+static inline bool _is_token(std::string_view s)
+{
+	if (s.empty())
+	{
+		return false;
+	}
+
+	for (auto c : s)
+	{
+		if (!_is_token_char(c))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static inline std::string_view _trim_whitespace(std::string_view s)
+{
+	while (!s.empty() && (s.front() == ' ' || s.front() == '\t'))
+	{
+		s.remove_prefix(1);
+	}
+
+	while (!s.empty() && (s.back() == ' ' || s.back() == '\t'))
+	{
+		s.remove_suffix(1);
+	}
+
+	return s;
+}
+
+static inline bool _equals_ignore_case(std::string_view left, std::string_view right)
+{
+	if (left.size() != right.size())
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < left.size(); i++)
+	{
+		if (std::tolower((unsigned char)left[i]) != std::tolower((unsigned char)right[i]))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Returns true if comma-separated `list` contains `token`,
+// case-insensitively, see RFC 7230, section 7.
+static inline bool _has_token(std::string_view list, std::string_view token)
+{
+	while (!list.empty())
+	{
+		auto end = std::min(list.find(','), list.size());
+		if (_equals_ignore_case(_trim_whitespace(list.substr(0, end)), token))
+		{
+			return true;
+		}
+
+		list.remove_prefix(std::min(end + 1, list.size()));
+	}
+
+	return false;
+}
+
+// Splits the request target in origin form or in absolute form to path
+// and query, the fragment is dropped.
+static inline bool _parse_target(std::string_view target, net::RequestContext& context)
+{
+	for (auto c : target)
+	{
+		if ((unsigned char)c <= ' ' || c == 0x7f)
+		{
+			return false;
+		}
+	}
+
+	if (target.starts_with("http://") || target.starts_with("https://"))
+	{
+		target.remove_prefix(target.find("//") + 2);
+		auto path_start = target.find_first_of("/?");
+		target = path_start == std::string_view::npos ? "/" : target.substr(path_start);
+	}
+	else if (!target.starts_with('/') && target != "*")
+	{
+		return false;
+	}
+
+	target = target.substr(0, target.find('#'));
+	auto query_start = target.find('?');
+	context.path = target.substr(0, query_start);
+	context.query = query_start == std::string_view::npos ? "" : target.substr(query_start + 1);
+	if (context.path.empty())
+	{
+		context.path = "/";
+	}
+
+	return true;
+}
+
+static inline ParseStatus _parse_request_line(std::string_view line, net::RequestContext& context)
+{
+	auto method_end = line.find(' ');
+	auto target_end = line.rfind(' ');
+	if (method_end == std::string_view::npos || method_end == target_end)
+	{
+		return ParseStatus::BadRequest;
+	}
+
+	auto method = line.substr(0, method_end);
+	auto target = line.substr(method_end + 1, target_end - method_end - 1);
+	auto version = line.substr(target_end + 1);
+	if (!_is_token(method) || target.empty() || !_parse_target(target, context))
+	{
+		return ParseStatus::BadRequest;
+	}
+
+	if (
+		version.size() != 8 || !version.starts_with("HTTP/") || version[6] != '.' ||
+		!std::isdigit((unsigned char)version[5]) || !std::isdigit((unsigned char)version[7])
+	)
+	{
+		return ParseStatus::BadRequest;
+	}
+
+	if (version[5] != '1')
+	{
+		return ParseStatus::VersionNotSupported;
+	}
+
+	context.method = method;
+	context.protocol_version.major = version[5] - '0';
+	context.protocol_version.minor = version[7] - '0';
+	return ParseStatus::Done;
+}
+
+// Returns the node of header `key`, which is taken from `spare_nodes` if
+// there is one. Strings of a spare node keep their capacity, so assigning
+// them usually does not allocate memory.
+static inline std::map<std::string, std::string>::node_type _make_header_node(
+	std::string_view key, HeaderNodes* spare_nodes
+)
+{
+	if (!spare_nodes || spare_nodes->empty())
+	{
+		std::map<std::string, std::string> nodes;
+		nodes.emplace(key, std::string());
+		return nodes.extract(nodes.begin());
+	}
+
+	auto node = std::move(spare_nodes->back());
+	spare_nodes->pop_back();
+	node.key().assign(key);
+	node.mapped().clear();
+	return node;
+}
+
+static inline ParseStatus _add_header(std::string_view line, net::RequestContext& context, HeaderNodes* spare_nodes)
+{
+	auto colon = line.find(':');
+	if (colon == std::string_view::npos)
+	{
+		return ParseStatus::BadRequest;
+	}
+
+	// Whitespace between the name and the colon, as well as obsolete
+	// line folding, is rejected, see RFC 7230, section 3.2.4.
+	auto name = line.substr(0, colon);
+	if (!_is_token(name))
+	{
+		return ParseStatus::BadRequest;
+	}
+
+	auto value = _trim_whitespace(line.substr(colon + 1));
+	auto id = http::get_header_id(name);
+	if (id == http::HeaderId::TransferEncoding && !_equals_ignore_case(value, "identity"))
+	{
+		return ParseStatus::NotImplemented;
+	}
+
+	std::string_view key = id ? http::get_header_name(*id) : name;
+	if (!id && _equals_ignore_case(name, http::CONNECTION))
+	{
+		key = http::CONNECTION;
+	}
+
+	if (id == http::HeaderId::ContentLength)
+	{
+		size_t content_size = 0;
+		auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), content_size);
+		if (value.empty() || error != std::errc() || end != value.data() + value.size())
+		{
+			return ParseStatus::BadRequest;
+		}
+
+		if (context.headers.contains(http::CONTENT_LENGTH) && context.content_size != content_size)
+		{
+			return ParseStatus::BadRequest;
+		}
+
+		context.content_size = content_size;
+	}
+
+	// The key of the node is used for lookup, so the key is not
+	// copied to a temporary string.
+	auto node = _make_header_node(key, spare_nodes);
+	auto header = context.headers.find(node.key());
+	if (header == context.headers.end())
+	{
+		node.mapped().assign(value);
+		context.headers.insert(std::move(node));
+		return ParseStatus::Done;
+	}
+
+	if (id == http::HeaderId::ContentLength)
+	{
+		header->second.assign(value);
+	}
+	else
+	{
+		header->second.append(", ").append(value);
+	}
+
+	if (spare_nodes)
+	{
+		spare_nodes->push_back(std::move(node));
+	}
+
+	return ParseStatus::Done;
+}
+
+ParseResult parse_request_head(
+	std::string_view data, net::RequestContext& context, size_t max_header_length, size_t max_headers_count,
+	HeaderNodes* spare_nodes
+)
+{
+	auto head_end = data.find("\r\n\r\n");
+	if (head_end == std::string_view::npos)
+	{
+		auto first_line_end = data.find("\r\n");
+		bool is_too_large = first_line_end == std::string_view::npos ?
+			data.size() > max_header_length :
+			data.size() > (max_header_length + 2) * (max_headers_count + 1) + 2;
+		return {.status = is_too_large ? ParseStatus::HeadersTooLarge : ParseStatus::Incomplete};
+	}
+
+	if (spare_nodes)
+	{
+		while (!context.headers.empty())
+		{
+			auto node = context.headers.extract(context.headers.begin());
+			if (node.key().capacity() + node.mapped().capacity() <= _MAX_SPARE_HEADER_SIZE)
+			{
+				spare_nodes->push_back(std::move(node));
+			}
+		}
+	}
+	else
+	{
+		context.headers.clear();
+	}
+
+	context.content_size = 0;
+	auto head = data.substr(0, head_end + 2);
+	auto line_end = head.find("\r\n");
+	if (line_end > max_header_length)
+	{
+		return {.status = ParseStatus::HeadersTooLarge};
+	}
+
+	auto status = _parse_request_line(head.substr(0, line_end), context);
+	if (status != ParseStatus::Done)
+	{
+		return {.status = status};
+	}
+
+	size_t headers_count = 0;
+	for (auto line_start = line_end + 2; line_start < head.size(); line_start = line_end + 2)
+	{
+		line_end = head.find("\r\n", line_start);
+		if (line_end - line_start > max_header_length || ++headers_count > max_headers_count)
+		{
+			return {.status = ParseStatus::HeadersTooLarge};
+		}
+
+		status = _add_header(head.substr(line_start, line_end - line_start), context, spare_nodes);
+		if (status != ParseStatus::Done)
+		{
+			return {.status = status};
+		}
+	}
+
+	auto connection = context.headers.find(http::CONNECTION);
+	auto options = connection == context.headers.end() ? std::string_view() : std::string_view(connection->second);
+	return {
+		.status = ParseStatus::Done,
+		.size = head_end + 4,
+		.is_keep_alive = context.protocol_version.minor == 0 ?
+			_has_token(options, "keep-alive") : !_has_token(options, "close")
+	};
+}
+
+ResponseHead inspect_response_head(std::string_view data)
+{
+	auto head_end = data.find("\r\n\r\n");
+	if (head_end == std::string_view::npos)
+	{
+		return {};
+	}
+
+	ResponseHead result{.size = head_end + 4};
+	auto head = data.substr(0, head_end + 2);
+	auto line_end = head.find("\r\n");
+
+	// Status line is "HTTP/1.x NNN reason".
+	auto status_line = head.substr(0, line_end);
+	if (status_line.size() < 12 || !status_line.starts_with("HTTP/1.") || status_line[8] != ' ')
+	{
+		return result;
+	}
+
+	unsigned short int status_code = 0;
+	auto [end, error] = std::from_chars(status_line.data() + 9, status_line.data() + 12, status_code);
+	if (error != std::errc() || end != status_line.data() + 12)
+	{
+		return result;
+	}
+
+	result.is_delimited = status_code < 200 || status_code == 204 || status_code == 304;
+	for (auto line_start = line_end + 2; line_start < head.size(); line_start = line_end + 2)
+	{
+		line_end = head.find("\r\n", line_start);
+		auto line = head.substr(line_start, line_end - line_start);
+		auto colon = std::min(line.find(':'), line.size());
+		auto name = line.substr(0, colon);
+		auto value = _trim_whitespace(line.substr(std::min(colon + 1, line.size())));
+		if (_equals_ignore_case(name, http::CONNECTION))
+		{
+			result.has_connection = true;
+			result.is_close = result.is_close || _has_token(value, "close");
+		}
+		else if (_equals_ignore_case(name, http::CONTENT_LENGTH))
+		{
+			result.is_delimited = true;
+		}
+		else if (_equals_ignore_case(name, http::TRANSFER_ENCODING))
+		{
+			// The chunked coding is always the last one.
+			auto comma = value.rfind(',');
+			auto last_coding = comma == std::string_view::npos ? value : value.substr(comma + 1);
+			result.is_delimited = result.is_delimited || _equals_ignore_case(_trim_whitespace(last_coding), "chunked");
+		}
+	}
+
+	return result;
+}
+
+unsigned short int get_error_status_code(ParseStatus status)
+{
+	switch (status)
+	{
+		case ParseStatus::BadRequest:
+			return 400;
+		case ParseStatus::HeadersTooLarge:
+			return 431;
+		case ParseStatus::NotImplemented:
+			return 501;
+		case ParseStatus::VersionNotSupported:
+			return 505;
+		case ParseStatus::PayloadTooLarge:
+			return 413;
+		default:
+			return 0;
+	}
+}
+
+__SERVER_END__
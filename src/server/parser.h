@@ -0,0 +1,122 @@
+/**
+ * server/parser.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Incremental parser of HTTP/1.x request heads.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Base libraries.
+#include <xalwart.base/net/request_context.h>
+
+// Module definitions.
+#include "./_def_.h"
+
+
+__SERVER_BEGIN__
+
+enum class ParseStatus
+{
+	// The head is not received completely yet.
+	Incomplete,
+	Done,
+
+	// Malformed request line or headers, 400.
+	BadRequest,
+
+	// Too long header or too many headers, 431.
+	HeadersTooLarge,
+
+	// Transfer coding of the body is not supported, 501.
+	NotImplemented,
+
+	// HTTP major version is not 1, 505.
+	VersionNotSupported,
+
+	// The body is larger than 'Config::max_body_size', 413.
+	PayloadTooLarge
+};
+
+struct ParseResult
+{
+	ParseStatus status = ParseStatus::Incomplete;
+
+	// Count of bytes of the head including the empty line which
+	// terminates it, the body starts right after them.
+	size_t size = 0;
+
+	// The client allows to send the next request over the same
+	// connection: HTTP/1.1 without 'Connection: close', or HTTP/1.0
+	// with 'Connection: keep-alive', see RFC 7230, section 6.3.
+	bool is_keep_alive = false;
+};
+
+// Nodes of the map of headers which are extracted from it to be reused.
+using HeaderNodes = std::vector<std::map<std::string, std::string>::node_type>;
+
+// TESTME: parse_request_head
+// Parses the request line and headers from the beginning of `data` into
+// method, path, query, protocol version, headers and content size of
+// `context`. Data which is not terminated by an empty line is incomplete,
+// so the function is called again when more bytes are received.
+//
+// Names of well-known headers and of the 'Connection' header are stored
+// as they are declared in 'http/headers.h', values of repeated headers
+// are joined by comma.
+//
+// Headers of the previous request are moved to `spare_nodes` instead of
+// being freed, and new headers are stored in them, so a connection which
+// keeps its spare nodes does not allocate memory for headers of requests
+// after the first one.
+//
+// @param data: received bytes, starting with the request line.
+// @param context: context of the request to fill.
+// @param max_header_length: maximum length of the request line and of each header.
+// @param max_headers_count: maximum count of headers.
+// @param spare_nodes: nodes to reuse, or nullptr.
+// @return status of parsing and size of the head.
+extern ParseResult parse_request_head(
+	std::string_view data, net::RequestContext& context, size_t max_header_length, size_t max_headers_count,
+	HeaderNodes* spare_nodes=nullptr
+);
+
+struct ResponseHead
+{
+	// Count of bytes of the head including the empty line which
+	// terminates it, or zero if the head is not complete.
+	size_t size = 0;
+
+	// The end of the body is known without closing the connection:
+	// the response has 'Content-Length', is chunked, or has no body
+	// because of its status code, see RFC 7230, section 3.3.3.
+	bool is_delimited = false;
+
+	// The response has 'Connection' header.
+	bool has_connection = false;
+
+	// 'Connection' header contains 'close' option.
+	bool is_close = false;
+};
+
+// TESTME: inspect_response_head
+// Finds the end of the head at the beginning of the response written by
+// the handler and the headers which control persistence of the connection.
+// Malformed status line makes the response undelimited, so the connection
+// is closed after it.
+[[nodiscard]]
+extern ResponseHead inspect_response_head(std::string_view data);
+
+// Returns status code of the response to a request which
+// could not be parsed, or zero if `status` is not an error.
+[[nodiscard]]
+extern unsigned short int get_error_status_code(ParseStatus status);
+
+__SERVER_END__
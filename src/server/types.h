@@ -0,0 +1,93 @@
+/**
+ * server/types.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Types of 'server' module.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory_resource>
+#include <string>
+
+// Base libraries.
+#include <xalwart.base/net/request_context.h>
+#include <xalwart.base/net/status.h>
+
+// Module definitions.
+#include "./_def_.h"
+
+// Framework libraries.
+#include "../utility/task.h"
+
+
+__SERVER_BEGIN__
+
+// Handles the request which is described by the context. Memory resource
+// belongs to the request: everything which is allocated from it is freed
+// in one shot after the response is sent, so it must not be used after
+// the handler returns.
+using Handler = std::function<net::StatusCode(
+	net::RequestContext*, const std::map<std::string, std::string>& /* environment */,
+	std::pmr::memory_resource* /* memory_resource */
+)>;
+
+// The same as 'Handler', but the request may be suspended while it waits,
+// so other requests are processed by the same thread in the meantime. The
+// task is started and resumed by the event loop of the server, see
+// 'util::EventLoop'. Context, environment and memory resource are alive
+// until the task is finished.
+using AsyncHandler = std::function<util::Task<net::StatusCode>(
+	net::RequestContext*, const std::map<std::string, std::string>& /* environment */,
+	std::pmr::memory_resource* /* memory_resource */
+)>;
+
+struct Config
+{
+	// Count of event loops, each of them runs in its own thread and
+	// accepts connections from its own listening socket. Zero means
+	// the count of cores.
+	size_t workers = 0;
+
+	// Count of additional attempts to bind the address when it is in use,
+	// for example, by the previous instance which is still shutting down.
+	size_t retries = 5;
+
+	// Time to receive the head of the request since its first byte, to
+	// receive each part of its body and to send each part of the response
+	// which the client reads, the connection is closed after it. Zero
+	// disables the timeout.
+	std::chrono::microseconds timeout = std::chrono::seconds(5);
+
+	// Time to wait for the next request over the connection after the
+	// response is sent. Zero disables persistent connections, so the
+	// connection is closed after the first response.
+	std::chrono::microseconds keep_alive_timeout = std::chrono::seconds(5);
+
+	// Maximum count of requests which are served over one connection,
+	// the connection is closed after the last response. Zero means
+	// no limit.
+	size_t max_requests_per_connection = 1000;
+
+	// Maximum length of the request line and of each header.
+	size_t max_header_length = 65536;
+
+	// Maximum count of headers of the request.
+	size_t max_headers_count = 100;
+
+	// Maximum size of the body of the request, larger requests are
+	// answered with 413 without receiving the body. Zero means no limit.
+	size_t max_body_size = 0;
+
+	// Directory where bodies larger than 'MAX_BUFFERED_BODY_SIZE' are
+	// spooled, see 'Connection::spool_body()'. The temporary directory
+	// of the system is used if it is empty.
+	std::string upload_directory;
+};
+
+__SERVER_END__
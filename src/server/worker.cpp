@@ -0,0 +1,813 @@
+/**
+ * server/worker.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./worker.h"
+
+// C++ libraries.
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Base libraries.
+#include <xalwart.base/exceptions.h>
+
+// Framework libraries.
+#include "./meta.h"
+#include "../http/exceptions.h"
+
+
+__SERVER_BEGIN__
+
+// The last identifier of a connection, it is shared by all workers.
+static std::atomic<uint64_t> _last_connection_id = 0;
+
+// Returns time point after `timeout`, or the most distant
+// one if `timeout` is zero.
+static inline std::chrono::steady_clock::time_point _get_deadline(std::chrono::microseconds timeout)
+{
+	if (timeout.count() == 0)
+	{
+		return std::chrono::steady_clock::time_point::max();
+	}
+
+	return std::chrono::steady_clock::now() + timeout;
+}
+
+static inline const char* _get_reason_phrase(unsigned short int status_code)
+{
+	switch (status_code)
+	{
+		case 400:
+			return "Bad Request";
+		case 403:
+			return "Forbidden";
+		case 404:
+			return "Not Found";
+		case 408:
+			return "Request Timeout";
+		case 413:
+			return "Payload Too Large";
+		case 431:
+			return "Request Header Fields Too Large";
+		case 501:
+			return "Not Implemented";
+		case 500:
+			return "Internal Server Error";
+		case 505:
+			return "HTTP Version Not Supported";
+		default:
+			return "Error";
+	}
+}
+
+// Removes the notifier of the event loop when the worker stops running it.
+struct _NotifierGuard
+{
+	util::EventLoop& event_loop;
+
+	inline ~_NotifierGuard()
+	{
+		this->event_loop.set_notifier(nullptr);
+	}
+};
+
+Worker::Worker(
+	int listener, const Config& config, const Handler& handler, const AsyncHandler& async_handler,
+	const std::map<std::string, std::string>& environment, std::shared_ptr<ILogger> logger
+) : _listener(listener), _config(config), _handler(handler), _async_handler(async_handler),
+	_environment(environment), _logger(std::move(logger)),
+	_max_unread_size(
+		(config.max_header_length + 2) * (config.max_headers_count + 2) + MAX_BUFFERED_BODY_SIZE
+	)
+{
+	this->_epoll = ::epoll_create1(EPOLL_CLOEXEC);
+	this->_wakeup = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (this->_epoll < 0 || this->_wakeup < 0)
+	{
+		auto error = std::string(std::strerror(errno));
+		this->_close_descriptors();
+		throw RuntimeError("unable to create event loop: " + error, _ERROR_DETAILS_);
+	}
+
+	// The listening socket is level-triggered, so connections which are
+	// not accepted because of the limit of descriptors are tried again.
+	epoll_event listener_event{.events = EPOLLIN, .data = {.ptr = nullptr}};
+	epoll_event wakeup_event{.events = EPOLLIN, .data = {.ptr = this}};
+	if (
+		::epoll_ctl(this->_epoll, EPOLL_CTL_ADD, this->_listener, &listener_event) < 0 ||
+		::epoll_ctl(this->_epoll, EPOLL_CTL_ADD, this->_wakeup, &wakeup_event) < 0
+	)
+	{
+		auto error = std::string(std::strerror(errno));
+		this->_close_descriptors();
+		throw RuntimeError("unable to create event loop: " + error, _ERROR_DETAILS_);
+	}
+}
+
+Worker::~Worker()
+{
+	this->_connections.clear();
+	this->_idle_connections.clear();
+	this->_suspended_connections.clear();
+	this->_writing_connections.clear();
+	this->_close_descriptors();
+}
+
+void Worker::run()
+{
+	try
+	{
+		this->_run();
+	}
+	catch (...)
+	{
+		// The kernel keeps balancing new connections to the listener of
+		// the worker which does not serve them anymore, so it is closed,
+		// and connections go to listeners of other workers.
+		this->_close_listener();
+		this->_connections.clear();
+		this->_idle_connections.clear();
+		throw;
+	}
+}
+
+void Worker::stop()
+{
+	this->_is_stopped.store(true, std::memory_order_release);
+	::eventfd_write(this->_wakeup, 1);
+}
+
+void Worker::_run()
+{
+	// Coroutines which are scheduled by other threads wake
+	// the loop up in the same way as 'stop()' does.
+	auto& event_loop = util::EventLoop::current();
+	event_loop.set_notifier([wakeup = this->_wakeup]() { ::eventfd_write(wakeup, 1); });
+	_NotifierGuard notifier_guard{event_loop};
+	this->_run_scheduled(event_loop);
+
+	epoll_event events[MAX_EVENTS_COUNT];
+	while (true)
+	{
+		if (this->_is_stopped.load(std::memory_order_acquire))
+		{
+			// New connections go to listeners of other workers,
+			// if they are still running.
+			this->_close_listener();
+			if (this->_suspended_connections.empty() && this->_writing_connections.empty())
+			{
+				break;
+			}
+		}
+
+		auto count = ::epoll_wait(this->_epoll, events, MAX_EVENTS_COUNT, this->_get_wait_timeout());
+		if (count < 0 && errno != EINTR)
+		{
+			throw RuntimeError("unable to wait for events: " + std::string(std::strerror(errno)), _ERROR_DETAILS_);
+		}
+
+		bool is_woken_up = false;
+		for (int i = 0; i < count; i++)
+		{
+			auto* data = events[i].data.ptr;
+			if (data == nullptr)
+			{
+				this->_accept();
+			}
+			else if (data == this)
+			{
+				is_woken_up = true;
+			}
+			else
+			{
+				this->_on_event((Connection*)data, events[i].events);
+			}
+		}
+
+		// Resumed handlers finish their connections, which may be closed,
+		// so they are run after events of the batch which may refer to
+		// these connections.
+		if (is_woken_up)
+		{
+			eventfd_t value;
+			::eventfd_read(this->_wakeup, &value);
+			this->_run_scheduled(event_loop);
+		}
+
+		this->_close_expired_connections();
+	}
+
+	this->_connections.clear();
+	this->_idle_connections.clear();
+}
+
+void Worker::_close_listener()
+{
+	if (this->_listener >= 0)
+	{
+		// The descriptor is removed from epoll when it is closed.
+		::close(this->_listener);
+		this->_listener = -1;
+	}
+}
+
+void Worker::_accept()
+{
+	while (true)
+	{
+		int fd = ::accept4(this->_listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0)
+		{
+			if (errno == EINTR || errno == ECONNABORTED)
+			{
+				continue;
+			}
+
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+			{
+				this->_logger->error("unable to accept connection: " + std::string(std::strerror(errno)), _ERROR_DETAILS_);
+			}
+
+			return;
+		}
+
+		// Responses are written by a single call when possible,
+		// so there is nothing to coalesce.
+		int no_delay = 1;
+		::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+
+		auto position = this->_connections.emplace(
+			this->_connections.end(), std::make_unique<Connection>(fd)
+		);
+		auto* connection = position->get();
+		connection->position = position;
+		connection->waiting_connections = &this->_waiting_connections;
+		connection->environment = this->_environment;
+		connection->environment[meta::CONNECTION_ID] = std::to_string(
+			_last_connection_id.fetch_add(1, std::memory_order_relaxed) + 1
+		);
+		epoll_event event{.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET, .data = {.ptr = connection}};
+		if (::epoll_ctl(this->_epoll, EPOLL_CTL_ADD, fd, &event) < 0)
+		{
+			this->_logger->error("unable to watch connection: " + std::string(std::strerror(errno)), _ERROR_DETAILS_);
+			this->_close(connection);
+			continue;
+		}
+
+		this->_touch(connection);
+	}
+}
+
+void Worker::_on_event(Connection* connection, uint32_t events)
+{
+	// Bytes are received when the connection is processed, so a client
+	// does not fill the memory of the connection which is not.
+	bool is_readable = events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP);
+	if (is_readable)
+	{
+		connection->is_receiving_paused = true;
+		connection->is_peer_closing = connection->is_peer_closing || (events & (EPOLLRDHUP | EPOLLHUP));
+	}
+
+	if (connection->is_suspended)
+	{
+		// The part of the response which is written already is sent while
+		// the handler waits, the request is processed further when the
+		// handler is finished.
+		if (events & (EPOLLOUT | EPOLLERR))
+		{
+			auto status = connection->flush();
+			if (connection->is_writer_waiting)
+			{
+				if (status == Connection::IOStatus::Error || !connection->is_write_buffer_full())
+				{
+					this->_resume_writer(connection);
+				}
+				else
+				{
+					// The client reads the response, so the time to read
+					// the rest of it is counted from now.
+					connection->deadline = _get_deadline(this->_config.timeout);
+					this->_writing_connections.splice(
+						this->_writing_connections.end(), this->_writing_connections, connection->position
+					);
+				}
+			}
+		}
+
+		return;
+	}
+
+	if (events & EPOLLERR)
+	{
+		this->_close(connection);
+		return;
+	}
+
+	// The client reads the response, so the time to send
+	// the rest of it is counted from now.
+	if ((events & EPOLLOUT) && connection->has_pending_writes())
+	{
+		this->_touch(connection);
+	}
+
+	// The next request starts, its deadline is not moved by receiving
+	// the rest of its head. The body has time for each part of it, so
+	// a large one is not cut while the client keeps sending it.
+	if (is_readable && (connection->is_idle || connection->is_head_parsed))
+	{
+		this->_touch(connection);
+	}
+
+	if (connection->state == Connection::State::Reading)
+	{
+		if (is_readable || connection->is_write_buffer_full())
+		{
+			this->_process(connection);
+		}
+		else
+		{
+			this->_flush(connection);
+		}
+	}
+	else
+	{
+		this->_continue_closing(connection);
+	}
+}
+
+bool Worker::_receive(Connection* connection)
+{
+	auto status = connection->receive(this->_max_unread_size);
+	if (status == Connection::IOStatus::Error)
+	{
+		this->_close(connection);
+		return false;
+	}
+
+	// The end of the stream is reported by the event, and it is reached
+	// when everything which is left in the socket is received.
+	connection->is_peer_closed = connection->is_peer_closed ||
+		status == Connection::IOStatus::Closed ||
+		(connection->is_peer_closing && !connection->is_receiving_paused);
+	return true;
+}
+
+void Worker::_process(Connection* connection)
+{
+	while (true)
+	{
+		// The client which does not read responses does not make the
+		// connection keep more of them, the next request is processed
+		// when the written ones are sent.
+		if (connection->is_write_buffer_full())
+		{
+			if (connection->flush() == Connection::IOStatus::Error)
+			{
+				this->_close(connection);
+				return;
+			}
+
+			if (connection->is_write_buffer_full())
+			{
+				return;
+			}
+		}
+
+		if (connection->is_receiving_paused && !this->_receive(connection))
+		{
+			return;
+		}
+
+		ParseStatus status;
+		try
+		{
+			status = this->_receive_request(connection);
+		}
+		catch (...)
+		{
+			// The body can not be spooled.
+			this->_send_error(connection, this->_get_error_status_code());
+			this->_start_closing(connection);
+			return;
+		}
+
+		if (status == ParseStatus::Incomplete)
+		{
+			break;
+		}
+
+		if (status != ParseStatus::Done)
+		{
+			this->_send_error(connection, get_error_status_code(status));
+			this->_start_closing(connection);
+			return;
+		}
+
+		connection->is_head_parsed = false;
+		this->_handle_request(connection);
+		if (connection->is_suspended)
+		{
+			// The part of the response which is written
+			// already is sent while the handler waits.
+			connection->flush();
+			return;
+		}
+
+		if (!connection->is_keep_alive)
+		{
+			this->_start_closing(connection);
+			return;
+		}
+
+		// The response and the next request have their own time.
+		this->_touch(connection);
+	}
+
+	if (connection->is_peer_closed)
+	{
+		// The rest of the request is never received.
+		this->_start_closing(connection);
+		return;
+	}
+
+	this->_flush(connection);
+}
+
+ParseStatus Worker::_receive_request(Connection* connection) const
+{
+	if (!connection->is_head_parsed)
+	{
+		if (connection->unread().empty())
+		{
+			return ParseStatus::Incomplete;
+		}
+
+		auto result = parse_request_head(
+			connection->unread(), connection->context,
+			this->_config.max_header_length, this->_config.max_headers_count, &connection->spare_header_nodes
+		);
+		if (result.status != ParseStatus::Done)
+		{
+			return result.status;
+		}
+
+		auto max_body_size = this->_config.max_body_size;
+		if (max_body_size > 0 && connection->context.content_size > max_body_size)
+		{
+			return ParseStatus::PayloadTooLarge;
+		}
+
+		// The context keeps copies of everything which is parsed.
+		connection->consume(result.size);
+		connection->is_head_parsed = true;
+		connection->is_keep_alive = result.is_keep_alive;
+	}
+
+	// The handler does not wait for a slow client, so the whole body is
+	// received by the loop, and large bodies are not kept in memory.
+	if (connection->context.content_size > MAX_BUFFERED_BODY_SIZE)
+	{
+		return connection->spool_body(this->_config.upload_directory) ? ParseStatus::Done : ParseStatus::Incomplete;
+	}
+
+	if (connection->unread().size() < connection->context.content_size)
+	{
+		return ParseStatus::Incomplete;
+	}
+
+	return ParseStatus::Done;
+}
+
+void Worker::_handle_request(Connection* connection)
+{
+	connection->start_request();
+	auto max_requests_count = this->_config.max_requests_per_connection;
+	connection->is_keep_alive = connection->is_keep_alive &&
+		this->_config.keep_alive_timeout.count() > 0 &&
+		(max_requests_count == 0 || connection->requests_count < max_requests_count) &&
+		!this->_is_stopped.load(std::memory_order_relaxed);
+	this->_take_arena(connection);
+	if (this->_async_handler)
+	{
+		connection->task = this->_run_async_handler(connection);
+		connection->task.start();
+		if (!connection->task.done())
+		{
+			this->_suspend(connection);
+			this->_wait_for_clients();
+			return;
+		}
+
+		connection->task = {};
+	}
+	else
+	{
+		try
+		{
+			this->_handler(&connection->context, connection->environment, connection->arena->resource());
+		}
+		catch (...)
+		{
+			connection->error_status_code = this->_get_error_status_code();
+		}
+	}
+
+	this->_finish_request(connection);
+}
+
+util::Task<> Worker::_run_async_handler(Connection* connection)
+{
+	try
+	{
+		co_await this->_async_handler(&connection->context, connection->environment, connection->arena->resource());
+	}
+	catch (...)
+	{
+		connection->error_status_code = this->_get_error_status_code();
+	}
+
+	if (connection->is_suspended)
+	{
+		this->_finished_connections.push_back(connection);
+	}
+}
+
+unsigned short int Worker::_get_error_status_code() const
+{
+	try
+	{
+		throw;
+	}
+	catch (const http::exc::HttpError& exc)
+	{
+		this->_logger->warning(exc.get_message(), _ERROR_DETAILS_);
+		return exc.status_code();
+	}
+	catch (const BaseException& exc)
+	{
+		this->_logger->error(exc);
+	}
+	catch (const std::exception& exc)
+	{
+		this->_logger->error(exc.what(), _ERROR_DETAILS_);
+	}
+	catch (...)
+	{
+		this->_logger->error("unknown exception is thrown by the handler", _ERROR_DETAILS_);
+	}
+
+	return 500;
+}
+
+void Worker::_finish_request(Connection* connection)
+{
+	this->_release_arena(connection);
+
+	// The response which is not written, or which is possibly
+	// incomplete, is followed by closing of the connection.
+	auto error_status_code = connection->error_status_code;
+	if (error_status_code || !connection->is_response_started)
+	{
+		connection->is_keep_alive = false;
+	}
+
+	if (error_status_code && !connection->is_response_started)
+	{
+		this->_send_error(connection, error_status_code);
+	}
+
+	connection->body_reader()->discard();
+}
+
+void Worker::_suspend(Connection* connection)
+{
+	this->_suspended_connections.splice(
+		this->_suspended_connections.end(), this->_get_list(connection), connection->position
+	);
+	connection->is_suspended = true;
+}
+
+void Worker::_wait_for_clients()
+{
+	for (auto* connection : this->_waiting_connections)
+	{
+		connection->deadline = _get_deadline(this->_config.timeout);
+		this->_writing_connections.splice(
+			this->_writing_connections.end(), this->_suspended_connections, connection->position
+		);
+		connection->is_writer_waiting = true;
+	}
+
+	this->_waiting_connections.clear();
+}
+
+void Worker::_resume_writer(Connection* connection)
+{
+	this->_suspended_connections.splice(
+		this->_suspended_connections.end(), this->_writing_connections, connection->position
+	);
+	connection->is_writer_waiting = false;
+	util::EventLoop::current().schedule(std::exchange(connection->writer_waiter, {}));
+}
+
+void Worker::_run_scheduled(util::EventLoop& event_loop)
+{
+	event_loop.run_ready();
+	this->_wait_for_clients();
+	while (!this->_finished_connections.empty())
+	{
+		auto* connection = this->_finished_connections.back();
+		this->_finished_connections.pop_back();
+		connection->task = {};
+		this->_touch(connection);
+		connection->is_suspended = false;
+		this->_finish_request(connection);
+		if (!connection->is_keep_alive)
+		{
+			this->_start_closing(connection);
+			continue;
+		}
+
+		this->_process(connection);
+	}
+}
+
+void Worker::_take_arena(Connection* connection)
+{
+	if (this->_arenas.empty())
+	{
+		connection->arena = std::make_unique<util::Arena>();
+		return;
+	}
+
+	connection->arena = std::move(this->_arenas.back());
+	this->_arenas.pop_back();
+}
+
+void Worker::_release_arena(Connection* connection)
+{
+	connection->arena->reset();
+	this->_arenas.push_back(std::move(connection->arena));
+}
+
+void Worker::_flush(Connection* connection)
+{
+	if (connection->flush() == Connection::IOStatus::Error)
+	{
+		this->_close(connection);
+		return;
+	}
+
+	bool is_waiting = connection->requests_count > 0 &&
+		!connection->is_head_parsed &&
+		!connection->is_receiving_paused &&
+		connection->unread().empty() &&
+		!connection->has_pending_writes();
+	if (is_waiting && !connection->is_idle)
+	{
+		this->_wait_for_request(connection);
+	}
+}
+
+void Worker::_send_error(Connection* connection, unsigned short int status_code) const
+{
+	auto response = "HTTP/1.1 " + std::to_string(status_code) + " " + _get_reason_phrase(status_code) + "\r\n"
+		"Content-Length: 0\r\n"
+		"Connection: close\r\n\r\n";
+	connection->write(response.data(), response.size());
+}
+
+void Worker::_start_closing(Connection* connection)
+{
+	connection->state = Connection::State::Closing;
+	this->_touch(connection);
+	this->_continue_closing(connection);
+}
+
+void Worker::_continue_closing(Connection* connection)
+{
+	// The rest of the request is not needed.
+	connection->consume(connection->unread().size());
+	while (connection->is_receiving_paused)
+	{
+		if (!this->_receive(connection))
+		{
+			return;
+		}
+
+		connection->consume(connection->unread().size());
+	}
+	if (connection->state == Connection::State::Closing)
+	{
+		if (connection->flush() == Connection::IOStatus::Error)
+		{
+			this->_close(connection);
+			return;
+		}
+
+		if (connection->has_pending_writes())
+		{
+			return;
+		}
+
+		// Nothing is left to wait for when the peer is closed already.
+		if (!connection->is_peer_closed)
+		{
+			::shutdown(connection->fd(), SHUT_WR);
+			connection->state = Connection::State::Lingering;
+		}
+	}
+
+	if (connection->is_peer_closed)
+	{
+		this->_close(connection);
+	}
+}
+
+void Worker::_close_descriptors() const
+{
+	for (auto fd : {this->_wakeup, this->_epoll, this->_listener})
+	{
+		if (fd >= 0)
+		{
+			::close(fd);
+		}
+	}
+}
+
+void Worker::_close(Connection* connection)
+{
+	// The descriptor is removed from epoll when it is closed.
+	this->_get_list(connection).erase(connection->position);
+}
+
+void Worker::_touch(Connection* connection)
+{
+	connection->deadline = _get_deadline(this->_config.timeout);
+	this->_connections.splice(this->_connections.end(), this->_get_list(connection), connection->position);
+	connection->is_idle = false;
+}
+
+void Worker::_wait_for_request(Connection* connection)
+{
+	connection->deadline = _get_deadline(this->_config.keep_alive_timeout);
+	this->_idle_connections.splice(
+		this->_idle_connections.end(), this->_get_list(connection), connection->position
+	);
+	connection->is_idle = true;
+}
+
+void Worker::_close_expired_connections()
+{
+	auto now = std::chrono::steady_clock::now();
+	for (auto* connections : {&this->_connections, &this->_idle_connections})
+	{
+		while (!connections->empty() && connections->front()->deadline <= now)
+		{
+			connections->pop_front();
+		}
+	}
+
+	// The handler which waits for the client can not be destroyed, so it
+	// is resumed to find the connection failed, and the connection is
+	// closed when the handler is finished.
+	while (!this->_writing_connections.empty() && this->_writing_connections.front()->deadline <= now)
+	{
+		auto* connection = this->_writing_connections.front().get();
+		connection->fail();
+		this->_resume_writer(connection);
+	}
+}
+
+int Worker::_get_wait_timeout() const
+{
+	auto deadline = std::chrono::steady_clock::time_point::max();
+	for (const auto* connections : {&this->_connections, &this->_idle_connections, &this->_writing_connections})
+	{
+		if (!connections->empty())
+		{
+			deadline = std::min(deadline, connections->front()->deadline);
+		}
+	}
+
+	if (deadline == std::chrono::steady_clock::time_point::max())
+	{
+		return -1;
+	}
+
+	auto timeout = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+	return (int)std::max<std::chrono::milliseconds::rep>(timeout.count(), 0);
+}
+
+__SERVER_END__
@@ -0,0 +1,250 @@
+/**
+ * server/worker.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Event loop which serves connections accepted by a listening socket.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <atomic>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Base libraries.
+#include <xalwart.base/interfaces/base.h>
+
+// Module definitions.
+#include "./_def_.h"
+
+// Framework libraries.
+#include "./connection.h"
+#include "./parser.h"
+#include "./types.h"
+#include "../utility/event_loop.h"
+
+
+__SERVER_BEGIN__
+
+// TESTME: Worker
+// Single-threaded event loop over edge-triggered epoll. The worker owns its
+// listening socket, so workers do not share any state and the kernel
+// balances new connections between sockets bound with SO_REUSEPORT.
+//
+// Requests are processed by the thread of the loop, which never waits for
+// a socket. The handler is called when the whole request is received, the
+// body which does not fit 'MAX_BUFFERED_BODY_SIZE' is spooled to a file in
+// 'Config::upload_directory' meanwhile. The response which the client does
+// not read in time is kept by the connection and sent when the socket is
+// writable. The asynchronous handler waits for the client while the write
+// buffer is full, see 'ResponseWriter::drain()', the synchronous one can
+// not wait, so the rest of its response is kept in memory.
+//
+// The synchronous handler processes one request at a time. The asynchronous
+// one may suspend the request, and the worker processes other connections
+// until the request is resumed by 'util::EventLoop::current()' of the
+// thread, which wakes the worker up through its event file.
+//
+// Connections are persistent, see 'Config::keep_alive_timeout'. Pipelined
+// requests are handled in order of receiving, so their responses are
+// written in the same order, and the write buffer is flushed once for
+// all requests which are received together.
+class Worker final
+{
+public:
+	// Maximum size of the body which is kept in memory.
+	static inline constexpr size_t MAX_BUFFERED_BODY_SIZE = 64 * 1024;
+
+	// Maximum count of events which are handled per wait.
+	static inline constexpr int MAX_EVENTS_COUNT = 256;
+
+	// Takes ownership of `listener`, which must be non-blocking. Requests
+	// are handled by `async_handler` if it is set, otherwise by `handler`.
+	Worker(
+		int listener, const Config& config, const Handler& handler, const AsyncHandler& async_handler,
+		const std::map<std::string, std::string>& environment, std::shared_ptr<ILogger> logger
+	);
+
+	Worker(const Worker&) = delete;
+	Worker& operator= (const Worker&) = delete;
+
+	~Worker();
+
+	// Serves connections until 'stop()' is called. Suspended requests
+	// are finished before it returns, because their coroutines may be
+	// resumed by other threads. The listening socket is closed if the
+	// loop fails, so new connections are accepted by other workers.
+	void run();
+
+	// Makes 'run()' return as soon as possible,
+	// may be called from any thread.
+	void stop();
+
+private:
+	int _listener;
+	int _epoll = -1;
+
+	// Event file which wakes up the loop when it is stopped
+	// or when suspended coroutines are scheduled.
+	int _wakeup = -1;
+
+	std::atomic<bool> _is_stopped = false;
+
+	const Config& _config;
+	const Handler& _handler;
+	const AsyncHandler& _async_handler;
+	const std::map<std::string, std::string>& _environment;
+	std::shared_ptr<ILogger> _logger;
+
+	// Maximum count of received bytes which a connection keeps: the
+	// largest head with a body which is not spooled. The rest is left
+	// in the socket until the connection consumes them.
+	size_t _max_unread_size;
+
+	// Connections ordered by deadline, which is always moved forward by
+	// the same timeout, so expired connections are at the front. The
+	// deadline is moved when a request starts, when a part of its body
+	// is received, when it is handled and when the client reads a part
+	// of the response.
+	std::list<std::unique_ptr<Connection>> _connections;
+
+	// Connections which wait for the next request, ordered by deadline
+	// in the same way using 'Config::keep_alive_timeout'.
+	std::list<std::unique_ptr<Connection>> _idle_connections;
+
+	// Arenas which are not used by requests at the moment. An arena is
+	// taken by the connection while its request is handled, so buffers
+	// are allocated once per concurrently handled request, not per
+	// connection.
+	std::vector<std::unique_ptr<util::Arena>> _arenas;
+
+	// Connections which requests are suspended by the asynchronous handler.
+	// They have no deadline, because they can not be closed until their
+	// handlers are finished.
+	std::list<std::unique_ptr<Connection>> _suspended_connections;
+
+	// Suspended connections which handlers wait for their clients to read
+	// the response, ordered by deadline in the same way as '_connections'.
+	// The connection is failed when the deadline is reached, so the handler
+	// is resumed and finished.
+	std::list<std::unique_ptr<Connection>> _writing_connections;
+
+	// Suspended connections which handlers start to wait for their clients
+	// by the current run of the handlers, see 'Connection::writer_waiter'.
+	std::vector<Connection*> _waiting_connections;
+
+	// Suspended connections which handlers are finished by the current
+	// run of the event loop, see '_run_scheduled()'.
+	std::vector<Connection*> _finished_connections;
+
+	void _run();
+
+	void _close_listener();
+
+	void _accept();
+
+	void _on_event(Connection* connection, uint32_t events);
+
+	// Receives bytes which are left in the socket, if
+	// the connection has room for them.
+	//
+	// @return false if the connection failed and is closed.
+	bool _receive(Connection* connection);
+
+	// Processes the received requests, if any.
+	void _process(Connection* connection);
+
+	// Parses the head of the request if it is not parsed yet and waits
+	// for the body, spooling it to a file if it is large.
+	//
+	// @return 'Done' if the request can be handled, 'Incomplete' if more
+	// bytes are needed, or the error of parsing.
+	// @throws FileError if the body can not be spooled.
+	ParseStatus _receive_request(Connection* connection) const;
+
+	// Calls the handler. The connection is suspended if the asynchronous
+	// handler waits, otherwise the request is finished.
+	void _handle_request(Connection* connection);
+
+	// Runs the asynchronous handler and records the connection as finished
+	// if it was suspended.
+	util::Task<> _run_async_handler(Connection* connection);
+
+	// Logs the exception which is being handled and returns status
+	// code of the response to the request.
+	unsigned short int _get_error_status_code() const;
+
+	// Sends the error response if the handler failed
+	// and drops the rest of the body.
+	void _finish_request(Connection* connection);
+
+	void _suspend(Connection* connection);
+
+	// Moves connections which handlers start to wait for
+	// their clients to '_writing_connections'.
+	void _wait_for_clients();
+
+	// Resumes the handler which waits for the client when the response
+	// is read, or when the connection failed.
+	void _resume_writer(Connection* connection);
+
+	// Resumes coroutines which are scheduled on the event loop of the
+	// thread and processes connections which handlers are finished.
+	void _run_scheduled(util::EventLoop& event_loop);
+
+	void _take_arena(Connection* connection);
+
+	// Frees memory of the finished request and keeps the arena for
+	// the next one.
+	void _release_arena(Connection* connection);
+
+	// Sends written responses and moves the connection to the idle
+	// ones when there is nothing to send and to process.
+	void _flush(Connection* connection);
+
+	// Writes a response without a body to the request which
+	// can not be processed.
+	void _send_error(Connection* connection, unsigned short int status_code) const;
+
+	// Sends the rest of the response and shuts the socket down for writing.
+	// The connection is closed when the peer closes its side, so a client
+	// which sends more data does not get a reset instead of the response.
+	void _start_closing(Connection* connection);
+
+	void _continue_closing(Connection* connection);
+
+	void _close(Connection* connection);
+
+	void _close_descriptors() const;
+
+	[[nodiscard]]
+	inline std::list<std::unique_ptr<Connection>>& _get_list(const Connection* connection)
+	{
+		if (connection->is_suspended)
+		{
+			return connection->is_writer_waiting ? this->_writing_connections : this->_suspended_connections;
+		}
+
+		return connection->is_idle ? this->_idle_connections : this->_connections;
+	}
+
+	// Moves the deadline of `connection` forward.
+	void _touch(Connection* connection);
+
+	// Moves `connection` to the idle ones.
+	void _wait_for_request(Connection* connection);
+
+	void _close_expired_connections();
+
+	// Returns time in milliseconds until the nearest deadline,
+	// or -1 if there is nothing to wait for.
+	[[nodiscard]]
+	int _get_wait_timeout() const;
+};
+
+__SERVER_END__
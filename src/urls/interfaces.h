@@ -12,9 +12,11 @@
 #include "./_def_.h"
 
 // Other libraries.
+#include "./match.h"
 #include "../http/request.h"
 #include "../http/response.h"
 #include "../conf/_def_.h"
+#include "../utility/task.h"
 
 
 __CONF_BEGIN__
@@ -27,6 +29,10 @@ __CONF_END__
 __URLS_BEGIN__
 
 // TODO: docs for 'IPattern'
+//
+// Pattern may be changed only during configuration ('add_prefix' and
+// 'add_namespace'), after that 'match' and 'apply' are safe to call from
+// multiple threads at the same time.
 class IPattern
 {
 public:
@@ -40,9 +46,23 @@ public:
 
 	virtual void add_namespace(const std::string& ns) = 0;
 
-	virtual std::unique_ptr<http::IResponse> apply(http::IRequest* request, conf::Settings* settings) = 0;
-
-	virtual bool match(const std::string& url) = 0;
+	// Calls the handler with arguments captured by 'match'.
+	virtual std::unique_ptr<http::IResponse> apply(
+		http::IRequest* request, const Match& match, conf::Settings* settings
+	) const = 0;
+
+	// Returns task which calls the handler with arguments captured by
+	// 'match'. Patterns of synchronous handlers call them immediately.
+	virtual inline util::Task<std::unique_ptr<http::IResponse>> apply_async(
+		http::IRequest* request, const Match& match, conf::Settings* settings
+	) const
+	{
+		return util::ready_task(this->apply(request, match, settings));
+	}
+
+	// Matches the whole url, result holds views into 'url'.
+	[[nodiscard]]
+	virtual Match match(const std::string& url) const = 0;
 
 	[[nodiscard]]
 	virtual std::string build(const std::vector<std::string>& args) const = 0;
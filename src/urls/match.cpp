@@ -0,0 +1,106 @@
+/**
+ * urls/match.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./match.h"
+
+// C++ libraries.
+#include <cctype>
+
+
+__URLS_BEGIN__
+
+inline bool _is_arg_name_char(char c)
+{
+	return std::isalnum((unsigned char)c) || c == '_';
+}
+
+Matcher::Matcher(const std::string& expression)
+{
+	std::string translated;
+	translated.reserve(expression.size());
+	size_t group_index = 0;
+	bool in_class = false;
+	for (size_t i = 0; i < expression.size(); i++)
+	{
+		char c = expression[i];
+		if (c == '\\')
+		{
+			translated.push_back(c);
+			if (i + 1 < expression.size())
+			{
+				translated.push_back(expression[++i]);
+			}
+
+			continue;
+		}
+
+		if (in_class)
+		{
+			in_class = c != ']';
+		}
+		else if (c == '[')
+		{
+			in_class = true;
+		}
+		else if (c == '<')
+		{
+			auto end = i + 1;
+			while (end < expression.size() && _is_arg_name_char(expression[end]))
+			{
+				end++;
+			}
+
+			if (end > i + 1 && end + 1 < expression.size() && expression[end] == '>' && expression[end + 1] == '(')
+			{
+				this->_arg_names.push_back(expression.substr(i + 1, end - i - 1));
+				this->_arg_groups.push_back(++group_index);
+				translated.push_back('(');
+				i = end + 1;
+				continue;
+			}
+		}
+		else if (c == '(' && (i + 1 >= expression.size() || expression[i + 1] != '?'))
+		{
+			group_index++;
+		}
+
+		translated.push_back(c);
+	}
+
+	if (this->_arg_groups.size() > Match::MAX_ARGS)
+	{
+		throw ArgumentError(
+			"url pattern '" + expression + "' has more than " + std::to_string(Match::MAX_ARGS) + " arguments",
+			_ERROR_DETAILS_
+		);
+	}
+
+	this->_regex = std::regex(translated);
+}
+
+Match Matcher::match(const std::string& path) const
+{
+	// Sub-matches are reused per thread to avoid allocation on every call.
+	thread_local std::cmatch groups;
+	Match result;
+	if (std::regex_match(path.data(), path.data() + path.size(), groups, this->_regex))
+	{
+		result._matched = true;
+		result._size = this->_arg_groups.size();
+		for (size_t i = 0; i < result._size; i++)
+		{
+			const auto& group = groups[this->_arg_groups[i]];
+			if (group.matched)
+			{
+				result._args[i] = std::string_view(group.first, group.length());
+			}
+		}
+	}
+
+	return result;
+}
+
+__URLS_END__
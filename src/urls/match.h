@@ -0,0 +1,176 @@
+/**
+ * urls/match.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Stateless url pattern matching.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <array>
+#include <charconv>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// Base libraries.
+#include <xalwart.base/exceptions.h>
+
+// Module definitions.
+#include "./_def_.h"
+
+
+__URLS_BEGIN__
+
+// TESTME: arg_cast<T>
+// Converts captured url argument to the type which is
+// expected by controller.
+template <typename T>
+inline T arg_cast(std::string_view arg)
+{
+	using ValueT = std::remove_cvref_t<T>;
+	if constexpr (std::is_same_v<ValueT, std::string_view>)
+	{
+		return arg;
+	}
+	else if constexpr (std::is_same_v<ValueT, std::string>)
+	{
+		return std::string(arg);
+	}
+	else if constexpr (std::is_same_v<ValueT, bool>)
+	{
+		return arg == "true" || arg == "1";
+	}
+	else if constexpr (std::is_integral_v<ValueT>)
+	{
+		ValueT value{};
+		auto [end, error_code] = std::from_chars(arg.data(), arg.data() + arg.size(), value);
+		if (error_code != std::errc() || end != arg.data() + arg.size())
+		{
+			throw ValueError("unable to convert url argument '" + std::string(arg) + "'", _ERROR_DETAILS_);
+		}
+
+		return value;
+	}
+	else if constexpr (std::is_floating_point_v<ValueT>)
+	{
+		try
+		{
+			return (ValueT)std::stold(std::string(arg));
+		}
+		catch (const std::exception&)
+		{
+			throw ValueError("unable to convert url argument '" + std::string(arg) + "'", _ERROR_DETAILS_);
+		}
+	}
+	else
+	{
+		static_assert(std::is_constructible_v<ValueT, std::string>, "unsupported type of url argument");
+		return ValueT(std::string(arg));
+	}
+}
+
+// TESTME: Match
+// Result of matching a path against url pattern. Captured arguments
+// are views into the matched path, so the path must outlive the result.
+class Match final
+{
+public:
+	// Maximum number of arguments which url pattern can capture.
+	static inline constexpr size_t MAX_ARGS = 16;
+
+	Match() = default;
+
+	[[nodiscard]]
+	inline explicit operator bool() const
+	{
+		return this->_matched;
+	}
+
+	[[nodiscard]]
+	inline size_t size() const
+	{
+		return this->_size;
+	}
+
+	[[nodiscard]]
+	inline std::string_view arg(size_t index) const
+	{
+		if (index >= this->_size)
+		{
+			throw ArgumentError(
+				"url argument index " + std::to_string(index) + " is out of range", _ERROR_DETAILS_
+			);
+		}
+
+		return this->_args[index];
+	}
+
+	// Converts captured arguments to tuple of types which are
+	// expected by controller.
+	template <typename ...ArgsT>
+	[[nodiscard]]
+	inline std::tuple<ArgsT...> args_tuple() const
+	{
+		return this->_args_tuple<ArgsT...>(std::index_sequence_for<ArgsT...>{});
+	}
+
+private:
+	friend class Matcher;
+
+	bool _matched = false;
+	size_t _size = 0;
+	std::array<std::string_view, MAX_ARGS> _args{};
+
+	template <typename ...ArgsT, size_t ...Indices>
+	[[nodiscard]]
+	inline std::tuple<ArgsT...> _args_tuple(std::index_sequence<Indices...>) const
+	{
+		return std::tuple<ArgsT...>(arg_cast<ArgsT>(this->arg(Indices))...);
+	}
+};
+
+// TESTME: Matcher
+// Compiled url pattern expression, for example: '/profile/<user_id>(\d+)/?'.
+//
+// Named groups are translated to plain capturing groups of standard regular
+// expression. Matcher keeps no state between calls, so one instance can be
+// used from multiple threads at the same time.
+class Matcher final
+{
+public:
+	Matcher() = default;
+
+	explicit Matcher(const std::string& expression);
+
+	// Matches the whole path and captures arguments
+	// as views into it.
+	[[nodiscard]]
+	Match match(const std::string& path) const;
+
+	[[nodiscard]]
+	inline size_t args_count() const
+	{
+		return this->_arg_groups.size();
+	}
+
+	[[nodiscard]]
+	inline const std::vector<std::string>& arg_names() const
+	{
+		return this->_arg_names;
+	}
+
+private:
+	std::regex _regex;
+
+	// Indices of capturing groups which hold arguments.
+	std::vector<size_t> _arg_groups;
+	std::vector<std::string> _arg_names;
+};
+
+__URLS_END__
@@ -19,8 +19,11 @@
 
 // Framework libraries.
 #include "./interfaces.h"
+#include "./match.h"
 #include "../conf/settings.h"
 #include "../controllers/controller.h"
+#include "../controllers/async_controller.h"
+#include "../utility/event_loop.h"
 
 
 __URLS_BEGIN__
@@ -42,6 +45,12 @@ public:
 		this->_reload_pattern_parts();
 	}
 
+	inline Pattern(const std::string& rgx, ctrl::AsyncHandler<ArgsT...> handler, std::string name) :
+		Pattern(rgx, ctrl::Handler<ArgsT...>(nullptr), std::move(name))
+	{
+		this->_async_handler = std::move(handler);
+	}
+
 	[[nodiscard]]
 	inline std::string get_name() const override
 	{
@@ -65,14 +74,38 @@ public:
 		this->_name = ns + "::" + this->_name;
 	}
 
-	inline std::unique_ptr<http::IResponse> apply(http::IRequest* request, conf::Settings* settings) override
+	inline std::unique_ptr<http::IResponse> apply(
+		http::IRequest* request, const Match& match, conf::Settings* settings
+	) const override
+	{
+		if (this->_async_handler)
+		{
+			// Synchronous caller waits for the asynchronous handler
+			// on the loop of the current thread.
+			return util::EventLoop::current().run_until_complete(
+				this->_async_handler(request, match.template args_tuple<ArgsT...>(), settings)
+			);
+		}
+
+		return this->_handler(request, match.template args_tuple<ArgsT...>(), settings);
+	}
+
+	inline util::Task<std::unique_ptr<http::IResponse>> apply_async(
+		http::IRequest* request, const Match& match, conf::Settings* settings
+	) const override
 	{
-		return this->_handler(request, this->_regex.template args_tuple<ArgsT...>(), settings);
+		if (this->_async_handler)
+		{
+			return this->_async_handler(request, match.template args_tuple<ArgsT...>(), settings);
+		}
+
+		return util::ready_task(this->_handler(request, match.template args_tuple<ArgsT...>(), settings));
 	}
 
-	inline bool match(const std::string& url) override
+	[[nodiscard]]
+	inline Match match(const std::string& url) const override
 	{
-		return this->_regex.match(url) && this->_regex.search(url);
+		return this->_matcher.match(url);
 	}
 
 	[[nodiscard]]
@@ -112,12 +145,28 @@ private:
 	std::string _original_expression;
 	std::vector<std::string> _pattern_parts;
 	ctrl::Handler<ArgsT...> _handler;
+
+	// Is set instead of '_handler' for asynchronous controllers.
+	ctrl::AsyncHandler<ArgsT...> _async_handler;
 	std::string _name;
+
+	// Is used only during configuration for extracting the
+	// expression parts, matching is performed by '_matcher'.
 	re::ArgRegex _regex;
+	Matcher _matcher;
 
 	inline void _reload_pattern_parts()
 	{
 		this->_original_expression = this->_regex.to_string();
+		this->_matcher = Matcher(this->_original_expression);
+		if (this->_matcher.args_count() < sizeof...(ArgsT))
+		{
+			throw ArgumentError(
+				"url pattern '" + this->_original_expression + "' captures less arguments than handler requires",
+				_ERROR_DETAILS_
+			);
+		}
+
 		this->_pattern_parts = this->_regex.parts();
 		if (!this->_pattern_parts.empty())
 		{
@@ -16,12 +16,13 @@ std::function<std::unique_ptr<http::IResponse>(http::IRequest*, conf::Settings*)
 	std::function<std::unique_ptr<http::IResponse>(http::IRequest*, conf::Settings*)> fn = nullptr;
 	for (const auto& url_pattern : urlpatterns)
 	{
-		if (url_pattern->match(path))
+		auto match = url_pattern->match(path);
+		if (match)
 		{
-			fn = [url_pattern](
+			fn = [url_pattern, match](
 				http::IRequest* request, conf::Settings* settings
 			) -> std::unique_ptr<http::IResponse> {
-				return url_pattern->apply(request, settings);
+				return url_pattern->apply(request, match, settings);
 			};
 			break;
 		}
@@ -30,4 +31,61 @@ std::function<std::unique_ptr<http::IResponse>(http::IRequest*, conf::Settings*)
 	return fn;
 }
 
+std::function<std::unique_ptr<http::IResponse>(http::IRequest*, conf::Settings*)> resolve(
+	const std::string& path, const Router& router
+)
+{
+	auto [url_pattern, match] = router.find(path);
+	if (!url_pattern)
+	{
+		return nullptr;
+	}
+
+	return [url_pattern, match](
+		http::IRequest* request, conf::Settings* settings
+	) -> std::unique_ptr<http::IResponse>
+	{
+		return url_pattern->apply(request, match, settings);
+	};
+}
+
+std::function<util::Task<std::unique_ptr<http::IResponse>>(http::IRequest*, conf::Settings*)> resolve_async(
+	const std::string& path, const std::vector<std::shared_ptr<IPattern>>& urlpatterns
+)
+{
+	for (const auto& url_pattern : urlpatterns)
+	{
+		auto match = url_pattern->match(path);
+		if (match)
+		{
+			return [url_pattern, match](
+				http::IRequest* request, conf::Settings* settings
+			) -> util::Task<std::unique_ptr<http::IResponse>>
+			{
+				return url_pattern->apply_async(request, match, settings);
+			};
+		}
+	}
+
+	return nullptr;
+}
+
+std::function<util::Task<std::unique_ptr<http::IResponse>>(http::IRequest*, conf::Settings*)> resolve_async(
+	const std::string& path, const Router& router
+)
+{
+	auto [url_pattern, match] = router.find(path);
+	if (!url_pattern)
+	{
+		return nullptr;
+	}
+
+	return [url_pattern, match](
+		http::IRequest* request, conf::Settings* settings
+	) -> util::Task<std::unique_ptr<http::IResponse>>
+	{
+		return url_pattern->apply_async(request, match, settings);
+	};
+}
+
 __URLS_END__
@@ -17,6 +17,7 @@
 
 // Framework libraries.
 #include "./interfaces.h"
+#include "./router.h"
 
 
 __URLS_BEGIN__
@@ -24,6 +25,9 @@ __URLS_BEGIN__
 // TESTME: resolve
 // Searches path in urlpatterns and returns an expression
 // to process request if path is found, otherwise returns nullptr.
+//
+// Returned expression holds views into 'path', so it must not
+// be called after 'path' is destroyed or changed.
 extern std::function<std::unique_ptr<http::IResponse>(http::IRequest*, conf::Settings*)> resolve(
 	const std::string& path, const std::vector<std::shared_ptr<IPattern>>& urlpatterns
 );
@@ -36,4 +40,33 @@ inline bool is_valid_path(const std::string& path, const std::vector<std::shared
 	return resolve(path, urlpatterns) != nullptr;
 }
 
+// TESTME: resolve
+// Searches path using compiled router and returns an expression
+// to process request if path is found, otherwise returns nullptr.
+extern std::function<std::unique_ptr<http::IResponse>(http::IRequest*, conf::Settings*)> resolve(
+	const std::string& path, const Router& router
+);
+
+// TESTME: is_valid_path
+// Return true if the given path can be found by router,
+// false otherwise.
+inline bool is_valid_path(const std::string& path, const Router& router)
+{
+	return router.find(path).first != nullptr;
+}
+
+// TESTME: resolve_async
+// The same as 'resolve()', but returned expression produces task which
+// awaits asynchronous controllers instead of waiting for them in place.
+extern std::function<util::Task<std::unique_ptr<http::IResponse>>(http::IRequest*, conf::Settings*)> resolve_async(
+	const std::string& path, const std::vector<std::shared_ptr<IPattern>>& urlpatterns
+);
+
+// TESTME: resolve_async
+// The same as 'resolve()' for compiled router, but returned expression
+// produces task which awaits asynchronous controllers.
+extern std::function<util::Task<std::unique_ptr<http::IResponse>>(http::IRequest*, conf::Settings*)> resolve_async(
+	const std::string& path, const Router& router
+);
+
 __URLS_END__
@@ -0,0 +1,185 @@
+/**
+ * urls/router.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./router.h"
+
+// C++ libraries.
+#include <algorithm>
+#include <cctype>
+#include <string_view>
+
+// Base libraries.
+#include <xalwart.base/exceptions.h>
+
+
+__URLS_BEGIN__
+
+inline bool _has_top_level_alternation(const std::string& expression)
+{
+	int depth = 0;
+	bool in_class = false;
+	for (size_t i = 0; i < expression.size(); i++)
+	{
+		char c = expression[i];
+		if (c == '\\')
+		{
+			i++;
+		}
+		else if (in_class)
+		{
+			in_class = c != ']';
+		}
+		else if (c == '[')
+		{
+			in_class = true;
+		}
+		else if (c == '(')
+		{
+			depth++;
+		}
+		else if (c == ')')
+		{
+			depth--;
+		}
+		else if (c == '|' && depth == 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+inline bool _is_optional_quantifier(char c)
+{
+	return c == '?' || c == '*' || c == '{';
+}
+
+std::string static_prefix(const std::string& expression)
+{
+	if (_has_top_level_alternation(expression))
+	{
+		return "";
+	}
+
+	std::string prefix;
+	size_t i = expression.starts_with("^") ? 1 : 0;
+	while (i < expression.size())
+	{
+		char c = expression[i];
+		size_t next = i + 1;
+		if (c == '\\')
+		{
+			// Only escaped punctuation is literal, sequences like
+			// '\d' or '\w' are character classes.
+			if (next >= expression.size() || std::isalnum((unsigned char)expression[next]))
+			{
+				break;
+			}
+
+			c = expression[next++];
+		}
+		else if (std::string_view("<>()[]{}.^$|?*+").find(c) != std::string_view::npos)
+		{
+			break;
+		}
+
+		if (next < expression.size() && _is_optional_quantifier(expression[next]))
+		{
+			break;
+		}
+
+		prefix.push_back(c);
+		i = next;
+	}
+
+	return prefix;
+}
+
+Router::Router(const std::vector<std::shared_ptr<IPattern>>& patterns)
+{
+	for (const auto& pattern : patterns)
+	{
+		this->add(pattern);
+	}
+}
+
+void Router::add(const std::shared_ptr<IPattern>& pattern)
+{
+	require_non_null(pattern.get(), "'pattern' is nullptr", _ERROR_DETAILS_);
+	auto prefix = static_prefix(pattern->get_pattern_str());
+	auto* node = &this->_root;
+	auto last_slash_pos = prefix.rfind('/');
+	size_t tail_start = 0;
+	if (last_slash_pos != std::string::npos)
+	{
+		size_t start = 0;
+		while (start <= last_slash_pos)
+		{
+			auto end = prefix.find('/', start);
+			node = &node->children[prefix.substr(start, end - start)];
+			start = end + 1;
+		}
+
+		tail_start = last_slash_pos + 1;
+	}
+
+	node->entries.push_back(Entry{
+		.index = this->_size++,
+		.tail = prefix.substr(tail_start),
+		.pattern = pattern
+	});
+}
+
+std::pair<std::shared_ptr<IPattern>, Match> Router::find(const std::string& path) const
+{
+	std::vector<const Entry*> candidates;
+	const auto* node = &this->_root;
+	std::string_view rest = path;
+	while (true)
+	{
+		for (const auto& entry : node->entries)
+		{
+			if (rest.starts_with(entry.tail))
+			{
+				candidates.push_back(&entry);
+			}
+		}
+
+		auto slash_pos = rest.find('/');
+		if (slash_pos == std::string_view::npos)
+		{
+			break;
+		}
+
+		auto child = node->children.find(rest.substr(0, slash_pos));
+		if (child == node->children.end())
+		{
+			break;
+		}
+
+		node = &child->second;
+		rest.remove_prefix(slash_pos + 1);
+	}
+
+	// Candidates are collected from different depths of the trie,
+	// restore the order of registration to keep the first match wins.
+	std::sort(candidates.begin(), candidates.end(), [](const auto* left, const auto* right) -> bool {
+		return left->index < right->index;
+	});
+	for (const auto* candidate : candidates)
+	{
+		auto match = candidate->pattern->match(path);
+		if (match)
+		{
+			return {candidate->pattern, match};
+		}
+	}
+
+	return {nullptr, Match()};
+}
+
+__URLS_END__
@@ -0,0 +1,100 @@
+/**
+ * urls/router.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Prefix trie over url patterns which is compiled once and
+ * used for resolving request paths.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Module definitions.
+#include "./_def_.h"
+
+// Framework libraries.
+#include "./interfaces.h"
+#include "./match.h"
+
+
+__URLS_BEGIN__
+
+// TESTME: static_prefix
+// Returns the longest literal prefix of url pattern expression
+// which every matched path must start with.
+//
+// Scanning stops on the first argument ('<name>(...)'), group, class or
+// any other regular expression construction. A literal character which
+// is followed by '?', '*' or '{' is dropped, because it can be omitted.
+// If the expression contains a top-level alternation, an empty prefix
+// is returned.
+extern std::string static_prefix(const std::string& expression);
+
+// TESTME: Router
+// Segment trie of url patterns keyed by static prefixes of their expressions.
+//
+// Lookup walks the path segment by segment and collects only the patterns
+// whose static prefix is a prefix of the path, then tries them in the order
+// of registration, so the first matched pattern wins exactly as it does
+// in linear scan of 'settings->URLPATTERNS'.
+//
+// The router does not modify patterns and should be built after all
+// prefixes and namespaces are applied to them.
+class Router final
+{
+public:
+	Router() = default;
+
+	explicit Router(const std::vector<std::shared_ptr<IPattern>>& patterns);
+
+	// Appends pattern to the router. Patterns added later
+	// have lower priority.
+	void add(const std::shared_ptr<IPattern>& pattern);
+
+	// Returns the first pattern which matches the given path with
+	// the result of matching, or nullptr if there is no such pattern.
+	[[nodiscard]]
+	std::pair<std::shared_ptr<IPattern>, Match> find(const std::string& path) const;
+
+	[[nodiscard]]
+	inline size_t size() const
+	{
+		return this->_size;
+	}
+
+	[[nodiscard]]
+	inline bool empty() const
+	{
+		return this->_size == 0;
+	}
+
+private:
+	struct Entry
+	{
+		// Position of pattern in the order of registration.
+		size_t index;
+
+		// Part of the static prefix after the last '/'.
+		std::string tail;
+
+		std::shared_ptr<IPattern> pattern;
+	};
+
+	struct Node
+	{
+		std::map<std::string, Node, std::less<>> children;
+		std::vector<Entry> entries;
+	};
+
+	Node _root;
+	size_t _size = 0;
+};
+
+__URLS_END__
@@ -22,6 +22,10 @@
 #define __UTIL_CACHE_INTERNAL_BEGIN__ __UTIL_CACHE_BEGIN__ namespace internal {
 #define __UTIL_CACHE_INTERNAL_END__ } __UTIL_CACHE_END__
 
+// xw::util::compression
+#define __UTIL_COMPRESSION_BEGIN__ __UTIL_BEGIN__ namespace compression {
+#define __UTIL_COMPRESSION_END__ } __UTIL_END__
+
 // xw::util::fn
 #define __UTIL_FN_BEGIN__ __UTIL_BEGIN__ namespace fn {
 #define __UTIL_FN_END__ } __UTIL_END__
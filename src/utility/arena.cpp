@@ -0,0 +1,42 @@
+/**
+ * utility/arena.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./arena.h"
+
+// C++ libraries.
+#include <new>
+
+
+__UTIL_BEGIN__
+
+void* Arena::Upstream::do_allocate(size_t bytes, size_t alignment)
+{
+	this->blocks_count++;
+	return ::operator new(bytes, std::align_val_t(alignment));
+}
+
+void Arena::Upstream::do_deallocate(void* pointer, size_t bytes, size_t alignment)
+{
+	::operator delete(pointer, bytes, std::align_val_t(alignment));
+}
+
+Arena::Arena(size_t initial_size) :
+	_buffer(std::make_unique<std::byte[]>(initial_size)),
+	_monotonic_resource(_buffer.get(), initial_size, &_upstream),
+	_counter(&_monotonic_resource)
+{
+}
+
+void Arena::reset()
+{
+	// Returns additional blocks to the heap and starts
+	// from the beginning of the initial buffer.
+	this->_monotonic_resource.release();
+	this->_upstream.blocks_count = 0;
+	this->_counter.allocated_bytes = 0;
+}
+
+__UTIL_END__
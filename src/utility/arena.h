@@ -0,0 +1,144 @@
+/**
+ * utility/arena.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Monotonic memory arena for objects which live as long as a request.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+// Module definitions.
+#include "./_def_.h"
+
+
+__UTIL_BEGIN__
+
+// TESTME: Arena
+// Memory resource which hands out memory by bumping a pointer and frees
+// everything in one shot by 'reset()'. Deallocation of a single object is
+// a no-op, so it is suitable only for objects which are destroyed before
+// the arena is reset, for example, objects of a request.
+//
+// The initial buffer is allocated once and reused after each reset, so
+// a request which fits into it does not touch the heap at all. Larger
+// requests take additional blocks from the heap, which are freed by reset.
+//
+// Arena is not thread-safe, use one arena per thread.
+class Arena final
+{
+public:
+	static inline constexpr size_t DEFAULT_INITIAL_SIZE = 16 * 1024;
+
+	explicit Arena(size_t initial_size=DEFAULT_INITIAL_SIZE);
+
+	Arena(const Arena&) = delete;
+	Arena& operator= (const Arena&) = delete;
+
+	[[nodiscard]]
+	inline std::pmr::memory_resource* resource()
+	{
+		return &this->_counter;
+	}
+
+	// Releases all memory which was allocated since the last reset.
+	void reset();
+
+	// Returns count of bytes allocated since the last reset.
+	[[nodiscard]]
+	inline size_t allocated_bytes() const
+	{
+		return this->_counter.allocated_bytes;
+	}
+
+	// Returns count of blocks which were taken from the heap since the
+	// last reset, it is zero if everything fits into the initial buffer.
+	[[nodiscard]]
+	inline size_t heap_blocks_count() const
+	{
+		return this->_upstream.blocks_count;
+	}
+
+private:
+	// Counts blocks which are requested by monotonic resource.
+	class Upstream final : public std::pmr::memory_resource
+	{
+	public:
+		size_t blocks_count = 0;
+
+	protected:
+		void* do_allocate(size_t bytes, size_t alignment) override;
+
+		void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+
+		[[nodiscard]]
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+		{
+			return this == &other;
+		}
+	};
+
+	// Counts bytes which are requested by users of the arena.
+	class Counter final : public std::pmr::memory_resource
+	{
+	public:
+		size_t allocated_bytes = 0;
+
+		explicit Counter(std::pmr::memory_resource* resource) : _resource(resource)
+		{
+		}
+
+	protected:
+		void* do_allocate(size_t bytes, size_t alignment) override
+		{
+			this->allocated_bytes += bytes;
+			return this->_resource->allocate(bytes, alignment);
+		}
+
+		void do_deallocate(void* pointer, size_t bytes, size_t alignment) override
+		{
+		}
+
+		[[nodiscard]]
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+		{
+			return this == &other;
+		}
+
+	private:
+		std::pmr::memory_resource* _resource;
+	};
+
+	std::unique_ptr<std::byte[]> _buffer;
+	Upstream _upstream;
+	std::pmr::monotonic_buffer_resource _monotonic_resource;
+	Counter _counter;
+};
+
+// TESTME: ArenaResetGuard
+// Resets the arena when the guard is destroyed.
+class ArenaResetGuard final
+{
+public:
+	inline explicit ArenaResetGuard(Arena& arena) : _arena(arena)
+	{
+	}
+
+	ArenaResetGuard(const ArenaResetGuard&) = delete;
+	ArenaResetGuard& operator= (const ArenaResetGuard&) = delete;
+
+	inline ~ArenaResetGuard()
+	{
+		this->_arena.reset();
+	}
+
+private:
+	Arena& _arena;
+};
+
+__UTIL_END__
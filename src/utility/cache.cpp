@@ -6,6 +6,9 @@
 
 #include "./cache.h"
 
+// C++ libraries.
+#include <algorithm>
+
 // Base libraries.
 #include <xalwart.base/utility.h>
 #include <xalwart.base/string_utils.h>
@@ -16,6 +19,7 @@
 // Framework libraries.
 #include "../http/headers.h"
 #include "../http/utility.h"
+#include "./hash.h"
 
 
 __UTIL_CACHE_INTERNAL_BEGIN__
@@ -81,6 +85,19 @@ bool if_none_match_passes(
 	}
 }
 
+bool if_range_passes(const std::string& if_range, const std::string& etag, long last_modified)
+{
+	auto value = str::trim(if_range);
+	if (value.starts_with("\"") || value.starts_with("W/"))
+	{
+		// A weak ETag can never strongly match another ETag.
+		return !etag.empty() && !etag.starts_with("W/") && value == etag;
+	}
+
+	long if_range_date = http::parse_http_date(value);
+	return if_range_date != -1 && last_modified != -1 && if_range_date == last_modified;
+}
+
 std::unique_ptr<http::IResponse> not_modified(http::IRequest* request, http::IResponse* response)
 {
 	auto new_response = std::make_unique<http::NotModified>("");
@@ -122,14 +139,82 @@ __UTIL_CACHE_INTERNAL_END__
 
 __UTIL_CACHE_BEGIN__
 
-void set_response_etag(http::IResponse* response)
+std::string hash_etag(std::string_view content)
+{
+	return util::to_hex(util::xxh64(content));
+}
+
+std::string md5_etag(std::string_view content)
+{
+	return crypto::md5(std::string(content));
+}
+
+void set_response_etag(http::IResponse* response, const ETagFunction& etag_function)
 {
-	if (!response->is_streaming() && response->content_length() > 0)
+	if (response->is_streaming())
 	{
-		response->set_header(
-			http::E_TAG, http::quote_etag(crypto::md5(response->get_content()))
+		return;
+	}
+
+	std::string content;
+	std::string_view content_view;
+	auto* base_response = dynamic_cast<http::BaseResponse*>(response);
+	if (base_response)
+	{
+		content_view = base_response->get_content_view();
+	}
+	else
+	{
+		content = response->get_content();
+		content_view = content;
+	}
+
+	if (!content_view.empty())
+	{
+		auto etag = http::quote_etag(etag_function(content_view));
+
+		// Encoded body differs from content which is hashed, but it is
+		// semantically equivalent to it.
+		if (response->has_header(http::CONTENT_ENCODING))
+		{
+			etag = "W/" + etag;
+		}
+
+		response->set_header(http::E_TAG, etag);
+	}
+}
+
+void patch_vary_headers(http::IResponse* response, const std::vector<std::string>& new_headers)
+{
+	std::vector<std::string> vary_headers;
+	for (const auto& header : str::split(response->get_header(http::VARY, ""), ','))
+	{
+		auto name = str::trim(header);
+		if (!name.empty())
+		{
+			vary_headers.push_back(name);
+		}
+	}
+
+	if (vary_headers.size() == 1 && vary_headers[0] == "*")
+	{
+		return;
+	}
+
+	for (const auto& header : new_headers)
+	{
+		auto name = str::to_lower(header);
+		bool exists = std::any_of(
+			vary_headers.begin(), vary_headers.end(),
+			[&name](const std::string& item) -> bool { return str::to_lower(item) == name; }
 		);
+		if (!exists)
+		{
+			vary_headers.push_back(header);
+		}
 	}
+
+	response->set_header(http::VARY, str::join(", ", vary_headers.begin(), vary_headers.end()));
 }
 
 std::unique_ptr<http::IResponse> get_conditional_response(
@@ -195,9 +280,30 @@ std::unique_ptr<http::IResponse> get_conditional_response(
 		}
 	}
 
-	// Step 5: Test the If-Range precondition (not supported).
+	// Step 5: The If-Range precondition affects only how the content is
+	// sent, it is tested by 'get_requested_ranges()'.
 	// Step 6: Return nullptr since there isn't a conditional response.
 	return nullptr;
 }
 
+std::optional<std::vector<http::ByteRange>> get_requested_ranges(
+	http::IRequest* request, const std::string& etag, long last_modified, size_t size
+)
+{
+	if (request->method() != "GET" || !request->has_header(http::RANGE))
+	{
+		return std::nullopt;
+	}
+
+	if (
+		request->has_header(http::IF_RANGE) &&
+		!internal::if_range_passes(request->get_header(http::IF_RANGE, ""), etag, last_modified)
+	)
+	{
+		return std::nullopt;
+	}
+
+	return http::parse_range(request->get_header(http::RANGE, ""), size);
+}
+
 __UTIL_CACHE_END__
@@ -9,7 +9,11 @@
 #pragma once
 
 // C++ libraries.
+#include <functional>
 #include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
 
 // Module definitions.
 #include "./_def_.h"
@@ -44,6 +48,12 @@ inline bool if_unmodified_since_passes(long last_modified, long if_unmodified_si
 	return last_modified != -1 && last_modified <= if_unmodified_since;
 }
 
+// TESTME: if_range_passes
+// Test the If-Range precondition as defined in section 3.2 of RFC 7233.
+// The value is either an entity-tag which must strongly match `etag` or
+// an HTTP-date which must be equal to `last_modified`.
+extern bool if_range_passes(const std::string& if_range, const std::string& etag, long last_modified);
+
 // TESTME: precondition_failed
 // TODO: docs for 'precondition_failed'
 inline std::unique_ptr<http::IResponse> precondition_failed(http::IRequest* request)
@@ -62,9 +72,30 @@ __UTIL_CACHE_INTERNAL_END__
 
 __UTIL_CACHE_BEGIN__
 
+// Computes ETag value, without quotes, of serialized content.
+using ETagFunction = std::function<std::string(std::string_view content)>;
+
+// TESTME: hash_etag
+// Default ETag function, returns hex of 64-bit xxHash of content.
+extern std::string hash_etag(std::string_view content);
+
+// TESTME: md5_etag
+// Returns hex digest of MD5 of content, it is several times slower
+// than 'hash_etag', but ETags are stable between versions which
+// used it by default.
+extern std::string md5_etag(std::string_view content);
+
 // TESTME: set_response_etag
-// TODO: docs for 'set_response_etag'
-extern void set_response_etag(http::IResponse* response);
+// Sets ETag computed by `etag_function` from content of non-streaming
+// response. Content of 'http::BaseResponse' is serialized once and the
+// same buffer is sent later. ETag is weak if Content-Encoding is set.
+extern void set_response_etag(http::IResponse* response, const ETagFunction& etag_function=hash_etag);
+
+// TESTME: patch_vary_headers
+// Add (or update) the Vary header in the given response object. Headers
+// which are already present in Vary are not duplicated, comparison of
+// header names is case-insensitive. If Vary is '*', it is kept as is.
+extern void patch_vary_headers(http::IResponse* response, const std::vector<std::string>& new_headers);
 
 // TESTME: get_conditional_response
 // TODO: docs for 'get_conditional_response'
@@ -75,4 +106,14 @@ extern std::unique_ptr<http::IResponse> get_conditional_response(
 	http::IResponse* response
 );
 
+// TESTME: get_requested_ranges
+// Step 5 of section 6 of RFC 7232: returns ranges of representation of
+// `size` bytes requested by GET request if Range header should be honored,
+// i.e. it is valid and If-Range precondition passes. An empty vector means
+// that none of ranges is satisfiable. Returns std::nullopt if the whole
+// representation should be sent.
+extern std::optional<std::vector<http::ByteRange>> get_requested_ranges(
+	http::IRequest* request, const std::string& etag, long last_modified, size_t size
+);
+
 __UTIL_CACHE_END__
@@ -0,0 +1,302 @@
+/**
+ * utility/compression.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./compression.h"
+
+// C++ libraries.
+#include <algorithm>
+#include <array>
+
+// Base libraries.
+#include <xalwart.base/exceptions.h>
+
+// Compression libraries.
+#include <zlib.h>
+
+#ifdef XW_USE_BROTLI
+#include <brotli/encode.h>
+#endif
+
+#ifdef XW_USE_ZSTD
+#include <zstd.h>
+#endif
+
+
+__UTIL_COMPRESSION_BEGIN__
+
+// Size of buffer for output of encoders.
+inline constexpr size_t _CHUNK_SIZE = 16 * 1024;
+
+// Encoder of 'gzip' and 'deflate' codings, the last one is
+// deflate stream in zlib format as defined in RFC 1950.
+class ZlibCompressor final : public Compressor
+{
+public:
+	inline explicit ZlibCompressor(Level level, bool use_gzip_format)
+	{
+		int value = level == Level::Fastest ? 1 : (level == Level::Best ? 9 : 6);
+
+		// Window size is increased by 16 to write gzip header and trailer.
+		int window_bits = use_gzip_format ? 15 + 16 : 15;
+		if (deflateInit2(&this->_stream, value, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		{
+			throw RuntimeError("unable to initialize zlib encoder", _ERROR_DETAILS_);
+		}
+	}
+
+	inline ~ZlibCompressor() override
+	{
+		deflateEnd(&this->_stream);
+	}
+
+	inline std::string compress(std::string_view data) override
+	{
+		return this->_deflate(data, Z_NO_FLUSH);
+	}
+
+	inline std::string flush() override
+	{
+		return this->_deflate({}, Z_SYNC_FLUSH);
+	}
+
+	inline std::string finish() override
+	{
+		return this->_deflate({}, Z_FINISH);
+	}
+
+private:
+	z_stream _stream{};
+
+	inline std::string _deflate(std::string_view data, int flush)
+	{
+		std::string result;
+		std::array<unsigned char, _CHUNK_SIZE> buffer{};
+		this->_stream.next_in = (Bytef*)data.data();
+		this->_stream.avail_in = (uInt)data.size();
+		do
+		{
+			this->_stream.next_out = buffer.data();
+			this->_stream.avail_out = (uInt)buffer.size();
+			auto status = deflate(&this->_stream, flush);
+			if (status == Z_STREAM_ERROR)
+			{
+				throw RuntimeError("unable to compress data with zlib", _ERROR_DETAILS_);
+			}
+
+			result.append((const char*)buffer.data(), buffer.size() - this->_stream.avail_out);
+		}
+		while (this->_stream.avail_out == 0);
+		return result;
+	}
+};
+
+#ifdef XW_USE_BROTLI
+class BrotliCompressor final : public Compressor
+{
+public:
+	inline explicit BrotliCompressor(Level level) : _state(BrotliEncoderCreateInstance(nullptr, nullptr, nullptr))
+	{
+		if (!this->_state)
+		{
+			throw RuntimeError("unable to initialize brotli encoder", _ERROR_DETAILS_);
+		}
+
+		uint32_t quality = level == Level::Fastest ? 1 : (level == Level::Best ? BROTLI_MAX_QUALITY : 5);
+		BrotliEncoderSetParameter(this->_state, BROTLI_PARAM_QUALITY, quality);
+	}
+
+	inline ~BrotliCompressor() override
+	{
+		BrotliEncoderDestroyInstance(this->_state);
+	}
+
+	inline std::string compress(std::string_view data) override
+	{
+		return this->_encode(data, BROTLI_OPERATION_PROCESS);
+	}
+
+	inline std::string flush() override
+	{
+		return this->_encode({}, BROTLI_OPERATION_FLUSH);
+	}
+
+	inline std::string finish() override
+	{
+		return this->_encode({}, BROTLI_OPERATION_FINISH);
+	}
+
+private:
+	BrotliEncoderState* _state;
+
+	inline std::string _encode(std::string_view data, BrotliEncoderOperation operation)
+	{
+		std::string result;
+		std::array<uint8_t, _CHUNK_SIZE> buffer{};
+		auto available_in = data.size();
+		const auto* next_in = (const uint8_t*)data.data();
+		do
+		{
+			size_t available_out = buffer.size();
+			auto* next_out = buffer.data();
+			if (!BrotliEncoderCompressStream(
+				this->_state, operation, &available_in, &next_in, &available_out, &next_out, nullptr
+			))
+			{
+				throw RuntimeError("unable to compress data with brotli", _ERROR_DETAILS_);
+			}
+
+			result.append((const char*)buffer.data(), buffer.size() - available_out);
+		}
+		while (
+			available_in > 0 || BrotliEncoderHasMoreOutput(this->_state) ||
+			(operation == BROTLI_OPERATION_FINISH && !BrotliEncoderIsFinished(this->_state))
+		);
+		return result;
+	}
+};
+#endif
+
+#ifdef XW_USE_ZSTD
+class ZstdCompressor final : public Compressor
+{
+public:
+	inline explicit ZstdCompressor(Level level) : _context(ZSTD_createCCtx())
+	{
+		if (!this->_context)
+		{
+			throw RuntimeError("unable to initialize zstd encoder", _ERROR_DETAILS_);
+		}
+
+		int value = level == Level::Fastest ? 1 : (level == Level::Best ? 19 : ZSTD_CLEVEL_DEFAULT);
+		ZSTD_CCtx_setParameter(this->_context, ZSTD_c_compressionLevel, value);
+	}
+
+	inline ~ZstdCompressor() override
+	{
+		ZSTD_freeCCtx(this->_context);
+	}
+
+	inline std::string compress(std::string_view data) override
+	{
+		return this->_encode(data, ZSTD_e_continue);
+	}
+
+	inline std::string flush() override
+	{
+		return this->_encode({}, ZSTD_e_flush);
+	}
+
+	inline std::string finish() override
+	{
+		return this->_encode({}, ZSTD_e_end);
+	}
+
+private:
+	ZSTD_CCtx* _context;
+
+	inline std::string _encode(std::string_view data, ZSTD_EndDirective directive)
+	{
+		std::string result;
+		std::array<char, _CHUNK_SIZE> buffer{};
+		ZSTD_inBuffer input{data.data(), data.size(), 0};
+		size_t remaining = 0;
+		do
+		{
+			ZSTD_outBuffer output{buffer.data(), buffer.size(), 0};
+			remaining = ZSTD_compressStream2(this->_context, &output, &input, directive);
+			if (ZSTD_isError(remaining))
+			{
+				throw RuntimeError(
+					"unable to compress data with zstd: " + std::string(ZSTD_getErrorName(remaining)),
+					_ERROR_DETAILS_
+				);
+			}
+
+			result.append(buffer.data(), output.pos);
+		}
+		while (directive == ZSTD_e_continue ? input.pos < input.size : remaining != 0);
+		return result;
+	}
+};
+#endif
+
+const std::vector<std::string>& supported_encodings()
+{
+	static const std::vector<std::string> encodings = {
+#ifdef XW_USE_BROTLI
+		"br",
+#endif
+#ifdef XW_USE_ZSTD
+		"zstd",
+#endif
+		"gzip",
+		"deflate"
+	};
+	return encodings;
+}
+
+std::unique_ptr<Compressor> make_compressor(const std::string& encoding, Level level)
+{
+	if (encoding == "gzip" || encoding == "deflate")
+	{
+		return std::make_unique<ZlibCompressor>(level, encoding == "gzip");
+	}
+
+#ifdef XW_USE_BROTLI
+	if (encoding == "br")
+	{
+		return std::make_unique<BrotliCompressor>(level);
+	}
+#endif
+
+#ifdef XW_USE_ZSTD
+	if (encoding == "zstd")
+	{
+		return std::make_unique<ZstdCompressor>(level);
+	}
+#endif
+
+	return nullptr;
+}
+
+std::string compress(const std::string& encoding, std::string_view data, Level level)
+{
+	auto compressor = make_compressor(encoding, level);
+	if (!compressor)
+	{
+		throw ArgumentError("content coding '" + encoding + "' is not supported", _ERROR_DETAILS_);
+	}
+
+	auto result = compressor->compress(data);
+	result += compressor->finish();
+	return result;
+}
+
+bool is_compressible(const std::string& content_type)
+{
+	auto media_type = std::string_view(content_type).substr(0, content_type.find(';'));
+	if (media_type.starts_with("text/"))
+	{
+		return true;
+	}
+
+	static const std::array<std::string_view, 10> compressible_types = {
+		"application/javascript",
+		"application/json",
+		"application/manifest+json",
+		"application/wasm",
+		"application/xhtml+xml",
+		"application/xml",
+		"application/x-javascript",
+		"font/ttf",
+		"font/otf",
+		"image/svg+xml"
+	};
+	return std::find(compressible_types.begin(), compressible_types.end(), media_type) != compressible_types.end() ||
+		media_type.ends_with("+json") || media_type.ends_with("+xml");
+}
+
+__UTIL_COMPRESSION_END__
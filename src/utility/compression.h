@@ -0,0 +1,75 @@
+/**
+ * utility/compression.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Encoders of HTTP content codings.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Module definitions.
+#include "./_def_.h"
+
+
+__UTIL_COMPRESSION_BEGIN__
+
+enum class Level
+{
+	// For compressing responses on the fly.
+	Fastest,
+	Default,
+
+	// For compressing files ahead of time.
+	Best
+};
+
+// TESTME: Compressor
+// Streaming encoder of one content coding.
+class Compressor
+{
+public:
+	virtual ~Compressor() = default;
+
+	// Compresses the next part of data and returns compressed
+	// bytes which are ready, result can be empty.
+	virtual std::string compress(std::string_view data) = 0;
+
+	// Returns all pending compressed data, so the receiver can decode
+	// everything which was passed to 'compress()' so far. Flushing too
+	// often makes compression worse.
+	virtual std::string flush() = 0;
+
+	// Flushes the rest of compressed data and ends the stream.
+	virtual std::string finish() = 0;
+};
+
+// TESTME: supported_encodings
+// Returns content codings which are available in this build, in
+// order of preference: 'br', 'zstd', 'gzip' and 'deflate'.
+extern const std::vector<std::string>& supported_encodings();
+
+// TESTME: make_compressor
+// Returns encoder for content coding, or nullptr if the
+// coding is not supported.
+extern std::unique_ptr<Compressor> make_compressor(const std::string& encoding, Level level=Level::Default);
+
+// TESTME: compress
+// Compresses the whole data with the given content coding.
+//
+// Throws 'ArgumentError' if the coding is not supported.
+extern std::string compress(const std::string& encoding, std::string_view data, Level level=Level::Default);
+
+// TESTME: is_compressible
+// Checks if content of the given type, usually text, is worth
+// to be compressed. Already compressed formats, like images,
+// archives and fonts in WOFF2 format, are not.
+extern bool is_compressible(const std::string& content_type);
+
+__UTIL_COMPRESSION_END__
@@ -0,0 +1,100 @@
+/**
+ * utility/event_loop.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./event_loop.h"
+
+// C++ libraries.
+#include <utility>
+
+// Base libraries.
+#include <xalwart.base/exceptions.h>
+
+
+__UTIL_BEGIN__
+
+EventLoop& EventLoop::current()
+{
+	thread_local EventLoop loop;
+	return loop;
+}
+
+void EventLoop::schedule(std::coroutine_handle<> handle)
+{
+	{
+		std::lock_guard lock(this->_mutex);
+		this->_scheduled.push_back(handle);
+		if (this->_notifier && this->_scheduled.size() == 1)
+		{
+			this->_notifier();
+		}
+	}
+
+	this->_condition.notify_one();
+}
+
+void EventLoop::set_notifier(std::function<void()> notifier)
+{
+	std::lock_guard lock(this->_mutex);
+	this->_notifier = std::move(notifier);
+}
+
+size_t EventLoop::run_ready()
+{
+	// Nested runs take their own queue, so the outer
+	// one does not resume the same coroutines again.
+	std::vector<std::coroutine_handle<>> running;
+	{
+		std::lock_guard lock(this->_mutex);
+		if (this->_scheduled.empty())
+		{
+			return 0;
+		}
+
+		running.swap(this->_running);
+		running.swap(this->_scheduled);
+	}
+
+	// Resumed coroutines do not throw, their exceptions
+	// are kept by their tasks.
+	auto is_running = std::exchange(this->_is_running, true);
+	for (auto handle : running)
+	{
+		handle.resume();
+	}
+
+	this->_is_running = is_running;
+
+	auto count = running.size();
+	running.clear();
+	{
+		std::lock_guard lock(this->_mutex);
+		if (this->_running.capacity() < running.capacity())
+		{
+			this->_running.swap(running);
+		}
+	}
+
+	return count;
+}
+
+void EventLoop::_check_is_not_running() const
+{
+	if (this->_is_running)
+	{
+		throw RuntimeError(
+			"unable to run the task until it is complete: the caller is resumed by the same event loop",
+			_ERROR_DETAILS_
+		);
+	}
+}
+
+void EventLoop::_wait_for_scheduled()
+{
+	std::unique_lock lock(this->_mutex);
+	this->_condition.wait(lock, [this]() -> bool { return !this->_scheduled.empty(); });
+}
+
+__UTIL_END__
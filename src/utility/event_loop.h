@@ -0,0 +1,144 @@
+/**
+ * utility/event_loop.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Queue of coroutines which are resumed on a single thread.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <condition_variable>
+#include <coroutine>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Module definitions.
+#include "./_def_.h"
+
+// Framework libraries.
+#include "./task.h"
+
+
+__UTIL_BEGIN__
+
+// TESTME: EventLoop
+// Resumes suspended coroutines on the thread which runs the loop. A
+// coroutine which waits for an operation, for example, a query which is
+// executed by a database driver in its own thread, suspends itself and
+// the operation calls 'schedule()' when it is finished, so the thread of
+// the loop is free to process other requests in the meantime.
+//
+// Scheduling is thread-safe, running is not: a loop should be run only by
+// the thread it belongs to, see 'current()'.
+//
+// A thread which waits for other events as well, for example, the server
+// which waits in epoll, sets a notifier and calls 'run_ready()' when it is
+// notified instead of blocking in 'run_until_complete()'.
+class EventLoop final
+{
+public:
+	EventLoop() = default;
+
+	EventLoop(const EventLoop&) = delete;
+	EventLoop& operator= (const EventLoop&) = delete;
+
+	// Returns the loop of the calling thread.
+	[[nodiscard]]
+	static EventLoop& current();
+
+	// Queues `handle` to be resumed by the thread which runs the loop.
+	// May be called from any thread.
+	void schedule(std::coroutine_handle<> handle);
+
+	// Sets function which is called when a coroutine is scheduled while
+	// nothing is scheduled yet, so one notification is made for all
+	// coroutines which are resumed by the next 'run_ready()'. It is called
+	// by the thread which schedules, with the lock of the queue held, so
+	// it should be short, for example, a write to an event file. Empty
+	// function removes the notifier.
+	void set_notifier(std::function<void()> notifier);
+
+	// Returns awaitable which suspends the calling coroutine and resumes
+	// it on the loop:
+	//
+	//	co_await loop.schedule();
+	[[nodiscard]]
+	inline auto schedule()
+	{
+		struct Awaiter
+		{
+			EventLoop* loop;
+
+			[[nodiscard]]
+			inline bool await_ready() const noexcept
+			{
+				return false;
+			}
+
+			inline void await_suspend(std::coroutine_handle<> handle) const
+			{
+				this->loop->schedule(handle);
+			}
+
+			inline void await_resume() const noexcept
+			{
+			}
+		};
+
+		return Awaiter{this};
+	}
+
+	// Resumes coroutines which are scheduled at the moment of the call,
+	// coroutines scheduled by them are resumed by the next call.
+	//
+	// @return count of resumed coroutines.
+	size_t run_ready();
+
+	// Starts `task` and resumes scheduled coroutines until the task is
+	// finished, blocking the thread while there is nothing to resume.
+	// Other tasks which are scheduled on the loop make progress too.
+	//
+	// Must not be called from a coroutine which is resumed by the same
+	// loop: it would block the loop which resumes it and would run other
+	// coroutines on top of its stack.
+	//
+	// @return result of the task, its exception is rethrown.
+	// @throws RuntimeError if it is called from 'run_ready()'.
+	template <typename T>
+	inline T run_until_complete(Task<T> task)
+	{
+		this->_check_is_not_running();
+		task.start();
+		while (!task.done())
+		{
+			if (this->run_ready() == 0)
+			{
+				this->_wait_for_scheduled();
+			}
+		}
+
+		return task.get();
+	}
+
+private:
+	std::mutex _mutex;
+	std::condition_variable _condition;
+	std::vector<std::coroutine_handle<>> _scheduled;
+	std::function<void()> _notifier;
+
+	// Coroutines are being resumed by 'run_ready()'.
+	bool _is_running = false;
+
+	// Is swapped with '_scheduled', so the memory of both
+	// vectors is reused instead of being allocated each run.
+	std::vector<std::coroutine_handle<>> _running;
+
+	void _wait_for_scheduled();
+
+	void _check_is_not_running() const;
+};
+
+__UTIL_END__
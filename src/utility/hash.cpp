@@ -0,0 +1,137 @@
+/**
+ * utility/hash.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include "./hash.h"
+
+// C++ libraries.
+#include <bit>
+#include <cstring>
+
+
+__UTIL_BEGIN__
+
+inline constexpr uint64_t _XXH_PRIME_1 = 0x9E3779B185EBCA87ULL;
+inline constexpr uint64_t _XXH_PRIME_2 = 0xC2B2AE3D27D4EB4FULL;
+inline constexpr uint64_t _XXH_PRIME_3 = 0x165667B19E3779F9ULL;
+inline constexpr uint64_t _XXH_PRIME_4 = 0x85EBCA77C2B2AE63ULL;
+inline constexpr uint64_t _XXH_PRIME_5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t _read_64(const char* data)
+{
+	uint64_t value;
+	std::memcpy(&value, data, sizeof(value));
+	if constexpr (std::endian::native == std::endian::big)
+	{
+		value = __builtin_bswap64(value);
+	}
+
+	return value;
+}
+
+inline uint32_t _read_32(const char* data)
+{
+	uint32_t value;
+	std::memcpy(&value, data, sizeof(value));
+	if constexpr (std::endian::native == std::endian::big)
+	{
+		value = __builtin_bswap32(value);
+	}
+
+	return value;
+}
+
+inline uint64_t _xxh64_round(uint64_t accumulator, uint64_t input)
+{
+	accumulator += input * _XXH_PRIME_2;
+	accumulator = std::rotl(accumulator, 31);
+	return accumulator * _XXH_PRIME_1;
+}
+
+inline uint64_t _xxh64_merge_round(uint64_t accumulator, uint64_t value)
+{
+	accumulator ^= _xxh64_round(0, value);
+	return accumulator * _XXH_PRIME_1 + _XXH_PRIME_4;
+}
+
+uint64_t xxh64(std::string_view data, uint64_t seed)
+{
+	const char* position = data.data();
+	const char* end = position + data.size();
+	uint64_t result;
+	if (data.size() >= 32)
+	{
+		uint64_t accumulators[4] = {
+			seed + _XXH_PRIME_1 + _XXH_PRIME_2, seed + _XXH_PRIME_2, seed, seed - _XXH_PRIME_1
+		};
+
+		// Four independent lanes of 8 bytes are processed per
+		// iteration, so CPU can execute them in parallel.
+		const char* limit = end - 32;
+		do
+		{
+			for (auto& accumulator : accumulators)
+			{
+				accumulator = _xxh64_round(accumulator, _read_64(position));
+				position += 8;
+			}
+		}
+		while (position <= limit);
+
+		result = std::rotl(accumulators[0], 1) + std::rotl(accumulators[1], 7) +
+			std::rotl(accumulators[2], 12) + std::rotl(accumulators[3], 18);
+		for (auto accumulator : accumulators)
+		{
+			result = _xxh64_merge_round(result, accumulator);
+		}
+	}
+	else
+	{
+		result = seed + _XXH_PRIME_5;
+	}
+
+	result += (uint64_t)data.size();
+	for (; position + 8 <= end; position += 8)
+	{
+		result ^= _xxh64_round(0, _read_64(position));
+		result = std::rotl(result, 27) * _XXH_PRIME_1 + _XXH_PRIME_4;
+	}
+
+	if (position + 4 <= end)
+	{
+		result ^= (uint64_t)_read_32(position) * _XXH_PRIME_1;
+		result = std::rotl(result, 23) * _XXH_PRIME_2 + _XXH_PRIME_3;
+		position += 4;
+	}
+
+	for (; position < end; position++)
+	{
+		result ^= (uint64_t)(unsigned char)*position * _XXH_PRIME_5;
+		result = std::rotl(result, 11) * _XXH_PRIME_1;
+	}
+
+	// Final avalanche.
+	result ^= result >> 33;
+	result *= _XXH_PRIME_2;
+	result ^= result >> 29;
+	result *= _XXH_PRIME_3;
+	result ^= result >> 32;
+	return result;
+}
+
+std::string to_hex(uint64_t value)
+{
+	static constexpr const char* digits = "0123456789abcdef";
+	std::string result(16, '0');
+	for (auto it = result.rbegin(); it != result.rend(); it++)
+	{
+		*it = digits[value & 0xF];
+		value >>= 4;
+	}
+
+	return result;
+}
+
+__UTIL_END__
@@ -0,0 +1,32 @@
+/**
+ * utility/hash.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Fast non-cryptographic hash functions.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Module definitions.
+#include "./_def_.h"
+
+
+__UTIL_BEGIN__
+
+// TESTME: xxh64
+// 64-bit xxHash (XXH64) of data. It processes several gigabytes per second,
+// so it is suitable for hashing large response bodies, but it MUST NOT be
+// used where collisions can be forged by an attacker.
+extern uint64_t xxh64(std::string_view data, uint64_t seed=0);
+
+// TESTME: to_hex
+// Returns value as 16 lowercase hexadecimal digits.
+extern std::string to_hex(uint64_t value);
+
+__UTIL_END__
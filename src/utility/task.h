@@ -0,0 +1,272 @@
+/**
+ * utility/task.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Lazy coroutine which produces a single value.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+// Module definitions.
+#include "./_def_.h"
+
+
+__UTIL_BEGIN__
+
+template <typename T=void>
+class Task;
+
+struct _TaskPromiseBase
+{
+	// Coroutine which awaits the task, it is resumed
+	// when the task is finished.
+	std::coroutine_handle<> continuation = nullptr;
+	std::exception_ptr exception = nullptr;
+	bool is_started = false;
+
+	struct FinalAwaiter
+	{
+		[[nodiscard]]
+		inline bool await_ready() const noexcept
+		{
+			return false;
+		}
+
+		template <typename PromiseT>
+		inline std::coroutine_handle<> await_suspend(std::coroutine_handle<PromiseT> handle) noexcept
+		{
+			auto continuation = handle.promise().continuation;
+			return continuation ? continuation : std::noop_coroutine();
+		}
+
+		inline void await_resume() const noexcept
+		{
+		}
+	};
+
+	inline std::suspend_always initial_suspend() const noexcept
+	{
+		return {};
+	}
+
+	inline FinalAwaiter final_suspend() const noexcept
+	{
+		return {};
+	}
+
+	inline void unhandled_exception() noexcept
+	{
+		this->exception = std::current_exception();
+	}
+
+	inline void rethrow_if_failed() const
+	{
+		if (this->exception)
+		{
+			std::rethrow_exception(this->exception);
+		}
+	}
+};
+
+template <typename T>
+struct _TaskPromise : public _TaskPromiseBase
+{
+	std::optional<T> value;
+
+	[[nodiscard]]
+	inline Task<T> get_return_object() noexcept;
+
+	template <typename ValueT>
+	inline void return_value(ValueT&& result)
+	{
+		this->value.emplace(std::forward<ValueT>(result));
+	}
+
+	inline T result()
+	{
+		this->rethrow_if_failed();
+		return std::move(*this->value);
+	}
+};
+
+template <>
+struct _TaskPromise<void> : public _TaskPromiseBase
+{
+	[[nodiscard]]
+	inline Task<void> get_return_object() noexcept;
+
+	inline void return_void() const noexcept
+	{
+	}
+
+	inline void result() const
+	{
+		this->rethrow_if_failed();
+	}
+};
+
+// TESTME: Task<T>
+// Coroutine which is started when it is awaited for the first time and
+// resumes the awaiting coroutine when its result is ready. The task owns
+// its coroutine frame, so it must be alive until it is finished.
+//
+// Arguments of a coroutine are copied into its frame only if they are
+// passed by value. Arguments passed by reference and captures of a lambda
+// which is a coroutine must outlive the task.
+//
+// Exception thrown from the coroutine is rethrown from 'co_await' or
+// from 'get()'.
+template <typename T>
+class [[nodiscard]] Task final
+{
+public:
+	using promise_type = _TaskPromise<T>;
+	using value_type = T;
+
+	inline Task() noexcept = default;
+
+	inline explicit Task(std::coroutine_handle<promise_type> handle) noexcept : _handle(handle)
+	{
+	}
+
+	Task(const Task&) = delete;
+	Task& operator= (const Task&) = delete;
+
+	inline Task(Task&& other) noexcept : _handle(std::exchange(other._handle, nullptr))
+	{
+	}
+
+	inline Task& operator= (Task&& other) noexcept
+	{
+		if (this != &other)
+		{
+			this->_destroy();
+			this->_handle = std::exchange(other._handle, nullptr);
+		}
+
+		return *this;
+	}
+
+	inline ~Task()
+	{
+		this->_destroy();
+	}
+
+	[[nodiscard]]
+	inline bool is_valid() const noexcept
+	{
+		return (bool)this->_handle;
+	}
+
+	[[nodiscard]]
+	inline bool done() const noexcept
+	{
+		return !this->_handle || this->_handle.done();
+	}
+
+	// Runs the task until its first suspension point if it has not been
+	// started yet, so several tasks can wait at the same time. The task
+	// still has to be awaited or driven, for example, by 'EventLoop', to
+	// get its result.
+	inline void start()
+	{
+		if (this->_handle && !this->_handle.promise().is_started)
+		{
+			this->_handle.promise().is_started = true;
+			this->_handle.resume();
+		}
+	}
+
+	// Returns result of the finished task or rethrows its exception.
+	inline T get()
+	{
+		return this->_handle.promise().result();
+	}
+
+	inline auto operator co_await() && noexcept
+	{
+		struct Awaiter
+		{
+			std::coroutine_handle<promise_type> handle;
+
+			[[nodiscard]]
+			inline bool await_ready() const noexcept
+			{
+				return !this->handle || this->handle.done();
+			}
+
+			inline std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+			{
+				auto& promise = this->handle.promise();
+				promise.continuation = awaiting;
+				if (promise.is_started)
+				{
+					// The task is suspended somewhere else and
+					// resumes the awaiting coroutine when it is done.
+					return std::noop_coroutine();
+				}
+
+				promise.is_started = true;
+				return this->handle;
+			}
+
+			inline T await_resume()
+			{
+				return this->handle.promise().result();
+			}
+		};
+
+		return Awaiter{this->_handle};
+	}
+
+	inline auto operator co_await() & noexcept
+	{
+		return std::move(*this).operator co_await();
+	}
+
+private:
+	std::coroutine_handle<promise_type> _handle = nullptr;
+
+	inline void _destroy()
+	{
+		if (this->_handle)
+		{
+			this->_handle.destroy();
+			this->_handle = nullptr;
+		}
+	}
+};
+
+template <typename T>
+inline Task<T> _TaskPromise<T>::get_return_object() noexcept
+{
+	return Task<T>(std::coroutine_handle<_TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> _TaskPromise<void>::get_return_object() noexcept
+{
+	return Task<void>(std::coroutine_handle<_TaskPromise<void>>::from_promise(*this));
+}
+
+// TESTME: ready_task
+// Returns task which is finished as soon as it is started, it is used
+// to return an already computed value where a task is expected.
+template <typename T>
+inline Task<T> ready_task(T value)
+{
+	co_return std::move(value);
+}
+
+inline Task<void> ready_task()
+{
+	co_return;
+}
+
+__UTIL_END__
@@ -0,0 +1,137 @@
+/**
+ * controllers/tests_async_controller.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <map>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <xalwart.base/logger.h>
+
+#include "../../src/controllers/async_controller.h"
+#include "../../src/utility/event_loop.h"
+
+using namespace xw;
+
+
+// Resumes the awaiting coroutine on the loop from another thread.
+struct ResumeFromOtherThread
+{
+	util::EventLoop& loop;
+
+	bool await_ready() const noexcept
+	{
+		return false;
+	}
+
+	void await_suspend(std::coroutine_handle<> handle) const
+	{
+		std::thread([&loop = this->loop, handle]() { loop.schedule(handle); }).detach();
+	}
+
+	void await_resume() const noexcept
+	{
+	}
+};
+
+class ItemController : public ctrl::AsyncController<int>
+{
+public:
+	explicit ItemController(const ILogger* logger) : ctrl::AsyncController<int>({"get", "head"}, logger)
+	{
+	}
+
+	Result get(http::IRequest* request, int id) const override
+	{
+		co_await ResumeFromOtherThread{util::EventLoop::current()};
+		co_return std::make_unique<http::Response>(200, "item " + std::to_string(id));
+	}
+
+	util::Task<std::string> get_etag(http::IRequest* request, int id) const override
+	{
+		co_await ResumeFromOtherThread{util::EventLoop::current()};
+		co_return "version-" + std::to_string(id);
+	}
+};
+
+class AsyncControllerTestCase : public ::testing::Test
+{
+public:
+	static http::Request make_request(const std::string& method, std::map<std::string, std::string> headers={})
+	{
+		net::RequestContext context;
+		context.method = method;
+		context.headers = std::move(headers);
+		return http::Request(context, 99999, 99, 9999, 99, 9999, {});
+	}
+
+protected:
+	std::shared_ptr<ILogger> logger = nullptr;
+
+	void SetUp() override
+	{
+		auto lc = log::Config();
+		lc.disable_all_levels();
+		this->logger = std::make_shared<log::Logger>(lc);
+	}
+
+	std::unique_ptr<http::IResponse> dispatch(http::IRequest* request, int id)
+	{
+		return util::EventLoop::current().run_until_complete(ctrl::_dispatch_async(
+			std::make_unique<ItemController>(this->logger.get()), request, std::tuple<int>(id)
+		));
+	}
+};
+
+TEST_F(AsyncControllerTestCase, dispatch_AwaitsMethod)
+{
+	auto request = AsyncControllerTestCase::make_request("GET");
+	auto response = this->dispatch(&request, 5);
+
+	ASSERT_EQ(response->get_status(), 200);
+	ASSERT_EQ(response->get_content(), "item 5");
+	ASSERT_EQ(response->get_header(http::E_TAG, ""), "\"version-5\"");
+}
+
+TEST_F(AsyncControllerTestCase, dispatch_HeadAwaitsGet)
+{
+	auto request = AsyncControllerTestCase::make_request("HEAD");
+	auto response = this->dispatch(&request, 7);
+
+	ASSERT_EQ(response->get_status(), 200);
+	ASSERT_EQ(response->get_content(), "item 7");
+}
+
+TEST_F(AsyncControllerTestCase, dispatch_ReturnsNotModifiedIfETagMatches)
+{
+	auto request = AsyncControllerTestCase::make_request("GET", {{"If-None-Match", "\"version-5\""}});
+	auto response = this->dispatch(&request, 5);
+
+	ASSERT_EQ(response->get_status(), 304);
+	ASSERT_EQ(response->get_header(http::E_TAG, ""), "\"version-5\"");
+}
+
+TEST_F(AsyncControllerTestCase, dispatch_NotAllowed)
+{
+	auto request = AsyncControllerTestCase::make_request("POST");
+	auto response = this->dispatch(&request, 1);
+
+	ASSERT_EQ(response->get_status(), 405);
+}
+
+TEST_F(AsyncControllerTestCase, dispatch_Options)
+{
+	auto request = AsyncControllerTestCase::make_request("OPTIONS");
+	auto response = this->dispatch(&request, 1);
+
+	ASSERT_EQ(response->get_status(), 200);
+	ASSERT_EQ(response->get_header(http::ALLOW, ""), "GET, HEAD, OPTIONS");
+}
+
+TEST_F(AsyncControllerTestCase, dispatch_ThrowsIfRequestIsNullptr)
+{
+	ASSERT_THROW(auto _ = this->dispatch(nullptr, 1), NullPointerException);
+}
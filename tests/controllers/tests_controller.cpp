@@ -16,14 +16,37 @@
 using namespace xw;
 
 
+// Counts calls of 'get' which is skipped if ETag matches.
+class VersionedController : public ctrl::Controller<>
+{
+public:
+	mutable int calls_count = 0;
+
+	explicit VersionedController(const ILogger* logger) : ctrl::Controller<>({"get", "head"}, logger)
+	{
+	}
+
+	std::unique_ptr<http::IResponse> get(http::IRequest* request) const override
+	{
+		this->calls_count++;
+		return std::make_unique<http::Response>(200, "versioned content");
+	}
+
+	std::string get_etag(http::IRequest* request) const override
+	{
+		return "v1";
+	}
+};
+
 class ControllerTestCase : public ::testing::Test
 {
 public:
-	static http::Request make_request(const std::string& method)
+	static http::Request make_request(const std::string& method, std::map<std::string, std::string> headers={})
 	{
 		auto context = net::RequestContext{
 			.method = method
 		};
+		context.headers = std::move(headers);
 		return http::Request(context, 99999, 99, 9999, 99, 9999, {});
 	}
 
@@ -137,3 +160,51 @@ TEST_F(ControllerTestCase, DispatchNotAllowedTest)
 
 	ASSERT_EQ(response->get_status(), 405);
 }
+
+TEST_F(ControllerTestCase, DispatchSetsETagOfGetEtag)
+{
+	VersionedController versioned_controller(this->logger.get());
+	auto request = ControllerTestCase::make_request("GET");
+	auto response = versioned_controller.dispatch(&request);
+
+	ASSERT_EQ(response->get_status(), 200);
+	ASSERT_EQ(response->get_header(http::E_TAG, ""), "\"v1\"");
+	ASSERT_EQ(versioned_controller.calls_count, 1);
+}
+
+TEST_F(ControllerTestCase, DispatchReturnsNotModifiedWithoutCallingHandler)
+{
+	VersionedController versioned_controller(this->logger.get());
+	for (const auto* if_none_match : {"\"v1\"", "W/\"v1\"", "\"v0\", \"v1\"", "*"})
+	{
+		auto request = ControllerTestCase::make_request("GET", {{http::IF_NONE_MATCH, if_none_match}});
+		auto response = versioned_controller.dispatch(&request);
+
+		ASSERT_EQ(response->get_status(), 304) << if_none_match;
+		ASSERT_EQ(response->get_header(http::E_TAG, ""), "\"v1\"") << if_none_match;
+		ASSERT_EQ(response->get_content(), "") << if_none_match;
+	}
+
+	ASSERT_EQ(versioned_controller.calls_count, 0);
+}
+
+TEST_F(ControllerTestCase, DispatchCallsHandlerIfETagDiffers)
+{
+	VersionedController versioned_controller(this->logger.get());
+	auto request = ControllerTestCase::make_request("GET", {{http::IF_NONE_MATCH, "\"v0\""}});
+	auto response = versioned_controller.dispatch(&request);
+
+	ASSERT_EQ(response->get_status(), 200);
+	ASSERT_EQ(response->get_content(), "versioned content");
+	ASSERT_EQ(versioned_controller.calls_count, 1);
+}
+
+TEST_F(ControllerTestCase, DispatchReturnsPreconditionFailedWithoutCallingHandler)
+{
+	VersionedController versioned_controller(this->logger.get());
+	auto request = ControllerTestCase::make_request("GET", {{http::IF_MATCH, "\"v0\""}});
+	auto response = versioned_controller.dispatch(&request);
+
+	ASSERT_EQ(response->get_status(), 412);
+	ASSERT_EQ(versioned_controller.calls_count, 0);
+}
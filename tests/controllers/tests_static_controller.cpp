@@ -0,0 +1,93 @@
+/**
+ * controllers/tests_static_controller.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include <xalwart.base/logger.h>
+
+#include "../../src/conf/settings.h"
+#include "../../src/controllers/static.h"
+
+using namespace xw;
+
+
+class StaticControllerTestCase : public ::testing::Test
+{
+protected:
+	std::filesystem::path directory;
+	std::shared_ptr<ILogger> logger = nullptr;
+	conf::Settings settings;
+
+	void SetUp() override
+	{
+		this->directory = std::filesystem::temp_directory_path() / "xw_static_controller_tests";
+		std::filesystem::create_directories(this->directory);
+		std::ofstream file(this->directory / "digits.txt", std::ios::binary | std::ios::trunc);
+		file << "0123456789";
+		file.close();
+
+		auto lc = log::Config();
+		lc.disable_all_levels();
+		this->logger = std::make_shared<log::Logger>(lc);
+	}
+
+	void TearDown() override
+	{
+		std::filesystem::remove_all(this->directory);
+	}
+
+	std::unique_ptr<http::IResponse> get(
+		const std::map<std::string, std::string>& headers,
+		const std::shared_ptr<ctrl::StaticFileCache>& cache=nullptr
+	)
+	{
+		net::RequestContext context{
+			.protocol_version = {.major = 1, .minor = 1},
+			.path = "/static/digits.txt",
+			.method = "GET"
+		};
+		context.headers = headers;
+		http::Request request(context, 99999, 99, 9999, 99, 9999, {});
+		ctrl::StaticController controller(this->directory.string(), &this->settings, this->logger.get(), cache);
+		return controller.get(&request, "digits.txt");
+	}
+};
+
+TEST_F(StaticControllerTestCase, get_RangeWithMatchingIfRange)
+{
+	auto etag = this->get({})->get_header(http::E_TAG, "");
+	ASSERT_TRUE(etag.starts_with("\""));
+
+	auto response = this->get({{http::RANGE, "bytes=2-4"}, {http::IF_RANGE, etag}});
+
+	ASSERT_EQ(response->get_status(), 206);
+	ASSERT_EQ(response->get_header(http::E_TAG, ""), etag);
+	ASSERT_EQ(response->get_header(http::CONTENT_RANGE, ""), "bytes 2-4/10");
+}
+
+TEST_F(StaticControllerTestCase, get_RangeWithStaleIfRangeReturnsWholeFile)
+{
+	auto response = this->get({{http::RANGE, "bytes=2-4"}, {http::IF_RANGE, "\"x\""}});
+
+	ASSERT_EQ(response->get_status(), 200);
+	ASSERT_FALSE(response->has_header(http::CONTENT_RANGE));
+}
+
+TEST_F(StaticControllerTestCase, get_PrecompressedVariantFromCache)
+{
+	std::ofstream(this->directory / "digits.txt.br", std::ios::binary) << "compressed";
+	auto cache = std::make_shared<ctrl::StaticFileCache>(8, 1024, std::chrono::hours(1));
+
+	auto response = this->get({{http::ACCEPT_ENCODING, "gzip, br"}}, cache);
+
+	ASSERT_EQ(response->get_status(), 200);
+	ASSERT_EQ(response->get_header(http::CONTENT_ENCODING, ""), "br");
+	ASSERT_EQ(response->get_header(http::VARY, ""), http::ACCEPT_ENCODING);
+	ASSERT_EQ(cache->get((this->directory / "digits.txt").string())->variants.size(), 1);
+}
@@ -0,0 +1,179 @@
+/**
+ * controllers/tests_static_file_cache.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include "../../src/controllers/static_file_cache.h"
+
+using namespace xw;
+
+
+class StaticFileCacheTestCase : public ::testing::Test
+{
+protected:
+	std::filesystem::path directory;
+
+	void SetUp() override
+	{
+		this->directory = std::filesystem::temp_directory_path() / "xw_static_file_cache_tests";
+		std::filesystem::create_directories(this->directory);
+	}
+
+	void TearDown() override
+	{
+		std::filesystem::remove_all(this->directory);
+	}
+
+	std::string write_file(const std::string& name, const std::string& content)
+	{
+		auto file_path = (this->directory / name).string();
+		std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+		file << content;
+		return file_path;
+	}
+};
+
+TEST_F(StaticFileCacheTestCase, get_LoadsFile)
+{
+	ctrl::StaticFileCache cache(8, 1024, std::chrono::milliseconds(0));
+	auto file_path = this->write_file("index.html", "<p>Hello</p>");
+
+	auto entry = cache.get(file_path);
+
+	ASSERT_NE(entry, nullptr);
+	ASSERT_EQ(*entry->content, "<p>Hello</p>");
+	ASSERT_TRUE(entry->etag.starts_with("\""));
+	ASSERT_FALSE(entry->last_modified.empty());
+	ASSERT_EQ(cache.size(), 1);
+}
+
+TEST_F(StaticFileCacheTestCase, get_ReturnsSameEntryForUnchangedFile)
+{
+	ctrl::StaticFileCache cache(8, 1024, std::chrono::milliseconds(0));
+	auto file_path = this->write_file("style.css", "p {}");
+
+	auto first = cache.get(file_path);
+	auto second = cache.get(file_path);
+
+	ASSERT_EQ(first, second);
+}
+
+TEST_F(StaticFileCacheTestCase, get_ReloadsChangedFile)
+{
+	ctrl::StaticFileCache cache(8, 1024, std::chrono::milliseconds(0));
+	auto file_path = this->write_file("script.js", "let x = 1;");
+	auto first = cache.get(file_path);
+
+	this->write_file("script.js", "let x = 12;");
+	auto second = cache.get(file_path);
+
+	ASSERT_NE(first, second);
+	ASSERT_EQ(*second->content, "let x = 12;");
+}
+
+TEST_F(StaticFileCacheTestCase, get_DoesNotCheckFileWithinRevalidateInterval)
+{
+	ctrl::StaticFileCache cache(8, 1024, std::chrono::hours(1));
+	auto file_path = this->write_file("script.js", "let x = 1;");
+	auto first = cache.get(file_path);
+
+	std::filesystem::remove(file_path);
+	auto second = cache.get(file_path);
+
+	ASSERT_EQ(first, second);
+}
+
+TEST_F(StaticFileCacheTestCase, get_ReturnsNullForMissingFile)
+{
+	ctrl::StaticFileCache cache(8, 1024, std::chrono::milliseconds(0));
+
+	ASSERT_EQ(cache.get((this->directory / "missing.txt").string()), nullptr);
+	ASSERT_EQ(cache.size(), 0);
+}
+
+TEST_F(StaticFileCacheTestCase, get_SkipsLargeFile)
+{
+	ctrl::StaticFileCache cache(8, 4, std::chrono::milliseconds(0));
+	auto file_path = this->write_file("large.txt", "12345");
+
+	ASSERT_EQ(cache.get(file_path), nullptr);
+	ASSERT_EQ(cache.size(), 0);
+}
+
+TEST_F(StaticFileCacheTestCase, get_EvictsLeastRecentlyUsedFile)
+{
+	ctrl::StaticFileCache cache(2, 1024, std::chrono::hours(1));
+	auto first_path = this->write_file("1.txt", "1");
+	auto second_path = this->write_file("2.txt", "2");
+	auto third_path = this->write_file("3.txt", "3");
+	auto first = cache.get(first_path);
+	auto second = cache.get(second_path);
+
+	// Mark the first file as recently used.
+	ASSERT_EQ(cache.get(first_path), first);
+	(void)cache.get(third_path);
+
+	ASSERT_EQ(cache.size(), 2);
+	ASSERT_EQ(cache.get(first_path), first);
+	ASSERT_NE(cache.get(second_path), second);
+}
+
+TEST_F(StaticFileCacheTestCase, get_KeepsPrecompressedVariants)
+{
+	ctrl::StaticFileCache cache(8, 1024, std::chrono::milliseconds(0));
+	auto file_path = this->write_file("app.js", "let x = 1;");
+	auto gzip_path = this->write_file("app.js.gz", "gzip");
+	auto br_path = this->write_file("app.js.br", "br");
+
+	auto entry = cache.get(file_path);
+
+	ASSERT_NE(entry, nullptr);
+	ASSERT_EQ(entry->variants, std::vector<ctrl::StaticFileCache::Variant>({
+		{.encoding = "br", .file_path = br_path}, {.encoding = "gzip", .file_path = gzip_path}
+	}));
+	ASSERT_TRUE(cache.get(br_path)->variants.empty());
+}
+
+TEST_F(StaticFileCacheTestCase, get_SkipsVariantOlderThanFile)
+{
+	ctrl::StaticFileCache cache(8, 1024, std::chrono::milliseconds(0));
+	auto file_path = this->write_file("app.js", "let x = 1;");
+	auto br_path = this->write_file("app.js.br", "br");
+	std::filesystem::last_write_time(
+		br_path, std::filesystem::last_write_time(file_path) - std::chrono::hours(1)
+	);
+
+	ASSERT_TRUE(cache.get(file_path)->variants.empty());
+}
+
+TEST_F(StaticFileCacheTestCase, get_RevalidatesVariantsWithFile)
+{
+	ctrl::StaticFileCache cache(8, 1024, std::chrono::milliseconds(0));
+	auto file_path = this->write_file("app.js", "let x = 1;");
+	auto first = cache.get(file_path);
+
+	auto br_path = this->write_file("app.js.br", "br");
+	auto second = cache.get(file_path);
+
+	ASSERT_TRUE(first->variants.empty());
+	ASSERT_EQ(second->variants, std::vector<ctrl::StaticFileCache::Variant>({{.encoding = "br", .file_path = br_path}}));
+	ASSERT_EQ(second->content, first->content);
+}
+
+TEST_F(StaticFileCacheTestCase, get_DoesNotCheckVariantsWithinRevalidateInterval)
+{
+	ctrl::StaticFileCache cache(8, 1024, std::chrono::hours(1));
+	auto file_path = this->write_file("app.js", "let x = 1;");
+	auto first = cache.get(file_path);
+
+	this->write_file("app.js.br", "br");
+
+	ASSERT_EQ(cache.get(file_path), first);
+}
@@ -0,0 +1,114 @@
+/**
+ * http/cookie/tests_jar.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <memory_resource>
+
+#include <gtest/gtest.h>
+
+#include "../../../src/http/cookie/jar.h"
+#include "../../../src/http/utility.h"
+
+using namespace xw;
+
+
+TEST(TestCase_CookieJar, get_ReturnsValueWithoutQuotes)
+{
+	http::CookieJar jar(" session=abc; theme=\"dark\"; flag ");
+
+	ASSERT_EQ(jar.size(), 3);
+	ASSERT_EQ(jar.get("session"), "abc");
+	ASSERT_EQ(jar.get("theme"), "dark");
+	ASSERT_EQ(jar.get("flag"), "");
+	ASSERT_EQ(jar.get("missing"), std::nullopt);
+}
+
+TEST(TestCase_CookieJar, get_SkipsInvalidValuesOfSameName)
+{
+	http::CookieJar jar("id=bad\\value; other=1; id=good; id=last");
+
+	ASSERT_EQ(jar.get("id"), "good");
+	ASSERT_FALSE(jar.contains("bad"));
+}
+
+TEST(TestCase_CookieJar, get_IgnoresInvalidNames)
+{
+	http::CookieJar jar("na me=1; =2; valid=3");
+
+	ASSERT_EQ(jar.size(), 1);
+	ASSERT_EQ(jar.get("valid"), "3");
+}
+
+TEST(TestCase_CookieJar, cookies_KeepsOrderOfHeader)
+{
+	http::CookieJar jar("b=2; a=1; c=\"bad\"value\"; a=3");
+
+	auto all = jar.cookies();
+	ASSERT_EQ(all.size(), 3);
+	ASSERT_EQ(all[0].name(), "b");
+	ASSERT_EQ(all[1].name(), "a");
+	ASSERT_EQ(all[2].value(), "3");
+
+	auto named = jar.cookies("a");
+	ASSERT_EQ(named.size(), 2);
+	ASSERT_EQ(named[0].value(), "1");
+	ASSERT_EQ(named[1].value(), "3");
+}
+
+TEST(TestCase_CookieJar, CopyDoesNotReferToOriginal)
+{
+	std::optional<http::CookieJar> jar(http::CookieJar("name=some-long-value-which-is-not-inlined"));
+	auto copy = *jar;
+	jar.reset();
+
+	ASSERT_EQ(copy.get("name"), "some-long-value-which-is-not-inlined");
+}
+
+// Counts bytes which are allocated by the jar.
+class CountingMemoryResource : public std::pmr::memory_resource
+{
+public:
+	size_t allocated_bytes = 0;
+
+protected:
+	void* do_allocate(size_t bytes, size_t alignment) override
+	{
+		this->allocated_bytes += bytes;
+		return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+	}
+
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override
+	{
+		std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+	}
+
+	[[nodiscard]]
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+	{
+		return this == &other;
+	}
+};
+
+TEST(TestCase_CookieJar, AllocatesFromMemoryResource)
+{
+	std::string header = "b=2; a=1; name=some-long-value-which-is-not-inlined; a=3";
+	CountingMemoryResource resource;
+	http::CookieJar jar(header, &resource);
+
+	ASSERT_GT(resource.allocated_bytes, header.size() + 4 * sizeof(size_t));
+	ASSERT_EQ(jar.get("name"), "some-long-value-which-is-not-inlined");
+}
+
+TEST(TestCase_CookieJar, get_signed)
+{
+	auto signed_value = http::get_cookie_signer("secret", "session" "salt")->sign("user:1");
+	http::CookieJar jar("session=" + signed_value + "; plain=value");
+
+	ASSERT_EQ(jar.get_signed("session", "secret", "salt"), "user:1");
+	ASSERT_EQ(jar.get_signed("session", "secret", "other-salt"), std::nullopt);
+	ASSERT_EQ(jar.get_signed("session", "other-secret", "salt"), std::nullopt);
+	ASSERT_EQ(jar.get_signed("plain", "secret", "salt"), std::nullopt);
+	ASSERT_EQ(jar.get_signed("missing", "secret", "salt"), std::nullopt);
+}
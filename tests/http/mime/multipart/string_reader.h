@@ -0,0 +1,191 @@
+/**
+ * http/mime/multipart/string_reader.h
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ *
+ * Readers of in-memory data for tests of multipart readers.
+ */
+
+#pragma once
+
+// C++ libraries.
+#include <algorithm>
+#include <string>
+#include <string_view>
+
+// Base libraries.
+#include <xalwart.base/exceptions.h>
+#include <xalwart.base/io.h>
+
+// Framework libraries.
+#include "../../../../src/http/mime/multipart/temporary_file.h"
+
+
+// Returns `data` by chunks of at most `chunk_size` bytes, so the readers
+// which wrap it are tested with input split at every possible position.
+class StringReader : public xw::io::IReader
+{
+public:
+	explicit StringReader(std::string data, size_t chunk_size) :
+		_data(std::move(data)), _chunk_size(chunk_size)
+	{
+	}
+
+	ssize_t read_line(std::string& buffer) override
+	{
+		throw xw::NotImplementedException("read_line", _ERROR_DETAILS_);
+	}
+
+	ssize_t read(std::string& buffer, size_t max_count) override
+	{
+		buffer = this->_data.substr(this->_position, std::min(max_count, this->_chunk_size));
+		this->_position += buffer.size();
+		return (ssize_t)buffer.size();
+	}
+
+	bool close_reader() override
+	{
+		return true;
+	}
+
+private:
+	std::string _data;
+	size_t _chunk_size;
+	size_t _position = 0;
+};
+
+// Buffered reader of `data` which receives at most `chunk_size` bytes at
+// a time, like the body of a request which arrives by packets.
+class StringBufferedReader : public xw::io::ILimitedBufferedReader
+{
+public:
+	explicit StringBufferedReader(std::string data, size_t chunk_size) :
+		_data(std::move(data)), _chunk_size(chunk_size), _limit((ssize_t)this->_data.size())
+	{
+	}
+
+	ssize_t read_line(std::string& line) override
+	{
+		line.clear();
+		while (this->_limit > 0)
+		{
+			if (this->_buffered == 0)
+			{
+				this->_receive_more();
+			}
+
+			auto data = std::string_view(this->_data).substr(this->_position, this->_buffered);
+			auto line_end = data.find('\n');
+			auto count = line_end == std::string_view::npos ? data.size() : line_end + 1;
+			line.append(data.substr(0, count));
+			this->_consume(count);
+			if (line_end != std::string_view::npos)
+			{
+				break;
+			}
+		}
+
+		return (ssize_t)line.size();
+	}
+
+	ssize_t read(std::string& buffer, size_t max_count) override
+	{
+		if (this->_limit == 0 || max_count == 0)
+		{
+			buffer.clear();
+			return 0;
+		}
+
+		if (this->_buffered == 0)
+		{
+			this->_receive_more();
+		}
+
+		auto count = std::min(this->_buffered, max_count);
+		buffer.assign(this->_data, this->_position, count);
+		this->_consume(count);
+		return (ssize_t)count;
+	}
+
+	bool close_reader() override
+	{
+		return true;
+	}
+
+	void peek(std::string& buffer, size_t count) override
+	{
+		count = std::min(count, (size_t)this->_limit);
+		while (this->_buffered < count)
+		{
+			this->_receive_more();
+		}
+
+		buffer.assign(this->_data, this->_position, count);
+	}
+
+	[[nodiscard]]
+	size_t buffered() const override
+	{
+		return this->_buffered;
+	}
+
+	[[nodiscard]]
+	ssize_t limit() const override
+	{
+		return this->_limit - (ssize_t)this->_buffered;
+	}
+
+	void set_limit(ssize_t limit) override
+	{
+		this->_limit = std::clamp<ssize_t>(limit, 0, (ssize_t)(this->_data.size() - this->_position));
+		this->_buffered = std::min(this->_buffered, (size_t)this->_limit);
+	}
+
+private:
+	std::string _data;
+	size_t _chunk_size;
+	size_t _position = 0;
+	size_t _buffered = 0;
+	ssize_t _limit;
+
+	void _receive_more()
+	{
+		this->_buffered = std::min(this->_buffered + this->_chunk_size, (size_t)this->_limit);
+	}
+
+	void _consume(size_t count)
+	{
+		this->_position += count;
+		this->_buffered -= count;
+		this->_limit -= (ssize_t)count;
+	}
+};
+
+// Reader of `data` which is spooled to `file`, like the large body of
+// a request, see 'xw::http::mime::multipart::ISpooledReader'.
+class SpooledStringReader : public StringBufferedReader, public xw::http::mime::multipart::ISpooledReader
+{
+public:
+	explicit SpooledStringReader(
+		const std::string& data, size_t chunk_size, const xw::http::mime::multipart::TemporaryFile* file
+	) :
+		StringBufferedReader(data, chunk_size), _size(data.size()), _file(file)
+	{
+	}
+
+	[[nodiscard]]
+	const xw::http::mime::multipart::TemporaryFile* spooled_file() const override
+	{
+		return this->_file;
+	}
+
+	[[nodiscard]]
+	size_t spooled_position() const override
+	{
+		return this->_size - (size_t)(this->limit() + (ssize_t)this->buffered());
+	}
+
+private:
+	size_t _size;
+	const xw::http::mime::multipart::TemporaryFile* _file;
+};
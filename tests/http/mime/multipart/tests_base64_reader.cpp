@@ -0,0 +1,136 @@
+/**
+ * http/mime/multipart/tests_base64_reader.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <gtest/gtest.h>
+
+#include "../../../../src/http/mime/multipart/base64_reader.h"
+#include "./string_reader.h"
+
+using namespace xw;
+
+
+static std::string read_all_base64(const std::string& data, size_t chunk_size, size_t block_size)
+{
+	http::mime::multipart::Base64Reader reader(
+		std::make_shared<StringReader>(data, chunk_size), block_size
+	);
+	std::string result, buffer;
+	while (reader.read(buffer, 5) > 0)
+	{
+		result += buffer;
+	}
+
+	return result;
+}
+
+static std::string encode_base64(const std::string& data)
+{
+	static const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	std::string result;
+	size_t i = 0;
+	for (; i + 3 <= data.size(); i += 3)
+	{
+		auto value = (unsigned char)data[i] << 16 | (unsigned char)data[i + 1] << 8 | (unsigned char)data[i + 2];
+		result += alphabet[value >> 18 & 63];
+		result += alphabet[value >> 12 & 63];
+		result += alphabet[value >> 6 & 63];
+		result += alphabet[value & 63];
+	}
+
+	if (i + 1 == data.size())
+	{
+		auto value = (unsigned char)data[i] << 16;
+		result += alphabet[value >> 18 & 63];
+		result += alphabet[value >> 12 & 63];
+		result += "==";
+	}
+	else if (i + 2 == data.size())
+	{
+		auto value = (unsigned char)data[i] << 16 | (unsigned char)data[i + 1] << 8;
+		result += alphabet[value >> 18 & 63];
+		result += alphabet[value >> 12 & 63];
+		result += alphabet[value >> 6 & 63];
+		result += '=';
+	}
+
+	return result;
+}
+
+TEST(TestCase_Base64Reader, read_Padding)
+{
+	ASSERT_EQ(read_all_base64("", 3, 8), "");
+	ASSERT_EQ(read_all_base64("Zg==", 3, 8), "f");
+	ASSERT_EQ(read_all_base64("Zm8=", 3, 8), "fo");
+	ASSERT_EQ(read_all_base64("Zm9v", 3, 8), "foo");
+	ASSERT_EQ(read_all_base64("Zm9vYg", 3, 8), "foob");
+	ASSERT_EQ(read_all_base64("Zm9vYmE=\r\nignored", 3, 8), "fooba");
+}
+
+TEST(TestCase_Base64Reader, read_IgnoresLineBreaks)
+{
+	std::string data;
+	for (size_t i = 0; i < 5000; i++)
+	{
+		data += (char)(i * 7 + i / 256);
+	}
+
+	auto encoded = encode_base64(data);
+	std::string wrapped;
+	for (size_t i = 0; i < encoded.size(); i += 76)
+	{
+		wrapped += encoded.substr(i, 76) + "\r\n";
+	}
+
+	ASSERT_EQ(read_all_base64(wrapped, 1000, 333), data);
+	ASSERT_EQ(read_all_base64(wrapped, 1, 64 * 1024), data);
+}
+
+TEST(TestCase_Base64Reader, read_InvalidData)
+{
+	ASSERT_THROW(read_all_base64("Zm9v*mFy", 8, 8), ParseError);
+	ASSERT_THROW(read_all_base64("Zm9vY", 8, 8), ParseError);
+	ASSERT_THROW(read_all_base64("Z===", 8, 8), ParseError);
+	ASSERT_THROW(read_all_base64(std::string(100, 'A') + "\x80" + std::string(99, 'A'), 200, 200), ParseError);
+}
+
+TEST(TestCase_Base64Reader, decode_base64_AllCharactersOfBlock)
+{
+	// Each character is placed in every position of blocks which
+	// are decoded by vector instructions.
+	std::string alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	for (int c = 0; c < 256; c++)
+	{
+		auto is_valid = alphabet.find((char)c) != std::string::npos;
+		for (size_t position = 0; position < 64; position++)
+		{
+			std::string input(128, 'A');
+			input[position] = (char)c;
+			std::string output(input.size() / 4 * 3, '\0');
+			bool is_padded = false;
+			if (is_valid)
+			{
+				ASSERT_EQ(http::mime::multipart::_decode_base64(input, output.data(), is_padded), output.size());
+
+				// The value is placed at bit `offset` of zeros.
+				auto value = (unsigned)alphabet.find((char)c) << 2;
+				auto offset = position / 4 * 24 + position % 4 * 6;
+				std::string expected(output.size(), '\0');
+				expected[offset / 8] = (char)(value >> offset % 8);
+				expected[offset / 8 + 1] = (char)(value << (8 - offset % 8));
+				ASSERT_EQ(output, expected);
+			}
+			else if (c == '=' && position % 4 == 3)
+			{
+				ASSERT_EQ(http::mime::multipart::_decode_base64(input, output.data(), is_padded), position / 4 * 3 + 2);
+				ASSERT_TRUE(is_padded);
+			}
+			else
+			{
+				ASSERT_THROW(http::mime::multipart::_decode_base64(input, output.data(), is_padded), ParseError);
+			}
+		}
+	}
+}
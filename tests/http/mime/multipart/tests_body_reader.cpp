@@ -0,0 +1,199 @@
+/**
+ * http/mime/multipart/tests_body_reader.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <algorithm>
+#include <cctype>
+
+#include <gtest/gtest.h>
+
+#include "../../../../src/http/mime/multipart/body_reader.h"
+#include "./string_reader.h"
+
+using namespace xw;
+
+
+class BodyReaderTestCase : public ::testing::Test
+{
+protected:
+	std::string file_content;
+	std::string body;
+
+	void SetUp() override
+	{
+		for (int i = 0; i < 1000; i++)
+		{
+			this->file_content += "line " + std::to_string(i) + "\r\n";
+		}
+
+		this->body = "preamble\r\n"
+			"--XYZ\r\nContent-Disposition: form-data; name=\"title\"\r\n\r\nreport\r\n"
+			"--XYZ\r\nContent-Disposition: form-data; name=\"file\"; filename=\"report.txt\"\r\n"
+			"Content-Type: text/plain\r\n\r\n" + this->file_content + "\r\n"
+			"--XYZ\r\nContent-Disposition: form-data; name=\"comment\"\r\n\r\nlast part\r\n"
+			"--XYZ--\r\n";
+	}
+
+	[[nodiscard]]
+	http::mime::multipart::BodyReader make_reader(size_t chunk_size) const
+	{
+		return {
+			std::make_shared<StringBufferedReader>(this->body, chunk_size),
+			"XYZ", (ssize_t)this->body.size(), 1 << 20, 10, 1024, 10
+		};
+	}
+
+	[[nodiscard]]
+	static std::shared_ptr<http::mime::multipart::FileHeader> get_file(const http::mime::multipart::Form& form)
+	{
+		for (const auto& [name, headers] : form.files)
+		{
+			if (name == "file")
+			{
+				return headers.front();
+			}
+		}
+
+		return nullptr;
+	}
+};
+
+TEST_F(BodyReaderTestCase, read_parts_ReadsPartsInOrder)
+{
+	auto reader = this->make_reader(4096);
+	std::vector<std::string> names;
+	reader.read_parts([&](http::mime::multipart::Part& part) -> bool
+	{
+		names.push_back(part.form_name());
+		return true;
+	});
+
+	ASSERT_EQ(names, std::vector<std::string>({"title", "file", "comment"}));
+}
+
+TEST_F(BodyReaderTestCase, read_parts_PartialReadsOfFileAcrossChunks)
+{
+	for (size_t chunk_size : {1, 7, 100, 4096})
+	{
+		auto reader = this->make_reader(chunk_size);
+		std::string content;
+		size_t reads_count = 0;
+		reader.read_parts([&](http::mime::multipart::Part& part) -> bool
+		{
+			if (part.file_name() != "report.txt")
+			{
+				return true;
+			}
+
+			std::string chunk;
+			while (part.read_some(chunk, 1000) > 0)
+			{
+				EXPECT_LE(chunk.size(), 1000);
+				content += chunk;
+				reads_count++;
+			}
+
+			return true;
+		});
+
+		ASSERT_EQ(content, this->file_content) << chunk_size;
+		ASSERT_GE(reads_count, this->file_content.size() / 1000) << chunk_size;
+	}
+}
+
+TEST_F(BodyReaderTestCase, read_parts_SkipsUnreadParts)
+{
+	for (size_t chunk_size : {1, 7, 4096})
+	{
+		auto reader = this->make_reader(chunk_size);
+		std::string title_start, comment;
+		reader.read_parts([&](http::mime::multipart::Part& part) -> bool
+		{
+			// The rest of 'title' and the whole file are not read by the handler.
+			if (part.form_name() == "title")
+			{
+				part.read(title_start, 3);
+			}
+			else if (part.form_name() == "comment")
+			{
+				part.read(comment, 1024);
+			}
+
+			return true;
+		});
+
+		ASSERT_EQ(title_start, "rep") << chunk_size;
+		ASSERT_EQ(comment, "last part") << chunk_size;
+	}
+}
+
+TEST_F(BodyReaderTestCase, read_parts_StopsWhenHandlerReturnsFalse)
+{
+	auto reader = this->make_reader(7);
+	std::vector<std::string> names;
+	reader.read_parts([&](http::mime::multipart::Part& part) -> bool
+	{
+		names.push_back(part.form_name());
+		return part.form_name() != "file";
+	});
+
+	ASSERT_EQ(names, std::vector<std::string>({"title", "file"}));
+}
+
+TEST_F(BodyReaderTestCase, skip_DropsRestOfPart)
+{
+	auto reader = this->make_reader(7);
+	auto part = reader.next_part();
+	std::string chunk;
+	ASSERT_EQ(part->read_some(chunk, 2), 2);
+	ASSERT_EQ(chunk, "re");
+
+	part->skip();
+
+	ASSERT_EQ(part->read_some(chunk, 1024), 0);
+	ASSERT_TRUE(chunk.empty());
+	ASSERT_EQ(reader.next_part()->file_name(), "report.txt");
+}
+
+TEST_F(BodyReaderTestCase, read_form_CopiesFileFromSpooledBody)
+{
+	// The file part in the spooled copy differs from the data which is read,
+	// so the saved upload shows that it is copied from the file.
+	auto spooled_content = this->file_content;
+	std::transform(spooled_content.begin(), spooled_content.end(), spooled_content.begin(), ::toupper);
+	auto spooled_body = this->body;
+	spooled_body.replace(spooled_body.find(this->file_content), spooled_content.size(), spooled_content);
+	http::mime::multipart::TemporaryFile file;
+	file.write(spooled_body);
+
+	for (size_t chunk_size : {7, 4096})
+	{
+		http::mime::multipart::BodyReader reader(
+			std::make_shared<SpooledStringReader>(this->body, chunk_size, &file),
+			"XYZ", (ssize_t)this->body.size(), 1 << 20, 10, 1024, 10
+		);
+		auto header = get_file(reader.read_form(100));
+
+		ASSERT_TRUE(header->tmp_file) << chunk_size;
+		ASSERT_EQ(header->size, spooled_content.size()) << chunk_size;
+		ASSERT_EQ(header->tmp_file->read(), spooled_content) << chunk_size;
+	}
+}
+
+TEST_F(BodyReaderTestCase, read_form_WritesDecodedFileOfSpooledBody)
+{
+	this->body = "--XYZ\r\nContent-Disposition: form-data; name=\"file\"; filename=\"report.txt\"\r\n"
+		"Content-Transfer-Encoding: quoted-printable\r\n\r\n" + this->file_content + "caf=C3=A9\r\n"
+		"--XYZ--\r\n";
+	http::mime::multipart::TemporaryFile file;
+	file.write(this->body);
+	http::mime::multipart::BodyReader reader(
+		std::make_shared<SpooledStringReader>(this->body, 4096, &file),
+		"XYZ", (ssize_t)this->body.size(), 1 << 20, 10, 1024, 10
+	);
+	auto header = get_file(reader.read_form(100));
+
+	ASSERT_EQ(header->tmp_file->read(), this->file_content + "caf\xC3\xA9");
+}
@@ -0,0 +1,130 @@
+/**
+ * http/mime/multipart/tests_boundary_matcher.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <gtest/gtest.h>
+
+#include "../../../../src/http/mime/multipart/boundary_matcher.h"
+#include "../../../../src/http/mime/multipart/body_reader.h"
+#include "../../../../src/http/mime/multipart/part_reader.h"
+#include "./string_reader.h"
+
+using namespace xw;
+
+
+struct FindCase
+{
+	std::string name;
+	std::string boundary;
+	std::string text;
+	size_t from;
+	size_t expected;
+};
+
+TEST(TestCase_BoundaryMatcher, find)
+{
+	auto npos = std::string_view::npos;
+	std::vector<FindCase> cases = {
+		{"AtOffsetZero", "\r\n--XYZ", "\r\n--XYZ\r\n", 0, 0},
+		{"InTheMiddle", "\r\n--XYZ", "value\r\n--XYZ\r\n", 0, 5},
+		{"AtTheEnd", "\r\n--XYZ", "value\r\n--XYZ", 0, 5},
+		{"SecondOccurrenceFromOffset", "\r\n--XYZ", "\r\n--XYZ\r\n--XYZ", 1, 7},
+		{"NearMissPrefixAtTheEnd", "\r\n--XYZ", "value\r\n--XY", 0, npos},
+		{"NearMissInTheMiddle", "\r\n--XYZ", "value\r\n--XYA\r\n--XY", 0, npos},
+		{"RepeatedLastByte", "\r\n--ZZZ", "ZZZ\r\n-ZZZ\r\n--ZZZ", 0, 9},
+		{"TextIsShorter", "\r\n--XYZ", "--XYZ", 0, npos},
+		{"EmptyText", "\r\n--XYZ", "", 0, npos},
+		{"EmptyBoundary", "", "value", 2, 2},
+		{"OffsetBeyondText", "\r\n--XYZ", "\r\n--XYZ", 8, npos}
+	};
+	for (const auto& test_case : cases)
+	{
+		http::mime::multipart::BoundaryMatcher matcher(test_case.boundary);
+		ASSERT_EQ(matcher.find(test_case.text, test_case.from), test_case.expected) << test_case.name;
+	}
+}
+
+struct ScanCase
+{
+	std::string name;
+	std::string buffer;
+	ssize_t total;
+	ssize_t expected_count;
+	bool expected_is_ok;
+};
+
+// Boundary is 'XYZ', the result is the count of bytes of the body before
+// the delimiter and `false` if the delimiter was found.
+TEST(TestCase_ScanUntilBoundary, scan_until_boundary)
+{
+	std::vector<ScanCase> cases = {
+		{"DashBoundaryAtOffsetZero", "--XYZ\r\nContent-Type: text/plain", 0, 0, false},
+		{"PrefixOfDashBoundaryAtOffsetZero", "--XY", 0, 0, true},
+		{"DashBoundaryInsideOfBody", "--XYZ\r\n", 3, 5, true},
+		{"DelimiterAtOffsetZero", "\r\n--XYZ--\r\n", 5, 0, false},
+		{"DelimiterAfterBody", "value\r\n--XYZ\r\n", 0, 5, false},
+		{"DelimiterAtTheEnd", "value\r\n--XYZ", 3, 5, true},
+		{"DelimiterSplitAcrossReads", "value\r\n--X", 3, 5, true},
+		{"BufferIsPrefixOfDelimiter", "\r\n-", 3, 0, true},
+		{"CarriageReturnAtTheEnd", "value\r", 3, 5, true},
+		{"LineFeedWithoutCarriageReturn", "value\n--XYZ\r\nrest", 3, 17, true},
+		{"NearMissPrefixAtTheEnd", "value\r\n--XYA", 3, 12, true},
+		{"LongerBoundaryIsBody", "value\r\n--XYZW\r\n", 3, 12, true},
+		{"NoClosingBoundary", "the last part without delimiter", 3, 31, true}
+	};
+	auto matcher = http::mime::multipart::BoundaryMatcher("\r\n--XYZ");
+	for (const auto& test_case : cases)
+	{
+		auto [count, is_ok] = http::mime::multipart::_scan_until_boundary(
+			test_case.buffer, "--XYZ", matcher, test_case.total
+		);
+		ASSERT_EQ(count, test_case.expected_count) << test_case.name;
+		ASSERT_EQ(is_ok, test_case.expected_is_ok) << test_case.name;
+	}
+}
+
+static std::string read_first_part(const std::string& body, size_t chunk_size)
+{
+	http::mime::multipart::BodyReader reader(
+		std::make_shared<StringBufferedReader>(body, chunk_size), "XYZ", (ssize_t)body.size(), 1024, 10, 1024, 10
+	);
+	auto part = reader.next_part();
+	std::string content;
+	part->read(content, body.size());
+	return content;
+}
+
+TEST(TestCase_ScanUntilBoundary, read_DelimiterSplitAcrossChunks)
+{
+	std::string body = "--XYZ\r\nContent-Disposition: form-data; name=\"a\"\r\n\r\n"
+		"value with -- and \r\n--XY inside\r\n--XYZ--\r\n";
+	for (size_t chunk_size = 1; chunk_size <= body.size(); chunk_size++)
+	{
+		ASSERT_EQ(read_first_part(body, chunk_size), "value with -- and \r\n--XY inside") << chunk_size;
+	}
+}
+
+TEST(TestCase_ScanUntilBoundary, read_NoClosingBoundary)
+{
+	std::string body = "--XYZ\r\nContent-Disposition: form-data; name=\"a\"\r\n\r\nunterminated value";
+	for (size_t chunk_size : {1, 7, 4096})
+	{
+		http::mime::multipart::BodyReader reader(
+			std::make_shared<StringBufferedReader>(body, chunk_size), "XYZ", (ssize_t)body.size(), 1024, 10, 1024, 10
+		);
+		auto part = reader.next_part();
+		std::string content, chunk;
+		auto read_to_end = [&]()
+		{
+			while (part->read_some(chunk, 5) > 0)
+			{
+				content += chunk;
+			}
+		};
+
+		ASSERT_THROW(read_to_end(), ParseError) << chunk_size;
+		ASSERT_EQ(content, "unterminated value") << chunk_size;
+	}
+}
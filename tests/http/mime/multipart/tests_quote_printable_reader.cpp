@@ -0,0 +1,81 @@
+/**
+ * http/mime/multipart/tests_quote_printable_reader.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <gtest/gtest.h>
+
+#include "../../../../src/http/mime/multipart/quote_printable_reader.h"
+#include "./string_reader.h"
+
+using namespace xw;
+
+
+static std::string read_all_qp(const std::string& data, size_t chunk_size=1, size_t block_size=8)
+{
+	http::mime::multipart::QuotePrintableReader reader(
+		std::make_shared<StringReader>(data, chunk_size), block_size
+	);
+	std::string result, buffer;
+	while (reader.read(buffer, 5) > 0)
+	{
+		result += buffer;
+	}
+
+	return result;
+}
+
+TEST(TestCase_QuotePrintableReader, read_Success)
+{
+	std::vector<std::pair<std::string, std::string>> cases = {
+		{"", ""},
+		{"foo bar", "foo bar"},
+		{"foo bar=3D", "foo bar="},
+		{"foo bar=3d", "foo bar="},
+		{"foo bar=\n", "foo bar"},
+		{"foo bar\n", "foo bar\n"},
+		{"foo bar=0", "foo bar=0"},
+		{"foo bar=0D=0A", "foo bar\r\n"},
+		{" A B        \r\n C ", " A B\r\n C"},
+		{" A B =\r\n C ", " A B  C"},
+		{" A B =\n C ", " A B  C"},
+		{"foo=\nbar", "foobar"},
+		{"foo\x80" "bar", "foo\x80" "bar"},
+		{"foo bar=", "foo bar"},
+		{"foo\rbar", "foo\rbar"},
+		{"foo  \n\nfoo =\n\nfoo=20\n\n", "foo\n\nfoo \nfoo \n\n"},
+		{"foo bar=ab", "foo bar\xab"},
+		{"foo bar=Ab", "foo bar\xab"},
+		{"foo = bar", "foo = bar"},
+		{"=FF\r\n=FF", "\xff\r\n\xff"}
+	};
+	for (const auto& [input, expected] : cases)
+	{
+		ASSERT_EQ(read_all_qp(input), expected) << input;
+		ASSERT_EQ(read_all_qp(input, 100, 100), expected) << input;
+	}
+}
+
+TEST(TestCase_QuotePrintableReader, read_InvalidData)
+{
+	ASSERT_THROW(read_all_qp("foo bar=\r"), ParseError);
+	ASSERT_THROW(read_all_qp("foo bar=  "), ParseError);
+	ASSERT_THROW(read_all_qp("foo=\r\r\r \nbar"), ParseError);
+	ASSERT_THROW(read_all_qp("="), ParseError);
+	ASSERT_THROW(read_all_qp("foo bar=\rfoo"), ParseError);
+	ASSERT_THROW(read_all_qp("foo\x01" "bar"), ParseError);
+}
+
+TEST(TestCase_QuotePrintableReader, read_LongLineWithoutLineBreak)
+{
+	std::string input, expected;
+	for (size_t i = 0; i < 1000; i++)
+	{
+		input += "abc=3D  =\tx";
+		expected += "abc=  =\tx";
+	}
+
+	input += "  \t";
+	ASSERT_EQ(read_all_qp(input, 7, 16), expected);
+}
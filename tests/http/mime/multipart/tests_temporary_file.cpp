@@ -0,0 +1,139 @@
+/**
+ * http/mime/multipart/tests_temporary_file.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include <xalwart.base/exceptions.h>
+
+#include "../../../../src/http/mime/multipart/temporary_file.h"
+
+using namespace xw;
+
+
+class TemporaryFileTestCase : public ::testing::Test
+{
+protected:
+	std::filesystem::path directory;
+
+	void SetUp() override
+	{
+		this->directory = std::filesystem::temp_directory_path() / "xw_temporary_file_tests";
+		std::filesystem::create_directories(this->directory);
+	}
+
+	void TearDown() override
+	{
+		std::filesystem::remove_all(this->directory);
+	}
+
+	[[nodiscard]]
+	static std::string read_file(const std::filesystem::path& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+	}
+};
+
+TEST_F(TemporaryFileTestCase, write_AppendsData)
+{
+	http::mime::multipart::TemporaryFile file(this->directory.string());
+	file.write("hello, ");
+	file.write(std::string(100000, 'x'));
+
+	ASSERT_EQ(file.size(), 100007);
+	ASSERT_EQ(file.read(), "hello, " + std::string(100000, 'x'));
+}
+
+TEST_F(TemporaryFileTestCase, read_FromOffset)
+{
+	http::mime::multipart::TemporaryFile file(this->directory.string());
+	file.write("0123456789");
+
+	std::string buffer(4, '\0');
+	ASSERT_EQ(file.read(3, buffer.data(), buffer.size()), 4);
+	ASSERT_EQ(buffer, "3456");
+	ASSERT_EQ(file.read(8, buffer.data(), buffer.size()), 2);
+	ASSERT_EQ(buffer.substr(0, 2), "89");
+	ASSERT_EQ(file.read(10, buffer.data(), buffer.size()), 0);
+}
+
+TEST_F(TemporaryFileTestCase, append_CopiesRangeOfFile)
+{
+	http::mime::multipart::TemporaryFile source(this->directory.string());
+	source.write("0123456789" + std::string(200000, 'x') + "abc");
+	http::mime::multipart::TemporaryFile file(this->directory.string());
+	file.write("head:");
+
+	file.append(source, 5, 200008);
+	file.write(":tail");
+
+	ASSERT_EQ(file.size(), 200018);
+	ASSERT_EQ(file.read(), "head:56789" + std::string(200000, 'x') + "abc:tail");
+}
+
+TEST_F(TemporaryFileTestCase, append_RangeOutOfFile)
+{
+	http::mime::multipart::TemporaryFile source(this->directory.string());
+	source.write("0123456789");
+	http::mime::multipart::TemporaryFile file(this->directory.string());
+
+	ASSERT_THROW(file.append(source, 5, 6), FileError);
+	ASSERT_EQ(file.size(), 0);
+}
+
+TEST_F(TemporaryFileTestCase, save_MovesFileThenCopiesIt)
+{
+	auto first = this->directory / "first.txt";
+	auto second = this->directory / "second.txt";
+	{
+		std::ofstream existing(first);
+		existing << "existing content which is longer";
+	}
+
+	{
+		http::mime::multipart::TemporaryFile file(this->directory.string());
+		file.write("uploaded");
+		file.save(first.string());
+		file.save(second.string());
+	}
+
+	ASSERT_EQ(read_file(first), "uploaded");
+	ASSERT_EQ(read_file(second), "uploaded");
+	ASSERT_FALSE(std::filesystem::equivalent(first, second));
+}
+
+TEST_F(TemporaryFileTestCase, save_SamePathTwiceKeepsContent)
+{
+	auto path = this->directory / "uploaded.txt";
+	{
+		http::mime::multipart::TemporaryFile file(this->directory.string());
+		file.write("uploaded");
+		file.save(path.string());
+		file.save(path.string());
+
+		ASSERT_EQ(file.read(), "uploaded");
+	}
+
+	ASSERT_EQ(read_file(path), "uploaded");
+}
+
+TEST_F(TemporaryFileTestCase, Destructor_RemovesFile)
+{
+	{
+		http::mime::multipart::TemporaryFile file(this->directory.string());
+		file.write("data");
+	}
+
+	ASSERT_TRUE(std::filesystem::is_empty(this->directory));
+}
+
+TEST_F(TemporaryFileTestCase, Constructor_MissingDirectory)
+{
+	ASSERT_THROW(http::mime::multipart::TemporaryFile((this->directory / "missing").string()), FileError);
+}
@@ -0,0 +1,75 @@
+/**
+ * http/mime/tests_media_type.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <gtest/gtest.h>
+
+#include <xalwart.base/exceptions.h>
+
+#include "../../../src/http/mime/media_type.h"
+
+using namespace xw;
+
+
+TEST(TestCase_parse_media_type, TypeIsLowercaseAndTrimmed)
+{
+	auto media_type = http::mime::parse_media_type(" Text/HTML ");
+
+	ASSERT_EQ(media_type.type, "text/html");
+	ASSERT_TRUE(media_type.parameters.empty());
+	ASSERT_TRUE(media_type.ok);
+}
+
+TEST(TestCase_parse_media_type, Parameters)
+{
+	auto media_type = http::mime::parse_media_type(
+		R"(multipart/form-data; Boundary="----abc\"def"; charset=UTF-8;)"
+	);
+
+	ASSERT_EQ(media_type.type, "multipart/form-data");
+	ASSERT_TRUE(media_type.ok);
+	ASSERT_EQ(media_type.parameters.size(), 2);
+	ASSERT_EQ(*media_type.get("boundary"), "----abc\"def");
+	ASSERT_EQ(*media_type.get("charset"), "UTF-8");
+	ASSERT_EQ(media_type.get("Boundary"), nullptr);
+}
+
+TEST(TestCase_parse_media_type, ContentDisposition)
+{
+	auto media_type = http::mime::parse_media_type(R"(form-data; name="file"; filename="C:\dev\report.pdf")");
+
+	ASSERT_EQ(media_type.type, "form-data");
+	ASSERT_EQ(*media_type.get("name"), "file");
+	ASSERT_EQ(*media_type.get("filename"), R"(C:\dev\report.pdf)");
+}
+
+TEST(TestCase_parse_media_type, Rfc2231Parameters)
+{
+	auto media_type = http::mime::parse_media_type(
+		"attachment; filename=\"fallback.txt\"; filename*=UTF-8''%D0%B7%D0%B2%D1%96%D1%82.txt; "
+		"title*0=\"part one \"; title*1*=%E2%9C%93"
+	);
+
+	ASSERT_TRUE(media_type.ok);
+	ASSERT_EQ(*media_type.get("filename"), "звіт.txt");
+	ASSERT_EQ(*media_type.get("title"), "part one ✓");
+	ASSERT_EQ(media_type.get("filename*"), nullptr);
+}
+
+TEST(TestCase_parse_media_type, MalformedParameters)
+{
+	auto media_type = http::mime::parse_media_type("text/plain; charset");
+
+	ASSERT_EQ(media_type.type, "text/plain");
+	ASSERT_FALSE(media_type.ok);
+	ASSERT_TRUE(media_type.parameters.empty());
+}
+
+TEST(TestCase_parse_media_type, Errors)
+{
+	ASSERT_THROW(http::mime::parse_media_type(""), ValueError);
+	ASSERT_THROW(http::mime::parse_media_type("text/"), ValueError);
+	ASSERT_THROW(http::mime::parse_media_type("text/plain; a=1; a=2"), ParseError);
+}
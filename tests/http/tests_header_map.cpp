@@ -0,0 +1,78 @@
+/**
+ * http/tests_header_map.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <gtest/gtest.h>
+
+#include "../../src/http/header_map.h"
+#include "../../src/http/headers.h"
+
+using namespace xw;
+
+
+TEST(TestCase_HeaderMap, get_header_id_IgnoresCase)
+{
+	ASSERT_EQ(http::get_header_id("content-type"), http::HeaderId::ContentType);
+	ASSERT_EQ(http::get_header_id("X-XSS-PROTECTION"), http::HeaderId::XXSSProtection);
+	ASSERT_EQ(http::get_header_id("X-Custom"), std::nullopt);
+}
+
+TEST(TestCase_HeaderMap, get_header_name_AllIdentifiers)
+{
+	for (size_t i = 0; i < http::HEADER_IDS_COUNT; i++)
+	{
+		auto id = (http::HeaderId)i;
+		ASSERT_EQ(http::get_header_id(http::get_header_name(id)), id);
+	}
+
+	ASSERT_EQ(http::get_header_name(http::HeaderId::ETag), http::E_TAG);
+}
+
+TEST(TestCase_HeaderMap, set_KnownHeaderIsStoredByCanonicalName)
+{
+	http::HeaderMap headers;
+	headers.set("content-type", "text/html");
+	headers.set(http::CONTENT_TYPE, "application/json");
+
+	ASSERT_EQ(headers.size(), 1);
+	ASSERT_EQ(headers.begin()->first, "Content-Type");
+	ASSERT_EQ(*headers.find(http::HeaderId::ContentType), "application/json");
+}
+
+TEST(TestCase_HeaderMap, set_CustomHeaderIgnoresCase)
+{
+	http::HeaderMap headers;
+	headers.set("X-Request-Id", "1");
+	headers.set("x-request-id", "2");
+
+	ASSERT_EQ(headers.size(), 1);
+	ASSERT_EQ(headers.begin()->first, "X-Request-Id");
+	ASSERT_EQ(*headers.find("X-REQUEST-ID"), "2");
+	ASSERT_EQ(headers.find("X-Request"), nullptr);
+}
+
+TEST(TestCase_HeaderMap, erase_KeepsPositionsOfOtherHeaders)
+{
+	http::HeaderMap headers = {{"Date", "now"}, {"X-Custom", "value"}, {"Vary", "Cookie"}, {"ETag", "\"1\""}};
+
+	ASSERT_TRUE(headers.erase("date"));
+	ASSERT_FALSE(headers.erase(http::HeaderId::Date));
+	ASSERT_TRUE(headers.erase("x-custom"));
+
+	ASSERT_EQ(headers.size(), 2);
+	ASSERT_FALSE(headers.contains(http::DATE));
+	ASSERT_EQ(*headers.find(http::HeaderId::Vary), "Cookie");
+	ASSERT_EQ(*headers.find(http::E_TAG), "\"1\"");
+}
+
+TEST(TestCase_HeaderMap, serialize_KeepsOrderOfInsertion)
+{
+	http::HeaderMap headers = {{"Vary", "Cookie"}, {"X-Custom", "value"}, {"age", "5"}};
+	std::string result = "HTTP/1.1 200 OK\r\n";
+	headers.serialize(result);
+
+	ASSERT_EQ(result, "HTTP/1.1 200 OK\r\nVary: Cookie\r\nX-Custom: value\r\nAge: 5");
+	ASSERT_EQ(headers.serialized_size(), result.size() - 17 + 2);
+}
@@ -0,0 +1,135 @@
+/**
+ * http/tests_request.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <map>
+
+#include <gtest/gtest.h>
+
+#include "../../src/http/request.h"
+#include "./mime/multipart/string_reader.h"
+
+using namespace xw;
+
+
+class TestCase_RequestView : public ::testing::Test
+{
+protected:
+	net::RequestContext context;
+	std::map<std::string, std::string> environment = {{"SERVER_NAME", "localhost"}};
+
+	void SetUp() override
+	{
+		this->context.method = "GET";
+		this->context.path = "/products/";
+		this->context.query = "page=2&sort=price";
+		this->context.headers = {{"Host", "127.0.0.1"}, {"Accept-Encoding", "gzip"}};
+	}
+};
+
+TEST_F(TestCase_RequestView, RefersToHeadersOfContext)
+{
+	http::RequestView request(this->context, 99999, 99, 9999, 99, 9999, this->environment);
+
+	ASSERT_EQ(&request.headers(), &this->context.headers);
+	ASSERT_EQ(&request.environment(), &this->environment);
+	ASSERT_EQ(request.get_header_view("Accept-Encoding").data(), this->context.headers["Accept-Encoding"].data());
+	ASSERT_EQ(request.get_header_view("Cookie"), "");
+}
+
+TEST_F(TestCase_RequestView, SetHeaderCopiesHeaders)
+{
+	http::RequestView request(this->context, 99999, 99, 9999, 99, 9999, this->environment);
+	request.set_header("Accept-Encoding", "br");
+
+	ASSERT_NE(&request.headers(), &this->context.headers);
+	ASSERT_EQ(request.get_header("Accept-Encoding", ""), "br");
+	ASSERT_EQ(request.get_header("Host", ""), "127.0.0.1");
+	ASSERT_EQ(this->context.headers["Accept-Encoding"], "gzip");
+}
+
+TEST_F(TestCase_RequestView, ParsesPathAndQuery)
+{
+	http::RequestView request(this->context, 99999, 99, 9999, 99, 9999, this->environment);
+
+	ASSERT_EQ(request.url().path, "/products/");
+	ASSERT_EQ(request.url().raw_query, "page=2&sort=price");
+	ASSERT_EQ(request.url().full_path(), "/products/?page=2&sort=price");
+}
+
+TEST_F(TestCase_RequestView, GetHeaderIgnoresCaseOfKnownHeaders)
+{
+	http::RequestView request(this->context, 99999, 99, 9999, 99, 9999, this->environment);
+
+	ASSERT_TRUE(request.has_header("accept-encoding"));
+	ASSERT_EQ(request.get_header("HOST", ""), "127.0.0.1");
+	ASSERT_EQ(request.get_header_view("accept-encoding"), "gzip");
+}
+
+class TestCase_RequestMultipart : public ::testing::Test
+{
+protected:
+	net::RequestContext context;
+
+	void SetUp() override
+	{
+		std::string body = "--XYZ\r\nContent-Disposition: form-data; name=\"title\"\r\n\r\nreport\r\n"
+			"--XYZ\r\nContent-Disposition: form-data; name=\"file\"; filename=\"report.txt\"\r\n\r\n"
+			+ std::string(10000, 'x') + "\r\n--XYZ--\r\n";
+		this->context.method = "POST";
+		this->context.path = "/upload/";
+		this->context.headers = {
+			{"Host", "127.0.0.1"},
+			{"Content-Type", "multipart/form-data; boundary=XYZ"},
+			{"Content-Length", std::to_string(body.size())}
+		};
+		this->context.content_size = body.size();
+		this->context.body = std::make_shared<StringBufferedReader>(body, 1000);
+	}
+};
+
+TEST_F(TestCase_RequestMultipart, read_multipart_StreamsParts)
+{
+	http::Request request(this->context, 99999, 99, 9999, 99, 9999, {});
+	std::string title;
+	size_t file_size = 0;
+	request.read_multipart([&](http::mime::multipart::Part& part) -> bool
+	{
+		std::string chunk;
+		while (part.read_some(chunk, 512) > 0)
+		{
+			if (part.form_name() == "title")
+			{
+				title += chunk;
+			}
+			else
+			{
+				file_size += chunk.size();
+			}
+		}
+
+		return true;
+	});
+
+	ASSERT_EQ(title, "report");
+	ASSERT_EQ(file_size, 10000);
+}
+
+TEST_F(TestCase_RequestMultipart, multipart_form_AfterReadMultipartThrows)
+{
+	http::Request request(this->context, 99999, 99, 9999, 99, 9999, {});
+	request.read_multipart([](http::mime::multipart::Part&) -> bool { return false; });
+
+	ASSERT_THROW(request.multipart_form(), RuntimeError);
+	ASSERT_THROW(request.read_multipart([](http::mime::multipart::Part&) -> bool { return true; }), RuntimeError);
+}
+
+TEST_F(TestCase_RequestMultipart, read_multipart_AfterMultipartFormThrows)
+{
+	http::Request request(this->context, 99999, 99, 9999, 99, 9999, {});
+	ASSERT_NO_THROW(request.multipart_form());
+
+	ASSERT_THROW(request.read_multipart([](http::mime::multipart::Part&) -> bool { return true; }), RuntimeError);
+}
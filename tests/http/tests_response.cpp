@@ -0,0 +1,201 @@
+/**
+ * http/tests_response.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include "../../src/http/response.h"
+
+using namespace xw;
+
+
+// Removes 'Date' header which is set to the current time by each serialization.
+static std::string strip_date(std::string response)
+{
+	auto start = response.find("\r\nDate: ");
+	if (start != std::string::npos)
+	{
+		response.erase(start, response.find("\r\n", start + 2) - start);
+	}
+
+	return response;
+}
+
+TEST(TestCase_Response, SerializeSlicesReferencesContent)
+{
+	http::Response response(200, "<p>Hello, World</p>");
+	auto slices = response.serialize_slices();
+	ASSERT_EQ(slices.body, "<p>Hello, World</p>");
+	ASSERT_TRUE(slices.head.starts_with("HTTP/1.1 200 OK\r\n"));
+	ASSERT_TRUE(slices.head.ends_with("\r\n\r\n"));
+	ASSERT_EQ(response.get_header(http::CONTENT_LENGTH, ""), "19");
+
+	auto second_slices = response.serialize_slices();
+	ASSERT_EQ(slices.body.data(), second_slices.body.data());
+}
+
+TEST(TestCase_Response, SerializeJoinsSlices)
+{
+	http::Response response(404, "not found");
+	auto slices = response.serialize_slices();
+	ASSERT_EQ(strip_date(response.serialize()), strip_date(slices.head + std::string(slices.body)));
+}
+
+TEST(TestCase_Response, SerializeSlicesSendsEncodedContent)
+{
+	http::Response response(200, "<p>Hello, World</p>");
+	response.set_encoded_content("encoded", "gzip");
+	auto slices = response.serialize_slices();
+	ASSERT_EQ(slices.body, "encoded");
+	ASSERT_EQ(response.get_header(http::CONTENT_ENCODING, ""), "gzip");
+	ASSERT_EQ(response.get_header(http::CONTENT_LENGTH, ""), "7");
+	ASSERT_EQ(response.get_content(), "<p>Hello, World</p>");
+}
+
+TEST(TestCase_JsonResponse, SerializeSlicesKeepsDumpedContent)
+{
+	http::JsonResponse response(nlohmann::json{{"key", "value"}});
+	auto slices = response.serialize_slices();
+	ASSERT_EQ(slices.body, R"({"key":"value"})");
+}
+
+class FileResponseTestCase : public ::testing::Test
+{
+protected:
+	std::string file_path;
+
+	void SetUp() override
+	{
+		this->file_path = std::filesystem::temp_directory_path() / "xw_tests_file_response.txt";
+		std::ofstream file(this->file_path, std::ios::binary);
+		file << "0123456789abcdefghij";
+	}
+
+	void TearDown() override
+	{
+		std::filesystem::remove(this->file_path);
+	}
+
+	static std::string read_body(http::FileResponse& response)
+	{
+		response.get_chunk_view();
+		std::string body;
+		std::string_view chunk;
+		while (!(chunk = response.get_chunk_view()).empty())
+		{
+			body += chunk;
+		}
+
+		return body;
+	}
+};
+
+TEST_F(FileResponseTestCase, SendsWholeFile)
+{
+	http::FileResponse response(this->file_path);
+	ASSERT_EQ(read_body(response), "0123456789abcdefghij");
+	ASSERT_EQ(response.get_status(), 200);
+	ASSERT_EQ(response.get_header(http::CONTENT_LENGTH, ""), "20");
+}
+
+TEST_F(FileResponseTestCase, SendsSingleRange)
+{
+	http::FileResponse response(this->file_path);
+	response.set_ranges({{.first = 5, .last = 9}});
+	ASSERT_EQ(read_body(response), "56789");
+	ASSERT_EQ(response.get_status(), 206);
+	ASSERT_EQ(response.get_header(http::CONTENT_RANGE, ""), "bytes 5-9/20");
+	ASSERT_EQ(response.get_header(http::CONTENT_LENGTH, ""), "5");
+}
+
+TEST_F(FileResponseTestCase, SendsMultipleRanges)
+{
+	http::FileResponse response(this->file_path, false, 0, "text/plain");
+	response.set_ranges({{.first = 0, .last = 1}, {.first = 18, .last = 19}});
+	auto body = read_body(response);
+	auto content_type = response.get_header(http::CONTENT_TYPE, "");
+	ASSERT_TRUE(content_type.starts_with("multipart/byteranges; boundary="));
+
+	auto boundary = content_type.substr(content_type.find('=') + 1);
+	auto expected = "--" + boundary + "\r\n"
+		"Content-Type: text/plain\r\n"
+		"Content-Range: bytes 0-1/20\r\n\r\n"
+		"01\r\n"
+		"--" + boundary + "\r\n"
+		"Content-Type: text/plain\r\n"
+		"Content-Range: bytes 18-19/20\r\n\r\n"
+		"ij\r\n"
+		"--" + boundary + "--\r\n";
+	ASSERT_EQ(body, expected);
+	ASSERT_EQ(response.get_header(http::CONTENT_LENGTH, ""), std::to_string(expected.size()));
+}
+
+TEST_F(FileResponseTestCase, TruncatedFileEndsBodyEarly)
+{
+	http::FileResponse response(this->file_path);
+	response.get_chunk_view();
+	std::filesystem::resize_file(this->file_path, 5);
+
+	ASSERT_EQ(response.get_chunk_view(), "01234");
+	ASSERT_TRUE(response.get_chunk_view().empty());
+}
+
+TEST_F(FileResponseTestCase, ReturnsHeadAndRangesAsParts)
+{
+	http::FileResponse response(this->file_path, false, 0, "text/plain");
+	response.set_ranges({{.first = 0, .last = 1}, {.first = 18, .last = 19}});
+	auto head = response.get_next_part();
+	ASSERT_TRUE(head.has_value());
+	ASSERT_TRUE(head->prefix.starts_with("HTTP/1.1 206 "));
+	ASSERT_EQ(head->length, 0);
+
+	auto content_type = response.get_header(http::CONTENT_TYPE, "");
+	auto boundary = content_type.substr(content_type.find('=') + 1);
+	auto first = response.get_next_part();
+	ASSERT_TRUE(first.has_value());
+	ASSERT_EQ(first->prefix, "--" + boundary + "\r\nContent-Type: text/plain\r\nContent-Range: bytes 0-1/20\r\n\r\n");
+	ASSERT_EQ(first->offset, 0);
+	ASSERT_EQ(first->length, 2);
+
+	auto second = response.get_next_part();
+	ASSERT_TRUE(second.has_value());
+	ASSERT_EQ(second->prefix, "\r\n--" + boundary + "\r\nContent-Type: text/plain\r\nContent-Range: bytes 18-19/20\r\n\r\n");
+	ASSERT_EQ(second->offset, 18);
+	ASSERT_EQ(second->length, 2);
+
+	auto last = response.get_next_part();
+	ASSERT_TRUE(last.has_value());
+	ASSERT_EQ(last->prefix, "\r\n--" + boundary + "--\r\n");
+	ASSERT_EQ(last->length, 0);
+	ASSERT_FALSE(response.get_next_part().has_value());
+}
+
+TEST_F(FileResponseTestCase, ReturnsWholeFileAsPart)
+{
+	http::FileResponse response(this->file_path);
+	response.get_next_part();
+	auto part = response.get_next_part();
+	ASSERT_TRUE(part.has_value());
+	ASSERT_TRUE(part->prefix.empty());
+	ASSERT_EQ(part->offset, 0);
+	ASSERT_EQ(part->length, 20);
+	ASSERT_GE(response.file_descriptor(), 0);
+	ASSERT_FALSE(response.get_next_part().has_value());
+}
+
+TEST_F(FileResponseTestCase, DirectoryThrows)
+{
+	auto directory = std::filesystem::temp_directory_path().string();
+	ASSERT_THROW(http::FileResponse response(directory), http::exc::FileDoesNotExist);
+}
+
+TEST_F(FileResponseTestCase, UnsatisfiableRangeThrows)
+{
+	http::FileResponse response(this->file_path);
+	ASSERT_THROW(response.set_ranges({{.first = 5, .last = 20}}), ArgumentError);
+}
@@ -0,0 +1,62 @@
+/**
+ * http/tests_signer.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <gtest/gtest.h>
+
+#include <xalwart.base/exceptions.h>
+
+#include "../../src/http/signer.h"
+
+using namespace xw;
+
+
+TEST(TestCase_Signer, constant_time_equals)
+{
+	ASSERT_TRUE(http::constant_time_equals("signature", "signature"));
+	ASSERT_FALSE(http::constant_time_equals("signature", "signaturE"));
+	ASSERT_FALSE(http::constant_time_equals("signature", "sign"));
+	ASSERT_TRUE(http::constant_time_equals("", ""));
+}
+
+TEST(TestCase_Signer, unsign_SignedValue)
+{
+	http::Signer signer("secret", ':', "salt");
+	auto signed_value = signer.sign("user:1");
+
+	ASSERT_TRUE(signed_value.starts_with("user:1:"));
+	ASSERT_EQ(signer.unsign(signed_value), "user:1");
+	ASSERT_EQ(http::Signer("secret", ':', "salt").sign("user:1"), signed_value);
+}
+
+TEST(TestCase_Signer, unsign_ThrowsBadSignature)
+{
+	http::Signer signer("secret", ':', "salt");
+	auto signed_value = signer.sign("value");
+
+	ASSERT_THROW(auto _ = signer.unsign("value"), BadSignature);
+	ASSERT_THROW(auto _ = http::Signer("secret", ':', "other").unsign(signed_value), BadSignature);
+	ASSERT_THROW(auto _ = http::Signer("other", ':', "salt").unsign(signed_value), BadSignature);
+}
+
+TEST(TestCase_Signer, unsign_all)
+{
+	http::Signer signer("secret", ':', "salt");
+	auto result = signer.unsign_all({signer.sign("first"), "second:bad", "third", signer.sign("")});
+
+	ASSERT_EQ(result.size(), 4);
+	ASSERT_EQ(result[0], "first");
+	ASSERT_EQ(result[1], std::nullopt);
+	ASSERT_EQ(result[2], std::nullopt);
+	ASSERT_EQ(result[3], "");
+}
+
+TEST(TestCase_Signer, Constructor_ThrowsOnUnsafeSeparator)
+{
+	ASSERT_THROW(http::Signer("secret", 'a'), ValueError);
+	ASSERT_THROW(http::Signer("secret", '='), ValueError);
+	ASSERT_THROW(http::Signer(""), ValueError);
+	ASSERT_NO_THROW(http::Signer("secret", '.'));
+}
@@ -124,6 +124,26 @@ TEST(TestCase_url, split_NotExistingSep)
 	ASSERT_EQ(actual.second, "");
 }
 
+TEST(TestCase_url, unescape_ConsecutiveEscapes)
+{
+	ASSERT_EQ(http::query_unescape("%E4%BD%A0+x%2By"), "\xE4\xBD\xA0 x+y");
+	ASSERT_EQ(http::internal::unescape("/a+b%20c", http::internal::EscapeMode::EncodePath), "/a+b c");
+}
+
+TEST(TestCase_url, unescape_InvalidEscapeThrows)
+{
+	ASSERT_THROW(http::query_unescape("100%"), EscapeError);
+	ASSERT_THROW(http::query_unescape("x%2"), EscapeError);
+	ASSERT_THROW(http::query_unescape("%41%zz"), EscapeError);
+}
+
+TEST(TestCase_url, escape_LongString)
+{
+	auto value = std::string(40, 'a') + " /?" + std::string(40, 'b');
+	ASSERT_EQ(http::query_escape(value), std::string(40, 'a') + "+%2F%3F" + std::string(40, 'b'));
+	ASSERT_EQ(http::query_unescape(http::query_escape(value)), value);
+}
+
 class TestCase_url_UrlParserIPv4 : public ::testing::Test
 {
 protected:
@@ -82,6 +82,19 @@ bool assert_vector(const std::vector<T>& actual, const std::vector<T>& expected)
 	return true;
 }
 
+TEST(GetCookieSignerTestCase, SignerOutlivesEvictionOfCachedSigners)
+{
+	auto signer = http::get_cookie_signer("secret", "session");
+	auto expected = signer->sign("user:1");
+	for (int i = 0; i < 300; i++)
+	{
+		(void)http::get_cookie_signer("secret", "cookie-" + std::to_string(i));
+	}
+
+	ASSERT_EQ(signer->sign("user:1"), expected);
+	ASSERT_EQ(http::get_cookie_signer("secret", "session")->unsign(expected), "user:1");
+}
+
 TEST(ParseHttpDateTestCase, ParseGMTDate)
 {
 	auto actual = http::parse_http_date("Fri, 15 Nov 2019 12:45:26 GMT");
@@ -131,3 +144,92 @@ TEST(ParseETagsTestCase, MultipleETagsTest)
 	auto actual = http::parse_etags(e_tags);
 	ASSERT_TRUE(assert_vector(actual, expected));
 }
+
+TEST(ParseRangeTestCase, SingleRange)
+{
+	auto ranges = http::parse_range("bytes=0-99", 1000);
+	ASSERT_TRUE(ranges.has_value());
+	ASSERT_EQ(*ranges, std::vector<http::ByteRange>({{.first = 0, .last = 99}}));
+}
+
+TEST(ParseRangeTestCase, OpenAndSuffixRanges)
+{
+	auto ranges = http::parse_range("bytes=900-, -50", 1000);
+	ASSERT_TRUE(ranges.has_value());
+	ASSERT_EQ(*ranges, std::vector<http::ByteRange>({
+		{.first = 900, .last = 999}, {.first = 950, .last = 999}
+	}));
+}
+
+TEST(ParseRangeTestCase, LastPositionIsClipped)
+{
+	auto ranges = http::parse_range("bytes=10-5000", 100);
+	ASSERT_TRUE(ranges.has_value());
+	ASSERT_EQ(*ranges, std::vector<http::ByteRange>({{.first = 10, .last = 99}}));
+}
+
+TEST(ParseRangeTestCase, NotSatisfiable)
+{
+	auto ranges = http::parse_range("bytes=1000-1100", 1000);
+	ASSERT_TRUE(ranges.has_value());
+	ASSERT_TRUE(ranges->empty());
+}
+
+TEST(ParseRangeTestCase, InvalidHeaderIsIgnored)
+{
+	ASSERT_FALSE(http::parse_range("", 1000).has_value());
+	ASSERT_FALSE(http::parse_range("items=0-10", 1000).has_value());
+	ASSERT_FALSE(http::parse_range("bytes=10-5", 1000).has_value());
+	ASSERT_FALSE(http::parse_range("bytes=a-b", 1000).has_value());
+}
+
+TEST(ParseRangeTestCase, TooManyRangesAreIgnored)
+{
+	std::string header = "bytes=0-0";
+	for (size_t i = 1; i <= http::MAX_BYTE_RANGES; i++)
+	{
+		header += "," + std::to_string(i) + "-" + std::to_string(i);
+	}
+
+	ASSERT_FALSE(http::parse_range(header, 1000).has_value());
+}
+
+TEST(GetEncodingQualityTestCase, ListedCoding)
+{
+	ASSERT_EQ(http::get_encoding_quality("gzip, br;q=0.8", "gzip"), 1.0);
+	ASSERT_EQ(http::get_encoding_quality("gzip, br;q=0.8", "br"), 0.8);
+	ASSERT_EQ(http::get_encoding_quality("gzip, br;q=0.8", "zstd"), 0.0);
+}
+
+TEST(GetEncodingQualityTestCase, AnyCoding)
+{
+	ASSERT_EQ(http::get_encoding_quality("br;q=0, *;q=0.5", "gzip"), 0.5);
+	ASSERT_EQ(http::get_encoding_quality("br;q=0, *;q=0.5", "br"), 0.0);
+}
+
+TEST(GetEncodingQualityTestCase, Identity)
+{
+	ASSERT_EQ(http::get_encoding_quality("", "identity"), 1.0);
+	ASSERT_EQ(http::get_encoding_quality("gzip", "identity"), 1.0);
+	ASSERT_EQ(http::get_encoding_quality("gzip, identity;q=0", "identity"), 0.0);
+}
+
+TEST(GetEncodingQualityTestCase, XGzipIsGzip)
+{
+	ASSERT_EQ(http::get_encoding_quality("x-gzip", "gzip"), 1.0);
+}
+
+TEST(SelectEncodingTestCase, HighestQualityWins)
+{
+	ASSERT_EQ(http::select_encoding("gzip;q=1.0, br;q=0.5", {"br", "gzip"}), "gzip");
+}
+
+TEST(SelectEncodingTestCase, OrderOfAvailableBreaksTies)
+{
+	ASSERT_EQ(http::select_encoding("gzip, deflate, br", {"br", "zstd", "gzip"}), "br");
+}
+
+TEST(SelectEncodingTestCase, NothingIsAcceptable)
+{
+	ASSERT_EQ(http::select_encoding("deflate", {"br", "gzip"}), "");
+}
@@ -0,0 +1,343 @@
+/**
+ * middleware/tests_compression.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <random>
+
+#include <zlib.h>
+
+#include <gtest/gtest.h>
+
+#include "../../src/middleware/compression.h"
+
+using namespace xw;
+
+
+// Returns chunks which are given to it, the first one is the head.
+class ChunksResponse : public http::StreamingResponse
+{
+public:
+	explicit ChunksResponse(std::vector<std::string> chunks) :
+		StreamingResponse(200, "text/plain"), _chunks(std::move(chunks))
+	{
+	}
+
+	std::string get_chunk() override
+	{
+		return this->_index < this->_chunks.size() ? this->_chunks[this->_index++] : "";
+	}
+
+	[[nodiscard]]
+	unsigned long int tell() const override
+	{
+		return 0;
+	}
+
+	void flush() override
+	{
+	}
+
+	[[nodiscard]]
+	bool readable() const override
+	{
+		return true;
+	}
+
+	[[nodiscard]]
+	bool seekable() const override
+	{
+		return false;
+	}
+
+private:
+	std::vector<std::string> _chunks;
+	size_t _index = 0;
+};
+
+class CompressionMiddlewareTestCase : public ::testing::Test
+{
+protected:
+	std::string content;
+	std::function<std::unique_ptr<http::IResponse>()> make_response;
+
+	void SetUp() override
+	{
+		for (int i = 0; i < 100; i++)
+		{
+			this->content += "Hello, World! ";
+		}
+
+		this->make_response = [this]() -> std::unique_ptr<http::IResponse>
+		{
+			return std::make_unique<http::Response>(200, this->content, "text/plain");
+		};
+	}
+
+	std::unique_ptr<http::IResponse> get(const std::string& accept_encoding, unsigned short int minor_version=1)
+	{
+		net::RequestContext context;
+		context.method = "GET";
+		context.path = "/hello";
+		context.protocol_version.major = 1;
+		context.protocol_version.minor = minor_version;
+		context.headers = {{http::ACCEPT_ENCODING, accept_encoding}};
+		http::Request request(context, 99999, 99, 9999, 99, 9999, {});
+		auto function = middleware::Compression()([this](http::IRequest*) -> std::unique_ptr<http::IResponse>
+		{
+			return this->make_response();
+		});
+		return function(&request);
+	}
+
+	static std::string get_body(const std::unique_ptr<http::IResponse>& response)
+	{
+		return std::string(dynamic_cast<http::BaseResponse*>(response.get())->get_body_view());
+	}
+
+	static std::string decompress_gzip(const std::string& data)
+	{
+		z_stream stream{};
+		inflateInit2(&stream, 15 + 16);
+		std::string result;
+		char buffer[1024];
+		stream.next_in = (Bytef*)data.data();
+		stream.avail_in = (uInt)data.size();
+		int status;
+		do
+		{
+			stream.next_out = (Bytef*)buffer;
+			stream.avail_out = sizeof(buffer);
+			status = inflate(&stream, Z_SYNC_FLUSH);
+			result.append(buffer, sizeof(buffer) - stream.avail_out);
+		}
+		while (status == Z_OK && (stream.avail_in > 0 || stream.avail_out == 0));
+		inflateEnd(&stream);
+		return result;
+	}
+
+	// Returns data of the body in chunked transfer coding,
+	// `is_complete` is set if the last chunk is received.
+	static std::string decode_chunked(std::string_view body, bool& is_complete)
+	{
+		std::string result;
+		is_complete = false;
+		while (!body.empty())
+		{
+			auto size_end = body.find("\r\n");
+			auto size = std::stoul(std::string(body.substr(0, size_end)), nullptr, 16);
+			body.remove_prefix(size_end + 2);
+			if (size == 0)
+			{
+				is_complete = body == "\r\n";
+				break;
+			}
+
+			result.append(body.substr(0, size));
+			if (body.substr(size, 2) != "\r\n")
+			{
+				break;
+			}
+
+			body.remove_prefix(size + 2);
+		}
+
+		return result;
+	}
+};
+
+TEST_F(CompressionMiddlewareTestCase, CompressesResponse)
+{
+	auto response = this->get("deflate;q=0.5, gzip");
+
+	ASSERT_EQ(response->get_header(http::CONTENT_ENCODING, ""), "gzip");
+	ASSERT_EQ(response->get_header(http::VARY, ""), "Accept-Encoding");
+	ASSERT_EQ(decompress_gzip(get_body(response)), this->content);
+	ASSERT_EQ(response->get_content(), this->content);
+}
+
+TEST_F(CompressionMiddlewareTestCase, AddsAcceptEncodingToVary)
+{
+	this->make_response = [this]() -> std::unique_ptr<http::IResponse>
+	{
+		auto response = std::make_unique<http::Response>(200, this->content, "text/plain");
+		response->set_header(http::VARY, "Cookie");
+		return response;
+	};
+
+	ASSERT_EQ(this->get("gzip")->get_header(http::VARY, ""), "Cookie, Accept-Encoding");
+}
+
+TEST_F(CompressionMiddlewareTestCase, SkipsResponseWithContentEncoding)
+{
+	this->make_response = [this]() -> std::unique_ptr<http::IResponse>
+	{
+		auto response = std::make_unique<http::Response>(200, this->content, "text/plain");
+		response->set_header(http::CONTENT_ENCODING, "br");
+		return response;
+	};
+	auto response = this->get("gzip");
+
+	ASSERT_EQ(response->get_header(http::CONTENT_ENCODING, ""), "br");
+	ASSERT_EQ(get_body(response), this->content);
+	ASSERT_FALSE(response->has_header(http::VARY));
+}
+
+TEST_F(CompressionMiddlewareTestCase, SkipsSmallResponse)
+{
+	this->content = std::string(middleware::Compression::DEFAULT_MIN_LENGTH - 1, 'x');
+	auto response = this->get("gzip");
+
+	ASSERT_FALSE(response->has_header(http::CONTENT_ENCODING));
+	ASSERT_EQ(get_body(response), this->content);
+}
+
+TEST_F(CompressionMiddlewareTestCase, SkipsNotCompressibleType)
+{
+	this->make_response = [this]() -> std::unique_ptr<http::IResponse>
+	{
+		return std::make_unique<http::Response>(200, this->content, "image/png");
+	};
+	auto response = this->get("gzip");
+
+	ASSERT_FALSE(response->has_header(http::CONTENT_ENCODING));
+	ASSERT_EQ(get_body(response), this->content);
+}
+
+TEST_F(CompressionMiddlewareTestCase, SkipsNoTransformResponse)
+{
+	this->make_response = [this]() -> std::unique_ptr<http::IResponse>
+	{
+		auto response = std::make_unique<http::Response>(200, this->content, "text/plain");
+		response->set_header(http::CACHE_CONTROL, "max-age=60, No-Transform");
+		return response;
+	};
+
+	ASSERT_FALSE(this->get("gzip")->has_header(http::CONTENT_ENCODING));
+}
+
+TEST_F(CompressionMiddlewareTestCase, SkipsRejectedEncodings)
+{
+	for (const auto* accept_encoding : {"", "gzip;q=0, deflate;q=0", "identity", "*;q=0"})
+	{
+		auto response = this->get(accept_encoding);
+
+		ASSERT_FALSE(response->has_header(http::CONTENT_ENCODING)) << accept_encoding;
+		ASSERT_EQ(get_body(response), this->content) << accept_encoding;
+
+		// Other clients get the compressed response.
+		ASSERT_EQ(response->get_header(http::VARY, ""), "Accept-Encoding") << accept_encoding;
+	}
+}
+
+TEST_F(CompressionMiddlewareTestCase, WeakensStrongETag)
+{
+	std::string etag;
+	this->make_response = [this, &etag]() -> std::unique_ptr<http::IResponse>
+	{
+		auto response = std::make_unique<http::Response>(200, this->content, "text/plain");
+		response->set_header(http::E_TAG, etag);
+		return response;
+	};
+
+	etag = "\"abc\"";
+	ASSERT_EQ(this->get("gzip")->get_header(http::E_TAG, ""), "W/\"abc\"");
+
+	etag = "W/\"abc\"";
+	ASSERT_EQ(this->get("gzip")->get_header(http::E_TAG, ""), "W/\"abc\"");
+}
+
+TEST_F(CompressionMiddlewareTestCase, KeepsStrongETagWhenCompressedContentIsNotSmaller)
+{
+	// Random bytes are not compressible, so the original body is sent.
+	std::mt19937 generator(42);
+	this->content.clear();
+	for (int i = 0; i < 300; i++)
+	{
+		this->content += (char)(generator() % 256);
+	}
+
+	this->make_response = [this]() -> std::unique_ptr<http::IResponse>
+	{
+		auto response = std::make_unique<http::Response>(200, this->content, "text/plain");
+		response->set_header(http::E_TAG, "\"abc\"");
+		return response;
+	};
+	auto response = this->get("gzip");
+
+	ASSERT_FALSE(response->has_header(http::CONTENT_ENCODING));
+	ASSERT_EQ(get_body(response), this->content);
+	ASSERT_EQ(response->get_header(http::E_TAG, ""), "\"abc\"");
+}
+
+TEST_F(CompressionMiddlewareTestCase, CompressesStreamingResponseByChunks)
+{
+	this->make_response = [this]() -> std::unique_ptr<http::IResponse>
+	{
+		auto response = std::make_unique<ChunksResponse>(std::vector<std::string>{
+			"HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: " +
+				std::to_string(this->content.size() * 2) + "\r\nX-Custom: value\r\n\r\n",
+			this->content,
+			this->content
+		});
+		response->set_header(http::E_TAG, "\"abc\"");
+		return response;
+	};
+	auto response = this->get("gzip");
+	ASSERT_TRUE(response->is_streaming());
+	ASSERT_EQ(response->get_header(http::E_TAG, ""), "W/\"abc\"");
+
+	auto* streaming_response = dynamic_cast<http::StreamingResponse*>(response.get());
+	auto head = std::string(streaming_response->get_chunk_view());
+	ASSERT_TRUE(head.starts_with("HTTP/1.1 200 OK\r\n")) << head;
+	ASSERT_TRUE(head.ends_with("\r\n\r\n")) << head;
+	ASSERT_EQ(head.find("\r\n\r\n"), head.size() - 4) << head;
+	ASSERT_NE(head.find("X-Custom: value\r\n"), std::string::npos) << head;
+	ASSERT_NE(head.find("Content-Encoding: gzip\r\n"), std::string::npos) << head;
+	ASSERT_NE(head.find("Transfer-Encoding: chunked\r\n"), std::string::npos) << head;
+	ASSERT_NE(head.find("Vary: Accept-Encoding\r\n"), std::string::npos) << head;
+	ASSERT_EQ(head.find("Content-Length"), std::string::npos) << head;
+
+	// The header of the wrapped response is replaced, not repeated.
+	auto content_type = head.find("Content-Type: ");
+	ASSERT_NE(content_type, std::string::npos) << head;
+	ASSERT_EQ(head.find("Content-Type: ", content_type + 1), std::string::npos) << head;
+
+	// Each chunk of the wrapped response is sent as soon as it is produced.
+	std::vector<std::string> chunks;
+	std::string_view chunk;
+	while (!(chunk = streaming_response->get_chunk_view()).empty())
+	{
+		chunks.emplace_back(chunk);
+	}
+
+	ASSERT_EQ(chunks.size(), 3);
+	bool is_complete;
+	ASSERT_EQ(decompress_gzip(decode_chunked(chunks[0], is_complete)), this->content);
+	ASSERT_FALSE(is_complete);
+
+	std::string body;
+	for (const auto& part : chunks)
+	{
+		body += part;
+	}
+
+	ASSERT_TRUE(body.ends_with("\r\n0\r\n\r\n"));
+	ASSERT_EQ(decompress_gzip(decode_chunked(body, is_complete)), this->content + this->content);
+	ASSERT_TRUE(is_complete);
+}
+
+TEST_F(CompressionMiddlewareTestCase, SkipsStreamingResponseToHttp10Client)
+{
+	this->make_response = [this]() -> std::unique_ptr<http::IResponse>
+	{
+		return std::make_unique<ChunksResponse>(std::vector<std::string>{
+			"HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\n\r\n", this->content
+		});
+	};
+	auto response = this->get("gzip", 0);
+
+	ASSERT_NE(dynamic_cast<ChunksResponse*>(response.get()), nullptr);
+	ASSERT_FALSE(response->has_header(http::CONTENT_ENCODING));
+}
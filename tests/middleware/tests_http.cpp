@@ -0,0 +1,214 @@
+/**
+ * middleware/tests_http.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <map>
+
+#include <gtest/gtest.h>
+
+#include <xalwart.base/exceptions.h>
+
+#include "../../src/middleware/http.h"
+
+using namespace xw;
+
+
+class ConditionalGetTestCase : public ::testing::Test
+{
+protected:
+	static inline const std::string LAST_MODIFIED = "Sat, 01 Jan 2000 00:00:00 GMT";
+	static inline const std::string EARLIER = "Fri, 31 Dec 1999 00:00:00 GMT";
+	static inline const std::string LATER = "Sun, 02 Jan 2000 00:00:00 GMT";
+
+	std::function<std::unique_ptr<http::IResponse>()> make_response;
+	int calls_count = 0;
+
+	void SetUp() override
+	{
+		this->make_response = []() -> std::unique_ptr<http::IResponse>
+		{
+			return std::make_unique<http::Response>(200, "abc", "text/plain");
+		};
+	}
+
+	std::unique_ptr<http::IResponse> dispatch(
+		const middleware::ConditionalGet& middleware,
+		const std::string& method,
+		std::map<std::string, std::string> headers={}
+	)
+	{
+		net::RequestContext context;
+		context.method = method;
+		context.headers = std::move(headers);
+		http::Request request(context, 99999, 99, 9999, 99, 9999, {});
+		auto function = middleware([this](http::IRequest*) -> std::unique_ptr<http::IResponse>
+		{
+			this->calls_count++;
+			return this->make_response();
+		});
+		return function(&request);
+	}
+
+	static std::string reversed(std::string_view content)
+	{
+		return {content.rbegin(), content.rend()};
+	}
+};
+
+TEST_F(ConditionalGetTestCase, Constructor_ThrowsIfFunctionIsNull)
+{
+	ASSERT_THROW(middleware::ConditionalGet(nullptr), ArgumentError);
+}
+
+TEST_F(ConditionalGetTestCase, SetsETagComputedByFunction)
+{
+	auto response = this->dispatch(middleware::ConditionalGet(reversed), "GET");
+
+	ASSERT_EQ(response->get_status(), 200);
+	ASSERT_EQ(response->get_header(http::E_TAG, ""), "\"cba\"");
+	ASSERT_EQ(response->get_content(), "abc");
+}
+
+TEST_F(ConditionalGetTestCase, KeepsExistingETag)
+{
+	this->make_response = []() -> std::unique_ptr<http::IResponse>
+	{
+		auto response = std::make_unique<http::Response>(200, "abc", "text/plain");
+		response->set_header(http::E_TAG, "\"custom\"");
+		return response;
+	};
+	auto response = this->dispatch(middleware::ConditionalGet(reversed), "GET");
+
+	ASSERT_EQ(response->get_header(http::E_TAG, ""), "\"custom\"");
+}
+
+TEST_F(ConditionalGetTestCase, SkipsNotGetRequest)
+{
+	for (const auto* method : {"HEAD", "POST"})
+	{
+		auto response = this->dispatch(
+			middleware::ConditionalGet(reversed), method, {{http::IF_NONE_MATCH, "\"cba\""}}
+		);
+
+		ASSERT_EQ(response->get_status(), 200) << method;
+		ASSERT_FALSE(response->has_header(http::E_TAG)) << method;
+	}
+}
+
+TEST_F(ConditionalGetTestCase, SkipsNoStoreResponse)
+{
+	this->make_response = []() -> std::unique_ptr<http::IResponse>
+	{
+		auto response = std::make_unique<http::Response>(200, "abc", "text/plain");
+		response->set_header(http::CACHE_CONTROL, "private, No-Store");
+		return response;
+	};
+	auto response = this->dispatch(
+		middleware::ConditionalGet(reversed), "GET", {{http::IF_NONE_MATCH, "\"cba\""}}
+	);
+
+	ASSERT_EQ(response->get_status(), 200);
+	ASSERT_FALSE(response->has_header(http::E_TAG));
+}
+
+TEST_F(ConditionalGetTestCase, IfNoneMatch_ReturnsNotModified)
+{
+	this->make_response = []() -> std::unique_ptr<http::IResponse>
+	{
+		auto response = std::make_unique<http::Response>(200, "abc", "text/plain");
+		response->set_header(http::CACHE_CONTROL, "max-age=60");
+		response->set_header(http::LAST_MODIFIED, LAST_MODIFIED);
+		return response;
+	};
+	auto response = this->dispatch(
+		middleware::ConditionalGet(reversed), "GET", {{http::IF_NONE_MATCH, "\"xyz\", \"cba\""}}
+	);
+
+	ASSERT_EQ(response->get_status(), 304);
+	ASSERT_EQ(response->get_content(), "");
+	ASSERT_EQ(response->get_header(http::E_TAG, ""), "\"cba\"");
+	ASSERT_EQ(response->get_header(http::CACHE_CONTROL, ""), "max-age=60");
+	ASSERT_EQ(response->get_header(http::LAST_MODIFIED, ""), LAST_MODIFIED);
+	ASSERT_FALSE(response->has_header(http::CONTENT_TYPE));
+}
+
+TEST_F(ConditionalGetTestCase, IfNoneMatch_Mismatch)
+{
+	auto response = this->dispatch(
+		middleware::ConditionalGet(reversed), "GET", {{http::IF_NONE_MATCH, "\"abc\""}}
+	);
+
+	ASSERT_EQ(response->get_status(), 200);
+	ASSERT_EQ(response->get_content(), "abc");
+}
+
+TEST_F(ConditionalGetTestCase, IfNoneMatch_UsesWeakComparison)
+{
+	auto conditional_get = middleware::ConditionalGet(reversed);
+	ASSERT_EQ(this->dispatch(conditional_get, "GET", {{http::IF_NONE_MATCH, "W/\"cba\""}})->get_status(), 304);
+
+	this->make_response = []() -> std::unique_ptr<http::IResponse>
+	{
+		auto response = std::make_unique<http::Response>(200, "abc", "text/plain");
+		response->set_header(http::E_TAG, "W/\"cba\"");
+		return response;
+	};
+	ASSERT_EQ(this->dispatch(conditional_get, "GET", {{http::IF_NONE_MATCH, "\"cba\""}})->get_status(), 304);
+	ASSERT_EQ(this->dispatch(conditional_get, "GET", {{http::IF_NONE_MATCH, "W/\"cba\""}})->get_status(), 304);
+}
+
+TEST_F(ConditionalGetTestCase, IfNoneMatch_AsteriskMatchesAnyETag)
+{
+	auto response = this->dispatch(
+		middleware::ConditionalGet(reversed), "GET", {{http::IF_NONE_MATCH, "*"}}
+	);
+
+	ASSERT_EQ(response->get_status(), 304);
+	ASSERT_EQ(response->get_header(http::E_TAG, ""), "\"cba\"");
+}
+
+TEST_F(ConditionalGetTestCase, IfModifiedSince_ReturnsNotModified)
+{
+	this->make_response = []() -> std::unique_ptr<http::IResponse>
+	{
+		auto response = std::make_unique<http::Response>(200, "abc", "text/plain");
+		response->set_header(http::LAST_MODIFIED, LAST_MODIFIED);
+		return response;
+	};
+	auto conditional_get = middleware::ConditionalGet(reversed);
+
+	ASSERT_EQ(this->dispatch(conditional_get, "GET", {{http::IF_MODIFIED_SINCE, LAST_MODIFIED}})->get_status(), 304);
+	ASSERT_EQ(this->dispatch(conditional_get, "GET", {{http::IF_MODIFIED_SINCE, LATER}})->get_status(), 304);
+	ASSERT_EQ(this->dispatch(conditional_get, "GET", {{http::IF_MODIFIED_SINCE, EARLIER}})->get_status(), 200);
+}
+
+TEST_F(ConditionalGetTestCase, IfNoneMatch_TakesPrecedenceOverIfModifiedSince)
+{
+	this->make_response = []() -> std::unique_ptr<http::IResponse>
+	{
+		auto response = std::make_unique<http::Response>(200, "abc", "text/plain");
+		response->set_header(http::LAST_MODIFIED, LAST_MODIFIED);
+		return response;
+	};
+	auto conditional_get = middleware::ConditionalGet(reversed);
+
+	// If-Modified-Since is ignored when If-None-Match is present.
+	auto response = this->dispatch(conditional_get, "GET", {
+		{http::IF_NONE_MATCH, "\"abc\""}, {http::IF_MODIFIED_SINCE, LATER}
+	});
+	ASSERT_EQ(response->get_status(), 200);
+
+	response = this->dispatch(conditional_get, "GET", {
+		{http::IF_NONE_MATCH, "\"cba\""}, {http::IF_MODIFIED_SINCE, EARLIER}
+	});
+	ASSERT_EQ(response->get_status(), 304);
+}
+
+TEST_F(ConditionalGetTestCase, CallsNextOnce)
+{
+	this->dispatch(middleware::ConditionalGet(reversed), "GET", {{http::IF_NONE_MATCH, "\"cba\""}});
+
+	ASSERT_EQ(this->calls_count, 1);
+}
@@ -0,0 +1,239 @@
+/**
+ * middleware/tests_page_cache.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <chrono>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "../../src/middleware/page_cache.h"
+
+using namespace xw;
+
+
+class PageCacheStorageTestCase : public ::testing::Test
+{
+protected:
+	static inline const middleware::PageCacheStorage::VariantKeyFunction NO_VARIANTS = [](const auto&)
+	{
+		return std::string();
+	};
+
+	static std::shared_ptr<const middleware::CachedPage> make_page(
+		const std::string& content, std::chrono::milliseconds timeout
+	)
+	{
+		auto now = std::chrono::steady_clock::now();
+		auto page = std::make_shared<middleware::CachedPage>();
+		page->status = 200;
+		page->content = std::make_shared<const std::string>(content);
+		page->stored_at = now;
+		page->expires_at = now + timeout;
+		return page;
+	}
+};
+
+TEST_F(PageCacheStorageTestCase, get_MissingPage)
+{
+	middleware::PageCacheStorage storage(1024 * 1024, 4, std::chrono::seconds(60));
+	auto lookup = storage.get("GET /", NO_VARIANTS);
+
+	ASSERT_EQ(lookup.page, nullptr);
+	ASSERT_TRUE(lookup.should_update);
+}
+
+TEST_F(PageCacheStorageTestCase, get_FreshPage)
+{
+	middleware::PageCacheStorage storage(1024 * 1024, 4, std::chrono::seconds(60));
+	storage.set("GET /", {}, "", make_page("Hello, World!", std::chrono::seconds(60)));
+	auto lookup = storage.get("GET /", NO_VARIANTS);
+
+	ASSERT_NE(lookup.page, nullptr);
+	ASSERT_EQ(*lookup.page->content, "Hello, World!");
+	ASSERT_FALSE(lookup.should_update);
+}
+
+TEST_F(PageCacheStorageTestCase, get_ExpiredPageIsUpdatedOnce)
+{
+	middleware::PageCacheStorage storage(1024 * 1024, 4, std::chrono::seconds(60));
+	storage.set("GET /", {}, "", make_page("Hello, World!", std::chrono::milliseconds(-1)));
+
+	auto first = storage.get("GET /", NO_VARIANTS);
+	ASSERT_NE(first.page, nullptr);
+	ASSERT_TRUE(first.should_update);
+
+	// Stale page is served while the first caller regenerates it.
+	auto second = storage.get("GET /", NO_VARIANTS);
+	ASSERT_NE(second.page, nullptr);
+	ASSERT_FALSE(second.should_update);
+
+	storage.release("GET /", NO_VARIANTS);
+	ASSERT_TRUE(storage.get("GET /", NO_VARIANTS).should_update);
+}
+
+TEST_F(PageCacheStorageTestCase, get_MissingPageIsUpdatedOnce)
+{
+	middleware::PageCacheStorage storage(1024 * 1024, 4, std::chrono::seconds(60));
+
+	auto first = storage.get("GET /", NO_VARIANTS);
+	ASSERT_TRUE(first.should_update);
+	ASSERT_EQ(first.flight, nullptr);
+
+	// Other callers wait for the first one.
+	auto second = storage.get("GET /", NO_VARIANTS);
+	ASSERT_EQ(second.page, nullptr);
+	ASSERT_FALSE(second.should_update);
+	ASSERT_NE(second.flight, nullptr);
+
+	auto third = storage.get("GET /", NO_VARIANTS, false);
+	ASSERT_FALSE(third.should_update);
+	ASSERT_EQ(third.flight, nullptr);
+
+	storage.release("GET /", NO_VARIANTS);
+	ASSERT_TRUE(storage.get("GET /", NO_VARIANTS).should_update);
+}
+
+TEST_F(PageCacheStorageTestCase, get_WaitsForMissingPage)
+{
+	middleware::PageCacheStorage storage(1024 * 1024, 4, std::chrono::seconds(60));
+	ASSERT_TRUE(storage.get("GET /", NO_VARIANTS).should_update);
+
+	std::shared_ptr<const middleware::CachedPage> page;
+	std::thread waiter([&storage, &page]()
+	{
+		auto lookup = storage.get("GET /", NO_VARIANTS);
+		if (lookup.flight)
+		{
+			lookup.flight->wait();
+			lookup = storage.get("GET /", NO_VARIANTS, false);
+		}
+
+		page = lookup.page;
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	storage.set("GET /", {}, "", make_page("Hello, World!", std::chrono::seconds(60)));
+	waiter.join();
+
+	ASSERT_NE(page, nullptr);
+	ASSERT_EQ(*page->content, "Hello, World!");
+}
+
+TEST_F(PageCacheStorageTestCase, get_MissingVariantIsUpdatedOnce)
+{
+	middleware::PageCacheStorage storage(1024 * 1024, 4, std::chrono::seconds(60));
+	std::vector<std::string> vary_headers = {"Accept-Language"};
+	storage.set("GET /", vary_headers, "en\n", make_page("Hello", std::chrono::seconds(60)));
+	auto uk = [](const auto&) -> std::string { return "uk\n"; };
+
+	ASSERT_TRUE(storage.get("GET /", uk).should_update);
+	ASSERT_NE(storage.get("GET /", uk).flight, nullptr);
+
+	// Other variants are not affected.
+	ASSERT_TRUE(storage.get("GET /", NO_VARIANTS).should_update);
+
+	storage.set("GET /", vary_headers, "uk\n", make_page("Привіт", std::chrono::seconds(60)));
+	auto lookup = storage.get("GET /", uk);
+	ASSERT_NE(lookup.page, nullptr);
+	ASSERT_EQ(lookup.flight, nullptr);
+}
+
+TEST_F(PageCacheStorageTestCase, get_SelectsVariantByVaryHeaders)
+{
+	middleware::PageCacheStorage storage(1024 * 1024, 4, std::chrono::seconds(60));
+	std::vector<std::string> vary_headers = {"Accept-Language"};
+	storage.set("GET /", vary_headers, "en\n", make_page("Hello", std::chrono::seconds(60)));
+	storage.set("GET /", vary_headers, "uk\n", make_page("Привіт", std::chrono::seconds(60)));
+
+	auto lookup = storage.get("GET /", [](const auto& headers) -> std::string
+	{
+		return headers.size() == 1 && headers[0] == "Accept-Language" ? "uk\n" : "";
+	});
+	ASSERT_NE(lookup.page, nullptr);
+	ASSERT_EQ(*lookup.page->content, "Привіт");
+	ASSERT_EQ(storage.get("GET /", NO_VARIANTS).page, nullptr);
+}
+
+TEST_F(PageCacheStorageTestCase, set_EvictsLeastRecentlyUsedPages)
+{
+	auto page_size = make_page(std::string(1000, 'x'), std::chrono::seconds(60))->size() + 16;
+	middleware::PageCacheStorage storage(page_size * 2, 1, std::chrono::seconds(60));
+	storage.set("GET /a", {}, "", make_page(std::string(1000, 'a'), std::chrono::seconds(60)));
+	storage.set("GET /b", {}, "", make_page(std::string(1000, 'b'), std::chrono::seconds(60)));
+	ASSERT_NE(storage.get("GET /a", NO_VARIANTS).page, nullptr);
+
+	storage.set("GET /c", {}, "", make_page(std::string(1000, 'c'), std::chrono::seconds(60)));
+
+	ASSERT_NE(storage.get("GET /a", NO_VARIANTS).page, nullptr);
+	ASSERT_EQ(storage.get("GET /b", NO_VARIANTS).page, nullptr);
+	ASSERT_NE(storage.get("GET /c", NO_VARIANTS).page, nullptr);
+	ASSERT_LE(storage.size(), page_size * 2);
+}
+
+TEST_F(PageCacheStorageTestCase, remove)
+{
+	middleware::PageCacheStorage storage(1024 * 1024, 4, std::chrono::seconds(60));
+	storage.set("GET /", {}, "", make_page("Hello, World!", std::chrono::seconds(60)));
+	storage.remove("GET /", NO_VARIANTS);
+
+	ASSERT_EQ(storage.get("GET /", NO_VARIANTS).page, nullptr);
+	ASSERT_EQ(storage.size(), 0);
+}
+
+class PageCacheTestCase : public ::testing::Test
+{
+protected:
+	size_t calls_count = 0;
+	std::string vary;
+	middleware::Function function;
+
+	void SetUp() override
+	{
+		this->function = middleware::PageCache()([this](http::IRequest*) -> std::unique_ptr<http::IResponse>
+		{
+			this->calls_count++;
+			auto response = std::make_unique<http::Response>(200, "Hello, World!", "text/plain");
+			if (!this->vary.empty())
+			{
+				response->set_header(http::VARY, this->vary);
+			}
+
+			return response;
+		});
+	}
+
+	void get(std::map<std::string, std::string> headers={})
+	{
+		net::RequestContext context;
+		context.method = "GET";
+		context.path = "/hello";
+		context.headers = std::move(headers);
+		http::Request request(context, 99999, 99, 9999, 99, 9999, {});
+		ASSERT_EQ(this->function(&request)->get_status(), 200);
+	}
+};
+
+TEST_F(PageCacheTestCase, RequestWithCookieIsNotCached)
+{
+	this->get({{http::COOKIE, "session=a"}});
+	this->get({{http::COOKIE, "session=a"}});
+	ASSERT_EQ(this->calls_count, 2);
+
+	this->get();
+	this->get();
+	ASSERT_EQ(this->calls_count, 3);
+}
+
+TEST_F(PageCacheTestCase, RequestWithCookieIsCachedByVaryCookie)
+{
+	this->vary = "Accept-Encoding, cookie";
+
+	this->get({{http::COOKIE, "session=a"}});
+	this->get({{http::COOKIE, "session=a"}});
+	ASSERT_EQ(this->calls_count, 1);
+
+	this->get({{http::COOKIE, "session=b"}});
+	ASSERT_EQ(this->calls_count, 2);
+}
@@ -0,0 +1,972 @@
+/**
+ * server/tests_http_server.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <xalwart.base/logger.h>
+
+#include "../../src/server/connection.h"
+#include "../../src/server/http_server.h"
+#include "../../src/server/meta.h"
+#include "../../src/utility/event_loop.h"
+
+using namespace xw;
+
+
+class TestCase_HTTPServer : public ::testing::Test
+{
+protected:
+	std::unique_ptr<server::HTTPServer> server;
+	std::thread thread;
+
+	static server::Config make_config()
+	{
+		return server::Config{.workers = 2, .retries = 0};
+	}
+
+	template <typename HandlerT>
+	void start(HandlerT handler, server::Config config=make_config())
+	{
+		auto logger_config = log::Config();
+		logger_config.disable_all_levels();
+		this->server = std::make_unique<server::HTTPServer>(
+			config, std::move(handler), std::make_shared<log::Logger>(logger_config)
+		);
+		this->server->bind("127.0.0.1", 0);
+		this->thread = std::thread([this]() { this->server->listen(""); });
+	}
+
+	void TearDown() override
+	{
+		if (this->server)
+		{
+			this->server->close();
+			this->thread.join();
+		}
+	}
+
+	[[nodiscard]]
+	int connect() const
+	{
+		int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+		sockaddr_in address{};
+		address.sin_family = AF_INET;
+		address.sin_port = htons(this->server->port());
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		if (::connect(fd, (sockaddr*)&address, sizeof(address)) < 0)
+		{
+			::close(fd);
+			throw std::runtime_error("unable to connect");
+		}
+
+		return fd;
+	}
+
+	// Sends `request` and returns everything which is received until
+	// the server closes the connection. The connection is shut down for
+	// writing, so the server does not wait for the next request.
+	[[nodiscard]]
+	std::string send(const std::string& request) const
+	{
+		int fd = this->connect();
+		send_all(fd, request);
+		::shutdown(fd, SHUT_WR);
+		auto response = read_all(fd);
+		::close(fd);
+		return response;
+	}
+
+	static void send_all(int fd, const std::string& data)
+	{
+		for (size_t sent = 0; sent < data.size();)
+		{
+			auto n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+			if (n <= 0)
+			{
+				break;
+			}
+
+			sent += n;
+		}
+	}
+
+	// Returns the next response with 'Content-Length' header, `buffer`
+	// keeps bytes of the following responses which are received.
+	static std::string read_response(int fd, std::string& buffer)
+	{
+		char chunk[4096];
+		ssize_t n = 1;
+		size_t head_end;
+		while ((head_end = buffer.find("\r\n\r\n")) == std::string::npos && n > 0)
+		{
+			if ((n = ::recv(fd, chunk, sizeof(chunk), 0)) > 0)
+			{
+				buffer.append(chunk, n);
+			}
+		}
+
+		if (head_end == std::string::npos)
+		{
+			return "";
+		}
+
+		auto length_start = buffer.find("Content-Length: ") + 16;
+		auto size = head_end + 4 + std::stoul(buffer.substr(length_start, buffer.find("\r\n", length_start)));
+		while (buffer.size() < size && (n = ::recv(fd, chunk, sizeof(chunk), 0)) > 0)
+		{
+			buffer.append(chunk, n);
+		}
+
+		auto response = buffer.substr(0, size);
+		buffer.erase(0, size);
+		return response;
+	}
+
+	static std::string read_all(int fd)
+	{
+		std::string response;
+		char buffer[4096];
+		ssize_t n;
+		while ((n = ::recv(fd, buffer, sizeof(buffer), 0)) > 0)
+		{
+			response.append(buffer, n);
+		}
+
+		return response;
+	}
+
+	static net::StatusCode respond(net::RequestContext* context, const std::string& body)
+	{
+		auto response = "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+		context->response_writer->write(response.data(), response.size());
+		return 200;
+	}
+};
+
+TEST_F(TestCase_HTTPServer, PassesRequestToHandler)
+{
+	this->start([](auto* context, const auto& environment, auto*) -> net::StatusCode
+	{
+		return respond(
+			context,
+			context->method + " " + context->path + "?" + context->query + " " +
+			context->headers.at("Host") + " " + environment.at("SERVER_NAME") + ":" + environment.at("SERVER_PORT")
+		);
+	});
+
+	auto response = this->send("GET /hello/?name=world HTTP/1.1\r\nHost: localhost\r\n\r\n");
+	auto body = "GET /hello/?name=world localhost 127.0.0.1:" + std::to_string(this->server->port());
+	ASSERT_EQ(response, "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body);
+}
+
+TEST_F(TestCase_HTTPServer, SpoolsLargeBodyBeforeHandlerIsCalled)
+{
+	this->start([](auto* context, const auto&, auto*) -> net::StatusCode
+	{
+		std::string body, chunk;
+		while (context->body->read(chunk, 10000) > 0)
+		{
+			body += chunk;
+		}
+
+		auto is_valid = body.size() == context->content_size && body == std::string(body.size(), 'x');
+		return respond(context, std::to_string(body.size()) + (is_valid ? " valid" : " invalid"));
+	});
+
+	std::string body(1024 * 1024, 'x');
+	auto response = this->send(
+		"POST /upload/ HTTP/1.1\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body
+	);
+	ASSERT_TRUE(response.ends_with("\r\n\r\n1048576 valid")) << response;
+}
+
+TEST_F(TestCase_HTTPServer, SpoolsLargeBodyToUploadDirectory)
+{
+	auto directory = std::filesystem::temp_directory_path() / "xw_http_server_uploads";
+	std::filesystem::remove_all(directory);
+	auto config = make_config();
+	config.upload_directory = directory.string();
+	this->start([](auto* context, const auto&, auto*) -> net::StatusCode
+	{
+		auto* reader = dynamic_cast<http::mime::multipart::ISpooledReader*>(context->body.get());
+		if (!reader || !reader->spooled_file())
+		{
+			return respond(context, "in memory");
+		}
+
+		std::string chunk;
+		context->body->read(chunk, 10);
+		return respond(context, "spooled, position " + std::to_string(reader->spooled_position()));
+	}, config);
+
+	std::string body(1024 * 1024, 'x');
+	auto request = "POST /upload/ HTTP/1.1\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+	ASSERT_TRUE(this->send(request).starts_with("HTTP/1.1 500 Internal Server Error\r\n"));
+
+	std::filesystem::create_directories(directory);
+	auto response = this->send(request);
+	std::filesystem::remove_all(directory);
+	ASSERT_TRUE(response.ends_with("\r\n\r\nspooled, position 10")) << response;
+}
+
+TEST_F(TestCase_HTTPServer, SendsLargeResponse)
+{
+	std::string body(3 * 1024 * 1024 + 7, 'y');
+	this->start([&body](auto* context, const auto&, auto*) -> net::StatusCode
+	{
+		return respond(context, body);
+	});
+
+	auto response = this->send("GET / HTTP/1.1\r\n\r\n");
+	ASSERT_TRUE(response.starts_with("HTTP/1.1 200 OK\r\nContent-Length: 3145735\r\n\r\n"));
+	ASSERT_EQ(response.size(), body.size() + 44);
+}
+
+TEST_F(TestCase_HTTPServer, ServesOtherConnectionsWhileBodyIsReceived)
+{
+	auto config = make_config();
+	config.workers = 1;
+	this->start([](auto* context, const auto&, auto*) -> net::StatusCode
+	{
+		std::string body, chunk;
+		while (context->body->read(chunk, 10000) > 0)
+		{
+			body += chunk;
+		}
+
+		return respond(context, std::to_string(body.size()));
+	}, config);
+
+	// The only loop receives the first half of the body and does not wait for the rest.
+	std::string body(256 * 1024, 'x');
+	int slow = this->connect();
+	send_all(
+		slow,
+		"POST / HTTP/1.1\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body.substr(0, body.size() / 2)
+	);
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+	int other = this->connect();
+	auto start = std::chrono::steady_clock::now();
+	send_all(other, "GET / HTTP/1.1\r\n\r\n");
+	std::string other_buffer, slow_buffer;
+	ASSERT_EQ(read_response(other, other_buffer), "HTTP/1.1 200 OK\r\nContent-Length: 1\r\n\r\n0");
+	ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+
+	send_all(slow, body.substr(body.size() / 2));
+	ASSERT_EQ(read_response(slow, slow_buffer), "HTTP/1.1 200 OK\r\nContent-Length: 6\r\n\r\n262144");
+	::close(slow);
+	::close(other);
+}
+
+TEST_F(TestCase_HTTPServer, ServesOtherConnectionsWhileResponseIsNotRead)
+{
+	// The response does not fit buffers of the sockets.
+	std::string large_body(32 * 1024 * 1024, 'y');
+	auto config = make_config();
+	config.workers = 1;
+	this->start([&large_body](auto* context, const auto&, auto*) -> net::StatusCode
+	{
+		return respond(context, context->path == "/large/" ? large_body : "small");
+	}, config);
+
+	int slow = this->connect();
+	send_all(slow, "GET /large/ HTTP/1.1\r\n\r\n");
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+	int other = this->connect();
+	auto start = std::chrono::steady_clock::now();
+	send_all(other, "GET /small/ HTTP/1.1\r\n\r\n");
+	std::string other_buffer, slow_buffer;
+	ASSERT_EQ(read_response(other, other_buffer), "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nsmall");
+	ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+
+	auto response = read_response(slow, slow_buffer);
+	ASSERT_TRUE(response.starts_with("HTTP/1.1 200 OK\r\nContent-Length: 33554432\r\n\r\n"));
+	ASSERT_EQ(response.size(), large_body.size() + 45);
+	ASSERT_EQ(response.find_first_not_of('y', 45), std::string::npos);
+	::close(slow);
+	::close(other);
+}
+
+TEST_F(TestCase_HTTPServer, RespondsToMalformedRequest)
+{
+	bool is_called = false;
+	this->start([&is_called](auto* context, const auto&, auto*) -> net::StatusCode
+	{
+		is_called = true;
+		return respond(context, "");
+	});
+
+	ASSERT_TRUE(this->send("HELLO\r\n\r\n").starts_with("HTTP/1.1 400 Bad Request\r\n"));
+	ASSERT_TRUE(
+		this->send("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n").starts_with("HTTP/1.1 501 ")
+	);
+	ASSERT_FALSE(is_called);
+}
+
+TEST_F(TestCase_HTTPServer, RespondsToTooLargeBody)
+{
+	bool is_called = false;
+	auto config = make_config();
+	config.max_body_size = 4;
+	this->start([&is_called](auto* context, const auto&, auto*) -> net::StatusCode
+	{
+		is_called = true;
+		return respond(context, "");
+	}, config);
+
+	ASSERT_TRUE(
+		this->send("POST / HTTP/1.1\r\nContent-Length: 5\r\n\r\nhello").starts_with("HTTP/1.1 413 Payload Too Large\r\n")
+	);
+	ASSERT_FALSE(is_called);
+	ASSERT_TRUE(this->send("POST / HTTP/1.1\r\nContent-Length: 4\r\n\r\nhell").starts_with("HTTP/1.1 200 OK\r\n"));
+}
+
+TEST_F(TestCase_HTTPServer, RespondsWithServerErrorWhenHandlerThrows)
+{
+	this->start([](auto*, const auto&, auto*) -> net::StatusCode
+	{
+		throw std::runtime_error("failure");
+	});
+
+	ASSERT_TRUE(this->send("GET / HTTP/1.1\r\n\r\n").starts_with("HTTP/1.1 500 Internal Server Error\r\n"));
+}
+
+TEST_F(TestCase_HTTPServer, ClosesIdleConnection)
+{
+	auto config = make_config();
+	config.timeout = std::chrono::milliseconds(50);
+	this->start([](auto* context, const auto&, auto*) -> net::StatusCode { return respond(context, ""); }, config);
+
+	int fd = this->connect();
+	auto start = std::chrono::steady_clock::now();
+	ASSERT_EQ(read_all(fd), "");
+	ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+	::close(fd);
+}
+
+TEST_F(TestCase_HTTPServer, ClosesConnectionWhenRequestIsReceivedTooSlowly)
+{
+	auto config = make_config();
+	config.timeout = std::chrono::milliseconds(200);
+	this->start([](auto* context, const auto&, auto*) -> net::StatusCode { return respond(context, ""); }, config);
+
+	// Each header is received in time, but the whole head is not.
+	int fd = this->connect();
+	auto start = std::chrono::steady_clock::now();
+	send_all(fd, "GET / HTTP/1.1\r\n");
+	bool is_closed = false;
+	while (!is_closed && std::chrono::steady_clock::now() - start < std::chrono::seconds(2))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		send_all(fd, "X-Header: value\r\n");
+		char byte;
+		auto n = ::recv(fd, &byte, 1, MSG_DONTWAIT);
+		is_closed = n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK);
+	}
+
+	ASSERT_TRUE(is_closed);
+	::close(fd);
+}
+
+TEST_F(TestCase_HTTPServer, ReceivesBodyLongerThanTimeoutWhileItIsSent)
+{
+	auto config = make_config();
+	config.timeout = std::chrono::milliseconds(200);
+	this->start([](auto* context, const auto&, auto*) -> net::StatusCode
+	{
+		std::string body;
+		context->body->read(body, context->content_size);
+		return respond(context, body);
+	}, config);
+
+	// Each part of the body is received in time, but the whole body is not.
+	int fd = this->connect();
+	send_all(fd, "POST / HTTP/1.1\r\nHost: 127.0.0.1\r\nContent-Length: 8\r\n\r\n");
+	for (const auto* part : {"ab", "cd", "ef", "gh"})
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		send_all(fd, part);
+	}
+
+	std::string buffer;
+	ASSERT_EQ(read_response(fd, buffer), "HTTP/1.1 200 OK\r\nContent-Length: 8\r\n\r\nabcdefgh");
+	::close(fd);
+}
+
+TEST_F(TestCase_HTTPServer, ReusesConnection)
+{
+	this->start([](auto* context, const auto& environment, auto*) -> net::StatusCode
+	{
+		return respond(
+			context,
+			environment.at(server::meta::CONNECTION_ID) + " " + environment.at(server::meta::CONNECTION_REQUESTS_COUNT)
+		);
+	});
+
+	int fd = this->connect();
+	std::string buffer;
+	send_all(fd, "GET / HTTP/1.1\r\n\r\n");
+	auto first = read_response(fd, buffer);
+	send_all(fd, "GET / HTTP/1.1\r\n\r\n");
+	auto second = read_response(fd, buffer);
+	::close(fd);
+
+	auto id = first.substr(first.find("\r\n\r\n") + 4);
+	ASSERT_TRUE(id.ends_with(" 1")) << first;
+	id.resize(id.size() - 2);
+	ASSERT_EQ(second, "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(id.size() + 2) + "\r\n\r\n" + id + " 2");
+
+	auto other = this->send("GET / HTTP/1.1\r\n\r\n");
+	ASSERT_FALSE(other.ends_with("\r\n" + id + " 1")) << other;
+}
+
+TEST_F(TestCase_HTTPServer, RespondsToPipelinedRequestsInOrder)
+{
+	this->start([](auto* context, const auto&, auto*) -> net::StatusCode
+	{
+		return respond(context, context->path);
+	});
+
+	// The body of the second request is not read by the handler.
+	int fd = this->connect();
+	send_all(
+		fd,
+		"GET /first/ HTTP/1.1\r\n\r\n"
+		"POST /second/ HTTP/1.1\r\nContent-Length: 5\r\n\r\nhello"
+		"GET /third/ HTTP/1.1\r\n\r\n"
+	);
+	std::string buffer;
+	ASSERT_TRUE(read_response(fd, buffer).ends_with("\r\n\r\n/first/"));
+	ASSERT_TRUE(read_response(fd, buffer).ends_with("\r\n\r\n/second/"));
+	ASSERT_TRUE(read_response(fd, buffer).ends_with("\r\n\r\n/third/"));
+	ASSERT_EQ(buffer, "");
+	::close(fd);
+}
+
+TEST_F(TestCase_HTTPServer, ClosesConnectionAfterMaxRequests)
+{
+	auto config = make_config();
+	config.max_requests_per_connection = 2;
+	this->start([](auto* context, const auto&, auto*) -> net::StatusCode { return respond(context, "ok"); }, config);
+
+	int fd = this->connect();
+	send_all(fd, "GET / HTTP/1.1\r\n\r\nGET / HTTP/1.1\r\n\r\nGET / HTTP/1.1\r\n\r\n");
+	std::string buffer;
+	ASSERT_EQ(read_response(fd, buffer), "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok");
+	ASSERT_EQ(read_response(fd, buffer), "HTTP/1.1 200 OK\r\nContent-Length: 2\r\nConnection: close\r\n\r\nok");
+	ASSERT_EQ(buffer + read_all(fd), "");
+	::close(fd);
+}
+
+TEST_F(TestCase_HTTPServer, ClosesConnectionWhenClientAsks)
+{
+	this->start([](auto* context, const auto&, auto*) -> net::StatusCode { return respond(context, "ok"); });
+
+	int fd = this->connect();
+	send_all(fd, "GET / HTTP/1.1\r\nConnection: close\r\n\r\n");
+	ASSERT_EQ(read_all(fd), "HTTP/1.1 200 OK\r\nContent-Length: 2\r\nConnection: close\r\n\r\nok");
+	::close(fd);
+
+	fd = this->connect();
+	send_all(fd, "GET / HTTP/1.0\r\n\r\n");
+	ASSERT_EQ(read_all(fd), "HTTP/1.1 200 OK\r\nContent-Length: 2\r\nConnection: close\r\n\r\nok");
+	::close(fd);
+}
+
+TEST_F(TestCase_HTTPServer, KeepsConnectionOfHttp10Client)
+{
+	this->start([](auto* context, const auto&, auto*) -> net::StatusCode { return respond(context, "ok"); });
+
+	int fd = this->connect();
+	std::string buffer;
+	for (int i = 0; i < 2; i++)
+	{
+		send_all(fd, "GET / HTTP/1.0\r\nConnection: keep-alive\r\n\r\n");
+		ASSERT_EQ(
+			read_response(fd, buffer),
+			"HTTP/1.1 200 OK\r\nContent-Length: 2\r\nConnection: keep-alive\r\n\r\nok"
+		);
+	}
+
+	::close(fd);
+}
+
+TEST_F(TestCase_HTTPServer, ClosesConnectionAfterUndelimitedResponse)
+{
+	this->start([](auto* context, const auto&, auto*) -> net::StatusCode
+	{
+		std::string response = "HTTP/1.1 200 OK\r\n\r\nbody";
+		context->response_writer->write(response.data(), response.size());
+		return 200;
+	});
+
+	int fd = this->connect();
+	send_all(fd, "GET / HTTP/1.1\r\n\r\n");
+	ASSERT_EQ(read_all(fd), "HTTP/1.1 200 OK\r\nConnection: close\r\n\r\nbody");
+	::close(fd);
+}
+
+TEST_F(TestCase_HTTPServer, DropsBodyOfResponseToHeadRequest)
+{
+	this->start([](auto* context, const auto&, auto*) -> net::StatusCode { return respond(context, "body"); });
+
+	int fd = this->connect();
+	send_all(fd, "HEAD / HTTP/1.1\r\n\r\nGET / HTTP/1.1\r\nConnection: close\r\n\r\n");
+	ASSERT_EQ(
+		read_all(fd),
+		"HTTP/1.1 200 OK\r\nContent-Length: 4\r\n\r\n"
+		"HTTP/1.1 200 OK\r\nContent-Length: 4\r\nConnection: close\r\n\r\nbody"
+	);
+	::close(fd);
+}
+
+TEST_F(TestCase_HTTPServer, ClosesIdlePersistentConnection)
+{
+	auto config = make_config();
+	config.keep_alive_timeout = std::chrono::milliseconds(50);
+	this->start([](auto* context, const auto&, auto*) -> net::StatusCode { return respond(context, "ok"); }, config);
+
+	int fd = this->connect();
+	send_all(fd, "GET / HTTP/1.1\r\n\r\n");
+	auto start = std::chrono::steady_clock::now();
+	ASSERT_EQ(read_all(fd), "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok");
+	ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+	::close(fd);
+}
+
+// Keeps coroutines of requests which are suspended until the test resumes
+// them, recording threads which the coroutines are resumed on.
+struct Gate
+{
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::vector<std::pair<util::EventLoop*, std::coroutine_handle<>>> waiters;
+	std::vector<std::thread::id> threads;
+
+	auto wait()
+	{
+		struct Awaiter
+		{
+			Gate* gate;
+
+			bool await_ready() const noexcept
+			{
+				return false;
+			}
+
+			void await_suspend(std::coroutine_handle<> handle) const
+			{
+				std::lock_guard lock(this->gate->mutex);
+				this->gate->waiters.emplace_back(&util::EventLoop::current(), handle);
+				this->gate->threads.push_back(std::this_thread::get_id());
+				this->gate->condition.notify_all();
+			}
+
+			void await_resume() const
+			{
+				std::lock_guard lock(this->gate->mutex);
+				this->gate->threads.push_back(std::this_thread::get_id());
+			}
+		};
+
+		return Awaiter{this};
+	}
+
+	// Waits until `count` coroutines are suspended.
+	bool wait_for(size_t count)
+	{
+		std::unique_lock lock(this->mutex);
+		return this->condition.wait_for(
+			lock, std::chrono::seconds(5), [this, count]() -> bool { return this->waiters.size() == count; }
+		);
+	}
+
+	// Resumes suspended coroutines from the calling thread
+	// in reverse order of suspending.
+	void open()
+	{
+		std::lock_guard lock(this->mutex);
+		for (auto waiter = this->waiters.rbegin(); waiter != this->waiters.rend(); waiter++)
+		{
+			waiter->first->schedule(waiter->second);
+		}
+	}
+};
+
+TEST_F(TestCase_HTTPServer, AsyncHandlerProcessesOtherRequestsWhileSuspended)
+{
+	Gate gate;
+	auto config = make_config();
+	config.workers = 1;
+	this->start([&gate](auto* context, const auto&, auto*) -> util::Task<net::StatusCode>
+	{
+		co_await gate.wait();
+		co_return respond(context, context->path);
+	}, config);
+
+	int first = this->connect(), second = this->connect();
+	send_all(first, "GET /first HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+	send_all(second, "GET /second HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+
+	// Both requests are suspended by the only loop at the same time.
+	ASSERT_TRUE(gate.wait_for(2));
+	gate.open();
+
+	std::string first_buffer, second_buffer;
+	ASSERT_EQ(read_response(second, second_buffer), "HTTP/1.1 200 OK\r\nContent-Length: 7\r\n\r\n/second");
+	ASSERT_EQ(read_response(first, first_buffer), "HTTP/1.1 200 OK\r\nContent-Length: 6\r\n\r\n/first");
+	ASSERT_EQ(gate.threads.size(), 4);
+	for (const auto& thread_id : gate.threads)
+	{
+		ASSERT_EQ(thread_id, gate.threads.front());
+	}
+
+	::close(first);
+	::close(second);
+}
+
+TEST_F(TestCase_HTTPServer, AsyncHandlerErrorIsSentAfterResuming)
+{
+	Gate gate;
+	this->start([&gate](auto*, const auto&, auto*) -> util::Task<net::StatusCode>
+	{
+		co_await gate.wait();
+		throw std::runtime_error("failed");
+	});
+
+	int fd = this->connect();
+	send_all(fd, "GET / HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+	ASSERT_TRUE(gate.wait_for(1));
+	gate.open();
+
+	ASSERT_EQ(
+		read_all(fd), "HTTP/1.1 500 Internal Server Error\r\nContent-Length: 0\r\nConnection: close\r\n\r\n"
+	);
+	::close(fd);
+}
+
+TEST_F(TestCase_HTTPServer, AsyncHandlerResumedTogetherWithResetOfItsConnection)
+{
+	Gate gate;
+	auto config = make_config();
+	config.workers = 1;
+	this->start([&gate](auto* context, const auto&, auto*) -> util::Task<net::StatusCode>
+	{
+		if (context->path == "/busy")
+		{
+			// Keeps the loop busy, so the next wait returns both events.
+			std::this_thread::sleep_for(std::chrono::milliseconds(300));
+		}
+		else
+		{
+			co_await gate.wait();
+		}
+
+		co_return respond(context, context->path);
+	}, config);
+
+	int suspended = this->connect();
+	send_all(suspended, "GET /wait HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+	ASSERT_TRUE(gate.wait_for(1));
+
+	int busy = this->connect();
+	send_all(busy, "GET /busy HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+	// The connection is closed by the resumed handler, because sending the
+	// response fails, before the event of the reset is handled.
+	gate.open();
+	linger reset{.l_onoff = 1, .l_linger = 0};
+	::setsockopt(suspended, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+	::close(suspended);
+
+	std::string buffer;
+	ASSERT_EQ(read_response(busy, buffer), "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\n/busy");
+	::close(busy);
+
+	// The resumed handler is finished before the gate is destroyed.
+	this->server->close();
+	this->thread.join();
+	this->server.reset();
+}
+
+TEST_F(TestCase_HTTPServer, DoesNotReceiveWhileHandlerIsSuspended)
+{
+	Gate gate;
+	auto config = make_config();
+	config.workers = 1;
+	this->start([&gate](auto* context, const auto&, auto*) -> util::Task<net::StatusCode>
+	{
+		if (context->path == "/first")
+		{
+			co_await gate.wait();
+		}
+
+		co_return respond(context, context->path);
+	}, config);
+
+	int fd = this->connect();
+	send_all(fd, "GET /first HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+	ASSERT_TRUE(gate.wait_for(1));
+
+	// Pipelined bytes are left in buffers of the sockets, so the client
+	// is unable to send more of them than the buffers keep.
+	send_all(fd, "GET /second HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+	std::string chunk(1024 * 1024, 'x');
+	const size_t max_size = 64 * 1024 * 1024;
+	size_t sent = 0;
+	auto start = std::chrono::steady_clock::now();
+	while (sent < max_size && std::chrono::steady_clock::now() - start < std::chrono::seconds(2))
+	{
+		auto n = ::send(fd, chunk.data(), chunk.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (n > 0)
+		{
+			sent += n;
+		}
+		else
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+	}
+
+	gate.open();
+	ASSERT_LT(sent, max_size);
+
+	std::string buffer;
+	ASSERT_EQ(read_response(fd, buffer), "HTTP/1.1 200 OK\r\nContent-Length: 6\r\n\r\n/first");
+	ASSERT_EQ(read_response(fd, buffer), "HTTP/1.1 200 OK\r\nContent-Length: 7\r\n\r\n/second");
+	::close(fd);
+}
+
+TEST_F(TestCase_HTTPServer, StopsProcessingWhileResponsesAreNotRead)
+{
+	std::atomic<size_t> handled_count = 0;
+	this->start([&handled_count](auto* context, const auto&, auto*) -> net::StatusCode
+	{
+		handled_count++;
+		return respond(context, std::string(1024 * 1024, 'x'));
+	});
+
+	const size_t requests_count = 64;
+	std::string requests;
+	for (size_t i = 0; i < requests_count; i++)
+	{
+		requests += "GET / HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n";
+	}
+
+	int fd = this->connect();
+	send_all(fd, requests);
+	std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+	// Responses which are not read are not accumulated by the server.
+	ASSERT_LT(handled_count.load(), requests_count / 2);
+	auto expected = "HTTP/1.1 200 OK\r\nContent-Length: 1048576\r\n\r\n" + std::string(1024 * 1024, 'x');
+	std::string buffer;
+	for (size_t i = 0; i < requests_count; i++)
+	{
+		ASSERT_EQ(read_response(fd, buffer), expected);
+	}
+
+	ASSERT_EQ(handled_count.load(), requests_count);
+	::close(fd);
+}
+
+TEST_F(TestCase_HTTPServer, AsyncHandlerWaitsForClientToReadResponse)
+{
+	const size_t chunks_count = 64;
+	std::atomic<size_t> written_count = 0;
+	this->start([&written_count, chunks_count](auto* context, const auto&, auto*) -> util::Task<net::StatusCode>
+	{
+		std::string chunk(1024 * 1024, 'x');
+		auto head = "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(chunks_count * chunk.size()) + "\r\n\r\n";
+		context->response_writer->write(head.data(), head.size());
+		auto* writer = dynamic_cast<server::ResponseWriter*>(context->response_writer.get());
+		for (size_t i = 0; i < chunks_count && context->response_writer->write(chunk.data(), chunk.size()); i++)
+		{
+			written_count++;
+			co_await writer->drain();
+		}
+
+		co_return 200;
+	});
+
+	int fd = this->connect();
+	send_all(fd, "GET / HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+	std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+	// The rest of the response is not produced until the client reads it.
+	ASSERT_LT(written_count.load(), chunks_count / 2);
+	std::string buffer;
+	auto response = read_response(fd, buffer);
+	ASSERT_TRUE(response.starts_with("HTTP/1.1 200 OK\r\nContent-Length: 67108864\r\n\r\n"));
+	ASSERT_EQ(response.size(), 45 + chunks_count * 1024 * 1024);
+	ASSERT_EQ(written_count.load(), chunks_count);
+	::close(fd);
+}
+
+TEST_F(TestCase_HTTPServer, AsyncHandlerIsResumedWhenResponseIsNotReadInTime)
+{
+	std::atomic<bool> is_finished = false;
+	auto config = make_config();
+	config.timeout = std::chrono::milliseconds(200);
+	this->start([&is_finished](auto* context, const auto&, auto*) -> util::Task<net::StatusCode>
+	{
+		std::string chunk(1024 * 1024, 'x');
+		auto* writer = dynamic_cast<server::ResponseWriter*>(context->response_writer.get());
+		while (context->response_writer->write(chunk.data(), chunk.size()))
+		{
+			co_await writer->drain();
+		}
+
+		is_finished = true;
+		co_return 200;
+	}, config);
+
+	int fd = this->connect();
+	send_all(fd, "GET / HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+	auto start = std::chrono::steady_clock::now();
+	while (!is_finished && std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	ASSERT_TRUE(is_finished);
+	::close(fd);
+}
+
+// Creates the file of `size` bytes with different content of each part.
+static std::string make_file(const std::string& name, size_t size)
+{
+	auto path = (std::filesystem::temp_directory_path() / name).string();
+	std::string content(size, '\0');
+	for (size_t i = 0; i < size; i++)
+	{
+		content[i] = (char)('a' + (i / 4096) % 26);
+	}
+
+	std::ofstream(path, std::ios::binary) << content;
+	return path;
+}
+
+TEST_F(TestCase_HTTPServer, AsyncHandlerSendsRangesOfFile)
+{
+	auto path = make_file("xw_tests_http_server_send_file", 8 * 1024 * 1024);
+	std::ifstream file(path, std::ios::binary);
+	std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	this->start([&path](auto* context, const auto&, auto*) -> util::Task<net::StatusCode>
+	{
+		int fd = ::open(path.c_str(), O_RDONLY);
+		std::string head = "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(5 * 1024 * 1024 + 3) + "\r\n\r\n";
+		auto* writer = dynamic_cast<server::ResponseWriter*>(context->response_writer.get());
+		writer->write(head.data(), head.size());
+		writer->write_file(fd, 1024 * 1024, 4 * 1024 * 1024);
+		co_await writer->drain();
+		writer->write("-|-", 3);
+		writer->write_file(fd, 0, 1024 * 1024);
+		co_await writer->drain();
+		::close(fd);
+		co_return 200;
+	});
+
+	int fd = this->connect();
+	send_all(fd, "GET / HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+	std::string buffer;
+	auto response = read_response(fd, buffer);
+	auto body = response.substr(response.find("\r\n\r\n") + 4);
+	ASSERT_TRUE(body == content.substr(1024 * 1024, 4 * 1024 * 1024) + "-|-" + content.substr(0, 1024 * 1024));
+	::close(fd);
+	std::filesystem::remove(path);
+}
+
+TEST_F(TestCase_HTTPServer, SendsRangeOfFileBeforeBytesWrittenAfterIt)
+{
+	auto path = make_file("xw_tests_http_server_file_order", 16 * 1024 * 1024);
+	std::ifstream file(path, std::ios::binary);
+	std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	this->start([&path](auto* context, const auto&, auto*) -> net::StatusCode
+	{
+		// The synchronous handler does not wait, so the range which is not
+		// sent yet is read when the next bytes are written.
+		int fd = ::open(path.c_str(), O_RDONLY);
+		std::string head = "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(16 * 1024 * 1024 + 3) + "\r\n\r\n";
+		auto* writer = dynamic_cast<server::ResponseWriter*>(context->response_writer.get());
+		writer->write(head.data(), head.size());
+		writer->write_file(fd, 0, 16 * 1024 * 1024);
+		writer->write("end", 3);
+		::close(fd);
+		return 200;
+	});
+
+	int fd = this->connect();
+	send_all(fd, "GET / HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	std::string buffer;
+	auto response = read_response(fd, buffer);
+	auto body = response.substr(response.find("\r\n\r\n") + 4);
+	ASSERT_TRUE(body == content + "end");
+	::close(fd);
+	std::filesystem::remove(path);
+}
+
+TEST_F(TestCase_HTTPServer, BindFailsWhenAddressIsInUse)
+{
+	int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+	sockaddr_in address{};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	ASSERT_EQ(::bind(fd, (sockaddr*)&address, sizeof(address)), 0);
+	ASSERT_EQ(::listen(fd, 1), 0);
+	socklen_t size = sizeof(address);
+	::getsockname(fd, (sockaddr*)&address, &size);
+
+	auto logger_config = log::Config();
+	logger_config.disable_all_levels();
+	server::HTTPServer other(
+		server::Config{.workers = 1, .retries = 0},
+		[](auto*, const auto&, auto*) -> net::StatusCode { return 200; },
+		std::make_shared<log::Logger>(logger_config)
+	);
+	ASSERT_THROW(other.bind("127.0.0.1", ntohs(address.sin_port)), RuntimeError);
+	::close(fd);
+}
+
+TEST_F(TestCase_HTTPServer, BindFailsWhenAnotherServerListensOnAddress)
+{
+	this->start([](auto* context, const auto&, auto*) -> net::StatusCode
+	{
+		return respond(context, "");
+	});
+
+	auto logger_config = log::Config();
+	logger_config.disable_all_levels();
+	server::HTTPServer other(
+		make_config(),
+		[](auto*, const auto&, auto*) -> net::StatusCode { return 200; },
+		std::make_shared<log::Logger>(logger_config)
+	);
+	ASSERT_THROW(other.bind("127.0.0.1", this->server->port()), RuntimeError);
+}
@@ -0,0 +1,192 @@
+/**
+ * server/tests_parser.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "../../src/server/parser.h"
+
+using namespace xw;
+
+
+static server::ParseResult parse(const std::string& data, net::RequestContext& context)
+{
+	return server::parse_request_head(data, context, 1024, 8);
+}
+
+TEST(TestCase_ParseRequestHead, ParsesRequestLineAndHeaders)
+{
+	std::string data = "POST /api/items/?page=2#top HTTP/1.1\r\n"
+		"host: 127.0.0.1:8000\r\n"
+		"Content-Length: 4\r\n"
+		"X-Custom:  value \r\n"
+		"\r\n"
+		"body";
+	net::RequestContext context;
+	auto result = parse(data, context);
+
+	ASSERT_EQ(result.status, server::ParseStatus::Done);
+	ASSERT_EQ(result.size, data.size() - 4);
+	ASSERT_EQ(context.method, "POST");
+	ASSERT_EQ(context.path, "/api/items/");
+	ASSERT_EQ(context.query, "page=2");
+	ASSERT_EQ(context.protocol_version.major, 1);
+	ASSERT_EQ(context.protocol_version.minor, 1);
+	ASSERT_EQ(context.content_size, 4);
+	ASSERT_EQ(context.headers.at("Host"), "127.0.0.1:8000");
+	ASSERT_EQ(context.headers.at("X-Custom"), "value");
+}
+
+TEST(TestCase_ParseRequestHead, ParsesAbsoluteTarget)
+{
+	net::RequestContext context;
+	auto result = parse("GET http://example.com/index.html?q=1 HTTP/1.0\r\n\r\n", context);
+
+	ASSERT_EQ(result.status, server::ParseStatus::Done);
+	ASSERT_EQ(context.path, "/index.html");
+	ASSERT_EQ(context.query, "q=1");
+	ASSERT_EQ(context.protocol_version.minor, 0);
+}
+
+TEST(TestCase_ParseRequestHead, JoinsRepeatedHeaders)
+{
+	net::RequestContext context;
+	auto result = parse("GET / HTTP/1.1\r\nAccept: text/html\r\nAccept: */*\r\n\r\n", context);
+
+	ASSERT_EQ(result.status, server::ParseStatus::Done);
+	ASSERT_EQ(context.headers.at("Accept"), "text/html, */*");
+}
+
+TEST(TestCase_ParseRequestHead, ReusesHeaderNodesOfPreviousRequest)
+{
+	net::RequestContext context;
+	server::HeaderNodes spare_nodes;
+	auto result = server::parse_request_head(
+		"GET / HTTP/1.1\r\nHost: a\r\nAccept: text/html\r\nX-Old: 1\r\n\r\n", context, 1024, 8, &spare_nodes
+	);
+	ASSERT_EQ(result.status, server::ParseStatus::Done);
+
+	result = server::parse_request_head(
+		"GET / HTTP/1.1\r\nHost: b\r\nAccept: */*\r\nAccept: text/html\r\n\r\n", context, 1024, 8, &spare_nodes
+	);
+
+	ASSERT_EQ(result.status, server::ParseStatus::Done);
+	ASSERT_EQ(context.headers, (std::map<std::string, std::string>{{"Host", "b"}, {"Accept", "*/*, text/html"}}));
+	ASSERT_EQ(spare_nodes.size(), 1);
+}
+
+TEST(TestCase_ParseRequestHead, IncompleteHead)
+{
+	net::RequestContext context;
+	ASSERT_EQ(parse("GET / HTTP/1.1\r\nHost: 127.0.0.1\r\n", context).status, server::ParseStatus::Incomplete);
+	ASSERT_EQ(parse("GET / HTT", context).status, server::ParseStatus::Incomplete);
+}
+
+TEST(TestCase_ParseRequestHead, RejectsMalformedHead)
+{
+	net::RequestContext context;
+	for (const auto& data : {
+		"GET\r\n\r\n",
+		"GET /path\r\n\r\n",
+		"GET path HTTP/1.1\r\n\r\n",
+		"GET / HTTP/1.1 \r\n\r\n",
+		"G(T / HTTP/1.1\r\n\r\n",
+		"GET / HTTP/1.1\r\nHost 127.0.0.1\r\n\r\n",
+		"GET / HTTP/1.1\r\nHost : 127.0.0.1\r\n\r\n",
+		"GET / HTTP/1.1\r\nX-Folded: a\r\n b\r\n\r\n",
+		"GET / HTTP/1.1\r\nContent-Length: 1x\r\n\r\n",
+		"GET / HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\n"
+	})
+	{
+		ASSERT_EQ(parse(data, context).status, server::ParseStatus::BadRequest) << data;
+	}
+}
+
+TEST(TestCase_ParseRequestHead, RejectsUnsupportedRequests)
+{
+	net::RequestContext context;
+	ASSERT_EQ(
+		parse("GET / HTTP/2.0\r\n\r\n", context).status, server::ParseStatus::VersionNotSupported
+	);
+	ASSERT_EQ(
+		parse("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n", context).status,
+		server::ParseStatus::NotImplemented
+	);
+	ASSERT_EQ(
+		parse("POST / HTTP/1.1\r\nTransfer-Encoding: identity\r\n\r\n", context).status,
+		server::ParseStatus::Done
+	);
+}
+
+TEST(TestCase_ParseRequestHead, RejectsTooLargeHead)
+{
+	net::RequestContext context;
+	ASSERT_EQ(
+		parse("GET /" + std::string(2048, 'a') + " HTTP/1.1\r\n\r\n", context).status,
+		server::ParseStatus::HeadersTooLarge
+	);
+	ASSERT_EQ(parse("GET /" + std::string(2048, 'a'), context).status, server::ParseStatus::HeadersTooLarge);
+
+	std::string headers;
+	for (int i = 0; i < 9; i++)
+	{
+		headers += "X-Header-" + std::to_string(i) + ": value\r\n";
+	}
+
+	ASSERT_EQ(
+		parse("GET / HTTP/1.1\r\n" + headers + "\r\n", context).status, server::ParseStatus::HeadersTooLarge
+	);
+}
+
+TEST(TestCase_ParseRequestHead, DetectsKeepAlive)
+{
+	net::RequestContext context;
+	ASSERT_TRUE(parse("GET / HTTP/1.1\r\n\r\n", context).is_keep_alive);
+	ASSERT_FALSE(parse("GET / HTTP/1.1\r\nconnection: Upgrade, Close\r\n\r\n", context).is_keep_alive);
+	ASSERT_EQ(context.headers.at("Connection"), "Upgrade, Close");
+	ASSERT_FALSE(parse("GET / HTTP/1.0\r\n\r\n", context).is_keep_alive);
+	ASSERT_TRUE(parse("GET / HTTP/1.0\r\nConnection: keep-alive\r\n\r\n", context).is_keep_alive);
+}
+
+TEST(TestCase_InspectResponseHead, FindsHeadAndPersistenceHeaders)
+{
+	std::string head = "HTTP/1.1 200 OK\r\ncontent-length: 4\r\nConnection: keep-alive, close\r\n\r\n";
+	auto result = server::inspect_response_head(head + "body");
+	ASSERT_EQ(result.size, head.size());
+	ASSERT_TRUE(result.is_delimited);
+	ASSERT_TRUE(result.has_connection);
+	ASSERT_TRUE(result.is_close);
+
+	result = server::inspect_response_head("HTTP/1.1 200 OK\r\nTransfer-Encoding: gzip, chunked\r\n\r\n");
+	ASSERT_TRUE(result.is_delimited);
+	ASSERT_FALSE(result.has_connection);
+	ASSERT_FALSE(result.is_close);
+}
+
+TEST(TestCase_InspectResponseHead, UndelimitedResponse)
+{
+	ASSERT_FALSE(server::inspect_response_head("HTTP/1.1 200 OK\r\n\r\nbody").is_delimited);
+	ASSERT_FALSE(server::inspect_response_head("HTTP/1.1 200 OK\r\nTransfer-Encoding: gzip\r\n\r\n").is_delimited);
+	ASSERT_FALSE(server::inspect_response_head("HTTP/1.1 2x0 OK\r\nContent-Length: 0\r\n\r\n").is_delimited);
+	ASSERT_TRUE(server::inspect_response_head("HTTP/1.1 204 No Content\r\n\r\n").is_delimited);
+	ASSERT_TRUE(server::inspect_response_head("HTTP/1.1 304 Not Modified\r\n\r\n").is_delimited);
+}
+
+TEST(TestCase_InspectResponseHead, IncompleteHead)
+{
+	ASSERT_EQ(server::inspect_response_head("HTTP/1.1 200 OK\r\nContent-Length: 4\r\n").size, 0);
+}
+
+TEST(TestCase_ParseRequestHead, GetErrorStatusCode)
+{
+	ASSERT_EQ(server::get_error_status_code(server::ParseStatus::Done), 0);
+	ASSERT_EQ(server::get_error_status_code(server::ParseStatus::BadRequest), 400);
+	ASSERT_EQ(server::get_error_status_code(server::ParseStatus::HeadersTooLarge), 431);
+	ASSERT_EQ(server::get_error_status_code(server::ParseStatus::NotImplemented), 501);
+	ASSERT_EQ(server::get_error_status_code(server::ParseStatus::VersionNotSupported), 505);
+	ASSERT_EQ(server::get_error_status_code(server::ParseStatus::PayloadTooLarge), 413);
+}
@@ -0,0 +1,53 @@
+/**
+ * urls/tests_match.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <gtest/gtest.h>
+
+#include "../../src/urls/match.h"
+
+using namespace xw;
+
+
+TEST(TestCase_Matcher, MatchCapturesArguments)
+{
+	urls::Matcher matcher(R"(/profile/<user_id>(\d+)/(posts|photos)/<name>([a-z]+)/?)");
+	ASSERT_EQ(matcher.args_count(), 2);
+
+	std::string path = "/profile/42/posts/first/";
+	auto match = matcher.match(path);
+	ASSERT_TRUE(match);
+	ASSERT_EQ(match.size(), 2);
+	ASSERT_EQ(match.arg(0), "42");
+	ASSERT_EQ(match.arg(1), "first");
+
+	auto [user_id, name] = match.args_tuple<int, std::string>();
+	ASSERT_EQ(user_id, 42);
+	ASSERT_EQ(name, "first");
+}
+
+TEST(TestCase_Matcher, MatchRequiresWholePath)
+{
+	urls::Matcher matcher(R"(/profile/<user_id>(\d+)/?)");
+	ASSERT_FALSE(matcher.match("/profile/42/posts"));
+	ASSERT_FALSE(matcher.match("/api/profile/42"));
+}
+
+TEST(TestCase_Matcher, MatchIsIndependentOfPreviousCalls)
+{
+	urls::Matcher matcher("/static/<path>(.*)");
+	std::string first_path = "/static/first.css";
+	std::string second_path = "/static/second.css";
+	auto first = matcher.match(first_path);
+	auto second = matcher.match(second_path);
+	ASSERT_EQ(first.arg(0), "first.css");
+	ASSERT_EQ(second.arg(0), "second.css");
+}
+
+TEST(TestCase_arg_cast, ThrowsOnInvalidNumber)
+{
+	ASSERT_THROW(urls::arg_cast<int>("12a"), ValueError);
+	ASSERT_EQ(urls::arg_cast<long>("-12"), -12);
+}
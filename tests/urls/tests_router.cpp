@@ -0,0 +1,82 @@
+/**
+ * urls/tests_router.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <gtest/gtest.h>
+
+#include "../../src/urls/router.h"
+#include "../../src/urls/pattern.h"
+
+using namespace xw;
+
+
+static std::shared_ptr<urls::IPattern> make_pattern(const std::string& rgx, const std::string& name)
+{
+	return std::make_shared<urls::Pattern<>>(
+		rgx,
+		[](http::IRequest*, const std::tuple<>&, const conf::Settings*) -> std::unique_ptr<http::IResponse>
+		{
+			return nullptr;
+		},
+		name
+	);
+}
+
+TEST(TestCase_static_prefix, StopsOnArgument)
+{
+	ASSERT_EQ(urls::static_prefix(R"(/profile/<user_id>(\d+)/?)"), "/profile/");
+}
+
+TEST(TestCase_static_prefix, DropsOptionalCharacter)
+{
+	ASSERT_EQ(urls::static_prefix(R"(/profile/?)"), "/profile");
+	ASSERT_EQ(urls::static_prefix(R"(/files*)"), "/file");
+}
+
+TEST(TestCase_static_prefix, EscapedPunctuationIsLiteral)
+{
+	ASSERT_EQ(urls::static_prefix(R"(/robots\.txt)"), "/robots.txt");
+	ASSERT_EQ(urls::static_prefix(R"(/items/\d+)"), "/items/");
+}
+
+TEST(TestCase_static_prefix, TopLevelAlternation)
+{
+	ASSERT_EQ(urls::static_prefix(R"(/first|/second)"), "");
+	ASSERT_EQ(urls::static_prefix(R"(/items/(first|second))"), "/items/");
+}
+
+TEST(TestCase_Router, FindReturnsNullptrIfNotFound)
+{
+	urls::Router router({make_pattern("/users/?", "users")});
+	ASSERT_EQ(router.find("/posts").first, nullptr);
+}
+
+TEST(TestCase_Router, FindMatchesWholePath)
+{
+	auto pattern = make_pattern(R"(/users/<id>(\d+)/?)", "user");
+	urls::Router router({pattern});
+	ASSERT_EQ(router.find("/users/10/").first, pattern);
+	ASSERT_EQ(router.find("/users/10/posts").first, nullptr);
+}
+
+TEST(TestCase_Router, FirstRegisteredPatternWins)
+{
+	auto any = make_pattern("/<path>(.*)", "any");
+	auto user = make_pattern("/users/me/?", "me");
+	urls::Router router({any, user});
+	ASSERT_EQ(router.find("/users/me").first, any);
+
+	urls::Router reversed_router({user, any});
+	ASSERT_EQ(reversed_router.find("/users/me").first, user);
+	ASSERT_EQ(reversed_router.find("/users/other").first, any);
+}
+
+TEST(TestCase_Router, PrefixEndsInTheMiddleOfSegment)
+{
+	auto files = make_pattern("/files-<name>(.*)", "files");
+	urls::Router router({make_pattern("/files/?", "root"), files});
+	ASSERT_EQ(router.find("/files-archive/2021").first, files);
+	ASSERT_EQ(router.find("/file").first, nullptr);
+}
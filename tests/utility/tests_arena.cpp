@@ -0,0 +1,46 @@
+/**
+ * utility/tests_arena.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../../src/utility/arena.h"
+
+using namespace xw;
+
+
+TEST(ArenaTestCase, SmallAllocationsUseInitialBuffer)
+{
+	util::Arena arena(4096);
+	std::pmr::vector<int> items(arena.resource());
+	items.reserve(100);
+
+	ASSERT_GE(arena.allocated_bytes(), 100 * sizeof(int));
+	ASSERT_EQ(arena.heap_blocks_count(), 0);
+}
+
+TEST(ArenaTestCase, LargeAllocationsUseHeap)
+{
+	util::Arena arena(1024);
+	std::pmr::string value(4096, 'x', arena.resource());
+
+	ASSERT_EQ(value.size(), 4096);
+	ASSERT_EQ(arena.heap_blocks_count(), 1);
+}
+
+TEST(ArenaTestCase, ResetGuardReleasesMemory)
+{
+	util::Arena arena(1024);
+	{
+		util::ArenaResetGuard reset_guard(arena);
+		std::pmr::string value(4096, 'x', arena.resource());
+	}
+
+	ASSERT_EQ(arena.allocated_bytes(), 0);
+	ASSERT_EQ(arena.heap_blocks_count(), 0);
+}
@@ -0,0 +1,116 @@
+/**
+ * utility/tests_cache.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "../../src/utility/cache.h"
+#include "../../src/utility/hash.h"
+
+using namespace xw;
+
+
+// Streams a single chunk of content.
+class OneChunkResponse : public http::StreamingResponse
+{
+public:
+	explicit OneChunkResponse(std::string chunk) : StreamingResponse(200, "text/plain"), _chunk(std::move(chunk))
+	{
+	}
+
+	std::string get_chunk() override
+	{
+		return std::exchange(this->_chunk, "");
+	}
+
+	[[nodiscard]]
+	unsigned long int tell() const override
+	{
+		return 0;
+	}
+
+	void flush() override
+	{
+	}
+
+	[[nodiscard]]
+	bool readable() const override
+	{
+		return true;
+	}
+
+	[[nodiscard]]
+	bool seekable() const override
+	{
+		return false;
+	}
+
+private:
+	std::string _chunk;
+};
+
+class SetResponseETagTestCase : public ::testing::Test
+{
+protected:
+	static std::string reversed(std::string_view content)
+	{
+		return {content.rbegin(), content.rend()};
+	}
+};
+
+TEST_F(SetResponseETagTestCase, set_response_etag_DefaultFunction)
+{
+	http::Response response(200, "Hello, World!");
+	util::cache::set_response_etag(&response);
+
+	ASSERT_EQ(
+		response.get_header(http::E_TAG, ""),
+		"\"" + util::to_hex(util::xxh64("Hello, World!")) + "\""
+	);
+}
+
+TEST_F(SetResponseETagTestCase, set_response_etag_QuotesResultOfFunction)
+{
+	http::Response response(200, "abc");
+	util::cache::set_response_etag(&response, reversed);
+
+	ASSERT_EQ(response.get_header(http::E_TAG, ""), "\"cba\"");
+}
+
+TEST_F(SetResponseETagTestCase, set_response_etag_KeepsQuotedResultOfFunction)
+{
+	http::Response response(200, "abc");
+	util::cache::set_response_etag(&response, [](std::string_view) { return "W/\"abc\""; });
+
+	ASSERT_EQ(response.get_header(http::E_TAG, ""), "W/\"abc\"");
+}
+
+TEST_F(SetResponseETagTestCase, set_response_etag_WeakIfContentIsEncoded)
+{
+	http::Response response(200, "abc");
+	response.set_header(http::CONTENT_ENCODING, "gzip");
+	util::cache::set_response_etag(&response, reversed);
+
+	ASSERT_EQ(response.get_header(http::E_TAG, ""), "W/\"cba\"");
+}
+
+TEST_F(SetResponseETagTestCase, set_response_etag_SkipsEmptyContent)
+{
+	http::Response response(200, "");
+	util::cache::set_response_etag(&response, reversed);
+
+	ASSERT_FALSE(response.has_header(http::E_TAG));
+}
+
+TEST_F(SetResponseETagTestCase, set_response_etag_SkipsStreamingResponse)
+{
+	OneChunkResponse response("abc");
+	util::cache::set_response_etag(&response, reversed);
+
+	ASSERT_FALSE(response.has_header(http::E_TAG));
+	ASSERT_EQ(response.get_chunk(), "abc");
+}
@@ -0,0 +1,103 @@
+/**
+ * utility/tests_compression.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <algorithm>
+
+#include <zlib.h>
+
+#include <gtest/gtest.h>
+
+#include <xalwart.base/exceptions.h>
+
+#include "../../src/utility/compression.h"
+
+using namespace xw;
+
+
+std::string gunzip(const std::string& data)
+{
+	z_stream stream{};
+	inflateInit2(&stream, 15 + 16);
+	std::string result;
+	char buffer[1024];
+	stream.next_in = (Bytef*)data.data();
+	stream.avail_in = (uInt)data.size();
+	int status;
+	do
+	{
+		stream.next_out = (Bytef*)buffer;
+		stream.avail_out = sizeof(buffer);
+		status = inflate(&stream, Z_NO_FLUSH);
+		result.append(buffer, sizeof(buffer) - stream.avail_out);
+	}
+	while (status == Z_OK);
+	inflateEnd(&stream);
+	return result;
+}
+
+TEST(CompressionTestCase, ZlibCodingsAreAlwaysSupported)
+{
+	const auto& encodings = util::compression::supported_encodings();
+
+	ASSERT_FALSE(encodings.empty());
+	ASSERT_NE(std::find(encodings.begin(), encodings.end(), "gzip"), encodings.end());
+	ASSERT_NE(std::find(encodings.begin(), encodings.end(), "deflate"), encodings.end());
+}
+
+TEST(CompressionTestCase, compress_Gzip)
+{
+	std::string data;
+	for (int i = 0; i < 1000; i++)
+	{
+		data += "Hello, World! ";
+	}
+
+	auto compressed = util::compression::compress("gzip", data);
+
+	ASSERT_LT(compressed.size(), data.size());
+	ASSERT_EQ(gunzip(compressed), data);
+}
+
+TEST(CompressionTestCase, Compressor_StreamsData)
+{
+	auto compressor = util::compression::make_compressor("gzip", util::compression::Level::Fastest);
+	ASSERT_NE(compressor, nullptr);
+
+	auto compressed = compressor->compress("Hello, ");
+	compressed += compressor->compress("World!");
+	compressed += compressor->finish();
+
+	ASSERT_EQ(gunzip(compressed), "Hello, World!");
+}
+
+TEST(CompressionTestCase, Compressor_FlushReturnsPendingData)
+{
+	auto compressor = util::compression::make_compressor("gzip");
+	ASSERT_NE(compressor, nullptr);
+
+	auto compressed = compressor->compress("Hello, World!");
+	compressed += compressor->flush();
+
+	// Stream is not finished, but everything passed so far can be decoded.
+	ASSERT_EQ(gunzip(compressed), "Hello, World!");
+}
+
+TEST(CompressionTestCase, make_compressor_UnsupportedCoding)
+{
+	ASSERT_EQ(util::compression::make_compressor("compress"), nullptr);
+	ASSERT_THROW(util::compression::compress("compress", "data"), ArgumentError);
+}
+
+TEST(CompressionTestCase, is_compressible)
+{
+	ASSERT_TRUE(util::compression::is_compressible("text/html; charset=utf-8"));
+	ASSERT_TRUE(util::compression::is_compressible("application/javascript"));
+	ASSERT_TRUE(util::compression::is_compressible("application/ld+json"));
+	ASSERT_TRUE(util::compression::is_compressible("image/svg+xml"));
+	ASSERT_FALSE(util::compression::is_compressible("image/png"));
+	ASSERT_FALSE(util::compression::is_compressible("font/woff2"));
+	ASSERT_FALSE(util::compression::is_compressible(""));
+}
@@ -0,0 +1,38 @@
+/**
+ * utility/tests_hash.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <gtest/gtest.h>
+
+#include "../../src/utility/hash.h"
+
+using namespace xw;
+
+
+TEST(HashTestCase, xxh64_EmptyString)
+{
+	ASSERT_EQ(util::xxh64(""), 0xef46db3751d8e999ull);
+}
+
+TEST(HashTestCase, xxh64_ShortString)
+{
+	ASSERT_EQ(util::xxh64("abc"), 0x44bc2cf5ad770999ull);
+}
+
+TEST(HashTestCase, xxh64_LongString)
+{
+	ASSERT_EQ(util::xxh64("Nobody inspects the spammish repetition"), 0xfbcea83c8a378bf1ull);
+}
+
+TEST(HashTestCase, xxh64_SeedChangesHash)
+{
+	ASSERT_NE(util::xxh64("abc", 1), util::xxh64("abc"));
+}
+
+TEST(HashTestCase, to_hex)
+{
+	ASSERT_EQ(util::to_hex(0x44bc2cf5ad770999ull), "44bc2cf5ad770999");
+	ASSERT_EQ(util::to_hex(15), "000000000000000f");
+}
@@ -0,0 +1,214 @@
+/**
+ * utility/tests_task.cpp
+ *
+ * Copyright (c) 2021 Yuriy Lisovskiy
+ */
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <xalwart.base/exceptions.h>
+
+#include "../../src/utility/task.h"
+#include "../../src/utility/event_loop.h"
+
+using namespace xw;
+
+
+static util::Task<int> add(int left, int right)
+{
+	co_return left + right;
+}
+
+static util::Task<int> add_twice(int value)
+{
+	auto result = co_await add(value, value);
+	co_return co_await add(result, result);
+}
+
+static util::Task<int> fail()
+{
+	throw std::runtime_error("failed");
+	co_return 0;
+}
+
+// Resumes the coroutine from another thread, the same way
+// as a driver of a database does when the query is finished.
+static util::Task<std::string> wait_in_other_thread(util::EventLoop& loop, std::string value)
+{
+	std::thread worker;
+	auto thread_id = std::this_thread::get_id();
+	struct Awaiter
+	{
+		util::EventLoop& loop;
+		std::thread& worker;
+
+		bool await_ready() const noexcept
+		{
+			return false;
+		}
+
+		void await_suspend(std::coroutine_handle<> handle)
+		{
+			this->worker = std::thread([&loop = this->loop, handle]() { loop.schedule(handle); });
+		}
+
+		void await_resume() const noexcept
+		{
+		}
+	};
+
+	co_await Awaiter{loop, worker};
+	worker.join();
+	if (std::this_thread::get_id() != thread_id)
+	{
+		throw std::runtime_error("resumed in other thread");
+	}
+
+	co_return value + "!";
+}
+
+TEST(TaskTestCase, IsStartedWhenAwaited)
+{
+	auto task = add(1, 2);
+	ASSERT_FALSE(task.done());
+
+	ASSERT_EQ(util::EventLoop::current().run_until_complete(std::move(task)), 3);
+}
+
+TEST(TaskTestCase, AwaitsNestedTasks)
+{
+	ASSERT_EQ(util::EventLoop::current().run_until_complete(add_twice(3)), 12);
+}
+
+TEST(TaskTestCase, RethrowsException)
+{
+	ASSERT_THROW(util::EventLoop::current().run_until_complete(fail()), std::runtime_error);
+}
+
+TEST(TaskTestCase, ready_task_MovesValue)
+{
+	auto task = util::ready_task(std::make_unique<int>(5));
+	task.start();
+
+	ASSERT_TRUE(task.done());
+	ASSERT_EQ(*task.get(), 5);
+}
+
+TEST(EventLoopTestCase, run_until_complete_ResumesOnLoopThread)
+{
+	util::EventLoop loop;
+	ASSERT_EQ(loop.run_until_complete(wait_in_other_thread(loop, "value")), "value!");
+}
+
+TEST(EventLoopTestCase, run_until_complete_IsNestedBeforeFirstSuspension)
+{
+	util::EventLoop loop;
+	auto outer = [&loop]() -> util::Task<std::string>
+	{
+		auto inner = loop.run_until_complete(wait_in_other_thread(loop, "inner"));
+		co_await loop.schedule();
+		co_return inner + co_await wait_in_other_thread(loop, "outer");
+	};
+
+	ASSERT_EQ(loop.run_until_complete(outer()), "inner!outer!");
+}
+
+TEST(EventLoopTestCase, run_until_complete_ThrowsWhenCalledByResumedCoroutine)
+{
+	util::EventLoop loop;
+	bool is_thrown = false;
+	auto nested = [&loop, &is_thrown]() -> util::Task<>
+	{
+		co_await loop.schedule();
+		try
+		{
+			loop.run_until_complete(add(1, 2));
+		}
+		catch (const RuntimeError&)
+		{
+			is_thrown = true;
+		}
+	};
+
+	auto task = nested();
+	task.start();
+	loop.run_ready();
+
+	ASSERT_TRUE(task.done());
+	ASSERT_TRUE(is_thrown);
+}
+
+TEST(EventLoopTestCase, run_ready_ResumesOnlyScheduledCoroutines)
+{
+	util::EventLoop loop;
+	int steps = 0;
+	auto step = [&loop, &steps]() -> util::Task<>
+	{
+		steps++;
+		co_await loop.schedule();
+		steps++;
+	};
+	auto task = step();
+	task.start();
+
+	ASSERT_EQ(steps, 1);
+	ASSERT_EQ(loop.run_ready(), 1);
+	ASSERT_EQ(steps, 2);
+	ASSERT_TRUE(task.done());
+	ASSERT_EQ(loop.run_ready(), 0);
+}
+
+TEST(EventLoopTestCase, StartedTasksWaitAtTheSameTime)
+{
+	util::EventLoop loop;
+	auto wait_all = [&loop]() -> util::Task<std::string>
+	{
+		std::vector<util::Task<std::string>> tasks;
+		for (int i = 0; i < 10; i++)
+		{
+			tasks.push_back(wait_in_other_thread(loop, std::to_string(i)));
+			tasks.back().start();
+		}
+
+		std::string result;
+		for (auto& task : tasks)
+		{
+			result += co_await task;
+		}
+
+		co_return result;
+	};
+
+	ASSERT_EQ(loop.run_until_complete(wait_all()), "0!1!2!3!4!5!6!7!8!9!");
+}
+
+TEST(EventLoopTestCase, set_notifier_NotifiesOncePerRun)
+{
+	util::EventLoop loop;
+	int notifications_count = 0;
+	loop.set_notifier([&notifications_count]() { notifications_count++; });
+	auto step = [&loop]() -> util::Task<>
+	{
+		co_await loop.schedule();
+	};
+	auto first = step(), second = step();
+	first.start();
+	second.start();
+
+	ASSERT_EQ(notifications_count, 1);
+	ASSERT_EQ(loop.run_ready(), 2);
+	ASSERT_TRUE(first.done() && second.done());
+
+	auto third = step();
+	third.start();
+
+	ASSERT_EQ(notifications_count, 2);
+	loop.set_notifier(nullptr);
+	ASSERT_EQ(loop.run_ready(), 1);
+}